@@ -9,13 +9,18 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ShapeMeshes.h"
+#include "RenderStats.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include <vector>
+#include <cstddef>
+#include <algorithm>
 
 namespace
 {
@@ -24,23 +29,263 @@ namespace
 	const GLuint g_FloatsPerVertex = 3;	// Number of coordinates per vertex
 	const GLuint g_FloatsPerNormal = 3;	// Number of values per vertex color
 	const GLuint g_FloatsPerUV = 2;		// Number of texture coordinate values
+	const GLuint g_FloatsPerMeshVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	// the fewest segments around a round mesh, and the fewest
+	// sphere stacks, kept by the coarsest levels of detail
+	const int g_MinRoundSegments = 6;
+	const int g_MinSphereStacks = 4;
+
+	// attribute locations of the per-instance values in the vertex shader,
+	// the model matrix takes one location for each of its four columns
+	const GLuint g_InstanceModelLocation = 3;
+	const GLuint g_InstanceColorLocation = 7;
+	const GLuint g_InstanceParamsLocation = 8;
+	const GLuint g_InstanceDecodeScaleLocation = 9;
+	const GLuint g_InstanceDecodeOffsetLocation = 10;
+
+	// one vertex of the packed vertex format
+	struct PACKED_VERTEX
+	{
+		GLushort position[4];   // position within the mesh bounds, w unused
+		GLuint normal;          // octahedral normal as GL_INT_2_10_10_10_REV
+		GLuint uv;              // texture coordinate as two half floats
+	};
+
+	// steps across the bounding box of a packed position, and
+	// steps from 0 to 1 of a packed normal value
+	const float g_PositionSteps = 65535.0f;
+	const float g_NormalSteps = 511.0f;
+
+	///////////////////////////////////////////////////
+	//	AddVertex()
+	//
+	//	Append one interleaved vertex to the passed in
+	//  vertex data.
+	///////////////////////////////////////////////////
+	void AddVertex(
+		std::vector<GLfloat>& verts,
+		const glm::vec3& position,
+		const glm::vec3& normal,
+		const glm::vec2& uv)
+	{
+		verts.push_back(position.x);
+		verts.push_back(position.y);
+		verts.push_back(position.z);
+		verts.push_back(normal.x);
+		verts.push_back(normal.y);
+		verts.push_back(normal.z);
+		verts.push_back(uv.x);
+		verts.push_back(uv.y);
+	}
+
+	///////////////////////////////////////////////////
+	//	GetSliceDirection()
+	//
+	//	Get the direction out from the Y axis to a slice
+	//  of a round mesh, starting along the X axis and
+	//  turning toward -Z.
+	///////////////////////////////////////////////////
+	glm::vec3 GetSliceDirection(int slice, int slices)
+	{
+		float angle = glm::two_pi<float>() * slice / slices;
+		return(glm::vec3(glm::cos(angle), 0.0f, -glm::sin(angle)));
+	}
+
+	///////////////////////////////////////////////////
+	//	GetLevelSegments()
+	//
+	//	Get the number of segments of a level of detail,
+	//  halved for every level down to the minimum.  A
+	//  mesh made with fewer than the minimum keeps its
+	//  own number at every level.
+	///////////////////////////////////////////////////
+	int GetLevelSegments(int segments, int minimum, int lod)
+	{
+		return(std::max(std::min(segments, minimum), segments >> lod));
+	}
+
+	///////////////////////////////////////////////////
+	//	GetDecodeScale()
+	//
+	//	Get the size of the bounding box that packed
+	//  positions are spread across.  A flat side keeps
+	//  a size of 1, so the packing can still divide
+	//  by it.
+	///////////////////////////////////////////////////
+	glm::vec3 GetDecodeScale(const ShapeMeshes::MESH_BOUNDS& bounds)
+	{
+		glm::vec3 scale = bounds.boxMax - bounds.boxMin;
+		for (int i = 0; i < 3; i++)
+		{
+			if (scale[i] <= 0.0f)
+			{
+				scale[i] = 1.0f;
+			}
+		}
+		return(scale);
+	}
+
+	///////////////////////////////////////////////////
+	//	DecodeOctahedral()
+	//
+	//	Get the unit normal of a point on the octahedron
+	//  unfolded into the -1 to 1 square, the same way
+	//  the vertex shader does.
+	///////////////////////////////////////////////////
+	glm::vec3 DecodeOctahedral(const glm::vec2& encoded)
+	{
+		glm::vec3 normal(encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y));
+		if (normal.z < 0.0f)
+		{
+			normal.x = (1.0f - glm::abs(encoded.y)) * ((encoded.x >= 0.0f) ? 1.0f : -1.0f);
+			normal.y = (1.0f - glm::abs(encoded.x)) * ((encoded.y >= 0.0f) ? 1.0f : -1.0f);
+		}
+		return(glm::normalize(normal));
+	}
+
+	///////////////////////////////////////////////////
+	//	EncodeOctahedral()
+	//
+	//	Pack a normal into the first two 10-bit values of
+	//  a GL_INT_2_10_10_10_REV.  The normal is projected
+	//  onto the octahedron |x| + |y| + |z| = 1, and the
+	//  lower half is folded over the corners of the
+	//  upper half.  Of the four nearest steps, the one
+	//  decoding closest to the normal is kept.
+	///////////////////////////////////////////////////
+	GLuint EncodeOctahedral(const glm::vec3& normal)
+	{
+		float length = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+		if (length <= 0.0f)
+		{
+			return(glm::packSnorm3x10_1x2(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f)));
+		}
+
+		glm::vec3 unit = normal / length;
+		glm::vec2 encoded(unit.x, unit.y);
+		if (unit.z < 0.0f)
+		{
+			encoded.x = (1.0f - glm::abs(unit.y)) * ((unit.x >= 0.0f) ? 1.0f : -1.0f);
+			encoded.y = (1.0f - glm::abs(unit.x)) * ((unit.y >= 0.0f) ? 1.0f : -1.0f);
+		}
+
+		glm::vec3 target = glm::normalize(normal);
+		glm::vec2 base = glm::floor(encoded * g_NormalSteps);
+		glm::vec2 best = base;
+		float bestDot = -2.0f;
+		for (int corner = 0; corner < 4; corner++)
+		{
+			glm::vec2 steps = glm::clamp(base + glm::vec2(corner & 1, corner >> 1), -g_NormalSteps, g_NormalSteps);
+			float dot = glm::dot(DecodeOctahedral(steps / g_NormalSteps), target);
+			if (dot > bestDot)
+			{
+				best = steps;
+				bestDot = dot;
+			}
+		}
+		return(glm::packSnorm3x10_1x2(glm::vec4(best / g_NormalSteps, 0.0f, 0.0f)));
+	}
+
+	///////////////////////////////////////////////////
+	//	PackVertex()
+	//
+	//	Pack one interleaved float vertex, storing its
+	//  position as steps across the passed in bounds.
+	///////////////////////////////////////////////////
+	PACKED_VERTEX PackVertex(
+		const GLfloat* vertex,
+		const ShapeMeshes::MESH_BOUNDS& bounds)
+	{
+		PACKED_VERTEX packed;
+		glm::vec3 position(vertex[0], vertex[1], vertex[2]);
+		glm::vec3 steps = glm::clamp((position - bounds.boxMin) / GetDecodeScale(bounds), 0.0f, 1.0f) * g_PositionSteps;
+
+		for (int i = 0; i < 3; i++)
+		{
+			packed.position[i] = (GLushort)(steps[i] + 0.5f);
+		}
+		packed.position[3] = 0;
+		packed.normal = EncodeOctahedral(glm::vec3(vertex[3], vertex[4], vertex[5]));
+		packed.uv = glm::packHalf2x16(glm::vec2(vertex[6], vertex[7]));
+		return(packed);
+	}
+
+	///////////////////////////////////////////////////
+	//	UnpackVertex()
+	//
+	//	Read back the values of a packed vertex the way
+	//  the GPU reads them, with the position moved back
+	//  into the passed in bounds.
+	///////////////////////////////////////////////////
+	void UnpackVertex(
+		const PACKED_VERTEX& packed,
+		const ShapeMeshes::MESH_BOUNDS& bounds,
+		glm::vec3& position,
+		glm::vec3& normal,
+		glm::vec2& uv)
+	{
+		glm::vec3 steps(packed.position[0], packed.position[1], packed.position[2]);
+		position = bounds.boxMin + (steps / g_PositionSteps) * GetDecodeScale(bounds);
+		normal = DecodeOctahedral(glm::vec2(glm::unpackSnorm3x10_1x2(packed.normal)));
+		uv = glm::unpackHalf2x16(packed.uv);
+	}
 }
 
 ShapeMeshes::ShapeMeshes()
 {
 	m_bMemoryLayoutDone = false;
+	m_vertexFormat = VERTEX_FORMAT_FLOAT;
+	m_instanceVBO = 0;
+	m_instanceCapacity = 0;
+	m_bInstanceLayoutDone = false;
+	m_indirectBuffer = 0;
+	m_indirectCapacity = 0;
+	m_arenaVAO = 0;
+	m_arenaVBOs[0] = 0;
+	m_arenaVBOs[1] = 0;
+	m_bArenaDirty = false;
+	m_bArenaBound = false;
+	m_bOptimizeVertexCache = true;
+
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		// every level is cleared, then only the full mesh is
+		// kept until levels of detail are loaded
+		m_lodCounts[i] = LOD_COUNT;
+		for (int lod = 0; lod < LOD_COUNT; lod++)
+		{
+			GLMesh* pMesh = GetMesh((MESH_TYPE)i, lod);
+			pMesh->baseVertex = 0;
+			pMesh->nVertices = 0;
+			pMesh->firstIndex = 0;
+			pMesh->nIndices = 0;
+			for (int part = 0; part < PART_COUNT; part++)
+			{
+				pMesh->parts[part].firstIndex = 0;
+				pMesh->parts[part].nIndices = 0;
+			}
+			pMesh->bounds.boxMin = glm::vec3(0.0f);
+			pMesh->bounds.boxMax = glm::vec3(0.0f);
+			pMesh->bounds.sphereCenter = glm::vec3(0.0f);
+			pMesh->bounds.sphereRadius = 0.0f;
+			pMesh->error = 0.0f;
+		}
+		m_lodCounts[i] = 1;
+	}
 }
 
 ///////////////////////////////////////////////////
 //	LoadBoxMesh()
 //
 //	Create a box mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//  add it to the shared mesh buffers.  The normals and texture
 //  coordinates are also set.
 //
-//	Correct triangle drawing command:
-//
-//	glDrawElements(GL_TRIANGLES, meshes.gBoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+//  The triangle list indices are added with
+//  AddMeshIndices(), which reorders them for the vertex
+//  cache, and the mesh is drawn as an indexed triangle
+//  range of the shared index buffer.
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadBoxMesh()
 {
@@ -105,481 +350,54 @@ void ShapeMeshes::LoadBoxMesh()
 	m_BoxMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 	m_BoxMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
 
-	glGenVertexArrays(1, &m_BoxMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_BoxMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(2, m_BoxMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_BoxMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BoxMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// add the mesh to the shared vertex and index buffers
+	AddMeshVertices(m_BoxMesh, verts);
+	AddMeshIndices(m_BoxMesh, indices, sizeof(indices) / sizeof(indices[0]));
 }
 
 ///////////////////////////////////////////////////
 //	LoadConeMesh()
 //
-//	Create a cole mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//	Create a cone mesh with the passed in number of
+//  slices around its side, and coarser levels of
+//  detail with fewer slices, and add them to the
+//  shared mesh buffers.  The normals and texture
 //  coordinates are also set.
 //
-//  Correct triangle drawing commands:
-//
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
+//  The bottom and sides are stored as mesh parts.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadConeMesh()
+void ShapeMeshes::LoadConeMesh(int slices)
 {
-	GLfloat verts[] = {
-		// cone bottom			// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cone sides		// normals									// texture coords
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		1.0f,0.5f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.0f, -0.116841137f, 		0.983f,0.6f,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f, 		0.983f,0.6f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f, 		0.96f,0.68f,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f, 		0.96f,0.68f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f, 		0.92f,0.77f,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f, 		0.92f,0.77f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f, 		0.87f, 0.83f,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f, 		0.87f, 0.83f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f, 		0.83f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f, 		0.83f, 0.87f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f, 		0.77f, 0.92f,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f, 		0.77f, 0.92f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f, 		0.68f, 0.96f,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f, 		0.68f, 0.96f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f, 		0.6f, 0.983f,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f, 		0.6f, 0.983f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f, 		0.41f, 0.983f,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f, 		0.41f, 0.983f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f, 		0.33f, 0.96f,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f, 		0.33f, 0.96f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f, 		0.25f, 0.92f,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f, 		0.25f, 0.92f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f, 		0.17f, 0.87f,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f, 		0.17f, 0.87f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f, 		0.13f, 0.83f,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f, 		0.13f, 0.83f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f, 		0.08f, 0.77f,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f, 		0.08f, 0.77f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f, 		0.04f, 0.68f,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f, 		0.04f, 0.68f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f, 		0.017f, 0.6f,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f, 		0.017f, 0.6f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f, 		0.5f, 0.5f,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f, 		0.017f, 0.41f,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f, 		0.017f, 0.41f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, 0.229039446f, 		0.5f, 0.5f,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f, 		0.04f, 0.33f,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f, 		0.04f, 0.33f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, 0.400818795f, 		0.5f, 0.5f,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f, 		0.08f, 0.25f,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f, 		0.08f, 0.25f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, 0.581238329f, 		0.5f, 0.5f,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f, 		0.13f, 0.17f,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f, 		0.13f, 0.17f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, 0.707106769f, 		0.5f, 0.5f,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f, 		0.17f, 0.13f,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f, 		0.17f, 0.13f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, 0.813733339f, 		0.5f, 0.5f,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f, 		0.25f, 0.08f,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f, 		0.25f, 0.08f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, 0.916157305f, 		0.5f, 0.5f,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f, 		0.33f, 0.04f,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f, 		0.33f, 0.04f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, 0.973417103f, 		0.5f, 0.5f,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f, 		0.41f, 0.017f,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f, 		0.41f, 0.017f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.0f,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.0f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f, 	0.6f, 0.017f,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f, 	0.6f, 0.017f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, 0.973417103f, 	0.5f, 0.5f,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f, 	0.68f, 0.04f,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f, 	0.68f, 0.04f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, 0.916157305f, 	0.5f, 0.5f,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f, 	0.77f, 0.08f,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f, 	0.77f, 0.08f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, 0.813733339f, 	0.5f, 0.5f,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f, 	0.83f, 0.13f,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f, 	0.83f, 0.13f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, 0.707106769f, 	0.5f, 0.5f,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f, 	0.87f, 0.17f,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f, 	0.87f, 0.17f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, 0.581238329f, 	0.5f, 0.5f,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f, 	0.92f, 0.25f,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f, 	0.92f, 0.25f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, 0.400818795f, 	0.5f, 0.5f,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f, 	0.96f, 0.33f,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f, 	0.96f, 0.33f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, 0.229039446f, 	0.5f, 0.5f,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f, 	0.983f, 0.41f,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f, 	0.983f, 0.41f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	0.5f, 0.5f,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	1.0f, 0.5f
-	};
-
-	// store vertex and index count
-	m_ConeMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_ConeMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_ConeMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_ConeMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_ConeMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_ConeMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadCylinderLevels(MESH_CONE, slices, 0.0f);
 }
 
 ///////////////////////////////////////////////////
 //	LoadCylinderMesh()
 //
-//	Create a cylinder mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//	Create a cylinder mesh with the passed in number
+//  of slices around its side, and coarser levels of
+//  detail with fewer slices, and add them to the
+//  shared mesh buffers.  The normals and texture
 //  coordinates are also set.
 //
-//  Correct triangle drawing commands:
-//
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 36);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+//  The bottom, top and sides are stored as mesh parts.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadCylinderMesh()
+void ShapeMeshes::LoadCylinderMesh(int slices)
 {
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 1.0f, -0.34f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 1.0f, -0.64f,		0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 1.0f, -0.77f,		0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 1.0f, -0.94f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 1.0f, -0.98f,		0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -1.0f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 1.0f, -0.98f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 1.0f, -0.94f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 1.0f, -0.77f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 1.0f, -0.64f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 1.0f, -0.34f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 1.0f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.5f, -0.116841137f,	0.0277,0.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.0277,1.0,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.0277,0.0,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f,	0.0554,0.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f,	0.0277,1.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,1.0,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,0.0,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f,	0.0831,0.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,1.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f,	0.1108,0.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,1.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,1.0,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f,	0.1385,0.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,1.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385,1.0,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385,0.0,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f,	0.1662,0.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385, 1.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f,	0.1939, 0.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 1.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 1.0,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f,	0.2216, 0.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 1.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 1.0,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 0.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 0.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 1.0,
-		0.0f, 1.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 1.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f,	0.277, 0.0,
-		0.0f, 1.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f,	0.2493, 1.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f,	0.3047, 0.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 1.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f,	0.3324, 0.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 1.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f,	0.3601, 0.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 1.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f,	0.3878, 0.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 1.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f,	0.4155, 0.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 1.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f,	0.4432, 0.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 1.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f,	0.4709, 0.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 1.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 1.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f,	0.5263, 0.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f,	0.4986, 1.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f,	0.554, 0.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 1.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f,	0.5817, 0.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 1.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f,	0.6094, 0.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 1.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f,	0.6371, 0.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 1.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f,	0.6648, 0.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 1.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f,	0.6925, 0.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 1.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f,	0.7202, 0.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 1.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 0.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 0.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 1.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 1.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f,	0.7756, 0.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 1.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 1.0,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f,	0.8033, 0.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 1.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 1.0,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 0.0,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f,	0.831, 0.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 1.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f,	0.8587, 0.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 1.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 1.0,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f,	0.8864, 0.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 1.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 1.0,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 0.0,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f,	0.9141, 0.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 1.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f,	0.9418, 0.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 1.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 1.0,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 0.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f,	0.9695, 0.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 1.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 1.0,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 0.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 1.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0
-	};
-
-	glm::vec3 normal;
-
-	normal = CalculateTriangleNormal(glm::vec3(.98f, 1.0f, 0.17f), glm::vec3(.98f, 0.0f, 0.17f), glm::vec3(1.0f, 0.0f, 0.0f));
-
-	// store vertex and index count
-	m_CylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_CylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_CylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_CylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_CylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_CylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadCylinderLevels(MESH_CYLINDER, slices, 1.0f);
 }
 
 ///////////////////////////////////////////////////
 //	LoadPlaneMesh()
 //
 //	Create a plane mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//  add it to the shared mesh buffers.  The normals and texture
 //  coordinates are also set.
 // 
-//  Correct triangle drawing command:
-//
-//	glDrawElements(GL_TRIANGLES, meshes.gPlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+//  The triangle list indices are added with
+//  AddMeshIndices(), which reorders them for the vertex
+//  cache, and the mesh is drawn as an indexed triangle
+//  range of the shared index buffer.
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPlaneMesh()
 {
@@ -602,34 +420,23 @@ void ShapeMeshes::LoadPlaneMesh()
 	m_PlaneMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 	m_PlaneMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
 
-	// Generate the VAO for the mesh
-	glGenVertexArrays(1, &m_PlaneMesh.vao);
-	glBindVertexArray(m_PlaneMesh.vao);	// activate the VAO
-
-	// Create VBOs for the mesh
-	glGenBuffers(2, m_PlaneMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PlaneMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_PlaneMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// add the mesh to the shared vertex and index buffers
+	AddMeshVertices(m_PlaneMesh, verts);
+	AddMeshIndices(m_PlaneMesh, indices, sizeof(indices) / sizeof(indices[0]));
 }
 
 ///////////////////////////////////////////////////
 //	LoadPrismMesh()
 //
 //	Create a prism mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//  add it to the shared mesh buffers.  The normals and texture
 //  coordinates are also set.
 //
-//	Correct triangle drawing command:
-//
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPrismMesh.nVertices);
+//  The vertices are laid out as a triangle strip, which
+//  AddMeshTriangles() turns into triangle list indices
+//  reordered for the vertex cache, so the mesh is drawn
+//  as an indexed triangle range of the shared index
+//  buffer like every other mesh.
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPrismMesh()
 {
@@ -684,30 +491,21 @@ void ShapeMeshes::LoadPrismMesh()
 
 	m_PrismMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_PrismMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_PrismMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(1, m_PrismMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PrismMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// add the mesh to the shared vertex and index buffers
+	AddMeshVertices(m_PrismMesh, verts);
+	AddMeshTriangles(m_PrismMesh, GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
 }
 
 ///////////////////////////////////////////////////
 //	LoadPyramid3Mesh()
 //
 //	Create a 3-sided pyramid mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
+//  vertices and add it to the shared mesh buffers.  The normals 
 //  and texture coordinates are also set.
 //
-//  Correct triangle drawing command:
-//
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, gPyramid3Mesh.nVertices);
+//  Like the prism, the triangle strip is turned into
+//  cache ordered triangle list indices by
+//  AddMeshTriangles().
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid3Mesh()
 {
@@ -739,29 +537,21 @@ void ShapeMeshes::LoadPyramid3Mesh()
 	// Calculate total defined vertices
 	m_Pyramid3Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_Pyramid3Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid3Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid3Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid3Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// add the mesh to the shared vertex and index buffers
+	AddMeshVertices(m_Pyramid3Mesh, verts);
+	AddMeshTriangles(m_Pyramid3Mesh, GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
 }
 
 ///////////////////////////////////////////////////
 //	LoadPyramid4Mesh()
 //
 //	Create a 4-sided pyramid mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
+//  vertices and add it to the shared mesh buffers.  The normals 
 //  and texture coordinates are also set.
 //
-//  Correct triangle drawing command:
-//
-//	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPyramid4Mesh.nVertices);
+//  Like the prism, the triangle strip is turned into
+//  cache ordered triangle list indices by
+//  AddMeshTriangles().
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid4Mesh()
 {
@@ -802,1389 +592,359 @@ void ShapeMeshes::LoadPyramid4Mesh()
 	// Calculate total defined vertices
 	m_Pyramid4Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_Pyramid4Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid4Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid4Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid4Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// add the mesh to the shared vertex and index buffers
+	AddMeshVertices(m_Pyramid4Mesh, verts);
+	AddMeshTriangles(m_Pyramid4Mesh, GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
 }
 
 ///////////////////////////////////////////////////
 //	LoadSphereMesh()
 //
-//	Create a sphere mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//  Correct triangle drawing command:
+//	Create a sphere mesh with the passed in number of
+//  slices around it and stacks from top to bottom,
+//  and coarser levels of detail with fewer of each,
+//  and add them to the shared mesh buffers.  The
+//  normals and texture coordinates are also set.
 //
-//	glDrawElements(GL_TRIANGLES, meshes.gSphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+//  The triangles are stored from the top down, so
+//  the first half of the indices is the top half of
+//  the sphere when the number of stacks is even.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadSphereMesh()
+void ShapeMeshes::LoadSphereMesh(int slices, int stacks)
 {
-	GLfloat verts[] = {
-		// vertex data					// texture coords			// index
-		// top center point
-		0.0f, 1.0f, 0.0f,				0.5f, 1.0f,					//0
-		// ring 1
-		0.0f, 0.9808f, 0.1951f,			0.5f, 0.9375f,				//1
-		0.0747f, 0.9808f, 0.1802f,		0.51219375f, 0.9375f,		//2
-		0.1379f, 0.9808f, 0.1379f,		0.5243875f, 0.9375f,		//3
-		0.1802f, 0.9808f, 0.0747f,		0.53658125f, 0.9375f,		//4
-		0.1951f, 0.9808, 0.0f,			0.548775f, 0.9375f,			//5
-		0.1802f, 0.9808f, -0.0747f,		0.56096875f, 0.9375f,		//6
-		0.1379f, 0.9808f, -0.1379f,		0.5731625f, 0.9375f,		//7
-		0.0747f, 0.9808f, -0.1802f,		0.58535625f, 0.9375f,		//8
-		0.0f, 0.9808f, -0.1951f,		0.59755f, 0.9375f,			//9 - seam
-		0.0f, 0.9808f, -0.1951f,		0.40245f, 0.9375f,			//10 - seam
-		-0.0747f, 0.9808f, -0.1802f,	0.41464375f, 0.9375f,		//11
-		-0.1379f, 0.9808f, -0.1379f,	0.4268375f, 0.9375f,		//12
-		-0.1802f, 0.9808f, -0.0747f,	0.43903125f, 0.9375f,		//13
-		-0.1951f, 0.9808, 0.0f,			0.451225f, 0.9375f,			//14
-		-0.1802f, 0.9808f, 0.0747f,		0.46341875f, 0.9375f,		//15
-		-0.1379f, 0.9808f, 0.1379f,		0.4756125f, 0.9375f,		//16
-		-0.0747f, 0.9808f, 0.1802f,		0.48780625f, 0.9375f,		//17
-		// ring 2
-		0.0f, 0.9239f, 0.3827f,			0.5f, 0.875f,				//18
-		0.1464f, 0.9239f, 0.3536f,		0.52391875f, 0.875f,		//19
-		0.2706f, 0.9239f, 0.2706f,		0.5478375f, 0.875f,			//20
-		0.3536f, 0.9239f, 0.1464f,		0.57175625f, 0.875f,		//21
-		0.3827f, 0.9239f, 0.0f,			0.5956755f, 0.875f,			//22
-		0.3536f, 0.9239f, -0.1464f,		0.61959425f, 0.875f,		//23
-		0.2706f, 0.9239f, -0.2706f,		0.643513f, 0.875f,			//24
-		0.1464f, 0.9239f, -0.3536f,		0.66743175f, 0.875f,		//25
-		0.0f, 0.9239f, -0.3827f,		0.6913505f, 0.875f,			//26 - seam
-		0.0f, 0.9239f, -0.3827f,		0.3086495f, 0.875f,			//27 - seam
-		-0.1464f, 0.9239f, -0.3536f,	0.33256825f, 0.875f,		//28
-		-0.2706f, 0.9239f, -0.2706f,	0.356487f, 0.875f,			//29
-		-0.3536f, 0.9239f, -0.1464f,	0.38040575f, 0.875f,		//30
-		-0.3827f, 0.9239f, 0.0f,		0.4043245f, 0.875f,			//31
-		-0.3536f, 0.9239f, 0.1464f,		0.42824325f, 0.875f,		//32
-		-0.2706f, 0.9239f, 0.2706f,		0.452162f, 0.875f,			//33
-		-0.1464f, 0.9239f, 0.3536f,		0.47608075f, 0.875f,		//34
-		// ring 3
-		0.0f, 0.8315f, 0.5556f,			0.5f, 0.8125f,				//35
-		0.2126f, 0.8315f, 0.5133f,		0.534725f, 0.8125f,			//36
-		0.3928f, 0.8315f, 0.3928f,		0.56945f, 0.8125f,			//37
-		0.5133f, 0.8315f, 0.2126f,		0.604175f, 0.8125f,			//38
-		0.5556f, 0.8315f, 0.0f,			0.6389f, 0.8125f,			//39
-		0.5133f, 0.8315f, -0.2126f,		0.673625f, 0.8125f,			//40
-		0.3928f, 0.8315f, -0.3928f,		0.70835f, 0.8125f,			//41
-		0.2126f, 0.8315f, -0.5133f,		0.743075f, 0.8125f,			//42
-		0.0f, 0.8315f, -0.5556f,		0.7778f, 0.8125f,			//43 - seam
-		0.0f, 0.8315f, -0.5556f,		0.2222f, 0.8125f,			//44 - seam
-		-0.2126f, 0.8315f, -0.5133f,	0.256925f, 0.8125f,			//45
-		-0.3928f, 0.8315f, -0.3928f,	0.29165f, 0.8125f,			//46
-		-0.5133f, 0.8315f, -0.2126f,	0.326375f, 0.8125f,			//47
-		-0.5556f, 0.8315f, 0.0f,		0.3611f, 0.8125f,			//48
-		-0.5133f, 0.8315f, 0.2126f,		0.395825f, 0.8125f,			//49
-		-0.3928f, 0.8315f, 0.3928f,		0.43055f, 0.8125f,			//50
-		-0.2126f, 0.8315f, 0.5133f,		0.465275f, 0.8125f,			//51
-		// ring 4
-		0.0f, 0.7071f, 0.7071f,			0.5f, 0.75f,				//52
-		0.2706f, 0.7071f, 0.6533f,		0.54419375f, 0.75f,			//53
-		0.5f, 0.7071f, 0.5f,			0.5883875f, 0.75f,			//54
-		0.6533f, 0.7071f, 0.2706f,		0.63258125f, 0.75f,			//55
-		0.7071f, 0.7071f, 0.0f,			0.676775f, 0.75f,			//56
-		0.6533f, 0.7071f, -0.2706f,		0.72096875f, 0.75f,			//57
-		0.5f, 0.7071f, -0.5f,			0.7651625f, 0.75f,			//58
-		0.2706f, 0.7071f, -0.6533f,		0.80935625f, 0.75f,			//59
-		0.0f, 0.7071f, -0.7071f,		0.85355f, 0.75f,			//60 - seam
-		0.0f, 0.7071f, -0.7071f,		0.14645f, 0.75f,			//61 - seam
-		-0.2706f, 0.7071f, -0.6533f,	0.19064375f, 0.75f,			//62
-		-0.5f, 0.7071f, -0.5f,			0.2348375f, 0.75f,			//63
-		-0.6533f, 0.7071f, -0.2706f,	0.27903135f, 0.75f,			//64
-		-0.7071f, 0.7071f, 0.0f,		0.323225f, 0.75f,			//65
-		-0.6533f, 0.7071f, 0.2706f,		0.36741875f, 0.75f,			//66
-		-0.5f, 0.7071f, 0.5f,			0.4116125f, 0.75f,			//67
-		-0.2706f, 0.7071f, 0.6533f,		0.45580625f, 0.75f,			//68
-		// ring 5
-		0.0f, 0.5556f, 0.8315f,			0.5f, 0.6875f,				//69
-		0.3182f, 0.5556f, 0.7682f,		0.55196875f, 0.6875f,		//70
-		0.5879f, 0.5556f, 0.5879f,		0.6039375f, 0.6875f,		//71
-		0.7682f, 0.5556f, 0.3182f,		0.65590625f, 0.6875f,		//72
-		0.8315f, 0.5556f, 0.0f,			0.707875f, 0.6875f,			//73
-		0.7682f, 0.5556f, -0.3182f,		0.75984375f, 0.6875f,		//74
-		0.5879f, 0.5556f, -0.5879f,		0.8118125f, 0.6875f,		//75
-		0.3182f, 0.5556f, -0.7682f,		0.86378125f, 0.6875f,		//76
-		0.0f, 0.5556f, -0.8315f,		0.91575f, 0.6875f,			//77 - seam
-		0.0f, 0.5556f, -0.8315f,		0.08425f, 0.6875f,			//78 - seam
-		-0.3182f, 0.5556f, -0.7682f,	0.13621875f, 0.6875f,		//79
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.6875f,		//80
-		-0.7682f, 0.5556f, -0.3182f,	0.24015625f, 0.6875f,		//81
-		-0.8315f, 0.5556f, 0.0f,		0.292125f, 0.6875f,			//82
-		-0.7682f, 0.5556f, 0.3182f,		0.34409375f, 0.6875f,		//83
-		-0.5879f, 0.5556f, 0.5879f,		0.3960625f, 0.6875f,		//84
-		-0.3182f, 0.5556f, 0.7682f,		0.44803125f, 0.6875f,		//85
-		//ring 6
-		0.0f, 0.3827f, 0.9239f,			0.5f, 0.625f,				//86
-		0.3536f, 0.3827f, 0.8536f,		0.55774375f, 0.625f,		//87
-		0.6533f, 0.3827f, 0.6533f,		0.6154875f, 0.625f,			//88
-		0.8536f, 0.3827f, 0.3536f,		0.67323125f, 0.625f,		//89
-		0.9239f, 0.3827f, 0.0f,			0.730975f, 0.625f,			//90
-		0.8536f, 0.3827f, -0.3536f,		0.78871875f, 0.625f,		//91
-		0.6533f, 0.3827f, -0.6533f,		0.8464625f, 0.625f,			//92
-		0.3536f, 0.3827f, -0.8536f,		0.90420625f, 0.625f,		//93
-		0.0f, 0.3827f, -0.9239f,		0.96195f, 0.625f,			//94 - seam
-		0.0f, 0.3827f, -0.9239f,		0.03805f, 0.625f,			//95 - seam
-		-0.3536f, 0.3827f, -0.8536f,	0.09579375f, 0.625f,		//96
-		-0.6533f, 0.3827f, -0.6533f,	0.1535375f, 0.625f,			//97
-		-0.8536f, 0.3827f, -0.3536f,	0.21128125f, 0.625f,		//98
-		-0.9239f, 0.3827f, 0.0f,		0.269025f, 0.625f,			//99
-		-0.8536f, 0.3827f, 0.3536f,		0.32676875f, 0.625f,		//100
-		-0.6533f, 0.3827f, 0.6533f,		0.3845125f, 0.625f,			//101
-		-0.3536f, 0.3827f, 0.8536f,		0.44225625f, 0.625f,		//102
-		// ring 7
-		0.0f, 0.1951f, 0.9808f,			0.5f, 0.5625f,				//103
-		0.3753f, 0.1915f, 0.9061f,		0.5613f, 0.5625f,			//104
-		0.6935f, 0.1915f, 0.6935f,		0.6226f, 0.5625f,			//105
-		0.9061f, 0.1915f, 0.3753f,		0.6839f, 0.5625f,			//106
-		0.9808f, 0.1915f, 0.0f,			0.7452f, 0.5625f,			//107
-		0.9061f, 0.1915f, -0.3753f,		0.8065f, 0.5625f,			//108
-		0.6935f, 0.1915f, -0.6935f,		0.8678f, 0.5625f,			//109
-		0.3753f, 0.1915f, -0.9061f,		0.9291f, 0.5625f,			//110
-		0.0f, 0.1915f, -0.9808f,		0.9904f, 0.5625f,			//111 - seam
-		0.0f, 0.1915f, -0.9808f,		0.0096f, 0.5625f,			//112 - seam
-		-0.3753f, 0.1915f, -0.9061f,	0.0709f, 0.5625f,			//113
-		-0.6935f, 0.1915f, -0.6935f,	0.1322f, 0.5625f,			//114
-		-0.9061f, 0.1915f, -0.3753f,	0.1935f, 0.5625f,			//115
-		-0.9808f, 0.1915f, 0.0f,		0.2548f, 0.5625f,			//116
-		-0.9061f, 0.1915f, 0.3753f,		0.3161f, 0.5625f,			//117
-		-0.6935f, 0.1915f, 0.6935f,		0.3774f, 0.5625f,			//118
-		-0.3753f, 0.1915f, 0.9061f,		0.4387f, 0.5625f,			//119
-		// ring 8
-		0.0f, 0.0f, 1.0f,				0.5f, 0.5f,					//120
-		0.3827f, 0.0f, 0.9239f,			0.5625f, 0.5f,				//121
-		0.7071f, 0.0f, 0.7071f,			0.625f, 0.5f,				//122
-		0.9239f, 0.0f, 0.3827f,			0.6875f, 0.5f,				//123
-		1.0f, 0.0f, 0.0f,				0.75f, 0.5f,				//124
-		0.9239f, 0.0f, -0.3827f,		0.8125f, 0.5f,				//125
-		0.7071f, 0.0f, -0.7071f,		0.875f, 0.5f,				//126
-		0.3827f, 0.0f, -0.9239f,		0.9375f, 0.5f,				//127
-		0.0f, 0.0f, -1.0f,				1.0f, 0.5f,					//128 - seam
-		0.0f, 0.0f, -1.0f, 				0.0f, 0.5f,					//129 - seam
-		-0.3827f, 0.0f, -0.9239f,		0.0625f, 0.5f,				//130
-		-0.7071f, 0.0f, -0.7071f,		0.125f, 0.5f,				//131
-		-0.9239f, 0.0f, -0.3827f,		0.1875f, 0.5f,				//132
-		-1.0f, 0.0f, 0.0f,				0.25f, 0.5f,				//133
-		-0.9239f, 0.0f, 0.3827f,		0.3125f, 0.5f,				//134
-		-0.7071, 0.0, 0.7071f,			0.375f, 0.5f,				//135
-		-0.3827f, 0.0f, 0.9239f,		0.4375f, 0.5f,				//136
-		// ring 9
-		0.0f, -0.1915f, 0.9808f,		0.5f, 0.4375f,				//137
-		0.3753f, -0.1915f, 0.9061f,		0.5613f, 0.4375f,			//138
-		0.6935f, -0.1915f, 0.6935f,		0.6226f, 0.4375f,			//139
-		0.9061f, -0.1915f, 0.3753f,		0.6839f, 0.4375f,			//140
-		0.9808f, -0.1915f, 0.0f,		0.7452f, 0.4375f,			//141
-		0.9061f, -0.1915f, -0.3753f,	0.8065f, 0.4375f,			//142
-		0.6935f, -0.1915f, -0.6935f,	0.8678f, 0.4375f,			//143
-		0.3753f, -0.1915f, -0.9061f,	0.9261f, 0.4375f,			//144
-		0.0f, -0.1915f, -0.9808f,		0.9904f, 0.4375f,			//145 - seam
-		0.0f, -0.1915f, -0.9808f,		0.0096f, 0.4375f,			//146 - seam
-		-0.3753f, -0.1915f, -0.9061f,	0.0709f, 0.4375f,			//147
-		-0.6935f, -0.1915f, -0.6935f,	0.1322f, 0.4375f,			//148
-		-0.9061f, -0.1915f, -0.3753f,	0.1935f, 0.4375f,			//149
-		-0.9808f, -0.1915f, 0.0f,		0.2548f, 0.4375f,			//150
-		-0.9061f, -0.1915f, 0.3753f,	0.3161f, 0.4375f,			//151
-		-0.6935f, -0.1915f, 0.6935f,	0.3774f, 0.4375f,			//152
-		-0.3753f, -0.1915f, 0.9061f,	0.4387f, 0.4375f,			//153
-		// ring 10
-		0.0f, -0.3827f, 0.9239f,		0.5f, 0.375f,				//154
-		0.3536f, -0.3827f, 0.8536f,		0.55774375f, 0.375f,		//155
-		0.6533f, -0.3827f, 0.6533f,		0.6154875f, 0.375f,			//156
-		0.8536f, -0.3827f, 0.3536f,		0.67323125f, 0.375f,		//157
-		0.9239f, -0.3827f, 0.0f,		0.730975f, 0.375f,			//158
-		0.8536f, -0.3827f, -0.3536f,	0.78871875f, 0.375f,		//159
-		0.6533f, -0.3827f, -0.6533f,	0.8464625f, 0.375f,			//160
-		0.3536f, -0.3827f, -0.8536f,	0.90420625f, 0.375f,		//161
-		0.0f, -0.3827f, -0.9239f,		0.96195f, 0.375f,			//162 - seam
-		0.0f, -0.3827f, -0.9239f,		0.03805f, 0.375f,			//163 - seam
-		-0.3536f, -0.3827f, -0.8536f,	0.09579375f, 0.375f,		//164
-		-0.6533f, -0.3827f, -0.6533f,	0.1535375f, 0.375f,			//165
-		-0.8536f, -0.3827f, -0.3536f,	0.21128125f, 0.375f,		//166
-		-0.9239f, -0.3827f, 0.0f,		0.269025f, 0.375f,			//167
-		-0.8536f, -0.3827f, 0.3536f,	0.32676875f, 0.375f,		//168
-		-0.6533f, -0.3827f, 0.6533f,	0.3845125f, 0.375f,			//169
-		-0.3536f, -0.3827f, 0.8536f,	0.44225625f, 0.375f,		//170
-		// ring 11
-		0.0f, -0.5556f, 0.8315f,		0.5f, 0.3125f,				//171
-		0.3182f, -0.5556f, 0.7682f,		0.55196875f, 0.3125f,		//172
-		0.5879f, -0.5556f, 0.5879f,		0.6039375f, 0.3125f,		//173
-		0.7682f, -0.5556f, 0.3182f,		0.65590625f, 0.3125f,		//174
-		0.8315f, -0.5556f, 0.0f,		0.707875f, 0.3125f,			//175
-		0.7682f, -0.5556f, -0.3182f,	0.75984375f, 0.3125f,		//176
-		0.5879f, -0.5556f, -0.5879f,	0.8118125f, 0.3125f,		//177
-		0.3182f, -0.5556f, -0.7682f,	0.86378125f, 0.3125f,		//178
-		0.0f, -0.5556f, -0.8315f,		0.91575f, 0.3125f,			//179 - seam
-		0.0f, -0.5556f, -0.8315f,		0.08425f, 0.3125f,			//180 - seam
-		-0.3182f, -0.5556f, -0.7682f,	0.13621875f, 0.3125f,		//181
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.3125f,		//182
-		-0.7682f, -0.5556f, -0.3182f,	0.24015625f, 0.3125f,		//183
-		-0.8315f, -0.5556f, 0.0f,		0.292125f, 0.3125f,			//184
-		-0.7682f, -0.5556f, 0.3182f,	0.34409375f, 0.3125f,		//185
-		-0.5879f, -0.5556f, 0.5879f,	0.3960625f, 0.3125f,		//186
-		-0.3182f, -0.5556f, 0.7682f,	0.44803125f, 0.3125f,		//187
-		// ring 12
-		0.0f, -0.7071f, 0.7071f,		0.5f, 0.25f,				//188
-		0.2706f, -0.7071f, 0.6533f,		0.54419375f, 0.25f,			//189
-		0.5f, -0.7071f, 0.5f,			0.5883875f, 0.25f,			//190
-		0.6533f, -0.7071f, 0.2706f,		0.63258125f, 0.25f,			//191
-		0.7071f, -0.7071f, 0.0f,		0.676775f, 0.25f,			//192
-		0.6533f, -0.7071f, -0.2706f,	0.72096875f, 0.25f,			//193
-		0.5f, -0.7071f, -0.5f,			0.7651625f, 0.25f,			//194
-		0.2706f, -0.7071f, -0.6533f,	0.80935625f, 0.25f,			//195
-		0.0f, -0.7071f, -0.7071f,		0.85355f, 0.25f,			//196 - seam
-		0.0f, -0.7071f, -0.7071f,		0.14645f, 0.25f,			//197 - seam
-		-0.2706f, -0.7071f, -0.6533f,	0.19064375f, 0.25f,			//198
-		-0.5f, -0.7071f, -0.5f,			0.2348375f, 0.25f,			//199
-		-0.6533f, -0.7071f, -0.2706f,	0.27903135f, 0.25f,			//200
-		-0.7071f, -0.7071f, 0.0f,		0.323225f, 0.25f,			//201
-		-0.6533f, -0.7071f, 0.2706f,	0.36741875f, 0.25f,			//202
-		-0.5f, -0.7071f, 0.5f,			0.4116125f, 0.25f,			//203
-		-0.2706f, -0.7071f, 0.6533f,	0.45580625f, 0.25f,			//204
-		// ring 13
-		0.0f, -0.8315f, 0.5556f,		0.5f, 0.1875f,				//205
-		0.2126f, -0.8315f, 0.5133f,		0.534725f, 0.1875f,			//206
-		0.3928f, -0.8315f, 0.3928f,		0.56945f, 0.1875f,			//207
-		0.5133f, -0.8315f, 0.2126f,		0.604175f, 0.1875f,			//208
-		0.5556f, -0.8315f, 0.0f,		0.6389f, 0.1875f,			//209
-		0.5133f, -0.8315f, -0.2126f,	0.673625f, 0.1875f,			//210
-		0.3928f, -0.8315f, -0.3928f,	0.70835f, 0.1875f,			//211
-		0.2126f, -0.8315f, -0.5133f,	0.743075f, 0.1875f,			//212
-		0.0f, -0.8315f, -0.5556f,		0.7778f, 0.1875f,			//213 - seam
-		0.0f, -0.8315f, -0.5556f,		0.2222f, 0.1875f,			//214 - seam
-		-0.2126f, -0.8315f, -0.5133f,	0.256925f, 0.1875f,			//215
-		-0.3928f, -0.8315f, -0.3928f,	0.29165f, 0.1875f,			//216
-		-0.5133f, -0.8315f, -0.2126f,	0.326375f, 0.1875f,			//217
-		-0.5556f, -0.8315f, 0.0f,		0.3611f, 0.1875f,			//218
-		-0.5133f, -0.8315f, 0.2126f,	0.395825f, 0.1875f,			//219
-		-0.3928f, -0.8315f, 0.3928f,	0.43055f, 0.1875f,			//220
-		-0.2126f, -0.8315f, 0.5133f,	0.465275f, 0.1875f,			//221
-		// ring 14
-		0.0f, -0.9239f, 0.3827f,		0.5f, 0.125f,				//222
-		0.1464f, -0.9239f, 0.3536f,		0.52391875f, 0.125f,		//223
-		0.2706f, -0.9239f, 0.2706f,		0.5478375f, 0.125f,			//224
-		0.3536f, -0.9239f, 0.1464f,		0.57175625f, 0.125f,		//225
-		0.3827f, -0.9239f, 0.0f,		0.5956755f, 0.125f,			//226
-		0.3536f, -0.9239f, -0.1464f,	0.61959425f, 0.125f,		//227
-		0.2706f, -0.9239f, -0.2706f,	0.643513f, 0.125f,			//228
-		0.1464f, -0.9239f, -0.3536f,	0.66743175f, 0.125f,		//229
-		0.0f, -0.9239f, -0.3827f,		0.6913505f, 0.125f,			//230 - seam
-		0.0f, -0.9239f, -0.3827f,		0.3086495f, 0.125f,			//231 - seam
-		-0.1464f, -0.9239f, -0.3536f,	0.33256825f, 0.125f,		//232
-		-0.2706f, -0.9239f, -0.2706f,	0.356487f, 0.125f,			//233
-		-0.3536f, -0.9239f, -0.1464f,	0.38040575f, 0.125f,		//234
-		-0.3827f, -0.9239f, 0.0f,		0.4043245f, 0.125f,			//235
-		-0.3536f, -0.9239f, 0.1464f,	0.42824325f, 0.125f,		//236
-		-0.2706f, -0.9239f, 0.2706f,	0.452162f, 0.125f,			//237
-		-0.1464f, -0.9239f, 0.3536f,	0.47608075f, 0.125f,		//238
-		// ring 15
-		0.0f, -0.9808f, 0.1951f,		0.5f, 0.0625f,				//239
-		0.0747f, -0.9808f, 0.1802f,		0.51219375f, 0.0625f,		//240
-		0.1379f, -0.9808f, 0.1379f,		0.5243875f, 0.0625f,		//241
-		0.1802f, -0.9808f, 0.0747f,		0.53658125f, 0.0625f,		//242
-		0.1951f, -0.9808, 0.0f,			0.548775f, 0.0625f,			//243
-		0.1802f, -0.9808f, -0.0747f,	0.56096875f, 0.0625f,		//244
-		0.1379f, -0.9808f, -0.1379f,	0.5731625f, 0.0625f,		//245
-		0.0747f, -0.9808f, -0.1802f,	0.58535625f, 0.0625f,		//246
-		0.0f, -0.9808f, -0.1951f,		0.59755f, 0.0625f,			//247 - seam
-		0.0f, -0.9808f, -0.1951f,		0.40245f, 0.0625f,			//248 - seam
-		-0.0747f, -0.9808f, -0.1802f,	0.41464375f, 0.0625f,		//249
-		-0.1379f, -0.9808f, -0.1379f,	0.4268375f, 0.0625f,		//250
-		-0.1802f, -0.9808f, -0.0747f,	0.43903125f, 0.0625f,		//251
-		-0.1951f, -0.9808, 0.0f,		0.451225f, 0.0625f,			//252
-		-0.1802f, -0.9808f, 0.0747f,	0.46341875f, 0.0625f,		//253
-		-0.1379f, -0.9808f, 0.1379f,	0.4756125f, 0.0625f,		//254
-		-0.0747f, -0.9808f, 0.1802f,	0.48780625f, 0.0625f,		//255
-		// bottom center point
-		0.0f, -1.0f, 0.0f,				0.5f, 0.0f					//256
-	};
-
-	// index data
-	GLuint indices[] = {
-		//ring 1 - top
-		0,10,11,
-		0,11,12,
-		0,12,13,
-		0,13,14,
-		0,14,15,
-		0,15,16,
-		0,16,17,
-		0,17,1,
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,9,
-		0,9,10,
-
-		// ring 1 to ring 2
-		10,27,28,
-		10,11,28,
-		11,28,29,
-		11,12,29,
-		12,29,30,
-		12,13,30,
-		13,30,31,
-		13,14,31,
-		14,31,32,
-		14,15,32,
-		15,32,33,
-		15,16,33,
-		16,33,34,
-		16,17,34,
-		17,34,18,
-		17,1,18,
-		1,18,19,
-		1,2,19,
-		2,19,20,
-		2,3,20,
-		3,20,21,
-		3,4,21,
-		4,21,22,
-		4,5,22,
-		5,22,23,
-		5,6,23,
-		6,23,24,
-		6,7,24,
-		7,24,25,
-		7,8,25,
-		8,25,26,
-		8,9,26,
-		9,26,27,
-		9,10,27,
-
-		// ring 2 to ring 3
-		27,44,45,
-		27,28,45,
-		28,45,46,
-		28,29,46,
-		29,46,47,
-		29,30,47,
-		30,47,48,
-		30,31,48,
-		31,48,49,
-		31,32,49,
-		32,49,50,
-		32,33,50,
-		33,50,51,
-		33,34,51,
-		34,51,35,
-		34,18,35,
-		18,35,36,
-		18,19,36,
-		19,36,37,
-		19,20,37,
-		20,37,38,
-		20,21,38,
-		21,38,39,
-		21,22,39,
-		22,39,40,
-		22,23,40,
-		23,40,41,
-		23,24,41,
-		24,41,42,
-		24,25,42,
-		25,42,43,
-		25,26,43,
-		26,43,44,
-		26,27,44,
-
-		// ring 3 to ring 4
-		44,61,62,
-		44,45,62,
-		45,62,63,
-		45,46,63,
-		46,63,64,
-		46,47,64,
-		47,64,65,
-		47,48,65,
-		48,65,66,
-		48,49,66,
-		49,66,67,
-		49,50,67,
-		50,67,68,
-		50,51,68,
-		51,68,52,
-		51,35,52,
-		35,52,53,
-		35,36,53,
-		36,53,54,
-		36,37,54,
-		37,54,55,
-		37,38,55,
-		38,55,56,
-		38,39,56,
-		39,56,57,
-		39,40,57,
-		40,57,58,
-		40,41,58,
-		41,58,59,
-		41,42,59,
-		42,59,60,
-		42,43,60,
-		43,60,61,
-		43,44,61,
-
-		// ring 4 to ring 5
-		61,78,79,
-		61,62,79,
-		62,79,80,
-		62,63,80,
-		63,80,81,
-		63,64,81,
-		64,81,82,
-		64,65,82,
-		65,82,83,
-		65,66,83,
-		66,83,84,
-		66,67,84,
-		67,84,85,
-		67,68,85,
-		68,85,69,
-		68,52,69,
-		52,69,70,
-		52,53,70,
-		53,70,71,
-		53,54,71,
-		54,71,72,
-		54,55,72,
-		55,72,73,
-		55,56,73,
-		56,73,74,
-		56,57,74,
-		57,74,75,
-		57,58,75,
-		58,75,76,
-		58,59,76,
-		59,76,77,
-		59,60,77,
-		60,77,78,
-		60,61,78,
-
-		// ring 5 to ring 6
-		78,95,96,
-		78,79,96,
-		79,96,97,
-		79,80,97,
-		80,97,98,
-		80,81,98,
-		81,98,99,
-		81,82,99,
-		82,99,100,
-		82,83,100,
-		83,100,101,
-		83,84,101,
-		84,101,102,
-		84,85,102,
-		85,102,86,
-		85,69,86,
-		69,86,87,
-		69,70,87,
-		70,87,88,
-		70,71,88,
-		71,88,89,
-		71,72,89,
-		72,89,90,
-		72,73,90,
-		73,90,91,
-		73,74,91,
-		74,91,92,
-		74,75,92,
-		75,92,93,
-		75,76,93,
-		76,93,94,
-		76,77,94,
-		77,94,95,
-		77,78,95,
-
-		// ring 6 to ring 7
-		95,112,113,
-		95,96,113,
-		96,113,114,
-		96,97,114,
-		97,114,115,
-		97,98,115,
-		98,115,116,
-		98,99,116,
-		99,116,117,
-		99,100,117,
-		100,117,118,
-		100,101,118,
-		101,118,119,
-		101,102,119,
-		102,119,103,
-		102,86,103,
-		86,103,104,
-		86,87,104,
-		87,104,105,
-		87,88,105,
-		88,105,106,
-		88,89,106,
-		89,106,107,
-		89,90,107,
-		90,107,108,
-		90,91,108,
-		91,108,109,
-		91,92,109,
-		92,109,110,
-		92,93,110,
-		93,110,111,
-		93,94,111,
-		94,111,112,
-		94,95,112,
-
-		// ring 7 to ring 8
-		112,129,130,
-		112,113,130,
-		113,130,131,
-		113,114,131,
-		114,131,132,
-		114,115,132,
-		115,132,133,
-		115,116,133,
-		116,133,134,
-		116,117,134,
-		117,134,135,
-		117,118,135,
-		118,135,136,
-		118,119,136,
-		119,136,120,
-		119,103,120,
-		103,120,121,
-		103,104,121,
-		104,121,122,
-		104,105,122,
-		105,122,123,
-		105,106,123,
-		106,123,124,
-		106,107,124,
-		107,124,125,
-		107,108,125,
-		108,125,126,
-		108,109,126,
-		109,126,127,
-		109,110,127,
-		110,127,128,
-		110,111,128,
-		111,128,129,
-		111,112,129,
-
-		// ring 8 to ring 9
-		129,146,147,
-		129,130,147,
-		130,147,148,
-		130,131,148,
-		131,148,149,
-		131,132,149,
-		132,149,150,
-		132,133,150,
-		133,150,151,
-		133,134,151,
-		134,151,152,
-		134,135,152,
-		135,152,153,
-		135,136,153,
-		136,153,137,
-		136,120,137,
-		120,137,138,
-		120,121,138,
-		121,138,139,
-		121,122,139,
-		122,139,140,
-		122,123,140,
-		123,140,141,
-		123,124,141,
-		124,141,142,
-		124,125,142,
-		125,142,143,
-		125,126,143,
-		126,143,144,
-		126,127,144,
-		127,144,145,
-		127,128,145,
-		128,145,146,
-		128,129,146,
-
-		// ring 9 to ring 10
-		146,163,164,
-		146,147,164,
-		147,164,165,
-		147,148,165,
-		148,165,166,
-		148,149,166,
-		149,166,167,
-		149,150,167,
-		150,167,168,
-		150,151,168,
-		151,168,169,
-		151,152,169,
-		152,169,170,
-		152,153,170,
-		153,170,154,
-		153,137,154,
-		137,154,155,
-		137,138,155,
-		138,155,156,
-		138,139,156,
-		139,156,157,
-		139,140,157,
-		140,157,158,
-		140,141,158,
-		141,158,159,
-		141,142,159,
-		142,159,160,
-		142,143,160,
-		143,160,161,
-		143,144,161,
-		144,161,162,
-		144,145,162,
-		145,162,163,
-		145,146,163,
-
-		// ring 10 to ring 11
-		163,180,181,
-		163,164,181,
-		164,181,182,
-		164,165,182,
-		165,182,183,
-		165,166,183,
-		166,183,184,
-		166,167,184,
-		167,184,185,
-		167,168,185,
-		168,185,186,
-		168,169,186,
-		169,186,187,
-		169,170,187,
-		170,187,171,
-		170,154,171,
-		154,171,172,
-		154,155,172,
-		155,172,173,
-		155,156,173,
-		156,173,174,
-		156,157,174,
-		157,174,175,
-		157,158,175,
-		158,175,176,
-		158,159,176,
-		159,176,177,
-		159,160,177,
-		160,177,178,
-		160,161,178,
-		161,178,179,
-		161,162,179,
-		162,179,180,
-		162,163,180,
-
-		// ring 11 to ring 12
-		180,197,198,
-		180,181,198,
-		181,198,199,
-		181,182,199,
-		182,199,200,
-		182,183,200,
-		183,200,201,
-		183,184,201,
-		184,201,202,
-		184,185,202,
-		185,202,203,
-		185,186,203,
-		186,203,204,
-		186,187,204,
-		187,204,188,
-		187,171,188,
-		171,188,189,
-		171,172,189,
-		172,189,190,
-		172,173,190,
-		173,190,191,
-		173,174,191,
-		174,191,192,
-		174,175,192,
-		175,192,193,
-		175,176,193,
-		176,193,194,
-		176,177,194,
-		177,194,195,
-		177,178,195,
-		178,195,196,
-		178,179,196,
-		179,196,197,
-		179,180,197,
-
-		// ring 12 to ring 13
-		197,214,215,
-		197,198,215,
-		198,215,216,
-		198,199,216,
-		199,216,217,
-		199,200,217,
-		200,217,218,
-		200,201,218,
-		201,218,219,
-		201,202,219,
-		202,219,220,
-		202,203,220,
-		203,220,221,
-		203,204,221,
-		204,221,205,
-		204,188,205,
-		188,205,206,
-		188,189,206,
-		189,206,207,
-		189,190,207,
-		190,207,208,
-		190,191,208,
-		191,208,209,
-		191,192,209,
-		192,209,210,
-		192,193,210,
-		193,210,211,
-		193,194,211,
-		194,211,212,
-		194,195,212,
-		195,212,213,
-		195,196,213,
-		196,213,214,
-		196,197,214,
-
-		// ring 13 to ring 14
-		214,231,232,
-		214,215,232,
-		215,232,233,
-		215,216,233,
-		216,233,234,
-		216,217,234,
-		217,234,235,
-		217,218,235,
-		218,235,236,
-		218,219,236,
-		219,236,237,
-		219,220,237,
-		220,237,238,
-		220,221,238,
-		221,238,222,
-		221,205,222,
-		205,222,223,
-		205,206,223,
-		206,223,224,
-		206,207,224,
-		207,224,225,
-		207,208,225,
-		208,225,226,
-		208,209,226,
-		209,226,227,
-		209,210,227,
-		210,227,228,
-		210,211,228,
-		211,228,229,
-		211,212,229,
-		212,229,230,
-		212,213,230,
-		213,230,231,
-		213,214,231,
-
-		// ring 14 to ring 15
-		231,248,249,
-		231,232,249,
-		232,249,250,
-		232,233,250,
-		233,250,251,
-		233,234,251,
-		234,251,252,
-		234,235,252,
-		235,252,253,
-		235,236,253,
-		236,253,254,
-		236,237,254,
-		237,254,255,
-		237,238,255,
-		238,255,239,
-		238,222,239,
-		222,239,240,
-		222,223,240,
-		223,240,241,
-		223,224,241,
-		224,241,242,
-		224,225,242,
-		225,242,243,
-		225,226,243,
-		226,243,244,
-		226,227,244,
-		227,244,245,
-		227,228,245,
-		228,245,246,
-		228,229,246,
-		229,246,247,
-		229,230,247,
-		230,247,248,
-		230,231,248,
-
-		// ring 15 - bottom
-		248,256,249,
-		249,256,250,
-		250,256,251,
-		251,256,252,
-		252,256,253,
-		253,256,254,
-		254,256,255,
-		255,256,239,
-		239,256,240,
-		240,256,241,
-		241,256,242,
-		242,256,243,
-		243,256,244,
-		244,256,245,
-		245,256,246,
-		246,256,247,
-		247,256,248
-	};
-
-	// total float values per each type
-	const GLuint floatsPerVertex = 3;
-	const GLuint floatsPerNormal = 3;
-	const GLuint floatsPerUV = 2;
-
-	// store vertex and index count
-	m_SphereMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (floatsPerVertex));
-	m_SphereMesh.nIndices = sizeof(indices) / (sizeof(indices[0]));
-
-	glm::vec3 normal;
-	glm::vec3 vert;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	float u, v;
-	std::vector<GLfloat> combined_values;
+	slices = std::max(slices, 3);
+	stacks = std::max(stacks, 2);
 
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < sizeof(verts) / (sizeof(verts[0])); i += 5)
+	for (int lod = 0; lod < LOD_COUNT; lod++)
 	{
-		vert = glm::vec3(verts[i], verts[i + 1], verts[i + 2]);
-		normal = normalize(vert - center);
-		//u = atan2(normal.x, normal.z) / (2 * M_PI) + 0.5;
-		//v = normal.y * 0.5 + 0.5;
-		combined_values.push_back(vert.x);
-		combined_values.push_back(vert.y);
-		combined_values.push_back(vert.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(verts[i + 3]);
-		combined_values.push_back(verts[i + 4]);
-	}
-
-	// Create VAO
-	glGenVertexArrays(1, &m_SphereMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_SphereMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(2, m_SphereMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_SphereMesh.vbos[0]); // Activates the vertex buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_SphereMesh.vbos[1]); // Activates the index buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+		int levelSlices = GetLevelSegments(slices, g_MinRoundSegments, lod);
+		int levelStacks = GetLevelSegments(stacks, g_MinSphereStacks, lod);
+		if ((lod > 0) &&
+			(levelSlices == GetLevelSegments(slices, g_MinRoundSegments, lod - 1)) &&
+			(levelStacks == GetLevelSegments(stacks, g_MinSphereStacks, lod - 1)))
+		{
+			break;
+		}
 
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
+		m_lodCounts[MESH_SPHERE] = lod + 1;
+		GenerateSphereMesh(*GetMesh(MESH_SPHERE, lod), levelSlices, levelStacks);
 	}
 }
 
 ///////////////////////////////////////////////////
 //	LoadTaperedCylinderMesh()
 //
-//	Create a tapered cylinder mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
-//
-//  Correct triangle drawing commands:
+//	Create a tapered cylinder mesh, with its top half
+//  the width of its bottom, with the passed in number
+//  of slices around its side, and coarser levels of
+//  detail with fewer slices, and add them to the
+//  shared mesh buffers.  The normals and texture
+//  coordinates are also set.
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 72);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+//  The bottom, top and sides are stored as mesh parts.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTaperedCylinderMesh()
+void ShapeMeshes::LoadTaperedCylinderMesh(int slices)
 {
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.47f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.17f, 1.0f, -0.47f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.17f, 1.0f, -0.47f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.47f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.49f, 1.0f, 0.085f,	0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.435f, 1.0f, 0.25f,	0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.385f, 1.0f, 0.32f,	0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.32f, 1.0f, 0.385f,	0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.25f, 1.0f, 0.435f,	0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.085f, 1.0f, 0.49f,	0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.085f, 1.0f, 0.49f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.25f, 1.0f, 0.435f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.32f, 1.0f, 0.385f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.385f, 1.0f, 0.32f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.435f, 1.0f, 0.25f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.49f, 1.0f, 0.085f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		0.5f, 1.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f,	0.25,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651, 0.5f, -0.116841137f,	0.0277,0.0,
-		0.5f, 1.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f, 	0.25,1.0,
-		.49f, 1.0f, -0.085f,	0.993150651, 0.5f, -0.116841137f, 	0.2635,1.0,
-		.98f, 0.0f, -0.17f,		0.993150651, 0.5f, -0.116841137f,	0.0277,0.0,
-		.94f, 0.0f, -0.34f,		0.993417103f, 0.5f, -0.229039446f,	0.0554,0.0,
-		.49f, 1.0f, -0.085f,	0.993417103f, 0.5f, -0.229039446f,	0.2635,1.0,
-		.47f, 1.0f, -0.17f,		0.993417103f, 0.5f, -0.229039446f,	0.277,1.0,
-		.94f, 0.0f, -0.34f,		0.993417103f, 0.5f, -0.229039446f,	0.0554,0.0,
-		.87f, 0.0f, -0.5f,		0.993417103f, 0.5f, -0.229039446f,	0.0831,0.0,
-		.47f, 1.0f, -0.17f,		0.993417103f, 0.5f, -0.229039446f,	0.277,1.0,
-		.435f, 1.0f, -0.25f,	0.813733339f, 0.5f, -0.581238329f,	0.2905,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.5f, -0.581238329f,	0.0831,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.5f, -0.581238329f,	0.1108,0.0,
-		.435f, 1.0f, -0.25f,	0.813733339f, 0.5f, -0.581238329f,	0.2905,1.0,
-		.385f, 1.0f, -0.32f,	0.813733339f, 0.5f, -0.581238329f,	0.304,1.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.5f, -0.581238329f,	0.1108,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.5f, -0.707106769f,	0.1385,0.0,
-		.385f, 1.0f, -0.32f,	0.707106769f, 0.5f, -0.707106769f,	0.304,1.0,
-		.32f, 1.0f, -0.385f,	0.707106769f, 0.5f, -0.707106769f,	0.3175,1.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.5f, -0.707106769f,	0.1385,0.0,
-		.5f, 0.0f, -0.87f,		0.707106769f, 0.5f, -0.707106769f,	0.1662,0.0,
-		.32f, 1.0f, -0.385f,	0.707106769f, 0.5f, -0.707106769f,	0.3175, 1.0,
-		.25f, 1.0f, -0.435f,	0.400818795f, 0.5f, -0.916157305f,	0.331, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.5f, -0.916157305f,	0.1662, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.5f, -0.916157305f,	0.1939, 0.0,
-		.25f, 1.0f, -0.435f,	0.400818795f, 0.5f, -0.916157305f,	0.331, 1.0,
-		.17f, 1.0f, -0.47f,		0.400818795f, 0.5f, -0.916157305f,	0.3445, 1.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.5f, -0.916157305f,	0.1939, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.5f, -0.973417103f,	0.2216, 0.0,
-		.17f, 1.0f, -0.47f,		0.229039446f, 0.5f, -0.973417103f,	0.3445, 1.0,
-		.085f, 1.0f, -0.49f,	0.229039446f, 0.5f, -0.973417103f,	0.358, 1.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.5f, -0.973417103f,	0.2216, 0.0,
-		0.0f, 0.0f, -1.0f,		0.229039446f, 0.5f, -0.973417103f,	0.2493, 0.0,
-		.085f, 1.0f, -0.49f,	0.229039446f, 0.5f, -0.973417103f,	0.358, 1.0,
-		0.0f, 1.0f, -0.5f,		-0.116841137f, 0.5f, -0.993150651f,	0.3715, 1.0,
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.5f, -0.993150651f,	0.2493, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.5f, -0.993150651f,	0.277, 0.0,
-		0.0f, 1.0f, -0.5f,		-0.116841137f, 0.5f, -0.993150651f,	0.3715, 1.0,
-		-.085f, 1.0f, -0.49f,	-0.116841137f, 0.5f, -0.993150651f,	0.385, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.5f, -0.993150651f,	0.277, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.5f, -0.973417103f,	0.3047, 0.0,
-		-.085f, 1.0f, -0.49f,	-0.229039446f, 0.5f, -0.973417103f,	0.385, 1.0,
-		-.17f, 1.0f, -0.47f,	-0.229039446f, 0.5f, -0.973417103f,	0.3985, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.5f, -0.973417103f,	0.3047, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.229039446f, 0.5f, -0.973417103f,	0.3324, 0.0,
-		-.17f, 1.0f, -0.47f,	-0.229039446f, 0.5f, -0.973417103f,	0.3985, 1.0,
-		-.25f, 1.0f, -0.435f,	-0.581238329f, 0.5f, -0.581238329f,	0.412, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.5f, -0.581238329f,	0.3324, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.5f, -0.581238329f,	0.3601, 0.0,
-		-.25f, 1.0f, -0.435f,	-0.581238329f, 0.5f, -0.581238329f,	0.412, 1.0,
-		-.32f, 1.0f, -0.385f,	-0.581238329f, 0.5f, -0.581238329f,	0.4255, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.5f, -0.581238329f,	0.3601, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.5f, -0.707106769f,	0.3878, 0.0,
-		-.32f, 1.0f, -0.385f,	-0.707106769f, 0.5f, -0.707106769f,	0.4255, 1.0,
-		-.385f, 1.0f, -0.32f,	-0.707106769f, 0.5f, -0.707106769f,	0.439, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.5f, -0.707106769f,	0.3878, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.707106769f, 0.5f, -0.707106769f,	0.4155, 0.0,
-		-.385f, 1.0f, -0.32f,	-0.707106769f, 0.5f, -0.707106769f,	0.439, 1.0,
-		-.435f, 1.0f, -0.25f,	-0.916157305f, 0.5f, -0.400818795f,	0.4525, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.5f, -0.400818795f,	0.4155, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.5f, -0.400818795f,	0.4432, 0.0,
-		-.435f, 1.0f, -0.25f,	-0.916157305f, 0.5f, -0.400818795f,	0.4525, 1.0,
-		-.47f, 1.0f, -0.17f,	-0.916157305f, 0.5f, -0.400818795f,	0.466, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.5f, -0.400818795f,	0.4432, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.4709, 0.0,
-		-.47f, 1.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.466, 1.0,
-		-.49f, 1.0f, -0.085f,	-0.973417103f, 0.5f, -0.229039446f,	0.4795, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.4709, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.973417103f, 0.5f, -0.229039446f,	0.4986, 0.0,
-		-.49f, 1.0f, -0.085f,	-0.973417103f, 0.5f, -0.229039446f,	0.4795, 1.0,
-		-0.5f, 1.0f, 0.0f,		-0.993150651f, 0.5f, -0.116841137f,	0.493, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.5f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.5f, 0.116841137f,	0.5263, 0.0,
-		-0.5f, 1.0f, 0.0f,		-0.993150651f, 0.5f, 0.116841137f,	0.493, 1.0,
-		-.49f, 1.0f, 0.085f,	-0.993150651f, 0.5f, 0.116841137f,	0.5065, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.5f, 0.116841137f,	0.5263, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.5f, 0.229039446f,	0.554, 0.0,
-		-.49f, 1.0f, 0.085f,	-0.973417103f, 0.5f, 0.229039446f,	0.5065, 1.0,
-		-.47f, 1.0f, 0.17f,		-0.973417103f, 0.5f, 0.229039446f,	0.52, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.5f, 0.229039446f,	0.554, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.973417103f, 0.5f, 0.229039446f,	0.5817, 0.0,
-		-.47f, 1.0f, 0.17f,		-0.973417103f, 0.5f, 0.229039446f,	0.52, 1.0,
-		-.435f, 1.0f, 0.25f,	-0.813733339f, 0.5f, 0.581238329f,	0.5335, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.5f, 0.581238329f,	0.5817, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.5f, 0.581238329f,	0.6094, 0.0,
-		-.435f, 1.0f, 0.25f,	-0.813733339f, 0.5f, 0.581238329f,	0.5335, 1.0,
-		-.385f, 1.0f, 0.32f,	-0.813733339f, 0.5f, 0.581238329f,	0.547, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.5f, 0.581238329f,	0.6094, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.5f, 0.707106769f,	0.6371, 0.0,
-		-.385f, 1.0f, 0.32f,	-0.707106769f, 0.5f, 0.707106769f,	0.547, 1.0,
-		-.32f, 1.0f, 0.385f,	-0.707106769f, 0.5f, 0.707106769f,	0.5605, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.5f, 0.707106769f,	0.6371, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.707106769f, 0.5f, 0.707106769f,	0.6648, 0.0,
-		-.32f, 1.0f, 0.385f,	-0.707106769f, 0.5f, 0.707106769f,	0.5605, 1.0,
-		-.25f, 1.0f, 0.435f,	-0.400818795f, 0.5f, 0.916157305f,	0.574, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.5f, 0.916157305f,	0.6648, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.5f, 0.916157305f,	0.6925, 0.0,
-		-.25f, 1.0f, 0.435f,	-0.400818795f, 0.5f, 0.916157305f,	0.574, 1.0,
-		-.17f, 1.0f, 0.47f,		-0.400818795f, 0.5f, 0.916157305f,	0.5875, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.5f, 0.916157305f,	0.6925, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.5f, 0.973417103f,	0.7202, 0.0,
-		-.17f, 1.0f, 0.47f,		-0.229039446f, 0.5f, 0.973417103f,	0.5875, 1.0,
-		-.085f, 1.0f, 0.49f,	-0.229039446f, 0.5f, 0.973417103f,	0.601, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.5f, 0.973417103f,	0.7202, 0.0,
-		0.0f, 0.0f, 1.0f,		-0.229039446f, 0.5f, 0.973417103f,	0.7479, 0.0,
-		-.085f, 1.0f, 0.49f,	-0.229039446f, 0.5f, 0.973417103f,	0.601, 1.0,
-		0.0f, 1.0f, 0.5f,		-0.116841137f, 0.5f, 0.993150651f,	0.6145, 1.0,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.5f, 0.993150651f,	0.7479, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.5f, 0.993150651f,	0.7756, 0.0,
-		0.0f, 1.0f, 0.5f,		0.116841137f, 0.5f, 0.993150651f,	0.6145, 1.0,
-		.085f, 1.0f, 0.49f,		0.116841137f, 0.5f, 0.993150651f,	0.628, 1.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.5f, 0.993150651f,	0.7756, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.5f, 0.973417103f,	0.8033, 0.0,
-		.085f, 1.0f, 0.49f,		0.229039446f, 0.5f, 0.973417103f,	0.628, 1.0,
-		.17f, 1.0f, 0.47f,		0.229039446f, 0.5f, 0.973417103f,	0.6415, 1.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.5f, 0.973417103f,	0.8033, 0.0,
-		.5f, 0.0f, 0.87f,		0.229039446f, 0.5f, 0.973417103f,	0.831, 0.0,
-		.17f, 1.0f, 0.47f,		0.229039446f, 0.5f, 0.973417103f,	0.6415, 1.0,
-		.25f, 1.0f, 0.435f,		0.581238329f, 0.5f, 0.813733339f,	0.655, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.5f, 0.813733339f,	0.831, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.5f, 0.813733339f,	0.8587, 0.0,
-		.25f, 1.0f, 0.435f,		0.581238329f, 0.5f, 0.813733339f,	0.655, 1.0,
-		.32f, 1.0f, 0.385f,		0.581238329f, 0.5f, 0.813733339f,	0.6685, 1.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.5f, 0.813733339f,	0.8587, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.5f, 0.707106769f,	0.8864, 0.0,
-		.32f, 1.0f, 0.385f,		0.707106769f, 0.5f, 0.707106769f,	0.6685, 1.0,
-		.385f, 1.0f, 0.32f,		0.707106769f, 0.5f, 0.707106769f,	0.682, 1.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.5f, 0.707106769f,	0.8864, 0.0,
-		.87f, 0.0f, 0.5f,		0.707106769f, 0.5f, 0.707106769f,	0.9141, 0.0,
-		.385f, 1.0f, 0.32f,		0.707106769f, 0.5f, 0.707106769f,	0.682, 1.0,
-		.435f, 1.0f, 0.25f,		0.916157305f, 0.5f, 0.400818795f,	0.6955, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.5f, 0.400818795f,	0.9141, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.5f, 0.400818795f,	0.9418, 0.0,
-		.435f, 1.0f, 0.25f,		0.916157305f, 0.5f, 0.400818795f,	0.6955, 1.0,
-		.47f, 1.0f, 0.17f,		0.916157305f, 0.5f, 0.400818795f,	0.709, 1.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.5f, 0.400818795f,	0.9418, 1.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.9695, 0.0,
-		.47f, 1.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.709, 0.0,
-		.49f, 1.0f, 0.085f,		0.973417103f, 0.5f, 0.229039446f,	0.7225, 1.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.9695, 0.0,
-		1.0f, 0.0f, 0.0f,		0.973417103f, 0.5f, 0.229039446f,	1.0, 0.0,
-		.49f, 1.0f, 0.085f,		0.973417103f, 0.5f, 0.229039446f,	0.7225, 1.0,
-		0.5f, 1.0f, 0.0f,		0.993150651f, 0.5f, 0.116841137f,	0.75, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, 0.116841137f,	1.0, 0.0
-	};
-
-	// store vertex and index count
-	m_TaperedCylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_TaperedCylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TaperedCylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_TaperedCylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TaperedCylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadCylinderLevels(MESH_TAPERED_CYLINDER, slices, 0.5f);
 }
 
 ///////////////////////////////////////////////////
 //	LoadTorusMesh()
 //
-//	Create a torus mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//	Correct triangle drawing command:
+//	Create a torus mesh with the passed in number of
+//  segments around its ring and around its tube, and
+//  coarser levels of detail with fewer of each, and
+//  add them to the shared mesh buffers.  The normals
+//  and texture coordinates are also set.
 //
-//	glDrawArrays(GL_TRIANGLES, 0, meshes.gTorusMesh.nVertices);
+//  The triangles are stored around the ring, so the
+//  first half of the indices is the half of the torus
+//  above its center.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTorusMesh(float thickness)
+void ShapeMeshes::LoadTorusMesh(float thickness, int mainSegments, int tubeSegments)
 {
-	int _mainSegments = 30;
-	int _tubeSegments = 30;
-	float _mainRadius = 4.8f;
-	float _tubeRadius = .01f;
+	float mainRadius = 4.8f;
+	float tubeRadius = .01f;
 
 	if (thickness <= 1.0)
 	{
-		_tubeRadius = thickness;
+		tubeRadius = thickness;
 	}
+	mainSegments = std::max(mainSegments, 3);
+	tubeSegments = std::max(tubeSegments, 3);
 
-	auto mainSegmentAngleStep = glm::radians(360.0f / float(_mainSegments));
-	auto tubeSegmentAngleStep = glm::radians(360.0f / float(_tubeSegments));
-
-	std::vector<glm::vec3> vertex_list;
-	std::vector<std::vector<glm::vec3>> segments_list;
-	std::vector<glm::vec2> texture_coords;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	glm::vec3 normal;
-	glm::vec3 vertex;
-	glm::vec2 text_coord;
-
-	// generate the torus vertices
-	auto currentMainSegmentAngle = 0.0f;
-	for (auto i = 0; i < _mainSegments; i++)
+	for (int lod = 0; lod < LOD_COUNT; lod++)
 	{
-		// Calculate sine and cosine of main segment angle
-		auto sinMainSegment = sin(currentMainSegmentAngle);
-		auto cosMainSegment = cos(currentMainSegmentAngle);
-		auto currentTubeSegmentAngle = 0.0f;
-		std::vector<glm::vec3> segment_points;
-		for (auto j = 0; j < _tubeSegments; j++)
+		int levelMain = GetLevelSegments(mainSegments, g_MinRoundSegments, lod);
+		int levelTube = GetLevelSegments(tubeSegments, g_MinRoundSegments, lod);
+		if ((lod > 0) &&
+			(levelMain == GetLevelSegments(mainSegments, g_MinRoundSegments, lod - 1)) &&
+			(levelTube == GetLevelSegments(tubeSegments, g_MinRoundSegments, lod - 1)))
 		{
-			// Calculate sine and cosine of tube segment angle
-			auto sinTubeSegment = sin(currentTubeSegmentAngle);
-			auto cosTubeSegment = cos(currentTubeSegmentAngle);
+			break;
+		}
 
-			// Calculate vertex position on the surface of torus
-			auto surfacePosition = glm::vec3(
-				(_mainRadius + _tubeRadius * cosTubeSegment) * cosMainSegment,
-				(_mainRadius + _tubeRadius * cosTubeSegment) * sinMainSegment,
-				_tubeRadius * sinTubeSegment);
+		m_lodCounts[MESH_TORUS] = lod + 1;
+		GenerateTorusMesh(*GetMesh(MESH_TORUS, lod), levelMain, levelTube, mainRadius, tubeRadius);
+	}
+}
 
-			//vertex_list.push_back(surfacePosition);
-			segment_points.push_back(surfacePosition);
+///////////////////////////////////////////////////
+//	LoadCylinderLevels()
+//
+//	Create the levels of detail of a mesh that is a
+//  cylinder of radius 1 and height 1, with the top
+//  radius passed in - a cone when it is 0.  Every
+//  level has half the slices of the one before, down
+//  to a fixed minimum.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadCylinderLevels(
+	MESH_TYPE mesh,
+	int slices,
+	float topRadius)
+{
+	slices = std::max(slices, 3);
 
-			// Update current tube angle
-			currentTubeSegmentAngle += tubeSegmentAngleStep;
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		int levelSlices = GetLevelSegments(slices, g_MinRoundSegments, lod);
+		if ((lod > 0) && (levelSlices == GetLevelSegments(slices, g_MinRoundSegments, lod - 1)))
+		{
+			break;
 		}
-		segments_list.push_back(segment_points);
-		segment_points.clear();
 
-		// Update main segment angle
-		currentMainSegmentAngle += mainSegmentAngleStep;
+		m_lodCounts[mesh] = lod + 1;
+		GenerateCylinderMesh(*GetMesh(mesh, lod), levelSlices, topRadius);
 	}
+}
 
-	float horizontalStep = 1.0 / _mainSegments;
-	float verticalStep = 1.0 / _tubeSegments;
-	float u = 0.0;
-	float v = 0.0;
+///////////////////////////////////////////////////
+//	GenerateCylinderMesh()
+//
+//	Generate one level of a cylinder, tapered cylinder
+//  or cone, standing on the origin and reaching up to
+//  1.  The caps are fans around a center vertex, and
+//  the side has a column of vertices for every slice,
+//  with the seam vertices repeated so the texture
+//  wraps once around.  A cone has no top cap, and one
+//  triangle for each slice of its side.
+///////////////////////////////////////////////////
+void ShapeMeshes::GenerateCylinderMesh(
+	GLMesh& mesh,
+	int slices,
+	float topRadius)
+{
+	std::vector<GLfloat> verts;
+	std::vector<GLuint> bottomIndices;
+	std::vector<GLuint> topIndices;
+	std::vector<GLuint> sideIndices;
+	bool bTop = (topRadius > 0.0f);
+	glm::vec3 top(0.0f, 1.0f, 0.0f);
+
+	// the caps are mapped onto a disk in the middle of the texture
+	AddVertex(verts, glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec2(0.5f));
+	for (int j = 0; j < slices; j++)
+	{
+		glm::vec3 direction = GetSliceDirection(j, slices);
+		AddVertex(verts, direction, glm::vec3(0.0f, -1.0f, 0.0f),
+			glm::vec2(0.5f + 0.5f * direction.z, 0.5f + 0.5f * direction.x));
+
+		bottomIndices.push_back(0);
+		bottomIndices.push_back(1 + ((j + 1) % slices));
+		bottomIndices.push_back(1 + j);
+	}
 
-	// connect the various segments together, forming triangles
-	for (int i = 0; i < _mainSegments; i++)
+	if (bTop == true)
 	{
-		for (int j = 0; j < _tubeSegments; j++)
+		GLuint center = (GLuint)slices + 1;
+		AddVertex(verts, top, top, glm::vec2(0.5f));
+		for (int j = 0; j < slices; j++)
 		{
-			if (((i + 1) < _mainSegments) && ((j + 1) < _tubeSegments))
-			{
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i][j + 1]);
-				texture_coords.push_back(glm::vec2(u, v + verticalStep));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v + verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i + 1][j]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v - verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-			}
-			else
-			{
-				if (((i + 1) == _mainSegments) && ((j + 1) == _tubeSegments))
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((i + 1) == _mainSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][j + 1]);
-					texture_coords.push_back(glm::vec2(u, v + verticalStep));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((j + 1) == _tubeSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i + 1][j]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
+			glm::vec3 direction = GetSliceDirection(j, slices);
+			AddVertex(verts, direction * topRadius + top, top,
+				glm::vec2(0.5f + 0.5f * direction.z, 0.5f + 0.5f * direction.x));
 
-			}
-			v += verticalStep;
+			topIndices.push_back(center);
+			topIndices.push_back(center + 1 + j);
+			topIndices.push_back(center + 1 + ((j + 1) % slices));
 		}
-		v = 0.0;
-		u += horizontalStep;
 	}
 
-	std::vector<GLfloat> combined_values;
+	// the side normals lean up by the taper of the side
+	GLuint side = (GLuint)(verts.size() / g_FloatsPerMeshVertex);
+	for (int j = 0; j <= slices; j++)
+	{
+		glm::vec3 direction = GetSliceDirection(j, slices);
+		glm::vec3 normal = glm::normalize(glm::vec3(direction.x, 1.0f - topRadius, direction.z));
+		float u = (float)j / slices;
+
+		AddVertex(verts, direction, normal, glm::vec2(u, 0.0f));
+		AddVertex(verts, direction * topRadius + top, normal, glm::vec2(u, 1.0f));
+	}
 
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < vertex_list.size(); i++)
+	for (int j = 0; j < slices; j++)
 	{
-		vertex = vertex_list[i];
-		normal = normalize(vertex);
-		if (vertex.x < 0)
-		{
-			if (normal.x > 0)
-				normal.x *= -1;
-		}
-		else if (vertex.x > 0)
-		{
-			if (normal.x < 0)
-				normal.x *= -1;
-		}
-		if (vertex.y < 0)
-		{
-			if (normal.y > 0)
-				normal.y *= -1;
-		}
-		else if (vertex.y > 0)
+		GLuint bottom = side + 2 * j;
+
+		sideIndices.push_back(bottom + 1);
+		sideIndices.push_back(bottom);
+		sideIndices.push_back(bottom + 2);
+		if (bTop == true)
 		{
-			if (normal.y < 0)
-				normal.y *= -1;
+			sideIndices.push_back(bottom + 1);
+			sideIndices.push_back(bottom + 2);
+			sideIndices.push_back(bottom + 3);
 		}
-		if (vertex.z < 0)
+	}
+
+	// the widest edges, around the bottom, cut in the most
+	mesh.error = 1.0f - glm::cos(glm::pi<float>() / slices);
+
+	mesh.nVertices = (GLuint)(verts.size() / g_FloatsPerMeshVertex);
+	AddMeshVertices(mesh, verts.data());
+	AddMeshIndices(mesh, bottomIndices.data(), (GLuint)bottomIndices.size(), PART_BOTTOM);
+	AddMeshIndices(mesh, topIndices.data(), (GLuint)topIndices.size(), PART_TOP);
+	AddMeshIndices(mesh, sideIndices.data(), (GLuint)sideIndices.size(), PART_SIDES);
+}
+
+///////////////////////////////////////////////////
+//	GenerateSphereMesh()
+//
+//	Generate one level of a sphere of radius 1 around
+//  the origin.  Every stack has a row of vertices
+//  with the seam vertices repeated, including the
+//  rows at the poles, so that the texture is mapped
+//  once around and once from top to bottom.
+///////////////////////////////////////////////////
+void ShapeMeshes::GenerateSphereMesh(
+	GLMesh& mesh,
+	int slices,
+	int stacks)
+{
+	std::vector<GLfloat> verts;
+	std::vector<GLuint> indices;
+	GLuint rowLength = (GLuint)slices + 1;
+
+	for (int k = 0; k <= stacks; k++)
+	{
+		float stackAngle = glm::pi<float>() * k / stacks;
+		for (int j = 0; j <= slices; j++)
 		{
-			if (normal.z > 0)
-				normal.z *= -1;
+			// the seam is on the back of the sphere
+			float sliceAngle = glm::two_pi<float>() * j / slices - glm::pi<float>();
+			glm::vec3 position(
+				glm::sin(stackAngle) * glm::sin(sliceAngle),
+				glm::cos(stackAngle),
+				glm::sin(stackAngle) * glm::cos(sliceAngle));
+
+			AddVertex(verts, position, position, glm::vec2((float)j / slices, 1.0f - (float)k / stacks));
 		}
-		else if (vertex.z > 0)
+	}
+
+	// the rows at the poles only have the triangles
+	// that do not meet at the pole
+	for (int k = 0; k < stacks; k++)
+	{
+		for (int j = 0; j < slices; j++)
 		{
-			if (normal.z < 0)
-				normal.z *= -1;
+			GLuint upper = k * rowLength + j;
+			GLuint lower = upper + rowLength;
+
+			if (k != stacks - 1)
+			{
+				indices.push_back(upper);
+				indices.push_back(lower);
+				indices.push_back(lower + 1);
+			}
+			if (k != 0)
+			{
+				indices.push_back(upper);
+				indices.push_back(lower + 1);
+				indices.push_back(upper + 1);
+			}
 		}
-		text_coord = texture_coords[i];
-		combined_values.push_back(vertex.x);
-		combined_values.push_back(vertex.y);
-		combined_values.push_back(vertex.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(text_coord.x);
-		combined_values.push_back(text_coord.y);
 	}
 
-	// store vertex and index count
-	m_TorusMesh.nVertices = vertex_list.size();
-	m_TorusMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TorusMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TorusMesh.vao);
+	// the edges around the equator cut in the most, or
+	// the edges down from the poles, which span half the
+	// angle of a stack for the same depth
+	mesh.error = 1.0f - glm::cos(glm::pi<float>() / std::min(slices, 2 * stacks));
+
+	// the halves are added one at a time, so reordering
+	// the triangles keeps the top half first
+	GLuint halfIndices = (GLuint)(indices.size() / 6) * 3;
+	mesh.nVertices = (GLuint)(verts.size() / g_FloatsPerMeshVertex);
+	AddMeshVertices(mesh, verts.data());
+	AddMeshIndices(mesh, indices.data(), halfIndices);
+	AddMeshIndices(mesh, indices.data() + halfIndices, (GLuint)indices.size() - halfIndices);
+}
 
-	// Create VBOs
-	glGenBuffers(1, m_TorusMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TorusMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+///////////////////////////////////////////////////
+//	GenerateTorusMesh()
+//
+//	Generate one level of a torus lying in the XY
+//  plane around the origin.  The vertices are a grid
+//  of rings around the tube, with the seam vertices
+//  repeated in both directions so the texture wraps
+//  once around each.
+///////////////////////////////////////////////////
+void ShapeMeshes::GenerateTorusMesh(
+	GLMesh& mesh,
+	int mainSegments,
+	int tubeSegments,
+	float mainRadius,
+	float tubeRadius)
+{
+	std::vector<GLfloat> verts;
+	std::vector<GLuint> indices;
+	GLuint ringLength = (GLuint)tubeSegments + 1;
 
-	if (m_bMemoryLayoutDone == false)
+	for (int i = 0; i <= mainSegments; i++)
 	{
-		SetShaderMemoryLayout();
+		float mainAngle = glm::two_pi<float>() * i / mainSegments;
+		for (int j = 0; j <= tubeSegments; j++)
+		{
+			float tubeAngle = glm::two_pi<float>() * j / tubeSegments;
+			glm::vec3 normal(
+				glm::cos(tubeAngle) * glm::cos(mainAngle),
+				glm::cos(tubeAngle) * glm::sin(mainAngle),
+				glm::sin(tubeAngle));
+			glm::vec3 center(mainRadius * glm::cos(mainAngle), mainRadius * glm::sin(mainAngle), 0.0f);
+
+			AddVertex(verts, center + normal * tubeRadius, normal,
+				glm::vec2((float)i / mainSegments, (float)j / tubeSegments));
+		}
 	}
-}
 
+	for (int i = 0; i < mainSegments; i++)
+	{
+		for (int j = 0; j < tubeSegments; j++)
+		{
+			GLuint current = i * ringLength + j;
+			GLuint next = current + ringLength;
+
+			indices.push_back(current);
+			indices.push_back(next);
+			indices.push_back(next + 1);
+			indices.push_back(current);
+			indices.push_back(next + 1);
+			indices.push_back(current + 1);
+		}
+	}
 
+	// the edges around the outside of the ring and around
+	// the tube both cut in
+	mesh.error = (mainRadius + tubeRadius) * (1.0f - glm::cos(glm::pi<float>() / mainSegments)) +
+		tubeRadius * (1.0f - glm::cos(glm::pi<float>() / tubeSegments));
+
+	// the halves are added one at a time, so reordering
+	// the triangles keeps the upper half first
+	GLuint halfIndices = (GLuint)(indices.size() / 6) * 3;
+	mesh.nVertices = (GLuint)(verts.size() / g_FloatsPerMeshVertex);
+	AddMeshVertices(mesh, verts.data());
+	AddMeshIndices(mesh, indices.data(), halfIndices);
+	AddMeshIndices(mesh, indices.data() + halfIndices, (GLuint)indices.size() - halfIndices);
+}
 
 ///////////////////////////////////////////////////
 //	DrawBoxMesh()
@@ -2194,11 +954,7 @@ void ShapeMeshes::LoadTorusMesh(float thickness)
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMesh()
 {
-	glBindVertexArray(m_BoxMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawIndexRange(m_BoxMesh, m_BoxMesh.firstIndex, m_BoxMesh.nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2210,15 +966,7 @@ void ShapeMeshes::DrawBoxMesh()
 void ShapeMeshes::DrawConeMesh(
 	bool bDrawBottom)
 {
-	glBindVertexArray(m_ConeMesh.vao);
-
-	if (bDrawBottom == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-	}
-	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
-
-	glBindVertexArray(0);
+	DrawMeshParts(m_ConeMesh, bDrawBottom, false, true);
 }
 
 ///////////////////////////////////////////////////
@@ -2232,22 +980,7 @@ void ShapeMeshes::DrawCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_CylinderMesh.vao);
-
-	if (bDrawBottom == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
-	}
-	if (bDrawTop == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 36);	//top
-	}
-	if (bDrawSides == true)
-	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
-	}
-
-	glBindVertexArray(0);
+	DrawMeshParts(m_CylinderMesh, bDrawBottom, bDrawTop, bDrawSides);
 }
 
 ///////////////////////////////////////////////////
@@ -2258,11 +991,7 @@ void ShapeMeshes::DrawCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPlaneMesh()
 {
-	glBindVertexArray(m_PlaneMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-	
-	glBindVertexArray(0);
+	DrawIndexRange(m_PlaneMesh, m_PlaneMesh.firstIndex, m_PlaneMesh.nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2273,11 +1002,7 @@ void ShapeMeshes::DrawPlaneMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPrismMesh()
 {
-	glBindVertexArray(m_PrismMesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawIndexRange(m_PrismMesh, m_PrismMesh.firstIndex, m_PrismMesh.nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2288,11 +1013,7 @@ void ShapeMeshes::DrawPrismMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid3Mesh()
 {
-	glBindVertexArray(m_Pyramid3Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawIndexRange(m_Pyramid3Mesh, m_Pyramid3Mesh.firstIndex, m_Pyramid3Mesh.nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2303,11 +1024,7 @@ void ShapeMeshes::DrawPyramid3Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid4Mesh()
 {
-	glBindVertexArray(m_Pyramid4Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawIndexRange(m_Pyramid4Mesh, m_Pyramid4Mesh.firstIndex, m_Pyramid4Mesh.nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2318,11 +1035,7 @@ void ShapeMeshes::DrawPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawIndexRange(m_SphereMesh, m_SphereMesh.firstIndex, m_SphereMesh.nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2333,11 +1046,7 @@ void ShapeMeshes::DrawSphereMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices/2, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawIndexRange(m_SphereMesh, m_SphereMesh.firstIndex, m_SphereMesh.nIndices/2);
 }
 
 ///////////////////////////////////////////////////
@@ -2351,22 +1060,7 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
-
-	if (bDrawBottom == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
-	}
-	if (bDrawTop == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 72);	//top
-	}
-	if (bDrawSides == true)
-	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
-	}
-
-	glBindVertexArray(0);
+	DrawMeshParts(m_TaperedCylinderMesh, bDrawBottom, bDrawTop, bDrawSides);
 }
 
 ///////////////////////////////////////////////////
@@ -2377,11 +1071,7 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
-
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawIndexRange(m_TorusMesh, m_TorusMesh.firstIndex, m_TorusMesh.nIndices);
 }
 
 ///////////////////////////////////////////////////
@@ -2392,19 +1082,895 @@ void ShapeMeshes::DrawTorusMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	DrawIndexRange(m_TorusMesh, m_TorusMesh.firstIndex, m_TorusMesh.nIndices/2);
+}
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices/2);
+///////////////////////////////////////////////////
+//	DrawMesh()
+//
+//	Draw the full shape mesh of the passed in type
+//  to the window, at the passed in level of detail
+//  or the coarsest level the mesh has.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMesh(
+	MESH_TYPE mesh,
+	int lod)
+{
+	GLMesh* pMesh = GetMesh(mesh, lod);
+	if (NULL == pMesh)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	DrawIndexRange(*pMesh, pMesh->firstIndex, pMesh->nIndices);
 }
 
-glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
+///////////////////////////////////////////////////
+//	DrawMeshInstanced()
+//
+//	Draw the full shape mesh of the passed in type
+//  once for each instance, using the per-instance
+//  model matrix, color, UV scale and material.  Each
+//  mesh takes a single draw command no matter how
+//  many instances are drawn.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshInstanced(
+	MESH_TYPE mesh,
+	const INSTANCE_DATA* instances,
+	GLsizei instanceCount,
+	int lod)
 {
-	glm::vec3 Normal(0, 0, 0);
-	float v1x = p1.x - p0.x;
-	float v1y = p1.y - p0.y;
-	float v1z = p1.z - p0.z;
+	GLMesh* pMesh = GetMesh(mesh, lod);
+	if ((NULL == pMesh) || (NULL == instances) || (instanceCount <= 0))
+	{
+		return;
+	}
+
+	UploadInstanceData(instances, instanceCount);
+	BindInstancedMeshBuffers();
+
+	DrawIndexRange(*pMesh, pMesh->firstIndex, pMesh->nIndices, instanceCount);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshDrawCommand()
+//
+//	Fill the indirect draw command for the full shape
+//  mesh of the passed in type.  The command reads its
+//  per-instance values starting at baseInstance in
+//  the instance buffer.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshDrawCommand(
+	MESH_TYPE mesh,
+	GLuint instanceCount,
+	GLuint baseInstance,
+	DRAW_INDIRECT_COMMAND& command,
+	int lod)
+{
+	GLMesh* pMesh = GetMesh(mesh, lod);
+	if ((NULL == pMesh) || (pMesh->nIndices == 0))
+	{
+		return(false);
+	}
+
+	command.count = pMesh->nIndices;
+	command.instanceCount = instanceCount;
+	command.firstIndex = pMesh->firstIndex;
+	command.baseVertex = pMesh->baseVertex;
+	command.baseInstance = baseInstance;
+
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	UploadDrawCommands()
+//
+//	Copy the draw commands into the indirect draw
+//  buffer.  Like the instance buffer, it only grows
+//  and is orphaned before each upload.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadDrawCommands(
+	const DRAW_INDIRECT_COMMAND* commands,
+	GLsizei commandCount)
+{
+	if ((NULL == commands) || (commandCount <= 0))
+	{
+		return;
+	}
+
+	if (0 == m_indirectBuffer)
+	{
+		glGenBuffers(1, &m_indirectBuffer);
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+	RenderStats::CountStateChange();
+	if (commandCount > m_indirectCapacity)
+	{
+		m_indirectCapacity = commandCount;
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DRAW_INDIRECT_COMMAND) * m_indirectCapacity, commands, GL_STREAM_DRAW);
+	}
+	else
+	{
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DRAW_INDIRECT_COMMAND) * m_indirectCapacity, NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DRAW_INDIRECT_COMMAND) * commandCount, commands);
+	}
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshesIndirect()
+//
+//	Draw a run of the uploaded commands with a single
+//  multi-draw indirect command.  Needs OpenGL 4.3, and
+//  the instance values and commands must already be
+//  uploaded for the frame.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshesIndirect(
+	GLsizei firstCommand,
+	GLsizei commandCount)
+{
+	if ((0 == m_indirectBuffer) || (commandCount <= 0))
+	{
+		return;
+	}
+
+	BindInstancedMeshBuffers();
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+	RenderStats::CountStateChange();
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+		(void*)(sizeof(DRAW_INDIRECT_COMMAND) * firstCommand), commandCount, 0);
+	RenderStats::CountDrawCall();
+}
+
+///////////////////////////////////////////////////
+//	ResetBindings()
+//
+//	Forget that the shared VAO is bound, so that it
+//  is bound again by the next draw.  Called at the
+//  start of every frame, in case other code has
+//  bound its own VAO since.
+///////////////////////////////////////////////////
+void ShapeMeshes::ResetBindings()
+{
+	m_bArenaBound = false;
+}
+
+///////////////////////////////////////////////////
+//	BindInstancedMeshBuffers()
+//
+//	Bind the shared VAO, adding the per-instance
+//  attributes the first time any mesh is drawn with
+//  instancing.
+///////////////////////////////////////////////////
+void ShapeMeshes::BindInstancedMeshBuffers()
+{
+	BindMeshBuffers();
+
+	if ((m_bInstanceLayoutDone == false) && (0 != m_instanceVBO))
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+		SetInstanceMemoryLayout();
+		m_bInstanceLayoutDone = true;
+	}
+}
+
+///////////////////////////////////////////////////
+//	GetMesh()
+//
+//	Get the loaded mesh data for the passed in type
+//  and level of detail.  A level past the coarsest
+//  level of the mesh gets the coarsest level.
+///////////////////////////////////////////////////
+ShapeMeshes::GLMesh* ShapeMeshes::GetMesh(
+	MESH_TYPE mesh,
+	int lod)
+{
+	if ((mesh >= 0) && (mesh < MESH_COUNT) && (lod > 0))
+	{
+		lod = std::min(lod, m_lodCounts[mesh] - 1);
+		if (lod > 0)
+		{
+			return(&m_lodMeshes[mesh][lod - 1]);
+		}
+	}
+
+	switch (mesh)
+	{
+	case MESH_BOX:
+		return(&m_BoxMesh);
+	case MESH_CONE:
+		return(&m_ConeMesh);
+	case MESH_CYLINDER:
+		return(&m_CylinderMesh);
+	case MESH_PLANE:
+		return(&m_PlaneMesh);
+	case MESH_PRISM:
+		return(&m_PrismMesh);
+	case MESH_PYRAMID3:
+		return(&m_Pyramid3Mesh);
+	case MESH_PYRAMID4:
+		return(&m_Pyramid4Mesh);
+	case MESH_SPHERE:
+		return(&m_SphereMesh);
+	case MESH_TAPERED_CYLINDER:
+		return(&m_TaperedCylinderMesh);
+	case MESH_TORUS:
+		return(&m_TorusMesh);
+	default:
+		break;
+	}
+	return(NULL);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshLodCount()
+//
+//	Get the number of levels of detail loaded for the
+//  passed in mesh, 0 when the mesh is not loaded.
+///////////////////////////////////////////////////
+int ShapeMeshes::GetMeshLodCount(MESH_TYPE mesh)
+{
+	GLMesh* pMesh = GetMesh(mesh);
+
+	if ((NULL == pMesh) || (0 == pMesh->nVertices))
+	{
+		return(0);
+	}
+
+	return(m_lodCounts[mesh]);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshLodError()
+//
+//	Get how far the triangles of a level of detail
+//  of the passed in mesh are from the true surface,
+//  as a share of the bounding sphere radius of the
+//  full mesh, so that it scales with the object.
+//  Flat sided meshes have no error.
+///////////////////////////////////////////////////
+float ShapeMeshes::GetMeshLodError(
+	MESH_TYPE mesh,
+	int lod)
+{
+	GLMesh* pMesh = GetMesh(mesh);
+	GLMesh* pLevel = GetMesh(mesh, lod);
+
+	if ((NULL == pMesh) || (pMesh->bounds.sphereRadius <= 0.0f))
+	{
+		return(0.0f);
+	}
+
+	return(pLevel->error / pMesh->bounds.sphereRadius);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshTriangleCount()
+//
+//	Get the number of triangles drawn for a level of
+//  detail of the passed in mesh.
+///////////////////////////////////////////////////
+GLuint ShapeMeshes::GetMeshTriangleCount(
+	MESH_TYPE mesh,
+	int lod)
+{
+	GLMesh* pMesh = GetMesh(mesh, lod);
+
+	if (NULL == pMesh)
+	{
+		return(0);
+	}
+
+	return(pMesh->nIndices / 3);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshVertexCount()
+//
+//	Get the number of vertices stored for a level of
+//  detail of the passed in mesh.
+///////////////////////////////////////////////////
+GLuint ShapeMeshes::GetMeshVertexCount(
+	MESH_TYPE mesh,
+	int lod)
+{
+	GLMesh* pMesh = GetMesh(mesh, lod);
+
+	if (NULL == pMesh)
+	{
+		return(0);
+	}
+
+	return(pMesh->nVertices);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshCacheStats()
+//
+//	Measure how many vertices a FIFO post-transform
+//  cache of the passed in size transforms to draw a
+//  level of detail of the passed in mesh.  False is
+//  returned when the mesh is not loaded.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshCacheStats(
+	MESH_TYPE mesh,
+	int lod,
+	int cacheSize,
+	VertexCacheOptimizer::CACHE_STATS& stats)
+{
+	GLMesh* pMesh = GetMesh(mesh, lod);
+
+	if ((NULL == pMesh) || (0 == pMesh->nIndices))
+	{
+		return(false);
+	}
+
+	stats = VertexCacheOptimizer::MeasureCache(&m_arenaIndices[pMesh->firstIndex],
+		pMesh->nIndices, pMesh->nVertices, cacheSize);
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	SetVertexCacheOptimization()
+//
+//	Turn the reordering of the triangles and vertices
+//  of the meshes for the vertex cache on or off.  It
+//  only changes the meshes loaded after it is set.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetVertexCacheOptimization(bool bOptimize)
+{
+	m_bOptimizeVertexCache = bOptimize;
+}
+
+///////////////////////////////////////////////////
+//	SetVertexFormat()
+//
+//	Choose how the vertices are stored in the shared
+//  vertex buffer.  The loaded meshes are kept as
+//  floats, so the format can be changed at any time,
+//  and the vertex buffer is filled again by the next
+//  draw.  Packed positions are steps across the
+//  bounding box of their level of detail, so every
+//  draw must pass the shader the scale and offset from
+//  GetMeshPositionDecode(), and the normals must be
+//  unfolded from the octahedron by the shader.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetVertexFormat(VERTEX_FORMAT format)
+{
+	if (format != m_vertexFormat)
+	{
+		m_vertexFormat = format;
+		m_bArenaDirty = true;
+		m_bMemoryLayoutDone = false;
+	}
+}
+
+///////////////////////////////////////////////////
+//	GetVertexFormat()
+//
+//	Get how the vertices are stored in the shared
+//  vertex buffer.
+///////////////////////////////////////////////////
+ShapeMeshes::VERTEX_FORMAT ShapeMeshes::GetVertexFormat() const
+{
+	return(m_vertexFormat);
+}
+
+///////////////////////////////////////////////////
+//	GetVertexSize()
+//
+//	Get the number of bytes of one vertex in the
+//  shared vertex buffer.
+///////////////////////////////////////////////////
+GLuint ShapeMeshes::GetVertexSize() const
+{
+	if (VERTEX_FORMAT_PACKED == m_vertexFormat)
+	{
+		return(sizeof(PACKED_VERTEX));
+	}
+
+	return(sizeof(GLfloat) * g_FloatsPerMeshVertex);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshPositionDecode()
+//
+//	Get the scale and offset that move the positions
+//  stored for a level of detail of the passed in mesh
+//  into its object space - a scale of 1 and offset of
+//  0 for float vertices, or when the mesh is not
+//  loaded.
+///////////////////////////////////////////////////
+ShapeMeshes::POSITION_DECODE ShapeMeshes::GetMeshPositionDecode(
+	MESH_TYPE mesh,
+	int lod)
+{
+	GLMesh* pMesh = GetMesh(mesh, lod);
+	POSITION_DECODE decode;
+	decode.scale = glm::vec3(1.0f);
+	decode.offset = glm::vec3(0.0f);
+
+	if ((VERTEX_FORMAT_PACKED == m_vertexFormat) && (NULL != pMesh) && (0 != pMesh->nVertices))
+	{
+		decode.scale = GetDecodeScale(pMesh->bounds);
+		decode.offset = pMesh->bounds.boxMin;
+	}
+
+	return(decode);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshQuantizationError()
+//
+//	Pack every vertex of a level of detail of the
+//  passed in mesh, read it back the way the GPU
+//  does, and keep the largest differences from the
+//  float vertex.  False is returned when the mesh is
+//  not loaded.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshQuantizationError(
+	MESH_TYPE mesh,
+	int lod,
+	QUANTIZATION_ERROR& error)
+{
+	GLMesh* pMesh = GetMesh(mesh, lod);
+
+	if ((NULL == pMesh) || (0 == pMesh->nVertices))
+	{
+		return(false);
+	}
+
+	error.position = 0.0f;
+	error.normalDegrees = 0.0f;
+	error.uv = 0.0f;
+
+	for (GLuint i = 0; i < pMesh->nVertices; i++)
+	{
+		const GLfloat* vertex = &m_arenaVertices[((size_t)pMesh->baseVertex + i) * g_FloatsPerMeshVertex];
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+
+		UnpackVertex(PackVertex(vertex, pMesh->bounds), pMesh->bounds, position, normal, uv);
+
+		glm::vec3 trueNormal(vertex[3], vertex[4], vertex[5]);
+		float cosine = glm::clamp(glm::dot(normal, glm::normalize(trueNormal)), -1.0f, 1.0f);
+		error.position = glm::max(error.position, glm::length(position - glm::vec3(vertex[0], vertex[1], vertex[2])));
+		error.normalDegrees = glm::max(error.normalDegrees, glm::degrees(glm::acos(cosine)));
+		error.uv = glm::max(error.uv, glm::length(uv - glm::vec2(vertex[6], vertex[7])));
+	}
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshBounds()
+//
+//	Get the bounding box and bounding sphere of the
+//  vertices of the passed in mesh, in its own object
+//  space.  False is returned when the mesh is not
+//  loaded.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshBounds(
+	MESH_TYPE mesh,
+	MESH_BOUNDS& bounds)
+{
+	GLMesh* pMesh = GetMesh(mesh);
+
+	if ((NULL == pMesh) || (0 == pMesh->nVertices))
+	{
+		return(false);
+	}
+
+	bounds = pMesh->bounds;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	UploadInstanceData()
+//
+//	Copy the instance values into the instance buffer.
+//  The buffer only grows, and is orphaned before each
+//  upload so the driver does not wait on the previous
+//  draw that read from it.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadInstanceData(
+	const INSTANCE_DATA* instances,
+	GLsizei instanceCount)
+{
+	if (0 == m_instanceVBO)
+	{
+		glGenBuffers(1, &m_instanceVBO);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+	RenderStats::CountStateChange();
+	if (instanceCount > m_instanceCapacity)
+	{
+		m_instanceCapacity = instanceCount;
+		glBufferData(GL_ARRAY_BUFFER, sizeof(INSTANCE_DATA) * m_instanceCapacity, instances, GL_STREAM_DRAW);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, sizeof(INSTANCE_DATA) * m_instanceCapacity, NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(INSTANCE_DATA) * instanceCount, instances);
+	}
+}
+
+///////////////////////////////////////////////////
+//	AddMeshVertices()
+//
+//	Append the interleaved vertices of a mesh to the
+//  shared vertex buffer.  The mesh records where its
+//  vertices start, so its indices stay relative to
+//  its own first vertex.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddMeshVertices(
+	GLMesh& mesh,
+	const GLfloat* verts)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	mesh.baseVertex = (GLint)(m_arenaVertices.size() / floatsPerVertex);
+	mesh.firstIndex = (GLuint)m_arenaIndices.size();
+	mesh.nIndices = 0;
+	for (int part = 0; part < PART_COUNT; part++)
+	{
+		mesh.parts[part].firstIndex = mesh.firstIndex;
+		mesh.parts[part].nIndices = 0;
+	}
+
+	m_arenaVertices.insert(m_arenaVertices.end(), verts, verts + (mesh.nVertices * floatsPerVertex));
+	m_bArenaDirty = true;
+
+	// the vertices start out where they were passed in
+	m_vertexRemap.resize(mesh.nVertices);
+	for (GLuint i = 0; i < mesh.nVertices; i++)
+	{
+		m_vertexRemap[i] = i;
+	}
+
+	// the box is fitted to the positions, and the sphere is
+	// centered on the box and reaches the farthest position
+	mesh.bounds.boxMin = glm::vec3(0.0f);
+	mesh.bounds.boxMax = glm::vec3(0.0f);
+	for (GLuint i = 0; i < mesh.nVertices; i++)
+	{
+		glm::vec3 position(verts[i * floatsPerVertex], verts[i * floatsPerVertex + 1], verts[i * floatsPerVertex + 2]);
+		if (i == 0)
+		{
+			mesh.bounds.boxMin = position;
+			mesh.bounds.boxMax = position;
+		}
+		mesh.bounds.boxMin = glm::min(mesh.bounds.boxMin, position);
+		mesh.bounds.boxMax = glm::max(mesh.bounds.boxMax, position);
+	}
+
+	mesh.bounds.sphereCenter = (mesh.bounds.boxMin + mesh.bounds.boxMax) * 0.5f;
+	mesh.bounds.sphereRadius = 0.0f;
+	for (GLuint i = 0; i < mesh.nVertices; i++)
+	{
+		glm::vec3 position(verts[i * floatsPerVertex], verts[i * floatsPerVertex + 1], verts[i * floatsPerVertex + 2]);
+		mesh.bounds.sphereRadius = glm::max(mesh.bounds.sphereRadius, glm::length(position - mesh.bounds.sphereCenter));
+	}
+}
+
+///////////////////////////////////////////////////
+//	AddMeshIndices()
+//
+//	Append the triangle list indices of a mesh to the
+//  shared index buffer.  The indices can be recorded
+//  as one of the parts of the mesh.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddMeshIndices(
+	GLMesh& mesh,
+	const GLuint* indices,
+	GLuint nIndices,
+	int part)
+{
+	GLuint partStart = (GLuint)m_arenaIndices.size();
+
+	m_arenaIndices.insert(m_arenaIndices.end(), indices, indices + nIndices);
+	OptimizeMeshIndices(mesh, partStart);
+
+	if ((part >= 0) && (part < PART_COUNT))
+	{
+		mesh.parts[part].firstIndex = partStart;
+		mesh.parts[part].nIndices = nIndices;
+	}
+	mesh.nIndices = (GLuint)m_arenaIndices.size() - mesh.firstIndex;
+	m_bArenaDirty = true;
+}
+
+///////////////////////////////////////////////////
+//	AddMeshTriangles()
+//
+//	Append the indices of the triangles that the
+//  passed in array drawing command would draw, so
+//  fans and strips share the indexed triangle list
+//  draw of every other mesh.  The indices can be
+//  recorded as one of the parts of the mesh.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddMeshTriangles(
+	GLMesh& mesh,
+	GLenum mode,
+	GLuint first,
+	GLuint count,
+	int part)
+{
+	GLuint partStart = (GLuint)m_arenaIndices.size();
+
+	// never index past the end of the mesh vertices
+	if (first >= mesh.nVertices)
+	{
+		count = 0;
+	}
+	else if (first + count > mesh.nVertices)
+	{
+		count = mesh.nVertices - first;
+	}
+
+	for (GLuint i = 0; i + 2 < count; i++)
+	{
+		GLuint a, b, c;
+
+		if (mode == GL_TRIANGLE_FAN)
+		{
+			a = first;
+			b = first + i + 1;
+			c = first + i + 2;
+		}
+		else if (mode == GL_TRIANGLE_STRIP)
+		{
+			// every other strip triangle is flipped to
+			// keep the same winding as the strip
+			a = first + i + (i % 2);
+			b = first + i + 1 - (i % 2);
+			c = first + i + 2;
+		}
+		else
+		{
+			if (i % 3 != 0)
+			{
+				continue;
+			}
+			a = first + i;
+			b = first + i + 1;
+			c = first + i + 2;
+		}
+
+		m_arenaIndices.push_back(a);
+		m_arenaIndices.push_back(b);
+		m_arenaIndices.push_back(c);
+	}
+	OptimizeMeshIndices(mesh, partStart);
+
+	if ((part >= 0) && (part < PART_COUNT))
+	{
+		mesh.parts[part].firstIndex = partStart;
+		mesh.parts[part].nIndices = (GLuint)m_arenaIndices.size() - partStart;
+	}
+	mesh.nIndices = (GLuint)m_arenaIndices.size() - mesh.firstIndex;
+	m_bArenaDirty = true;
+}
+
+///////////////////////////////////////////////////
+//	OptimizeMeshIndices()
+//
+//	Reorder the triangles added to a mesh from the
+//  passed in index for the post-transform vertex
+//  cache, and then for overdraw, unless the order
+//  they were passed in suits the cache better.
+//  The vertices of the whole mesh are then merged
+//  where identical and numbered in the order they
+//  are first used, which keeps the order of the
+//  triangles added before.  The mesh must be the
+//  last one loaded, and the added indices are
+//  numbered as the vertices were passed in.
+///////////////////////////////////////////////////
+void ShapeMeshes::OptimizeMeshIndices(
+	GLMesh& mesh,
+	GLuint firstIndex)
+{
+	if ((m_bOptimizeVertexCache == false) || (0 == mesh.nVertices))
+	{
+		return;
+	}
+
+	GLfloat* vertices = &m_arenaVertices[(size_t)mesh.baseVertex * g_FloatsPerMeshVertex];
+	size_t nIndices = m_arenaIndices.size() - firstIndex;
+	std::vector<size_t> clusterStarts;
+	std::vector<GLuint> remap;
+
+	// point the new indices at where their vertices were moved
+	for (size_t i = firstIndex; i < m_arenaIndices.size(); i++)
+	{
+		m_arenaIndices[i] = m_vertexRemap[m_arenaIndices[i]];
+	}
+
+	if (nIndices > 0)
+	{
+		std::vector<GLuint> passedIndices(m_arenaIndices.begin() + firstIndex, m_arenaIndices.end());
+		double passedACMR = VertexCacheOptimizer::MeasureCache(passedIndices.data(), nIndices,
+			mesh.nVertices, VertexCacheOptimizer::DEFAULT_CACHE_SIZE).acmr;
+
+		VertexCacheOptimizer::OptimizeTriangleOrder(&m_arenaIndices[firstIndex], nIndices,
+			mesh.nVertices, VertexCacheOptimizer::DEFAULT_CACHE_SIZE, clusterStarts);
+		VertexCacheOptimizer::OptimizeOverdraw(&m_arenaIndices[firstIndex], nIndices,
+			vertices, mesh.nVertices, g_FloatsPerMeshVertex, clusterStarts);
+
+		// small meshes can already fit in the cache in the order
+		// they were passed in, which is then kept
+		if (VertexCacheOptimizer::MeasureCache(&m_arenaIndices[firstIndex], nIndices,
+			mesh.nVertices, VertexCacheOptimizer::DEFAULT_CACHE_SIZE).acmr >= passedACMR)
+		{
+			std::copy(passedIndices.begin(), passedIndices.end(), m_arenaIndices.begin() + firstIndex);
+		}
+	}
+
+	if (m_arenaIndices.size() > mesh.firstIndex)
+	{
+		mesh.nVertices = (GLuint)VertexCacheOptimizer::OptimizeVertexOrder(&m_arenaIndices[mesh.firstIndex],
+			m_arenaIndices.size() - mesh.firstIndex, vertices, mesh.nVertices, g_FloatsPerMeshVertex, remap);
+		m_arenaVertices.resize(((size_t)mesh.baseVertex + mesh.nVertices) * g_FloatsPerMeshVertex);
+		for (size_t i = 0; i < m_vertexRemap.size(); i++)
+		{
+			m_vertexRemap[i] = remap[m_vertexRemap[i]];
+		}
+	}
+}
+
+///////////////////////////////////////////////////
+//	UploadPackedVertices()
+//
+//	Pack the vertices of every loaded level of detail
+//  into the vertex buffer bound to GL_ARRAY_BUFFER,
+//  each across the bounds of its own level.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadPackedVertices()
+{
+	std::vector<PACKED_VERTEX> packed(m_arenaVertices.size() / g_FloatsPerMeshVertex);
+
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		for (int lod = 0; lod < m_lodCounts[i]; lod++)
+		{
+			GLMesh* pMesh = GetMesh((MESH_TYPE)i, lod);
+			for (GLuint vertex = 0; vertex < pMesh->nVertices; vertex++)
+			{
+				size_t index = (size_t)pMesh->baseVertex + vertex;
+				packed[index] = PackVertex(&m_arenaVertices[index * g_FloatsPerMeshVertex], pMesh->bounds);
+			}
+		}
+	}
+
+	glBufferData(GL_ARRAY_BUFFER, sizeof(PACKED_VERTEX) * packed.size(), packed.data(), GL_STATIC_DRAW);
+}
+
+///////////////////////////////////////////////////
+//	BindMeshBuffers()
+//
+//	Bind the shared VAO that every mesh is drawn from.
+//  The buffers are created on first use, and the
+//  vertex and index data are sent to the GPU again
+//  after meshes have been loaded.  The VAO is only
+//  bound again after ResetBindings().
+///////////////////////////////////////////////////
+void ShapeMeshes::BindMeshBuffers()
+{
+	if (0 == m_arenaVAO)
+	{
+		glGenVertexArrays(1, &m_arenaVAO);
+		glGenBuffers(2, m_arenaVBOs);
+	}
+
+	if (m_bArenaBound == false)
+	{
+		glBindVertexArray(m_arenaVAO);
+		RenderStats::CountStateChange();
+		m_bArenaBound = true;
+	}
+	else
+	{
+		RenderStats::CountEliminatedStateChange();
+	}
+
+	if (m_bArenaDirty == true)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_arenaVBOs[0]); // Activates the vertex buffer
+		if (VERTEX_FORMAT_PACKED == m_vertexFormat)
+		{
+			UploadPackedVertices();
+		}
+		else
+		{
+			glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * m_arenaVertices.size(), m_arenaVertices.data(), GL_STATIC_DRAW);
+		}
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_arenaVBOs[1]); // Activates the index buffer
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * m_arenaIndices.size(), m_arenaIndices.data(), GL_STATIC_DRAW);
+
+		if (m_bMemoryLayoutDone == false)
+		{
+			SetShaderMemoryLayout();
+			m_bMemoryLayoutDone = true;
+		}
+		m_bArenaDirty = false;
+	}
+}
+
+///////////////////////////////////////////////////
+//	DrawIndexRange()
+//
+//	Draw a range of the shared index buffer as
+//  triangles of the passed in mesh.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawIndexRange(
+	const GLMesh& mesh,
+	GLuint firstIndex,
+	GLuint nIndices,
+	GLsizei instanceCount)
+{
+	if (nIndices == 0)
+	{
+		return;
+	}
+
+	BindMeshBuffers();
+
+	if (instanceCount > 1)
+	{
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, nIndices, GL_UNSIGNED_INT,
+			(void*)(sizeof(GLuint) * firstIndex), instanceCount, mesh.baseVertex);
+	}
+	else
+	{
+		glDrawElementsBaseVertex(GL_TRIANGLES, nIndices, GL_UNSIGNED_INT,
+			(void*)(sizeof(GLuint) * firstIndex), mesh.baseVertex);
+	}
+	RenderStats::CountDrawCall();
+	RenderStats::CountTriangles((nIndices / 3) * (GLuint)std::max(instanceCount, 1));
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshParts()
+//
+//	Draw the selected parts of a mesh that has a
+//  bottom, top and sides.  The parts are stored one
+//  after another, so the whole mesh is one draw.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshParts(
+	const GLMesh& mesh,
+	bool bDrawBottom,
+	bool bDrawTop,
+	bool bDrawSides)
+{
+	if ((bDrawBottom == true) && (bDrawTop == true) && (bDrawSides == true))
+	{
+		DrawIndexRange(mesh, mesh.firstIndex, mesh.nIndices);
+		return;
+	}
+
+	if (bDrawBottom == true)
+	{
+		DrawIndexRange(mesh, mesh.parts[PART_BOTTOM].firstIndex, mesh.parts[PART_BOTTOM].nIndices);
+	}
+	if (bDrawTop == true)
+	{
+		DrawIndexRange(mesh, mesh.parts[PART_TOP].firstIndex, mesh.parts[PART_TOP].nIndices);
+	}
+	if (bDrawSides == true)
+	{
+		DrawIndexRange(mesh, mesh.parts[PART_SIDES].firstIndex, mesh.parts[PART_SIDES].nIndices);
+	}
+}
+
+glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
+{
+	glm::vec3 Normal(0, 0, 0);
+	float v1x = p1.x - p0.x;
+	float v1y = p1.y - p0.y;
+	float v1z = p1.z - p0.z;
 	float v2x = p2.x - p1.x;
 	float v2y = p2.y - p1.y;
 	float v2z = p2.z - p1.z;
@@ -2432,6 +1998,22 @@ void ShapeMeshes::SetShaderMemoryLayout()
 	// The following code defines the layout of the mesh data in memory - each mesh needs
 	// to have the same memory layout so that the data is retrieved properly by the shaders
 
+	if (VERTEX_FORMAT_PACKED == m_vertexFormat)
+	{
+		// the positions and UVs are turned into floats as they are
+		// fetched, and the two octahedral values of the normal are
+		// read as its x and y
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, position));
+		glEnableVertexAttribArray(0);
+
+		glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, normal));
+		glEnableVertexAttribArray(1);
+
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, uv));
+		glEnableVertexAttribArray(2);
+		return;
+	}
+
 	// Strides between vertex coordinates is 6 (x, y, z, r, g, b, a). A tightly packed stride is 0.
 	GLint stride = sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);// The number of floats before each
 
@@ -2445,3 +2027,36 @@ void ShapeMeshes::SetShaderMemoryLayout()
 	glVertexAttribPointer(2, g_FloatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal)));
 	glEnableVertexAttribArray(2);
 }
+
+void ShapeMeshes::SetInstanceMemoryLayout()
+{
+	// The per-instance values come from the instance buffer, which must be
+	// bound to GL_ARRAY_BUFFER, and advance once per instance instead of
+	// once per vertex
+	GLint stride = sizeof(INSTANCE_DATA);
+
+	// a mat4 attribute is passed as four vec4 columns
+	for (GLuint column = 0; column < 4; column++)
+	{
+		glVertexAttribPointer(g_InstanceModelLocation + column, 4, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(glm::vec4) * column));
+		glEnableVertexAttribArray(g_InstanceModelLocation + column);
+		glVertexAttribDivisor(g_InstanceModelLocation + column, 1);
+	}
+
+	glVertexAttribPointer(g_InstanceColorLocation, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(INSTANCE_DATA, color));
+	glEnableVertexAttribArray(g_InstanceColorLocation);
+	glVertexAttribDivisor(g_InstanceColorLocation, 1);
+
+	// UV scale, material index and texture are read together as one vec4
+	glVertexAttribPointer(g_InstanceParamsLocation, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(INSTANCE_DATA, uvScale));
+	glEnableVertexAttribArray(g_InstanceParamsLocation);
+	glVertexAttribDivisor(g_InstanceParamsLocation, 1);
+
+	glVertexAttribPointer(g_InstanceDecodeScaleLocation, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offsetof(INSTANCE_DATA, positionDecode) + offsetof(POSITION_DECODE, scale)));
+	glEnableVertexAttribArray(g_InstanceDecodeScaleLocation);
+	glVertexAttribDivisor(g_InstanceDecodeScaleLocation, 1);
+
+	glVertexAttribPointer(g_InstanceDecodeOffsetLocation, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offsetof(INSTANCE_DATA, positionDecode) + offsetof(POSITION_DECODE, offset)));
+	glEnableVertexAttribArray(g_InstanceDecodeOffsetLocation);
+	glVertexAttribDivisor(g_InstanceDecodeOffsetLocation, 1);
+}
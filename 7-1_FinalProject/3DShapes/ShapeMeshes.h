@@ -10,10 +10,14 @@
 
 #pragma once
 
+#include "VertexCacheOptimizer.h"
+
 #include <GL/glew.h>
 
 #include <glm/glm.hpp>
 
+#include <vector>
+
 /***********************************************************
  *  ShapeMeshes
  *
@@ -26,15 +30,115 @@ public:
 	// constructor
 	ShapeMeshes();
 
+	// the available 3D shapes, used for referencing a mesh by value
+	enum MESH_TYPE
+	{
+		MESH_NONE = -1,
+		MESH_BOX,
+		MESH_CONE,
+		MESH_CYLINDER,
+		MESH_PLANE,
+		MESH_PRISM,
+		MESH_PYRAMID3,
+		MESH_PYRAMID4,
+		MESH_SPHERE,
+		MESH_TAPERED_CYLINDER,
+		MESH_TORUS,
+		MESH_COUNT
+	};
+
+	// the scale and offset that move the stored positions of a
+	// level of detail into the object space of its mesh, read by
+	// the vertex shader as position * scale + offset
+	struct POSITION_DECODE
+	{
+		glm::vec3 scale;
+		glm::vec3 offset;
+	};
+
+	// per-instance values for drawing many copies of a mesh
+	// with one draw command - must match the instance
+	// attributes declared in the vertex shader
+	struct INSTANCE_DATA
+	{
+		glm::mat4 model;        // model matrix of the instance
+		glm::vec4 color;        // object color of the instance
+		glm::vec2 uvScale;      // texture UV scale of the instance
+		float materialIndex;    // index into the shader material table
+		float textureReference; // texture array layer, or -1 for none
+		POSITION_DECODE positionDecode; // decode of the level drawn
+	};
+
+	// one draw command in the indirect draw buffer, laid out
+	// as the DrawElementsIndirectCommand read by the GPU
+	struct DRAW_INDIRECT_COMMAND
+	{
+		GLuint count;           // number of indices to draw
+		GLuint instanceCount;   // number of instances to draw
+		GLuint firstIndex;      // first index in the shared index buffer
+		GLint baseVertex;       // first vertex in the shared vertex buffer
+		GLuint baseInstance;    // first record in the instance buffer
+	};
+
+	// the most levels of detail a mesh can have - level 0 is
+	// the full mesh, and every level after it has about half
+	// the segments of the level before
+	static const int LOD_COUNT = 4;
+
+	// bounding volumes of a mesh in its own object space
+	struct MESH_BOUNDS
+	{
+		glm::vec3 boxMin;       // smallest corner of the bounding box
+		glm::vec3 boxMax;       // largest corner of the bounding box
+		glm::vec3 sphereCenter; // center of the bounding sphere
+		float sphereRadius;     // radius of the bounding sphere
+	};
+
+	// the ways the vertices can be stored in the shared vertex buffer
+	enum VERTEX_FORMAT
+	{
+		VERTEX_FORMAT_FLOAT,    // 32 bytes - float position, normal and UV
+		VERTEX_FORMAT_PACKED    // 16 bytes - 16-bit position within the mesh
+		                        // bounds, octahedral normal and half float UV
+	};
+
+	// the largest differences between the vertices of a mesh
+	// and the values read back from their packed vertices
+	struct QUANTIZATION_ERROR
+	{
+		float position;         // distance in object space
+		float normalDegrees;    // angle between the normals
+		float uv;               // texture coordinate difference
+	};
+
 private:
 
-	// stores the GL data relative to a given mesh
+	// the parts of the meshes that can be drawn separately
+	enum MESH_PART
+	{
+		PART_BOTTOM,
+		PART_TOP,
+		PART_SIDES,
+		PART_COUNT
+	};
+
+	// a range of indices in the shared index buffer
+	struct MESH_RANGE
+	{
+		GLuint firstIndex;  // Offset of the first index in the index buffer
+		GLuint nIndices;    // Number of indices in the range
+	};
+
+	// stores the location of a given mesh in the shared buffers
 	struct GLMesh
 	{
-		GLuint vao;         // Handle for the vertex array object
-		GLuint vbos[2];     // Handles for the vertex buffer objects
+		GLint baseVertex;   // Offset of the first vertex in the vertex buffer
 		GLuint nVertices;	// Number of vertices for the mesh
+		GLuint firstIndex;  // Offset of the first index in the index buffer
 		GLuint nIndices;    // Number of indices for the mesh
+		MESH_RANGE parts[PART_COUNT];	// Index ranges of the mesh parts
+		MESH_BOUNDS bounds;	// Bounding volumes of the vertices
+		float error;		// Farthest the triangles are from the true surface
 	};
 
 	// the available 3D shapes
@@ -49,21 +153,64 @@ private:
 	GLMesh m_TaperedCylinderMesh;
 	GLMesh m_TorusMesh;
 
+	// the coarser levels of detail of the meshes, level 1 first
+	GLMesh m_lodMeshes[MESH_COUNT][LOD_COUNT - 1];
+	// number of levels of detail loaded for each mesh
+	int m_lodCounts[MESH_COUNT];
+	// set when the triangles and vertices of the loaded meshes
+	// are reordered for the vertex cache
+	bool m_bOptimizeVertexCache;
+	// where each vertex of the last mesh loaded was moved to by
+	// the reordering, so that indices added later still match
+	std::vector<GLuint> m_vertexRemap;
+
 	bool m_bMemoryLayoutDone;
+	// how the vertices are stored in the shared vertex buffer
+	VERTEX_FORMAT m_vertexFormat;
+
+	// every mesh is stored in one shared vertex buffer and one
+	// shared index buffer, drawn through a single VAO
+	GLuint m_arenaVAO;
+	GLuint m_arenaVBOs[2];
+	// CPU copies of the shared buffers, filled as meshes are loaded
+	std::vector<GLfloat> m_arenaVertices;
+	std::vector<GLuint> m_arenaIndices;
+	// set when loaded meshes have not been sent to the GPU yet
+	bool m_bArenaDirty;
+	// set while the shared VAO is known to be bound
+	bool m_bArenaBound;
+
+	// buffer holding the per-instance values, shared by all meshes
+	GLuint m_instanceVBO;
+	// number of instances the instance buffer can currently hold
+	GLsizei m_instanceCapacity;
+	// set once the instance attributes are added to the shared VAO
+	bool m_bInstanceLayoutDone;
+
+	// buffer holding the commands for the indirect draws
+	GLuint m_indirectBuffer;
+	// number of commands the indirect buffer can currently hold
+	GLsizei m_indirectCapacity;
 
 public:
 	// methods for loading the shape mesh data 
-	// into memory
+	// into memory - the round meshes take the number of
+	// segments of their full level of detail
 	void LoadBoxMesh();
-	void LoadConeMesh();
-	void LoadCylinderMesh();
+	void LoadConeMesh(int slices = 36);
+	void LoadCylinderMesh(int slices = 36);
 	void LoadPlaneMesh();
 	void LoadPrismMesh();
 	void LoadPyramid3Mesh();
 	void LoadPyramid4Mesh();
-	void LoadSphereMesh();
-	void LoadTaperedCylinderMesh();
-	void LoadTorusMesh(float thickness = 0.2);
+	void LoadSphereMesh(
+		int slices = 16,
+		int stacks = 16);
+	void LoadTaperedCylinderMesh(int slices = 36);
+	void LoadTorusMesh(
+		float thickness = 0.2,
+		int mainSegments = 30,
+		int tubeSegments = 30);
 
 	// methods for drawing the shape mesh in the
 	// display window
@@ -87,6 +234,99 @@ public:
 	void DrawTorusMesh();
 	void DrawHalfTorusMesh();
 
+	// draw the full shape mesh of the passed in type
+	void DrawMesh(
+		MESH_TYPE mesh,
+		int lod = 0);
+	// draw the full shape mesh once for each of the passed in
+	// instances, using a single instanced draw command
+	void DrawMeshInstanced(
+		MESH_TYPE mesh,
+		const INSTANCE_DATA* instances,
+		GLsizei instanceCount,
+		int lod = 0);
+
+	// fill the indirect draw command for the full shape mesh
+	// of the passed in type
+	bool GetMeshDrawCommand(
+		MESH_TYPE mesh,
+		GLuint instanceCount,
+		GLuint baseInstance,
+		DRAW_INDIRECT_COMMAND& command,
+		int lod = 0);
+	// get the number of levels of detail loaded for the shape
+	// mesh of the passed in type, 0 when it is not loaded
+	int GetMeshLodCount(MESH_TYPE mesh);
+	// get how far a level of detail of the shape mesh strays
+	// from the true surface, as a share of the radius of the
+	// bounding sphere of the full mesh
+	float GetMeshLodError(
+		MESH_TYPE mesh,
+		int lod);
+	// get the number of triangles of a level of detail of the
+	// shape mesh, 0 when the mesh is not loaded
+	GLuint GetMeshTriangleCount(
+		MESH_TYPE mesh,
+		int lod = 0);
+	// get the number of vertices of a level of detail of the
+	// shape mesh, 0 when the mesh is not loaded
+	GLuint GetMeshVertexCount(
+		MESH_TYPE mesh,
+		int lod = 0);
+	// measure how well a level of detail of the shape mesh reuses
+	// the vertices in a cache of the passed in size, false when
+	// the mesh is not loaded
+	bool GetMeshCacheStats(
+		MESH_TYPE mesh,
+		int lod,
+		int cacheSize,
+		VertexCacheOptimizer::CACHE_STATS& stats);
+	// turn the reordering of the triangles and vertices of the
+	// meshes loaded after for the vertex cache on or off
+	void SetVertexCacheOptimization(bool bOptimize);
+	// choose how the vertices are stored in the shared vertex
+	// buffer - with packed vertices every draw must pass the
+	// shader the decode from GetMeshPositionDecode()
+	void SetVertexFormat(VERTEX_FORMAT format);
+	VERTEX_FORMAT GetVertexFormat() const;
+	// get the number of bytes of one vertex in the shared
+	// vertex buffer
+	GLuint GetVertexSize() const;
+	// get the scale and offset that move the stored positions of
+	// a level of detail of the shape mesh into its object space
+	POSITION_DECODE GetMeshPositionDecode(
+		MESH_TYPE mesh,
+		int lod = 0);
+	// measure how far the packed vertices of a level of detail of
+	// the shape mesh stray from its vertices, false when the mesh
+	// is not loaded
+	bool GetMeshQuantizationError(
+		MESH_TYPE mesh,
+		int lod,
+		QUANTIZATION_ERROR& error);
+	// get the bounding volumes of the shape mesh of the passed
+	// in type, false when the mesh is not loaded
+	bool GetMeshBounds(
+		MESH_TYPE mesh,
+		MESH_BOUNDS& bounds);
+	// copy the instance values for all the draws of a frame
+	// into the instance buffer
+	void UploadInstanceData(
+		const INSTANCE_DATA* instances,
+		GLsizei instanceCount);
+	// copy the draw commands into the indirect draw buffer
+	void UploadDrawCommands(
+		const DRAW_INDIRECT_COMMAND* commands,
+		GLsizei commandCount);
+	// draw a run of the uploaded commands with one
+	// multi-draw indirect command
+	void DrawMeshesIndirect(
+		GLsizei firstCommand,
+		GLsizei commandCount);
+
+	// forget which VAO is bound, so the next draw binds the
+	// shared VAO again - for when other code binds a VAO
+	void ResetBindings();
 
 private:
 
@@ -98,4 +338,78 @@ private:
 	// called to set the memory layout 
 	// template for shader data
 	void SetShaderMemoryLayout();
+
+	// get the loaded mesh data for the passed in type
+	// and level of detail
+	GLMesh* GetMesh(
+		MESH_TYPE mesh,
+		int lod = 0);
+	// called to add the mesh data to the shared buffers
+	void AddMeshVertices(
+		GLMesh& mesh,
+		const GLfloat* verts);
+	void AddMeshIndices(
+		GLMesh& mesh,
+		const GLuint* indices,
+		GLuint nIndices,
+		int part = -1);
+	void AddMeshTriangles(
+		GLMesh& mesh,
+		GLenum mode,
+		GLuint first,
+		GLuint count,
+		int part = -1);
+	// called to reorder the indices added to a mesh from the
+	// passed in index, and the vertices of the mesh, for the
+	// vertex cache
+	void OptimizeMeshIndices(
+		GLMesh& mesh,
+		GLuint firstIndex);
+
+	// called to generate the levels of detail of the
+	// round meshes into the shared buffers
+	void LoadCylinderLevels(
+		MESH_TYPE mesh,
+		int slices,
+		float topRadius);
+	void GenerateCylinderMesh(
+		GLMesh& mesh,
+		int slices,
+		float topRadius);
+	void GenerateSphereMesh(
+		GLMesh& mesh,
+		int slices,
+		int stacks);
+	void GenerateTorusMesh(
+		GLMesh& mesh,
+		int mainSegments,
+		int tubeSegments,
+		float mainRadius,
+		float tubeRadius);
+
+	// called to fill the shared vertex buffer with the
+	// packed vertices of every loaded mesh
+	void UploadPackedVertices();
+	// called to bind the shared VAO, sending any
+	// newly loaded meshes to the GPU first
+	void BindMeshBuffers();
+	// called to draw a range of the shared index buffer
+	void DrawIndexRange(
+		const GLMesh& mesh,
+		GLuint firstIndex,
+		GLuint nIndices,
+		GLsizei instanceCount = 1);
+	// called to draw the selected parts of a mesh
+	void DrawMeshParts(
+		const GLMesh& mesh,
+		bool bDrawBottom,
+		bool bDrawTop,
+		bool bDrawSides);
+
+	// called to add the per-instance attributes
+	// to the shared VAO
+	void SetInstanceMemoryLayout();
+	// called to bind the shared VAO with the
+	// per-instance attributes added
+	void BindInstancedMeshBuffers();
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.cpp
+// ============
+// the helpers shared by all the benchmarks that report their results as JSON
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmark.h"
+
+#include <iostream>
+#include <fstream>
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  CreateBenchmarkContext()
+ *
+ *  Create the headless context and the offscreen
+ *  framebuffer a benchmark draws into.  GLEW reports that
+ *  there is no GLX display under EGL, which is ignored.
+ ***********************************************************/
+bool CreateBenchmarkContext(HeadlessContext& context, int width, int height)
+{
+	if (context.CreateContext() == false)
+	{
+		return(false);
+	}
+
+	glewExperimental = GL_TRUE;
+	GLenum result = glewInit();
+	if ((GLEW_OK != result) && (GLEW_ERROR_NO_GLX_DISPLAY != result))
+	{
+		std::cerr << "Failed to initialize GLEW" << std::endl;
+		return(false);
+	}
+
+	return(context.CreateFramebuffer(width, height));
+}
+
+/***********************************************************
+ *  WriteResults()
+ *
+ *  Write the JSON results of a benchmark to the output
+ *  file, when one was passed in, and to the standard
+ *  output.
+ ***********************************************************/
+bool WriteResults(const std::string& json, const char* outputFile)
+{
+	if (NULL != outputFile)
+	{
+		std::ofstream file(outputFile);
+		if (!file.is_open())
+		{
+			std::cerr << "Could not open " << outputFile << " for writing" << std::endl;
+			return(false);
+		}
+		file << json;
+	}
+	std::cout << json;
+
+	return(true);
+}
@@ -0,0 +1,23 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.h
+// ============
+// the helpers shared by all the benchmarks that report their results as JSON
+//
+// The benchmarks that draw do so into the offscreen framebuffer of a
+// headless context.  The results are always written to the standard output,
+// and also to a file when one is passed in with --output.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+#include "HeadlessContext.h"
+
+// create the headless context, initialize GLEW and draw into an offscreen
+// framebuffer of the passed in size, false when it fails
+bool CreateBenchmarkContext(HeadlessContext& context, int width, int height);
+
+// write the JSON results to the output file, when it is not NULL, and to
+// the standard output, false when the output file cannot be written
+bool WriteResults(const std::string& json, const char* outputFile);
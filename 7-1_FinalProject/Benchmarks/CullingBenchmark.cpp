@@ -0,0 +1,213 @@
+///////////////////////////////////////////////////////////////////////////////
+// cullingbenchmark.cpp
+// ============
+// measure the frustum culling throughput on a stress scene of randomly
+// placed objects, reported as JSON
+//
+// The objects are spread through a cube around a camera that turns a full
+// circle over the culling passes, so a different part of the scene is in
+// view for every pass.  The scene graph pass is what the scene manager
+// runs every frame - the SSE sphere test followed by the box test of the
+// spheres that pass.  The sphere test is also timed on its own, against a
+// loop that tests one sphere at a time.  The objects are placed from a
+// fixed seed, so the numbers from two runs can be compared directly.  No
+// OpenGL context is needed, since only the mesh bounds are used.
+//
+//  usage: CullingBenchmark [--objects N] [--passes N] [--output results.json]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ShapeMeshes.h"
+#include "SceneGraph.h"
+#include "Frustum.h"
+#include "StressSceneBenchmark.h"
+#include "Benchmark.h"
+
+namespace
+{
+	const int DEFAULT_OBJECTS = 100000;
+	const int DEFAULT_PASSES = 100;
+
+	// the times and visible objects of one kind of culling pass
+	struct PASS_RESULTS
+	{
+		double totalTime;
+		double visibleObjects;
+	};
+}
+
+/***********************************************************
+ *  WriteResults()
+ *
+ *  Write the averages of a kind of culling pass as a JSON
+ *  object.
+ ***********************************************************/
+static void WriteResults(std::ostringstream& json, const char* name, const PASS_RESULTS& results,
+	int objects, int passes, bool bLast)
+{
+	double milliseconds = results.totalTime / passes;
+
+	json << "  \"" << name << "\": {\n"
+		<< "    \"milliseconds\": " << milliseconds << ",\n"
+		<< "    \"objectsPerSecond\": " << ((milliseconds > 0.0) ? (objects / milliseconds * 1000.0) : 0.0) << ",\n"
+		<< "    \"visibleObjects\": " << (results.visibleObjects / passes) << "\n"
+		<< "  }" << (bLast ? "\n" : ",\n");
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int objects = DEFAULT_OBJECTS;
+	int passes = DEFAULT_PASSES;
+	const char* outputFile = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--objects") == 0) && (i + 1 < argc))
+		{
+			objects = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--passes") == 0) && (i + 1 < argc))
+		{
+			passes = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else
+		{
+			objects = 0;
+			break;
+		}
+	}
+
+	if ((objects <= 0) || (passes <= 0))
+	{
+		std::cerr << "usage: CullingBenchmark [--objects N] [--passes N] [--output results.json]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	// the meshes are only loaded for their bounds, and are
+	// never sent to the GPU
+	ShapeMeshes meshes;
+	meshes.LoadBoxMesh();
+	meshes.LoadConeMesh();
+	meshes.LoadCylinderMesh();
+	meshes.LoadPlaneMesh();
+	meshes.LoadPrismMesh();
+	meshes.LoadPyramid3Mesh();
+	meshes.LoadPyramid4Mesh();
+	meshes.LoadSphereMesh();
+	meshes.LoadTaperedCylinderMesh();
+	meshes.LoadTorusMesh();
+
+	SceneGraph sceneGraph;
+	for (int i = 0; i < ShapeMeshes::MESH_COUNT; i++)
+	{
+		ShapeMeshes::MESH_BOUNDS bounds;
+		if (meshes.GetMeshBounds((ShapeMeshes::MESH_TYPE)i, bounds) == true)
+		{
+			sceneGraph.SetMeshBounds((ShapeMeshes::MESH_TYPE)i, bounds);
+		}
+	}
+
+	std::mt19937 random(g_Seed);
+	std::uniform_real_distribution<float> position(-g_SceneExtent, g_SceneExtent);
+	std::uniform_real_distribution<float> scale(0.5f, 3.0f);
+	std::uniform_real_distribution<float> rotation(0.0f, 360.0f);
+	std::uniform_int_distribution<int> mesh(0, ShapeMeshes::MESH_COUNT - 1);
+
+	for (int i = 0; i < objects; i++)
+	{
+		sceneGraph.AddMeshNode(-1, (ShapeMeshes::MESH_TYPE)mesh(random),
+			Transform::FromEulerDegrees(
+				glm::vec3(scale(random), scale(random), scale(random)),
+				glm::vec3(rotation(random), rotation(random), rotation(random)),
+				glm::vec3(position(random), position(random), position(random))),
+			glm::vec4(1.0f), "");
+	}
+
+	// the first update computes every world matrix and bound
+	auto updateStart = std::chrono::steady_clock::now();
+	sceneGraph.UpdateWorldTransforms();
+	double updateTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - updateStart).count();
+
+	// the world spheres are copied out for timing the sphere
+	// test on its own
+	std::vector<float> centerX(objects);
+	std::vector<float> centerY(objects);
+	std::vector<float> centerZ(objects);
+	std::vector<float> radius(objects);
+	for (int i = 0; i < objects; i++)
+	{
+		const SceneGraph::SCENE_NODE& node = sceneGraph.GetNode(i);
+		ShapeMeshes::MESH_BOUNDS bounds;
+		glm::vec3 center;
+
+		meshes.GetMeshBounds(node.mesh, bounds);
+		Frustum::TransformSphere(node.worldMatrix, bounds.sphereCenter, bounds.sphereRadius, center, radius[i]);
+		centerX[i] = center.x;
+		centerY[i] = center.y;
+		centerZ[i] = center.z;
+	}
+
+	PASS_RESULTS sceneGraphResults = { 0.0, 0.0 };
+	PASS_RESULTS sphereResults = { 0.0, 0.0 };
+	PASS_RESULTS scalarSphereResults = { 0.0, 0.0 };
+	std::vector<unsigned char> visible(objects);
+
+	for (int pass = 0; pass < passes; pass++)
+	{
+		Frustum frustum;
+		frustum.SetViewProjection(GetStressSceneViewProjection(pass, passes));
+
+		auto start = std::chrono::steady_clock::now();
+		int visibleCount = sceneGraph.CullNodes(frustum, visible);
+		sceneGraphResults.totalTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		sceneGraphResults.visibleObjects += visibleCount;
+
+		start = std::chrono::steady_clock::now();
+		visibleCount = frustum.CullSpheres(centerX.data(), centerY.data(), centerZ.data(), radius.data(), objects, visible.data());
+		sphereResults.totalTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		sphereResults.visibleObjects += visibleCount;
+
+		start = std::chrono::steady_clock::now();
+		visibleCount = 0;
+		for (int i = 0; i < objects; i++)
+		{
+			visible[i] = frustum.IsSphereVisible(glm::vec3(centerX[i], centerY[i], centerZ[i]), radius[i]) ? 1 : 0;
+			visibleCount += visible[i];
+		}
+		scalarSphereResults.totalTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		scalarSphereResults.visibleObjects += visibleCount;
+	}
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"objects\": " << objects << ",\n"
+		<< "  \"passes\": " << passes << ",\n"
+		<< "  \"updateMilliseconds\": " << updateTime << ",\n";
+	WriteResults(json, "sceneGraph", sceneGraphResults, objects, passes, false);
+	WriteResults(json, "spheres", sphereResults, objects, passes, false);
+	WriteResults(json, "scalarSpheres", scalarSphereResults, objects, passes, true);
+	json << "}\n";
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
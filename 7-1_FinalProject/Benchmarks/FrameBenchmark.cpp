@@ -0,0 +1,363 @@
+///////////////////////////////////////////////////////////////////////////////
+// framebenchmark.cpp
+// ============
+// render the 3D scene offscreen along a scripted camera path, and report
+// the CPU frame time percentiles and the GL calls made per frame as JSON
+//
+// Every frame advances by a fixed timestep and the camera is moved by the
+// same script on every run, so the numbers from two runs, or from two
+// builds, can be compared directly.  Must be run from the project
+// directory, since the scene loads its shaders and textures from
+// "../../Utilities/".
+//
+//  usage: FrameBenchmark [--frames N] [--warmup N]
+//                        [--path immediate|instanced|indirect]
+//                        [--uncompressed] [--float-vertices]
+//                        [--lod-error PIXELS]
+//                        [--output results.json]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShaderManager.h"
+#include "HeadlessContext.h"
+#include "RenderStats.h"
+#include "Benchmark.h"
+
+namespace
+{
+	const int DEFAULT_FRAMES = 600;
+	const int DEFAULT_WARMUP_FRAMES = 30;
+
+	// seconds advanced by every frame
+	const float g_Timestep = 1.0f / 60.0f;
+
+	// one step of the camera path - the camera is moved in one
+	// direction and turned by the mouse offsets for every frame
+	struct CAMERA_STEP
+	{
+		int frames;
+		Camera_Movement movement;
+		float mouseX;
+		float mouseY;
+	};
+
+	// a loop around the scene that ends where it started, so
+	// that longer runs simply repeat it
+	const CAMERA_STEP g_CameraPath[] = {
+		{ 120, FORWARD,  0.0f,    0.0f },
+		{  90, LEFT,     40.0f,   0.0f },
+		{  60, UP,       0.0f,   -20.0f },
+		{  90, RIGHT,   -80.0f,   0.0f },
+		{  60, DOWN,     0.0f,    20.0f },
+		{  90, LEFT,     40.0f,   0.0f },
+		{ 120, BACKWARD, 0.0f,    0.0f },
+	};
+	const int g_CameraPathSteps = sizeof(g_CameraPath) / sizeof(g_CameraPath[0]);
+
+	// pitch of the default camera view direction, so that the
+	// first turn of the path does not snap the view level
+	const float g_StartPitch = -14.0f;
+}
+
+/***********************************************************
+ *  MoveCamera()
+ *
+ *  Move the camera for the passed in frame of the path.
+ ***********************************************************/
+static void MoveCamera(Camera* pCamera, int frame, float deltaTime)
+{
+	int pathFrames = 0;
+	for (int i = 0; i < g_CameraPathSteps; i++)
+	{
+		pathFrames += g_CameraPath[i].frames;
+	}
+
+	frame = frame % pathFrames;
+	for (int i = 0; i < g_CameraPathSteps; i++)
+	{
+		if (frame < g_CameraPath[i].frames)
+		{
+			pCamera->ProcessKeyboard(g_CameraPath[i].movement, deltaTime);
+			pCamera->ProcessMouseMovement(g_CameraPath[i].mouseX, g_CameraPath[i].mouseY);
+			return;
+		}
+		frame -= g_CameraPath[i].frames;
+	}
+}
+
+/***********************************************************
+ *  Percentile()
+ *
+ *  Get the nearest rank percentile of the sorted values.
+ ***********************************************************/
+static double Percentile(const std::vector<double>& sorted, double percent)
+{
+	if (sorted.empty())
+	{
+		return(0.0);
+	}
+
+	size_t rank = (size_t)((percent / 100.0) * sorted.size() + 0.5);
+	if (rank < 1)
+	{
+		rank = 1;
+	}
+	if (rank > sorted.size())
+	{
+		rank = sorted.size();
+	}
+	return(sorted[rank - 1]);
+}
+
+/***********************************************************
+ *  ParseRenderPath()
+ *
+ *  Get the render path for its command line name.
+ ***********************************************************/
+static bool ParseRenderPath(const char* name, SceneManager::RENDER_PATH& renderPath)
+{
+	if (strcmp(name, "immediate") == 0)
+	{
+		renderPath = SceneManager::RENDER_PATH_IMMEDIATE;
+	}
+	else if (strcmp(name, "instanced") == 0)
+	{
+		renderPath = SceneManager::RENDER_PATH_INSTANCED;
+	}
+	else if (strcmp(name, "indirect") == 0)
+	{
+		renderPath = SceneManager::RENDER_PATH_INDIRECT;
+	}
+	else
+	{
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  RenderPathName()
+ *
+ *  Get the command line name of a render path.
+ ***********************************************************/
+static const char* RenderPathName(SceneManager::RENDER_PATH renderPath)
+{
+	switch (renderPath)
+	{
+	case SceneManager::RENDER_PATH_IMMEDIATE:
+		return("immediate");
+	case SceneManager::RENDER_PATH_INSTANCED:
+		return("instanced");
+	default:
+		break;
+	}
+	return("indirect");
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int frames = DEFAULT_FRAMES;
+	int warmupFrames = DEFAULT_WARMUP_FRAMES;
+	SceneManager::RENDER_PATH renderPath = SceneManager::RENDER_PATH_INDIRECT;
+	const char* outputFile = NULL;
+	bool bCompressTextures = true;
+	bool bPackVertices = true;
+	float lodPixelError = -1.0f;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--frames") == 0) && (i + 1 < argc))
+		{
+			frames = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--warmup") == 0) && (i + 1 < argc))
+		{
+			warmupFrames = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--path") == 0) && (i + 1 < argc) && ParseRenderPath(argv[i + 1], renderPath))
+		{
+			i++;
+		}
+		else if (strcmp(argv[i], "--uncompressed") == 0)
+		{
+			bCompressTextures = false;
+		}
+		else if (strcmp(argv[i], "--float-vertices") == 0)
+		{
+			bPackVertices = false;
+		}
+		else if ((strcmp(argv[i], "--lod-error") == 0) && (i + 1 < argc))
+		{
+			lodPixelError = (float)atof(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else
+		{
+			frames = 0;
+			break;
+		}
+	}
+
+	if ((frames <= 0) || (warmupFrames < 0))
+	{
+		std::cerr << "usage: FrameBenchmark [--frames N] [--warmup N] [--path immediate|instanced|indirect] [--uncompressed] [--float-vertices] [--lod-error PIXELS] [--output results.json]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	// the scene reports its loading on the standard output, which
+	// is moved to the error output to keep the results clean
+	fflush(stdout);
+	int outputHandle = dup(STDOUT_FILENO);
+	dup2(STDERR_FILENO, STDOUT_FILENO);
+
+	HeadlessContext context;
+	if (CreateBenchmarkContext(context, ViewManager::WINDOW_WIDTH, ViewManager::WINDOW_HEIGHT) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	ShaderManager shaderManager;
+	if (shaderManager.LoadShaders(
+		"../../Utilities/shaders/vertexShader.glsl",
+		"../../Utilities/shaders/fragmentShader.glsl") == 0)
+	{
+		return(EXIT_FAILURE);
+	}
+	shaderManager.use();
+
+	ViewManager viewManager(&shaderManager);
+	viewManager.CreateOffscreenView();
+	viewManager.SetFixedTimestep(g_Timestep);
+
+	Camera* pCamera = viewManager.GetCamera();
+	pCamera->Pitch = g_StartPitch;
+	pCamera->ProcessMouseMovement(0.0f, 0.0f);
+
+	SceneManager sceneManager(&shaderManager);
+	sceneManager.SetTextureCompression(bCompressTextures);
+	sceneManager.SetVertexPacking(bPackVertices);
+	sceneManager.PrepareScene();
+	sceneManager.SetRenderPath(renderPath);
+	// without the option the scene keeps its own limit
+	if (lodPixelError >= 0.0f)
+	{
+		sceneManager.SetLodPixelError(lodPixelError);
+	}
+	// every timed frame draws the real textures
+	sceneManager.WaitForTextures();
+
+	std::cout.flush();
+	fflush(stdout);
+	dup2(outputHandle, STDOUT_FILENO);
+	close(outputHandle);
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(frames);
+	double drawCalls = 0.0;
+	double stateChanges = 0.0;
+	double uniformUploads = 0.0;
+	double eliminatedStateChanges = 0.0;
+	double culledObjects = 0.0;
+	double triangles = 0.0;
+
+	for (int frame = 0; frame < warmupFrames + frames; frame++)
+	{
+		RenderStats::Reset();
+		auto frameStart = std::chrono::steady_clock::now();
+
+		MoveCamera(pCamera, frame, viewManager.GetDeltaTime());
+
+		glEnable(GL_DEPTH_TEST);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		viewManager.PrepareSceneView();
+		sceneManager.SetViewFrustum(viewManager.GetViewProjection(), ViewManager::WINDOW_HEIGHT);
+		sceneManager.RenderScene();
+		glFlush();
+
+		auto frameEnd = std::chrono::steady_clock::now();
+
+		// the warm up frames load the buffers and shaders into
+		// the driver, and are not included in the results
+		if (frame < warmupFrames)
+		{
+			continue;
+		}
+
+		frameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+		const RENDER_STATS& stats = RenderStats::Get();
+		drawCalls += stats.drawCalls;
+		stateChanges += stats.stateChanges;
+		uniformUploads += stats.uniformUploads;
+		eliminatedStateChanges += stats.eliminatedStateChanges;
+		culledObjects += stats.culledObjects;
+		triangles += stats.triangles;
+	}
+	glFinish();
+
+	double totalTime = 0.0;
+	for (size_t i = 0; i < frameTimes.size(); i++)
+	{
+		totalTime += frameTimes[i];
+	}
+	std::vector<double> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"benchmark\": \"FrameBenchmark\",\n"
+		<< "  \"glVersion\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+		<< "  \"renderPath\": \"" << RenderPathName(sceneManager.GetRenderPath()) << "\",\n"
+		<< "  \"compressedTextures\": " << (bCompressTextures ? "true" : "false") << ",\n"
+		<< "  \"packedVertices\": " << (bPackVertices ? "true" : "false") << ",\n"
+		<< "  \"frames\": " << frames << ",\n"
+		<< "  \"warmupFrames\": " << warmupFrames << ",\n"
+		<< "  \"timestep\": " << g_Timestep << ",\n"
+		<< "  \"cpuFrameTimeMs\": {\n"
+		<< "    \"mean\": " << (totalTime / frames) << ",\n"
+		<< "    \"p50\": " << Percentile(sorted, 50.0) << ",\n"
+		<< "    \"p95\": " << Percentile(sorted, 95.0) << ",\n"
+		<< "    \"p99\": " << Percentile(sorted, 99.0) << ",\n"
+		<< "    \"max\": " << sorted.back() << "\n"
+		<< "  },\n"
+		<< "  \"perFrame\": {\n"
+		<< "    \"drawCalls\": " << (drawCalls / frames) << ",\n"
+		<< "    \"stateChanges\": " << (stateChanges / frames) << ",\n"
+		<< "    \"uniformUploads\": " << (uniformUploads / frames) << ",\n"
+		<< "    \"eliminatedStateChanges\": " << (eliminatedStateChanges / frames) << ",\n"
+		<< "    \"culledObjects\": " << (culledObjects / frames) << ",\n"
+		<< "    \"triangles\": " << (triangles / frames) << "\n"
+		<< "  }\n"
+		<< "}\n";
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
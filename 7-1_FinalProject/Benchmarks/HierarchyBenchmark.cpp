@@ -0,0 +1,352 @@
+///////////////////////////////////////////////////////////////////////////////
+// hierarchybenchmark.cpp
+// ============
+// measure the build, refit and query times of the bounding volume
+// hierarchy at several scene sizes, reported as JSON
+//
+// The object boxes are placed from a fixed seed through a cube that grows
+// with the number of objects, so every size has the same density around
+// the camera.  The frustum queries turn the camera a full circle and are
+// compared with testing every box.  A few of the ray and nearest object
+// queries are also answered by testing every box, and any answer that
+// differs from the tree is counted as a mismatch.  No OpenGL context is
+// needed.
+//
+//  usage: HierarchyBenchmark [--objects N] [--passes N] [--queries N]
+//                            [--output results.json]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BoundingVolumeHierarchy.h"
+#include "Frustum.h"
+#include "StressSceneBenchmark.h"
+#include "Benchmark.h"
+
+namespace
+{
+	// the scene sizes measured when no size is passed in
+	const int g_DefaultObjects[] = { 10000, 100000, 1000000 };
+	const int DEFAULT_PASSES = 20;
+	const int DEFAULT_QUERIES = 1000;
+	// queries that are also answered by testing every box
+	const int g_CheckedQueries = 20;
+	// share of the objects moved before each refit
+	const float g_MovedShare = 0.1f;
+
+	// the times of one scene size, in milliseconds
+	struct SIZE_RESULTS
+	{
+		int objects;
+		int nodes;
+		double build;
+		double refitMoved;
+		double refitAll;
+		double frustumQuery;
+		double frustumFlat;
+		double visibleObjects;
+		double rayQuery;
+		double rayFlat;
+		double nearestQuery;
+		double nearestFlat;
+		int mismatches;
+	};
+
+	typedef std::chrono::steady_clock CLOCK;
+}
+
+/***********************************************************
+ *  GetMilliseconds()
+ *
+ *  Get the milliseconds since a start time.
+ ***********************************************************/
+static double GetMilliseconds(CLOCK::time_point start)
+{
+	return(std::chrono::duration<double, std::milli>(CLOCK::now() - start).count());
+}
+
+/***********************************************************
+ *  RaycastFlat()
+ *
+ *  Find the nearest box hit by a ray by testing every box,
+ *  to check and compare with the tree.
+ ***********************************************************/
+static int RaycastFlat(const std::vector<glm::vec3>& boxMins, const std::vector<glm::vec3>& boxMaxs,
+	const glm::vec3& origin, const glm::vec3& direction)
+{
+	// clamped the same way as the tree, so a ray along a slab
+	// plane is never tested with NaN
+	glm::vec3 inverseDirection = glm::clamp(1.0f / (direction + glm::vec3(0.0f)), glm::vec3(-1.0e30f), glm::vec3(1.0e30f));
+	float nearest = FLT_MAX;
+	int item = -1;
+
+	for (size_t i = 0; i < boxMins.size(); i++)
+	{
+		glm::vec3 slab0 = (boxMins[i] - origin) * inverseDirection;
+		glm::vec3 slab1 = (boxMaxs[i] - origin) * inverseDirection;
+		glm::vec3 slabNear = glm::min(slab0, slab1);
+		glm::vec3 slabFar = glm::max(slab0, slab1);
+		float entry = glm::max(glm::max(slabNear.x, slabNear.y), glm::max(slabNear.z, 0.0f));
+		float exit = glm::min(glm::min(slabFar.x, slabFar.y), slabFar.z);
+
+		if ((entry <= exit) && (entry < nearest))
+		{
+			nearest = entry;
+			item = (int)i;
+		}
+	}
+	return(item);
+}
+
+/***********************************************************
+ *  FindNearestFlat()
+ *
+ *  Find the box nearest to a point by testing every box,
+ *  returning its distance.
+ ***********************************************************/
+static float FindNearestFlat(const std::vector<glm::vec3>& boxMins, const std::vector<glm::vec3>& boxMaxs,
+	const glm::vec3& point)
+{
+	float nearest = FLT_MAX;
+
+	for (size_t i = 0; i < boxMins.size(); i++)
+	{
+		glm::vec3 outside = glm::max(glm::max(boxMins[i] - point, point - boxMaxs[i]), glm::vec3(0.0f));
+		nearest = glm::min(nearest, glm::length(outside));
+	}
+	return(nearest);
+}
+
+/***********************************************************
+ *  MeasureSize()
+ *
+ *  Build, refit and query a tree over the passed in number
+ *  of random object boxes.
+ ***********************************************************/
+static SIZE_RESULTS MeasureSize(int objects, int passes, int queries)
+{
+	SIZE_RESULTS results = {};
+	std::mt19937 random(g_Seed);
+	float extent = g_SceneExtent * std::cbrt(objects / 100000.0f);
+	std::uniform_real_distribution<float> position(-extent, extent);
+	std::uniform_real_distribution<float> halfSize(0.25f, 1.5f);
+	std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+	std::uniform_int_distribution<int> object(0, objects - 1);
+
+	std::vector<glm::vec3> boxMins(objects);
+	std::vector<glm::vec3> boxMaxs(objects);
+	for (int i = 0; i < objects; i++)
+	{
+		glm::vec3 center(position(random), position(random), position(random));
+		glm::vec3 size(halfSize(random), halfSize(random), halfSize(random));
+		boxMins[i] = center - size;
+		boxMaxs[i] = center + size;
+	}
+
+	results.objects = objects;
+
+	BoundingVolumeHierarchy hierarchy;
+	CLOCK::time_point start = CLOCK::now();
+	hierarchy.Build(boxMins, boxMaxs);
+	results.build = GetMilliseconds(start);
+	results.nodes = hierarchy.GetNodeCount();
+
+	// a share of the objects move a little, as animated
+	// objects do from frame to frame
+	int moved = (int)(objects * g_MovedShare);
+	for (int pass = 0; pass < passes; pass++)
+	{
+		start = CLOCK::now();
+		for (int i = 0; i < moved; i++)
+		{
+			int item = object(random);
+			glm::vec3 move(offset(random), offset(random), offset(random));
+			boxMins[item] += move;
+			boxMaxs[item] += move;
+			hierarchy.UpdateItem(item, boxMins[item], boxMaxs[item]);
+		}
+		hierarchy.Refit();
+		results.refitMoved += GetMilliseconds(start) / passes;
+	}
+
+	start = CLOCK::now();
+	for (int i = 0; i < objects; i++)
+	{
+		hierarchy.UpdateItem(i, boxMins[i], boxMaxs[i]);
+	}
+	hierarchy.Refit();
+	results.refitAll = GetMilliseconds(start);
+
+	std::vector<int> items;
+	for (int pass = 0; pass < passes; pass++)
+	{
+		Frustum frustum;
+		frustum.SetViewProjection(GetStressSceneViewProjection(pass, passes));
+
+		start = CLOCK::now();
+		int visibleCount = hierarchy.QueryFrustum(frustum, items);
+		results.frustumQuery += GetMilliseconds(start) / passes;
+		results.visibleObjects += (double)visibleCount / passes;
+
+		start = CLOCK::now();
+		int flatCount = 0;
+		for (int i = 0; i < objects; i++)
+		{
+			flatCount += frustum.IsBoxVisible(boxMins[i], boxMaxs[i]) ? 1 : 0;
+		}
+		results.frustumFlat += GetMilliseconds(start) / passes;
+
+		if (flatCount != visibleCount)
+		{
+			results.mismatches++;
+		}
+	}
+
+	// rays leave the center of the scene in every direction,
+	// and nearest objects are found from points anywhere in it
+	std::normal_distribution<float> axis(0.0f, 1.0f);
+	std::vector<glm::vec3> directions(queries);
+	std::vector<glm::vec3> points(queries);
+	for (int i = 0; i < queries; i++)
+	{
+		directions[i] = glm::normalize(glm::vec3(axis(random), axis(random), axis(random)));
+		points[i] = glm::vec3(position(random), position(random), position(random));
+	}
+
+	std::vector<int> hits(queries);
+	std::vector<float> nearestDistances(queries);
+	float distance = 0.0f;
+
+	start = CLOCK::now();
+	for (int i = 0; i < queries; i++)
+	{
+		hierarchy.Raycast(glm::vec3(0.0f), directions[i], FLT_MAX, hits[i], distance);
+	}
+	results.rayQuery = GetMilliseconds(start) / queries;
+
+	start = CLOCK::now();
+	for (int i = 0; i < queries; i++)
+	{
+		int item = -1;
+		hierarchy.FindNearest(points[i], FLT_MAX, item, nearestDistances[i]);
+	}
+	results.nearestQuery = GetMilliseconds(start) / queries;
+
+	int checkedQueries = (queries < g_CheckedQueries) ? queries : g_CheckedQueries;
+	for (int i = 0; i < checkedQueries; i++)
+	{
+		start = CLOCK::now();
+		int flatHit = RaycastFlat(boxMins, boxMaxs, glm::vec3(0.0f), directions[i]);
+		results.rayFlat += GetMilliseconds(start) / checkedQueries;
+
+		start = CLOCK::now();
+		float flatDistance = FindNearestFlat(boxMins, boxMaxs, points[i]);
+		results.nearestFlat += GetMilliseconds(start) / checkedQueries;
+
+		// boxes hit at the same distance may be found in either
+		// order, so only the distances of the nearest are compared
+		if ((flatHit != hits[i]) && ((flatHit < 0) || (hits[i] < 0)))
+		{
+			results.mismatches++;
+		}
+		if (std::fabs(flatDistance - nearestDistances[i]) > 0.0001f)
+		{
+			results.mismatches++;
+		}
+	}
+
+	return(results);
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	std::vector<int> sizes;
+	int passes = DEFAULT_PASSES;
+	int queries = DEFAULT_QUERIES;
+	const char* outputFile = NULL;
+	bool bValid = true;
+
+	for (int i = 1; (i < argc) && bValid; i++)
+	{
+		if ((strcmp(argv[i], "--objects") == 0) && (i + 1 < argc))
+		{
+			sizes.push_back(atoi(argv[++i]));
+			bValid = (sizes.back() > 0);
+		}
+		else if ((strcmp(argv[i], "--passes") == 0) && (i + 1 < argc))
+		{
+			passes = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--queries") == 0) && (i + 1 < argc))
+		{
+			queries = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else
+		{
+			bValid = false;
+		}
+	}
+
+	if ((bValid == false) || (passes <= 0) || (queries <= 0))
+	{
+		std::cerr << "usage: HierarchyBenchmark [--objects N] [--passes N] [--queries N] [--output results.json]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+	if (sizes.empty() == true)
+	{
+		sizes.assign(g_DefaultObjects, g_DefaultObjects + sizeof(g_DefaultObjects) / sizeof(g_DefaultObjects[0]));
+	}
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"passes\": " << passes << ",\n"
+		<< "  \"queries\": " << queries << ",\n"
+		<< "  \"sizes\": [\n";
+
+	for (size_t i = 0; i < sizes.size(); i++)
+	{
+		SIZE_RESULTS results = MeasureSize(sizes[i], passes, queries);
+
+		json << "    {\n"
+			<< "      \"objects\": " << results.objects << ",\n"
+			<< "      \"nodes\": " << results.nodes << ",\n"
+			<< "      \"buildMilliseconds\": " << results.build << ",\n"
+			<< "      \"refitMovedMilliseconds\": " << results.refitMoved << ",\n"
+			<< "      \"refitAllMilliseconds\": " << results.refitAll << ",\n"
+			<< "      \"frustumQueryMilliseconds\": " << results.frustumQuery << ",\n"
+			<< "      \"frustumFlatMilliseconds\": " << results.frustumFlat << ",\n"
+			<< "      \"visibleObjects\": " << results.visibleObjects << ",\n"
+			<< "      \"rayQueryMilliseconds\": " << results.rayQuery << ",\n"
+			<< "      \"rayFlatMilliseconds\": " << results.rayFlat << ",\n"
+			<< "      \"nearestQueryMilliseconds\": " << results.nearestQuery << ",\n"
+			<< "      \"nearestFlatMilliseconds\": " << results.nearestFlat << ",\n"
+			<< "      \"mismatches\": " << results.mismatches << "\n"
+			<< "    }" << ((i + 1 < sizes.size()) ? ",\n" : "\n");
+	}
+	json << "  ]\n"
+		<< "}\n";
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
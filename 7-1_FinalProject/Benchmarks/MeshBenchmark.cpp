@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshbenchmark.cpp
+// ============
+// the setup shared by the benchmarks that draw every level of detail of
+// every shape mesh as a grid of small instances
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshBenchmark.h"
+#include "Benchmark.h"
+
+#include <iostream>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+	const char* g_MeshNames[ShapeMeshes::MESH_COUNT] =
+	{
+		"box", "cone", "cylinder", "plane", "prism", "pyramid3",
+		"pyramid4", "sphere", "taperedCylinder", "torus"
+	};
+}
+
+/***********************************************************
+ *  CreateMeshBenchmarkContext()
+ *
+ *  Create the headless context and the offscreen
+ *  framebuffer the meshes are drawn into, with no depth
+ *  test since the instances do not overlap.
+ ***********************************************************/
+bool CreateMeshBenchmarkContext(HeadlessContext& context, int framebufferSize)
+{
+	if (CreateBenchmarkContext(context, framebufferSize, framebufferSize) == false)
+	{
+		return(false);
+	}
+
+	glViewport(0, 0, framebufferSize, framebufferSize);
+	glDisable(GL_DEPTH_TEST);
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileMeshBenchmarkProgram()
+ *
+ *  Compile and link the shader program of a benchmark,
+ *  returning 0 when it fails.
+ ***********************************************************/
+GLuint CompileMeshBenchmarkProgram(const char* vertexShader, const char* fragmentShader)
+{
+	const char* sources[2] = { vertexShader, fragmentShader };
+	const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	GLuint programID = glCreateProgram();
+	GLint success = 0;
+	char infoLog[512];
+
+	for (int i = 0; i < 2; i++)
+	{
+		GLuint shaderID = glCreateShader(types[i]);
+		glShaderSource(shaderID, 1, &sources[i], NULL);
+		glCompileShader(shaderID);
+		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+			std::cerr << "Shader compilation failed: " << infoLog << std::endl;
+			return(0);
+		}
+		glAttachShader(programID, shaderID);
+		glDeleteShader(shaderID);
+	}
+
+	glLinkProgram(programID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		std::cerr << "Shader linking failed: " << infoLog << std::endl;
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  LoadMeshBenchmarkMeshes()
+ *
+ *  Load every shape mesh - the vertex order and format
+ *  are set on the meshes object before it is called.
+ ***********************************************************/
+void LoadMeshBenchmarkMeshes(ShapeMeshes& meshes)
+{
+	meshes.LoadBoxMesh();
+	meshes.LoadConeMesh();
+	meshes.LoadCylinderMesh();
+	meshes.LoadPlaneMesh();
+	meshes.LoadPrismMesh();
+	meshes.LoadPyramid3Mesh();
+	meshes.LoadPyramid4Mesh();
+	meshes.LoadSphereMesh();
+	meshes.LoadTaperedCylinderMesh();
+	meshes.LoadTorusMesh();
+}
+
+/***********************************************************
+ *  BuildMeshBenchmarkInstances()
+ *
+ *  Spread the instances over the view in a square grid,
+ *  untextured and with the first material.
+ ***********************************************************/
+std::vector<ShapeMeshes::INSTANCE_DATA> BuildMeshBenchmarkInstances(int instanceCount, float instanceScale)
+{
+	std::vector<ShapeMeshes::INSTANCE_DATA> instances(instanceCount);
+	int columns = 1;
+	while (columns * columns < instanceCount)
+	{
+		columns++;
+	}
+	for (int i = 0; i < instanceCount; i++)
+	{
+		glm::vec3 position(
+			-0.9f + 1.8f * (i % columns) / columns,
+			-0.9f + 1.8f * (i / columns) / columns,
+			0.0f);
+
+		instances[i].model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(instanceScale));
+		instances[i].color = glm::vec4(1.0f);
+		instances[i].uvScale = glm::vec2(1.0f);
+		instances[i].materialIndex = 0.0f;
+		instances[i].textureReference = -1.0f;
+		instances[i].positionDecode.scale = glm::vec3(1.0f);
+		instances[i].positionDecode.offset = glm::vec3(0.0f);
+	}
+
+	return(instances);
+}
+
+/***********************************************************
+ *  GetMeshBenchmarkName()
+ *
+ *  Get the name a mesh is reported with.
+ ***********************************************************/
+const char* GetMeshBenchmarkName(ShapeMeshes::MESH_TYPE mesh)
+{
+	if ((mesh < 0) || (mesh >= ShapeMeshes::MESH_COUNT))
+	{
+		return("unknown");
+	}
+
+	return(g_MeshNames[mesh]);
+}
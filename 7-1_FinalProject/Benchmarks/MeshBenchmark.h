@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshbenchmark.h
+// ============
+// the setup shared by the benchmarks that draw every level of detail of
+// every shape mesh as a grid of small instances
+//
+// The benchmarks draw into the offscreen framebuffer of a headless context
+// with a shader program of their own, and compare two sets of the meshes
+// that are loaded with different settings.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "ShapeMeshes.h"
+#include "HeadlessContext.h"
+
+// create the headless context, initialize GLEW and draw into a square
+// offscreen framebuffer of the passed in size, false when it fails
+bool CreateMeshBenchmarkContext(HeadlessContext& context, int framebufferSize);
+
+// compile and link a shader program, 0 when it fails
+GLuint CompileMeshBenchmarkProgram(const char* vertexShader, const char* fragmentShader);
+
+// load every shape mesh, with the settings of the meshes object
+void LoadMeshBenchmarkMeshes(ShapeMeshes& meshes);
+
+// spread the passed in number of instances over the view in a grid,
+// each scaled small enough that the pixels cost little
+std::vector<ShapeMeshes::INSTANCE_DATA> BuildMeshBenchmarkInstances(int instanceCount, float instanceScale);
+
+// the name of a mesh in the JSON results
+const char* GetMeshBenchmarkName(ShapeMeshes::MESH_TYPE mesh);
@@ -0,0 +1,241 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefilebenchmark.cpp
+// ============
+// measure the loading of scene files for growing numbers of nodes, reported
+// as JSON - compiled once from a text description, then mapped and added
+// to a scene graph the way the scene manager loads the scene
+//
+// The nodes are placed in groups of 16, a parent followed by its 15 mesh
+// children, from a fixed sequence so every run loads the same scene.  The
+// map time is the mapping of the file with the check of every record, the
+// add time adds the nodes to a scene graph, and the update time composes
+// their world matrices and bounds and builds the bounding volume hierarchy.
+// The time per node of the map and add should stay the same as the scene
+// grows.  The files are read back right after they are written,
+// so they are measured from the file cache.  No OpenGL context is needed,
+// since only the mesh bounds are used.
+//
+//  usage: SceneFileBenchmark [--passes N] [--directory DIR] [--output results.json]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+
+#include "ShapeMeshes.h"
+#include "SceneGraph.h"
+#include "SceneFile.h"
+#include "Benchmark.h"
+
+namespace
+{
+	const int DEFAULT_PASSES = 5;
+	const char* DEFAULT_DIRECTORY = "../../Utilities/scenes/cache/";
+
+	// the numbers of nodes that are measured
+	const int g_NodeCounts[] = { 1000, 10000, 100000, 1000000 };
+	const int g_NodeCountCount = sizeof(g_NodeCounts) / sizeof(g_NodeCounts[0]);
+
+	// nodes in each group of a parent and its children
+	const int g_GroupSize = 16;
+
+	// the meshes the children draw, in turn
+	const char* g_MeshNames[] = { "box", "cone", "cylinder", "sphere", "torus" };
+	const int g_MeshNameCount = sizeof(g_MeshNames) / sizeof(g_MeshNames[0]);
+}
+
+/***********************************************************
+ *  WriteDescription()
+ *
+ *  Write the text description of a scene with the passed
+ *  in number of nodes.
+ ***********************************************************/
+static bool WriteDescription(const std::string& filename, int nodeCount)
+{
+	std::ofstream file(filename.c_str());
+	if (!file.is_open())
+	{
+		return(false);
+	}
+
+	unsigned int seed = 12345u;
+
+	file << "texture stone ../../Utilities/textures/rubiks.jpg\n"
+		<< "material stone_material ambient 0.5 0.5 0.5 strength 1 diffuse 0.9 0.5 0.5 specular 0.1 0.1 0.9 shininess 1\n"
+		<< "light position 5 4 -4 ambient 0.7 0.7 0.5 diffuse 0.5 0.5 0.5 specular 0.5 0.5 0.7 intensity 30\n";
+
+	for (int i = 0; i < nodeCount; i++)
+	{
+		float values[9];
+		for (int v = 0; v < 9; v++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			values[v] = (float)(seed >> 8) / (float)(1 << 24);
+		}
+
+		if ((i % g_GroupSize) == 0)
+		{
+			file << "node g" << i / g_GroupSize
+				<< " rotation 0 " << values[0] * 360.0f << " 0"
+				<< " position " << values[1] * 1000.0f - 500.0f << " 0 " << values[2] * 1000.0f - 500.0f << "\n";
+			continue;
+		}
+
+		file << "node - parent g" << i / g_GroupSize
+			<< " mesh " << g_MeshNames[i % g_MeshNameCount]
+			<< " scale " << 0.5f + values[0] << " " << 0.5f + values[1] << " " << 0.5f + values[2]
+			<< " rotation " << values[3] * 360.0f - 180.0f << " " << values[4] * 360.0f - 180.0f << " " << values[5] * 360.0f - 180.0f
+			<< " position " << values[6] * 20.0f - 10.0f << " " << values[7] * 20.0f - 10.0f << " " << values[8] * 20.0f - 10.0f
+			<< " material stone_material";
+		if ((i % 4) == 0)
+		{
+			file << " texture stone";
+		}
+		file << "\n";
+	}
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int passes = DEFAULT_PASSES;
+	std::string directory = DEFAULT_DIRECTORY;
+	const char* outputFile = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--passes") == 0) && (i + 1 < argc))
+		{
+			passes = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--directory") == 0) && (i + 1 < argc))
+		{
+			directory = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else
+		{
+			passes = 0;
+			break;
+		}
+	}
+
+	if (passes <= 0)
+	{
+		std::cerr << "usage: SceneFileBenchmark [--passes N] [--directory DIR] [--output results.json]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	// the meshes are only loaded for their bounds, and are
+	// never sent to the GPU
+	ShapeMeshes meshes;
+	meshes.LoadBoxMesh();
+	meshes.LoadConeMesh();
+	meshes.LoadCylinderMesh();
+	meshes.LoadSphereMesh();
+	meshes.LoadTorusMesh();
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"benchmark\": \"SceneFileBenchmark\",\n"
+		<< "  \"passes\": " << passes << ",\n"
+		<< "  \"groupSize\": " << g_GroupSize << ",\n"
+		<< "  \"nodeBytes\": " << sizeof(SceneFile::NODE) << ",\n"
+		<< "  \"results\": [\n";
+
+	for (int c = 0; c < g_NodeCountCount; c++)
+	{
+		int count = g_NodeCounts[c];
+		std::ostringstream name;
+		name << "SceneFileBenchmark-" << count;
+		// the description is written next to its scene file
+		std::string compiledPath = SceneFile::GetCompiledPath(name.str(), directory);
+		std::string descriptionPath = compiledPath + ".txt";
+
+		if (WriteDescription(descriptionPath, count) == false)
+		{
+			std::cerr << "Could not write " << descriptionPath << std::endl;
+			return(EXIT_FAILURE);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		bool bCompiled = SceneFile::Compile(descriptionPath, compiledPath);
+		double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		remove(descriptionPath.c_str());
+		if (bCompiled == false)
+		{
+			std::cerr << "Could not compile " << descriptionPath << std::endl;
+			return(EXIT_FAILURE);
+		}
+
+		double mapMs = 0.0;
+		double addMs = 0.0;
+		double updateMs = 0.0;
+		int nodeCount = 0;
+		for (int p = 0; p < passes; p++)
+		{
+			SceneFile sceneFile;
+			SceneGraph sceneGraph;
+			for (int i = 0; i < ShapeMeshes::MESH_COUNT; i++)
+			{
+				ShapeMeshes::MESH_BOUNDS bounds;
+				if (meshes.GetMeshBounds((ShapeMeshes::MESH_TYPE)i, bounds) == true)
+				{
+					sceneGraph.SetMeshBounds((ShapeMeshes::MESH_TYPE)i, bounds);
+				}
+			}
+
+			start = std::chrono::steady_clock::now();
+			if (sceneFile.Map(compiledPath) == false)
+			{
+				std::cerr << "Could not map " << compiledPath << std::endl;
+				return(EXIT_FAILURE);
+			}
+			auto mapped = std::chrono::steady_clock::now();
+			sceneGraph.AddFileNodes(sceneFile);
+			auto added = std::chrono::steady_clock::now();
+			sceneGraph.UpdateWorldTransforms();
+			auto updated = std::chrono::steady_clock::now();
+
+			mapMs += std::chrono::duration<double, std::milli>(mapped - start).count();
+			addMs += std::chrono::duration<double, std::milli>(added - mapped).count();
+			updateMs += std::chrono::duration<double, std::milli>(updated - added).count();
+			nodeCount = sceneGraph.GetNodeCount();
+		}
+		mapMs /= passes;
+		addMs /= passes;
+		updateMs /= passes;
+		remove(compiledPath.c_str());
+
+		json << "    { \"nodes\": " << nodeCount
+			<< ", \"compileMs\": " << compileMs
+			<< ", \"mapMs\": " << mapMs
+			<< ", \"addMs\": " << addMs
+			<< ", \"updateMs\": " << updateMs
+			<< ", \"mapNsPerNode\": " << mapMs * 1.0e6 / count
+			<< ", \"addNsPerNode\": " << addMs * 1.0e6 / count
+			<< ", \"updateNsPerNode\": " << updateMs * 1.0e6 / count
+			<< ", \"compileNsPerNode\": " << compileMs * 1.0e6 / count
+			<< " }" << ((c + 1 < g_NodeCountCount) ? ",\n" : "\n");
+	}
+	json << "  ]\n}\n";
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
@@ -0,0 +1,229 @@
+///////////////////////////////////////////////////////////////////////////////
+// startupbenchmark.cpp
+// ============
+// measure the time from creating the scene to the first frame drawn with
+// all of its textures, with the texture cache turned off, with an empty
+// cache (a cold start) and with a filled cache (a warm start), reported
+// as JSON
+//
+// Every launch prepares a new SceneManager in the same offscreen context,
+// so the OpenGL context creation is not part of the times.  The cache is
+// kept in a temporary directory that is removed at the end.  Must be run
+// from the project directory, since the scene loads its shaders and
+// textures from "../../Utilities/".
+//
+//  usage: StartupBenchmark [--launches N] [--output results.json]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <GL/glew.h>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShaderManager.h"
+#include "HeadlessContext.h"
+#include "Benchmark.h"
+
+namespace
+{
+	const int DEFAULT_LAUNCHES = 5;
+
+	// the ways the texture cache is used by a launch
+	enum CACHE_MODE
+	{
+		CACHE_MODE_OFF,     // every image is decoded, nothing is stored
+		CACHE_MODE_COLD,    // the cache is emptied before the launch
+		CACHE_MODE_WARM     // the cache was filled by an earlier launch
+	};
+}
+
+/***********************************************************
+ *  ClearDirectory()
+ *
+ *  Delete the files in a cache directory.
+ ***********************************************************/
+static void ClearDirectory(const std::string& directory)
+{
+	DIR* pDirectory = opendir(directory.c_str());
+	if (NULL == pDirectory)
+	{
+		return;
+	}
+
+	struct dirent* pEntry = NULL;
+	while ((pEntry = readdir(pDirectory)) != NULL)
+	{
+		if (pEntry->d_name[0] != '.')
+		{
+			unlink((directory + "/" + pEntry->d_name).c_str());
+		}
+	}
+	closedir(pDirectory);
+}
+
+/***********************************************************
+ *  Launch()
+ *
+ *  Prepare the scene and draw its first frame with all of
+ *  the textures, returning the time taken in milliseconds.
+ ***********************************************************/
+static double Launch(ShaderManager& shaderManager, ViewManager& viewManager, const std::string& cacheDirectory)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	SceneManager sceneManager(&shaderManager);
+	sceneManager.SetTextureCacheDirectory(cacheDirectory);
+	sceneManager.PrepareScene();
+	sceneManager.WaitForTextures();
+
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	viewManager.PrepareSceneView();
+	sceneManager.SetViewFrustum(viewManager.GetViewProjection(), ViewManager::WINDOW_HEIGHT);
+	sceneManager.RenderScene();
+	glFinish();
+
+	return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+/***********************************************************
+ *  WriteTimes()
+ *
+ *  Add the summary of the launch times of one cache mode to
+ *  the JSON results.
+ ***********************************************************/
+static void WriteTimes(std::ostringstream& json, const char* name, std::vector<double> times, bool bLast)
+{
+	std::sort(times.begin(), times.end());
+
+	double total = 0.0;
+	for (size_t i = 0; i < times.size(); i++)
+	{
+		total += times[i];
+	}
+
+	json << "    \"" << name << "\": { "
+		<< "\"min\": " << times.front() << ", "
+		<< "\"median\": " << times[times.size() / 2] << ", "
+		<< "\"mean\": " << (total / times.size()) << ", "
+		<< "\"max\": " << times.back() << " }"
+		<< (bLast ? "\n" : ",\n");
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int launches = DEFAULT_LAUNCHES;
+	const char* outputFile = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--launches") == 0) && (i + 1 < argc))
+		{
+			launches = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else
+		{
+			launches = 0;
+			break;
+		}
+	}
+
+	if (launches <= 0)
+	{
+		std::cerr << "usage: StartupBenchmark [--launches N] [--output results.json]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	// the scene reports its loading on the standard output, which
+	// is moved to the error output to keep the results clean
+	fflush(stdout);
+	int outputHandle = dup(STDOUT_FILENO);
+	dup2(STDERR_FILENO, STDOUT_FILENO);
+
+	HeadlessContext context;
+	if (CreateBenchmarkContext(context, ViewManager::WINDOW_WIDTH, ViewManager::WINDOW_HEIGHT) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	ShaderManager shaderManager;
+	if (shaderManager.LoadShaders(
+		"../../Utilities/shaders/vertexShader.glsl",
+		"../../Utilities/shaders/fragmentShader.glsl") == 0)
+	{
+		return(EXIT_FAILURE);
+	}
+	shaderManager.use();
+
+	ViewManager viewManager(&shaderManager);
+	viewManager.CreateOffscreenView();
+	glEnable(GL_DEPTH_TEST);
+
+	char directoryTemplate[] = "/tmp/StartupBenchmarkXXXXXX";
+	if (NULL == mkdtemp(directoryTemplate))
+	{
+		std::cerr << "Could not create a temporary cache directory" << std::endl;
+		return(EXIT_FAILURE);
+	}
+	std::string cacheDirectory = directoryTemplate;
+
+	// one launch of each kind first, so the source files and the
+	// shader compiler are warm for all of the timed launches
+	Launch(shaderManager, viewManager, "");
+
+	std::vector<double> times[3];
+	for (int i = 0; i < launches; i++)
+	{
+		times[CACHE_MODE_OFF].push_back(Launch(shaderManager, viewManager, ""));
+
+		ClearDirectory(cacheDirectory);
+		times[CACHE_MODE_COLD].push_back(Launch(shaderManager, viewManager, cacheDirectory));
+
+		times[CACHE_MODE_WARM].push_back(Launch(shaderManager, viewManager, cacheDirectory));
+	}
+
+	ClearDirectory(cacheDirectory);
+	rmdir(cacheDirectory.c_str());
+
+	std::cout.flush();
+	fflush(stdout);
+	dup2(outputHandle, STDOUT_FILENO);
+	close(outputHandle);
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"benchmark\": \"StartupBenchmark\",\n"
+		<< "  \"glVersion\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+		<< "  \"launches\": " << launches << ",\n"
+		<< "  \"startupMs\": {\n";
+	WriteTimes(json, "cacheOff", times[CACHE_MODE_OFF], false);
+	WriteTimes(json, "cold", times[CACHE_MODE_COLD], false);
+	WriteTimes(json, "warm", times[CACHE_MODE_WARM], true);
+	json << "  }\n"
+		<< "}\n";
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
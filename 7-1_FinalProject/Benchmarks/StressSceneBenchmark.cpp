@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscenebenchmark.cpp
+// ============
+// the scene and camera shared by the benchmarks that query a stress scene
+// of randomly placed objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StressSceneBenchmark.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "ViewManager.h"
+
+namespace
+{
+	// the projection of the scene view
+	const float g_FieldOfView = 80.0f;
+	const float g_NearPlane = 0.1f;
+	const float g_FarPlane = 100.0f;
+}
+
+/***********************************************************
+ *  GetStressSceneViewProjection()
+ *
+ *  Get the view frustum of the camera at the center of the
+ *  scene for a pass, turned a little further for every
+ *  pass.
+ ***********************************************************/
+glm::mat4 GetStressSceneViewProjection(int pass, int passes)
+{
+	float yaw = glm::radians(360.0f * pass / passes);
+	glm::vec3 front(glm::cos(yaw), -0.2f, glm::sin(yaw));
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), front, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(g_FieldOfView),
+		(float)ViewManager::WINDOW_WIDTH / (float)ViewManager::WINDOW_HEIGHT, g_NearPlane, g_FarPlane);
+
+	return(projection * view);
+}
@@ -0,0 +1,23 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscenebenchmark.h
+// ============
+// the scene and camera shared by the benchmarks that query a stress scene
+// of randomly placed objects
+//
+// The objects are placed from a fixed seed, so the numbers from two runs
+// can be compared directly, and the camera at the center of the scene
+// turns a full circle over the passes.  No OpenGL context is needed.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// half the size of the cube 100k objects are placed in
+const float g_SceneExtent = 100.0f;
+// the seed the objects are placed from
+const unsigned int g_Seed = 330;
+
+// the view frustum of the camera at the center of the scene for
+// a pass, turned a little further for every pass
+glm::mat4 GetStressSceneViewProjection(int pass, int passes);
@@ -0,0 +1,492 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecompressionbenchmark.cpp
+// ============
+// measure what block compressing the scene textures saves, reported as
+// JSON - for each image and each format, the size of the mip levels in
+// memory and as the driver reports them, the time to compress them, the
+// quality of the first level and the time to sample the texture
+//
+// The sampling pass draws a fullscreen triangle that fetches one texel of
+// the first level per pixel, the worst case for texture bandwidth, and is
+// timed until glFinish() returns.  The fetched bytes per second are
+// the size of the fetched texels divided by that time.  Must be run from
+// the project directory, since the images are loaded from
+// "../../Utilities/textures/".
+//
+//  usage: TextureCompressionBenchmark [--passes N] [--output results.json]
+//             [image ...]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "stb_image.h"
+
+#include "TextureCache.h"
+#include "BlockCompressor.h"
+#include "ViewManager.h"
+#include "HeadlessContext.h"
+#include "Benchmark.h"
+
+namespace
+{
+	const int DEFAULT_PASSES = 20;
+
+	// the scene textures, and the large images the scene may use
+	const char* g_DefaultImages[] =
+	{
+		"../../Utilities/textures/pages.jpg",
+		"../../Utilities/textures/page.jpg",
+		"../../Utilities/textures/rubiks.jpg",
+		"../../Utilities/textures/shadow.jpg",
+		"../../Utilities/textures/backdrop.jpg",
+		"../../Utilities/textures/rusticwood.jpg"
+	};
+
+	const char* g_CompressionNames[] = { "none", "s3tc", "bptc" };
+
+	// draws a fullscreen triangle with texture coordinates scaled
+	// so that one texel of the first level covers one pixel
+	const char* g_VertexShader =
+		"#version 330 core\n"
+		"uniform vec2 uvScale;\n"
+		"out vec2 uv;\n"
+		"void main()\n"
+		"{\n"
+		"	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+		"	uv = position * uvScale;\n"
+		"	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);\n"
+		"}\n";
+	const char* g_FragmentShader =
+		"#version 330 core\n"
+		"uniform sampler2D image;\n"
+		"in vec2 uv;\n"
+		"out vec4 fragmentColor;\n"
+		"void main()\n"
+		"{\n"
+		"	fragmentColor = texture(image, uv);\n"
+		"}\n";
+
+	// the results of one format of one image
+	struct FORMAT_RESULT
+	{
+		std::string compression;
+		std::string format;
+		size_t storedBytes;
+		size_t driverBytes;
+		double encodeMs;
+		double psnr;
+		double sampleMs;
+		double fetchedBytes;
+		double fetchedGBps;
+	};
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  Compile and link the sampling shader program, returning
+ *  0 when it fails.
+ ***********************************************************/
+static GLuint CompileProgram()
+{
+	const char* sources[2] = { g_VertexShader, g_FragmentShader };
+	const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	GLuint programID = glCreateProgram();
+	GLint success = 0;
+	char infoLog[512];
+
+	for (int i = 0; i < 2; i++)
+	{
+		GLuint shaderID = glCreateShader(types[i]);
+		glShaderSource(shaderID, 1, &sources[i], NULL);
+		glCompileShader(shaderID);
+		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+			std::cerr << "Shader compilation failed: " << infoLog << std::endl;
+			return(0);
+		}
+		glAttachShader(programID, shaderID);
+		glDeleteShader(shaderID);
+	}
+
+	glLinkProgram(programID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		std::cerr << "Shader linking failed: " << infoLog << std::endl;
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  Decode an image file and build its mip levels, the same
+ *  as the texture loader does.
+ ***********************************************************/
+static bool DecodeImage(const char* filename, TEXTURE_IMAGE& image)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+	unsigned char* pixels = stbi_load(filename, &width, &height, &colorChannels, 0);
+	if (NULL == pixels)
+	{
+		return(false);
+	}
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		stbi_image_free(pixels);
+		return(false);
+	}
+
+	TEXTURE_IMAGE::MIP_LEVEL level;
+	level.width = width;
+	level.height = height;
+	level.offset = 0;
+	level.size = (size_t)width * height * colorChannels;
+
+	image.width = width;
+	image.height = height;
+	image.colorChannels = colorChannels;
+	image.format = (colorChannels == 4) ? TEXTURE_FORMAT_RGBA8 : TEXTURE_FORMAT_RGB8;
+	image.levels.push_back(level);
+	image.decodedPixels.assign(pixels, pixels + level.size);
+	stbi_image_free(pixels);
+
+	TextureCache::BuildMipLevels(image);
+
+	return(true);
+}
+
+/***********************************************************
+ *  UploadImage()
+ *
+ *  Create a texture with every mip level of an image,
+ *  returning the size of the levels the driver reports.
+ ***********************************************************/
+static GLuint UploadImage(const TEXTURE_IMAGE& image, size_t& driverBytes)
+{
+	GLenum internalFormat = GL_RGB8;
+	GLenum pixelFormat = GL_RGB;
+	bool bCompressed = true;
+
+	switch (image.format)
+	{
+	case TEXTURE_FORMAT_BC1:
+		internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		break;
+	case TEXTURE_FORMAT_BC3:
+		internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		break;
+	case TEXTURE_FORMAT_BC7:
+		internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+		break;
+	case TEXTURE_FORMAT_RGBA8:
+		internalFormat = GL_RGBA8;
+		pixelFormat = GL_RGBA;
+		bCompressed = false;
+		break;
+	default:
+		bCompressed = false;
+		break;
+	}
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	driverBytes = 0;
+	for (size_t i = 0; i < image.levels.size(); i++)
+	{
+		const TEXTURE_IMAGE::MIP_LEVEL& level = image.levels[i];
+		const unsigned char* pPixels = image.GetPixels() + level.offset;
+		GLint levelBytes = 0;
+		if (bCompressed)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, level.width, level.height, 0, (GLsizei)level.size, pPixels);
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, (GLint)i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &levelBytes);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, level.width, level.height, 0, pixelFormat, GL_UNSIGNED_BYTE, pPixels);
+
+			// the bits the driver keeps for each channel
+			const GLenum channelSizes[4] = { GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE, GL_TEXTURE_ALPHA_SIZE };
+			GLint texelBits = 0;
+			for (int c = 0; c < 4; c++)
+			{
+				GLint bits = 0;
+				glGetTexLevelParameteriv(GL_TEXTURE_2D, (GLint)i, channelSizes[c], &bits);
+				texelBits += bits;
+			}
+			levelBytes = (GLint)((size_t)level.width * level.height * texelBits / 8);
+		}
+		driverBytes += (size_t)levelBytes;
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  MeasurePSNR()
+ *
+ *  Read the first level of a texture back from the driver,
+ *  which decodes the blocks, and compare it to the source
+ *  image, returning the peak signal to noise ratio in dB,
+ *  or a negative value when the texture is lossless.
+ ***********************************************************/
+static double MeasurePSNR(GLuint textureID, const TEXTURE_IMAGE& source)
+{
+	const TEXTURE_IMAGE::MIP_LEVEL& level = source.levels[0];
+	std::vector<unsigned char> texels((size_t)level.width * level.height * 4);
+
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+
+	const int channels = source.colorChannels;
+	const unsigned char* pSource = source.GetPixels() + level.offset;
+	double squaredError = 0.0;
+	for (size_t i = 0; i < (size_t)level.width * level.height; i++)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			double difference = (double)texels[i * 4 + c] - (double)pSource[i * channels + c];
+			squaredError += difference * difference;
+		}
+	}
+
+	double meanError = squaredError / ((double)level.width * level.height * channels);
+	if (meanError <= 0.0)
+	{
+		return(-1.0);
+	}
+	return(10.0 * std::log10(255.0 * 255.0 / meanError));
+}
+
+/***********************************************************
+ *  MeasureSampling()
+ *
+ *  Draw the sampling pass the passed in number of times,
+ *  returning the time of one pass in milliseconds.  The
+ *  time includes waiting for the GPU with glFinish(), since
+ *  timer queries are not reliable on software renderers.
+ ***********************************************************/
+static double MeasureSampling(GLuint programID, GLuint textureID, const TEXTURE_IMAGE& image, int width, int height, int passes)
+{
+	glUseProgram(programID);
+	glUniform2f(glGetUniformLocation(programID, "uvScale"), (float)width / image.width, (float)height / image.height);
+	glUniform1i(glGetUniformLocation(programID, "image"), 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	// one pass first, so the texture is resident before timing
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glFinish();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < passes; i++)
+	{
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+	glFinish();
+
+	return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / passes);
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int passes = DEFAULT_PASSES;
+	const char* outputFile = NULL;
+	std::vector<std::string> images;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--passes") == 0) && (i + 1 < argc))
+		{
+			passes = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else if (argv[i][0] != '-')
+		{
+			images.push_back(argv[i]);
+		}
+		else
+		{
+			passes = 0;
+			break;
+		}
+	}
+
+	if (passes <= 0)
+	{
+		std::cerr << "usage: TextureCompressionBenchmark [--passes N] [--output results.json] [image ...]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+	if (images.empty())
+	{
+		images.assign(g_DefaultImages, g_DefaultImages + sizeof(g_DefaultImages) / sizeof(g_DefaultImages[0]));
+	}
+
+	const int width = ViewManager::WINDOW_WIDTH;
+	const int height = ViewManager::WINDOW_HEIGHT;
+	HeadlessContext context;
+	if (CreateBenchmarkContext(context, width, height) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	GLuint programID = CompileProgram();
+	if (0 == programID)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// the core profile draws nothing without a vertex array
+	GLuint vertexArray = 0;
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+	glViewport(0, 0, width, height);
+	glDisable(GL_DEPTH_TEST);
+
+	// only the formats the driver can sample are measured
+	std::vector<TEXTURE_COMPRESSION> compressions;
+	compressions.push_back(TEXTURE_COMPRESSION_NONE);
+	if (GLEW_EXT_texture_compression_s3tc)
+	{
+		compressions.push_back(TEXTURE_COMPRESSION_S3TC);
+	}
+	if (GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc)
+	{
+		compressions.push_back(TEXTURE_COMPRESSION_BPTC);
+	}
+
+	const char* formatNames[] = { "unknown", "RGB8", "RGBA8", "BC1", "BC3", "BC7" };
+
+	stbi_set_flip_vertically_on_load(true);
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"benchmark\": \"TextureCompressionBenchmark\",\n"
+		<< "  \"glVersion\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+		<< "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+		<< "  \"passes\": " << passes << ",\n"
+		<< "  \"sampledPixels\": " << width * height << ",\n"
+		<< "  \"images\": [\n";
+
+	for (size_t imageIndex = 0; imageIndex < images.size(); imageIndex++)
+	{
+		TEXTURE_IMAGE source;
+		if (DecodeImage(images[imageIndex].c_str(), source) == false)
+		{
+			std::cerr << "Could not load image:" << images[imageIndex] << std::endl;
+			return(EXIT_FAILURE);
+		}
+
+		std::vector<FORMAT_RESULT> results;
+		for (size_t i = 0; i < compressions.size(); i++)
+		{
+			TEXTURE_IMAGE image = source;
+
+			auto start = std::chrono::steady_clock::now();
+			BlockCompressor::CompressImage(image, compressions[i]);
+
+			FORMAT_RESULT formatResult;
+			formatResult.encodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			formatResult.compression = g_CompressionNames[compressions[i]];
+			formatResult.format = formatNames[image.format];
+			formatResult.storedBytes = image.GetPixelsSize();
+
+			GLuint textureID = UploadImage(image, formatResult.driverBytes);
+			formatResult.psnr = MeasurePSNR(textureID, source);
+			formatResult.sampleMs = MeasureSampling(programID, textureID, image, width, height, passes);
+
+			// every pixel fetches about one texel of the first level,
+			// at the size the driver keeps it - drivers may pad three
+			// channel texels to four
+			double bytesPerTexel = (double)TEXTURE_IMAGE::GetLevelSize(image.format, 4, 4) / 16.0 *
+				formatResult.driverBytes / formatResult.storedBytes;
+			formatResult.fetchedBytes = (double)width * height * bytesPerTexel;
+			formatResult.fetchedGBps = (formatResult.sampleMs > 0.0) ?
+				formatResult.fetchedBytes / (formatResult.sampleMs * 1.0e6) : 0.0;
+
+			glDeleteTextures(1, &textureID);
+			results.push_back(formatResult);
+		}
+
+		json << "    {\n"
+			<< "      \"image\": \"" << images[imageIndex] << "\",\n"
+			<< "      \"width\": " << source.width << ",\n"
+			<< "      \"height\": " << source.height << ",\n"
+			<< "      \"channels\": " << source.colorChannels << ",\n"
+			<< "      \"formats\": [\n";
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			json << "        { "
+				<< "\"compression\": \"" << results[i].compression << "\", "
+				<< "\"format\": \"" << results[i].format << "\", "
+				<< "\"storedBytes\": " << results[i].storedBytes << ", "
+				<< "\"driverBytes\": " << results[i].driverBytes << ", "
+				<< "\"savedPercent\": " << 100.0 * (1.0 - (double)results[i].driverBytes / results[0].driverBytes) << ", "
+				<< "\"encodeMs\": " << results[i].encodeMs << ", "
+				<< "\"psnr\": ";
+			if (results[i].psnr < 0.0)
+			{
+				json << "null, ";
+			}
+			else
+			{
+				json << results[i].psnr << ", ";
+			}
+			json << "\"sampleMs\": " << results[i].sampleMs << ", "
+				<< "\"fetchedBytesPerPass\": " << (size_t)results[i].fetchedBytes << ", "
+				<< "\"fetchedGBps\": " << results[i].fetchedGBps << " }"
+				<< ((i + 1 < results.size()) ? ",\n" : "\n");
+		}
+		json << "      ]\n"
+			<< "    }" << ((imageIndex + 1 < images.size()) ? ",\n" : "\n");
+
+		TextureCache::FreeImage(source);
+	}
+
+	json << "  ]\n"
+		<< "}\n";
+
+	glDeleteVertexArrays(1, &vertexArray);
+	glDeleteProgram(programID);
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
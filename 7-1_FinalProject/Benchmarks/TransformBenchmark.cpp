@@ -0,0 +1,217 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbenchmark.cpp
+// ============
+// measure the composition of world matrices for growing numbers of objects,
+// reported as JSON - built one draw at a time from Euler degrees the way
+// SceneManager::SetTransformations() does, and in one batch from
+// quaternions, with and without SSE
+//
+// The objects are placed in groups of 16, a parent followed by its 15
+// children, so every path also multiplies by the world matrix of a parent.
+// The angles are turned into quaternions before timing, as the scene does
+// when a node is added.  The largest difference between the matrices of
+// the batch and of the per-draw path is reported with the times.  No
+// OpenGL context is needed.
+//
+//  usage: TransformBenchmark [--passes N] [--output results.json]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include "Transform.h"
+#include "TransformBatch.h"
+#include "Benchmark.h"
+
+namespace
+{
+	const int DEFAULT_PASSES = 5;
+
+	// the numbers of objects that are measured
+	const int g_ObjectCounts[] = { 1000, 10000, 100000, 1000000 };
+	const int g_ObjectCountCount = sizeof(g_ObjectCounts) / sizeof(g_ObjectCounts[0]);
+
+	// objects in each group of a parent and its children
+	const int g_GroupSize = 16;
+
+	// the transformation of one object, as the scene authors it
+	struct OBJECT
+	{
+		int parent;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+	};
+}
+
+/***********************************************************
+ *  MakeObjects()
+ *
+ *  Fill in the transformations of the objects, varied by a
+ *  fixed sequence so every run measures the same values.
+ ***********************************************************/
+static void MakeObjects(std::vector<OBJECT>& objects, int count)
+{
+	unsigned int seed = 12345u;
+
+	objects.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		float values[9];
+		for (int v = 0; v < 9; v++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			values[v] = (float)(seed >> 8) / (float)(1 << 24);
+		}
+
+		objects[i].parent = ((i % g_GroupSize) == 0) ? -1 : (i - (i % g_GroupSize));
+		objects[i].scaleXYZ = glm::vec3(0.5f) + glm::vec3(values[0], values[1], values[2]);
+		objects[i].rotationDegrees = glm::vec3(values[3], values[4], values[5]) * 360.0f - 180.0f;
+		objects[i].positionXYZ = glm::vec3(values[6], values[7], values[8]) * 20.0f - 10.0f;
+	}
+}
+
+/***********************************************************
+ *  ComposePerDraw()
+ *
+ *  Build every world matrix the way the per-draw path does,
+ *  from a scale, three axis rotations and a translation.
+ ***********************************************************/
+static void ComposePerDraw(const std::vector<OBJECT>& objects, std::vector<glm::mat4>& worldMatrices)
+{
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		const OBJECT& object = objects[i];
+		glm::mat4 scale = glm::scale(object.scaleXYZ);
+		glm::mat4 rotationX = glm::rotate(glm::radians(object.rotationDegrees.x), glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::mat4 rotationY = glm::rotate(glm::radians(object.rotationDegrees.y), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rotationZ = glm::rotate(glm::radians(object.rotationDegrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 translation = glm::translate(object.positionXYZ);
+		glm::mat4 local = translation * rotationX * rotationY * rotationZ * scale;
+
+		if (object.parent >= 0)
+		{
+			worldMatrices[i] = worldMatrices[object.parent] * local;
+		}
+		else
+		{
+			worldMatrices[i] = local;
+		}
+	}
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int passes = DEFAULT_PASSES;
+	const char* outputFile = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--passes") == 0) && (i + 1 < argc))
+		{
+			passes = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else
+		{
+			passes = 0;
+			break;
+		}
+	}
+
+	if (passes <= 0)
+	{
+		std::cerr << "usage: TransformBenchmark [--passes N] [--output results.json]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"benchmark\": \"TransformBenchmark\",\n"
+		<< "  \"passes\": " << passes << ",\n"
+		<< "  \"groupSize\": " << g_GroupSize << ",\n"
+		<< "  \"results\": [\n";
+
+	for (int c = 0; c < g_ObjectCountCount; c++)
+	{
+		int count = g_ObjectCounts[c];
+		std::vector<OBJECT> objects;
+		std::vector<glm::mat4> perDrawMatrices(count);
+		TransformBatch batch;
+
+		MakeObjects(objects, count);
+		for (int i = 0; i < count; i++)
+		{
+			batch.Add(objects[i].parent, objects[i].scaleXYZ,
+				Transform::RotationFromEulerDegrees(objects[i].rotationDegrees), objects[i].positionXYZ);
+		}
+
+		// one pass of each first, so the memory is touched before timing
+		ComposePerDraw(objects, perDrawMatrices);
+		batch.ComposeWorldMatricesScalar();
+		batch.ComposeWorldMatrices();
+
+		auto start = std::chrono::steady_clock::now();
+		for (int p = 0; p < passes; p++)
+		{
+			ComposePerDraw(objects, perDrawMatrices);
+		}
+		double perDrawMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+
+		start = std::chrono::steady_clock::now();
+		for (int p = 0; p < passes; p++)
+		{
+			batch.ComposeWorldMatricesScalar();
+		}
+		double scalarMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+
+		start = std::chrono::steady_clock::now();
+		for (int p = 0; p < passes; p++)
+		{
+			batch.ComposeWorldMatrices();
+		}
+		double batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+
+		// the batch must give the matrices of the per-draw path
+		float maxDifference = 0.0f;
+		for (int i = 0; i < count; i++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				glm::vec4 difference = glm::abs(batch.GetWorldMatrix(i)[column] - perDrawMatrices[i][column]);
+				maxDifference = glm::max(maxDifference, glm::max(glm::max(difference.x, difference.y), glm::max(difference.z, difference.w)));
+			}
+		}
+
+		json << "    { \"objects\": " << count
+			<< ", \"perDrawMs\": " << perDrawMs
+			<< ", \"batchScalarMs\": " << scalarMs
+			<< ", \"batchMs\": " << batchMs
+			<< ", \"perDrawNsPerObject\": " << perDrawMs * 1.0e6 / count
+			<< ", \"batchNsPerObject\": " << batchMs * 1.0e6 / count
+			<< ", \"speedup\": " << ((batchMs > 0.0) ? perDrawMs / batchMs : 0.0)
+			<< ", \"maxDifference\": " << maxDifference
+			<< " }" << ((c + 1 < g_ObjectCountCount) ? ",\n" : "\n");
+	}
+	json << "  ]\n}\n";
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
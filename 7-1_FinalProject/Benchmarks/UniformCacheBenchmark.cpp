@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformcachebenchmark.cpp
+// ============
+// measure the per-frame CPU cost of the shader uniform uploads made by
+// the scene, comparing a driver lookup by name on every set against the
+// cached locations and the pre-resolved handles in ShaderManager
+//
+//  usage: UniformCacheBenchmark [frames] [drawsPerFrame] [shaderDirectory]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+
+#include <glm/glm.hpp>
+
+#include "ShaderManager.h"
+
+namespace
+{
+	// the number of draws issued by SceneManager::RenderScene()
+	const int DEFAULT_DRAWS_PER_FRAME = 34;
+	const int DEFAULT_FRAMES = 2000;
+
+	// uniforms set for every draw, matching the names in the shaders
+	const char* g_ModelName = "model";
+	const char* g_ColorValueName = "objectColor";
+	const char* g_TextureValueName = "objectTexture";
+	const char* g_UVScaleName = "UVscale";
+	const char* g_MaterialIndexName = "materialIndex";
+
+	// uniforms set for every draw - the texture is cleared with
+	// the color, then set to the texture array layer of the draw
+	const int UNIFORMS_PER_DRAW = 6;
+}
+
+/***********************************************************
+ *  RunByDriverLookup()
+ *
+ *  The original path - the driver is asked for the location
+ *  of the uniform by name on every set.
+ ***********************************************************/
+static void RunByDriverLookup(GLuint programID, int frames, int draws)
+{
+	glm::mat4 model(1.0f);
+	glm::vec4 color(1.0f);
+
+	for (int frame = 0; frame < frames; frame++)
+	{
+		for (int draw = 0; draw < draws; draw++)
+		{
+			model[3][0] = (float)draw;
+			glUniformMatrix4fv(glGetUniformLocation(programID, g_ModelName), 1, GL_FALSE, &model[0][0]);
+			glUniform1i(glGetUniformLocation(programID, g_TextureValueName), -1);
+			glUniform4fv(glGetUniformLocation(programID, g_ColorValueName), 1, &color[0]);
+			glUniform1i(glGetUniformLocation(programID, g_TextureValueName), draw % 4);
+			glUniform2f(glGetUniformLocation(programID, g_UVScaleName), 1.0f, 1.0f);
+			glUniform1i(glGetUniformLocation(programID, g_MaterialIndexName), draw % 5);
+		}
+	}
+}
+
+/***********************************************************
+ *  RunByCachedName()
+ *
+ *  The string based ShaderManager methods, which now look
+ *  the location up in the cache filled at link time.
+ ***********************************************************/
+static void RunByCachedName(ShaderManager& shaderManager, int frames, int draws)
+{
+	glm::mat4 model(1.0f);
+	glm::vec4 color(1.0f);
+
+	for (int frame = 0; frame < frames; frame++)
+	{
+		for (int draw = 0; draw < draws; draw++)
+		{
+			model[3][0] = (float)draw;
+			shaderManager.setMat4Value(g_ModelName, model);
+			shaderManager.setIntValue(g_TextureValueName, -1);
+			shaderManager.setVec4Value(g_ColorValueName, color);
+			shaderManager.setIntValue(g_TextureValueName, draw % 4);
+			shaderManager.setVec2Value(g_UVScaleName, glm::vec2(1.0f, 1.0f));
+			shaderManager.setIntValue(g_MaterialIndexName, draw % 5);
+		}
+	}
+}
+
+/***********************************************************
+ *  RunByHandle()
+ *
+ *  The pre-resolved handle path used by SceneManager, with
+ *  no string hashing or driver queries per draw.
+ ***********************************************************/
+static void RunByHandle(ShaderManager& shaderManager, int frames, int draws)
+{
+	ShaderUniform<glm::mat4> modelUniform = shaderManager.GetUniform<glm::mat4>(g_ModelName);
+	ShaderUniform<glm::vec4> colorUniform = shaderManager.GetUniform<glm::vec4>(g_ColorValueName);
+	ShaderUniform<int> textureUniform = shaderManager.GetUniform<int>(g_TextureValueName);
+	ShaderUniform<glm::vec2> uvScaleUniform = shaderManager.GetUniform<glm::vec2>(g_UVScaleName);
+	ShaderUniform<int> materialIndexUniform = shaderManager.GetUniform<int>(g_MaterialIndexName);
+
+	glm::mat4 model(1.0f);
+	glm::vec4 color(1.0f);
+
+	for (int frame = 0; frame < frames; frame++)
+	{
+		for (int draw = 0; draw < draws; draw++)
+		{
+			model[3][0] = (float)draw;
+			shaderManager.setMat4Value(modelUniform, model);
+			shaderManager.setIntValue(textureUniform, -1);
+			shaderManager.setVec4Value(colorUniform, color);
+			shaderManager.setIntValue(textureUniform, draw % 4);
+			shaderManager.setVec2Value(uvScaleUniform, glm::vec2(1.0f, 1.0f));
+			shaderManager.setIntValue(materialIndexUniform, draw % 5);
+		}
+	}
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  Print the CPU time per frame for one of the runs.
+ ***********************************************************/
+static void Report(const char* label, double seconds, int frames, int draws)
+{
+	double usPerFrame = seconds * 1.0e6 / frames;
+	double nsPerUpload = seconds * 1.0e9 / ((double)frames * draws * UNIFORMS_PER_DRAW);
+	std::cout << label << ": " << usPerFrame << " us/frame, "
+		<< nsPerUpload << " ns/uniform" << std::endl;
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int frames = (argc > 1) ? atoi(argv[1]) : DEFAULT_FRAMES;
+	int draws = (argc > 2) ? atoi(argv[2]) : DEFAULT_DRAWS_PER_FRAME;
+	std::string shaderDirectory = (argc > 3) ? argv[3] : "../../Utilities/shaders/";
+
+	if ((frames <= 0) || (draws <= 0))
+	{
+		std::cerr << "usage: UniformCacheBenchmark [frames] [drawsPerFrame] [shaderDirectory]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	// a hidden window is enough to get a current GL context
+	if (glfwInit() == GLFW_FALSE)
+	{
+		std::cerr << "Failed to initialize GLFW" << std::endl;
+		return(EXIT_FAILURE);
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "UniformCacheBenchmark", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cerr << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+	glfwMakeContextCurrent(window);
+
+	glewExperimental = GL_TRUE;
+	if (glewInit() != GLEW_OK)
+	{
+		std::cerr << "Failed to initialize GLEW" << std::endl;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+
+	ShaderManager shaderManager;
+	std::string vertexPath = shaderDirectory + "vertexShader.glsl";
+	std::string fragmentPath = shaderDirectory + "fragmentShader.glsl";
+	if (shaderManager.LoadShaders(vertexPath.c_str(), fragmentPath.c_str()) == 0)
+	{
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+	shaderManager.use();
+
+	std::cout << frames << " frames, " << draws << " draws/frame, " << UNIFORMS_PER_DRAW << " uniforms/draw" << std::endl;
+
+	// warm up the driver once before timing anything
+	RunByHandle(shaderManager, 10, draws);
+	glFinish();
+
+	auto start = std::chrono::steady_clock::now();
+	RunByDriverLookup(shaderManager.m_programID, frames, draws);
+	glFinish();
+	auto lookupEnd = std::chrono::steady_clock::now();
+	RunByCachedName(shaderManager, frames, draws);
+	glFinish();
+	auto cachedEnd = std::chrono::steady_clock::now();
+	RunByHandle(shaderManager, frames, draws);
+	glFinish();
+	auto handleEnd = std::chrono::steady_clock::now();
+
+	Report("glGetUniformLocation per set", std::chrono::duration<double>(lookupEnd - start).count(), frames, draws);
+	Report("cached location by name     ", std::chrono::duration<double>(cachedEnd - lookupEnd).count(), frames, draws);
+	Report("pre-resolved handle         ", std::chrono::duration<double>(handleEnd - cachedEnd).count(), frames, draws);
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	return(EXIT_SUCCESS);
+}
@@ -0,0 +1,290 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexcachebenchmark.cpp
+// ============
+// measure how the vertex cache order of the shape meshes changes the work
+// of the vertex shader, reported as JSON - for every level of detail of
+// every mesh, loaded in the order it is generated and reordered for the
+// cache
+//
+// The simulated FIFO caches give the average cache miss ratio (ACMR, the
+// vertices transformed per triangle) and the average transform to vertex
+// ratio (ATVR, per vertex used, 1 at best).  The throughput pass draws
+// many instances of each mesh, each covering only a few pixels, with a
+// vertex shader that is costly enough to hide the rest of the pipeline,
+// and is timed until glFinish() returns.  Where the driver can count them,
+// the vertex shader invocations of the pass are reported as well.  Must
+// be run from the project directory, like the other benchmarks.
+//
+//  usage: VertexCacheBenchmark [--instances N] [--passes N]
+//                              [--output results.json]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "ShapeMeshes.h"
+#include "VertexCacheOptimizer.h"
+#include "HeadlessContext.h"
+#include "MeshBenchmark.h"
+#include "Benchmark.h"
+
+// the pipeline statistics query of OpenGL 4.6, which older GLEW
+// headers do not name
+#ifndef GL_VERTEX_SHADER_INVOCATIONS
+#define GL_VERTEX_SHADER_INVOCATIONS 0x82F0
+#endif
+
+namespace
+{
+	const int DEFAULT_INSTANCES = 1000;
+	const int DEFAULT_PASSES = 10;
+
+	// the cache sizes the meshes are measured with - the size they
+	// are ordered for, and a larger one like most desktop GPUs have
+	const int g_CacheSizes[] = { VertexCacheOptimizer::DEFAULT_CACHE_SIZE, 32 };
+	const int g_CacheSizeCount = sizeof(g_CacheSizes) / sizeof(g_CacheSizes[0]);
+
+	// size of the offscreen framebuffer, and of every instance in it
+	const int g_FramebufferSize = 512;
+	const float g_InstanceScale = 0.004f;
+
+	// moves the vertices by the per-instance model matrix, after
+	// bending the normal enough times that the shader dominates
+	const char* g_VertexShader =
+		"#version 330 core\n"
+		"layout(location = 0) in vec3 position;\n"
+		"layout(location = 1) in vec3 normal;\n"
+		"layout(location = 3) in mat4 model;\n"
+		"out vec3 shade;\n"
+		"void main()\n"
+		"{\n"
+		"	vec3 n = normal;\n"
+		"	for (int i = 0; i < 32; i++)\n"
+		"	{\n"
+		"		n = normalize(n + 0.01 * cross(n, position + vec3(i)));\n"
+		"	}\n"
+		"	shade = n * 0.5 + 0.5;\n"
+		"	gl_Position = model * vec4(position, 1.0);\n"
+		"}\n";
+	const char* g_FragmentShader =
+		"#version 330 core\n"
+		"in vec3 shade;\n"
+		"out vec4 fragmentColor;\n"
+		"void main()\n"
+		"{\n"
+		"	fragmentColor = vec4(shade, 1.0);\n"
+		"}\n";
+
+	// the results of one level of detail with one vertex order
+	struct ORDER_RESULT
+	{
+		VertexCacheOptimizer::CACHE_STATS cacheStats[g_CacheSizeCount];
+		double drawMs;
+		double trianglesPerSecond;
+		double shaderInvocations;   // per triangle, or negative when not counted
+	};
+}
+
+/***********************************************************
+ *  MeasureThroughput()
+ *
+ *  Draw the instances of a level of detail of a mesh the
+ *  passed in number of times, filling in the time of one
+ *  pass and the vertex shader invocations per triangle.
+ ***********************************************************/
+static void MeasureThroughput(
+	ShapeMeshes& meshes,
+	ShapeMeshes::MESH_TYPE mesh,
+	int lod,
+	const std::vector<ShapeMeshes::INSTANCE_DATA>& instances,
+	int passes,
+	ORDER_RESULT& result)
+{
+	GLsizei instanceCount = (GLsizei)instances.size();
+	double triangles = (double)meshes.GetMeshTriangleCount(mesh, lod) * instanceCount;
+
+	// one pass first, so the buffers are resident before timing
+	meshes.DrawMeshInstanced(mesh, instances.data(), instanceCount, lod);
+	glFinish();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < passes; i++)
+	{
+		meshes.DrawMeshInstanced(mesh, instances.data(), instanceCount, lod);
+	}
+	glFinish();
+
+	result.drawMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+	result.trianglesPerSecond = (result.drawMs > 0.0) ? triangles / (result.drawMs * 1.0e-3) : 0.0;
+
+	// the invocations can only be counted from OpenGL 4.6
+	GLint majorVersion = 0;
+	GLint minorVersion = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+	glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+	result.shaderInvocations = -1.0;
+	if ((majorVersion > 4) || ((majorVersion == 4) && (minorVersion >= 6)))
+	{
+		GLuint query = 0;
+		GLuint64 invocations = 0;
+
+		glGenQueries(1, &query);
+		glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS, query);
+		meshes.DrawMeshInstanced(mesh, instances.data(), instanceCount, lod);
+		glEndQuery(GL_VERTEX_SHADER_INVOCATIONS);
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &invocations);
+		glDeleteQueries(1, &query);
+
+		result.shaderInvocations = (triangles > 0.0) ? (double)invocations / triangles : 0.0;
+	}
+}
+
+/***********************************************************
+ *  WriteOrderResult()
+ *
+ *  Write the results of one vertex order as a JSON object.
+ ***********************************************************/
+static void WriteOrderResult(std::ostringstream& json, const ORDER_RESULT& result)
+{
+	json << "{ ";
+	for (int i = 0; i < g_CacheSizeCount; i++)
+	{
+		json << "\"acmr" << g_CacheSizes[i] << "\": " << result.cacheStats[i].acmr << ", "
+			<< "\"atvr" << g_CacheSizes[i] << "\": " << result.cacheStats[i].atvr << ", ";
+	}
+	json << "\"drawMs\": " << result.drawMs << ", "
+		<< "\"trianglesPerSecond\": " << result.trianglesPerSecond << ", "
+		<< "\"vertexShaderInvocationsPerTriangle\": ";
+	if (result.shaderInvocations < 0.0)
+	{
+		json << "null";
+	}
+	else
+	{
+		json << result.shaderInvocations;
+	}
+	json << " }";
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int instanceCount = DEFAULT_INSTANCES;
+	int passes = DEFAULT_PASSES;
+	const char* outputFile = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--instances") == 0) && (i + 1 < argc))
+		{
+			instanceCount = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--passes") == 0) && (i + 1 < argc))
+		{
+			passes = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else
+		{
+			passes = 0;
+			break;
+		}
+	}
+
+	if ((instanceCount <= 0) || (passes <= 0))
+	{
+		std::cerr << "usage: VertexCacheBenchmark [--instances N] [--passes N] [--output results.json]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	HeadlessContext context;
+	if (CreateMeshBenchmarkContext(context, g_FramebufferSize) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	GLuint programID = CompileMeshBenchmarkProgram(g_VertexShader, g_FragmentShader);
+	if (0 == programID)
+	{
+		return(EXIT_FAILURE);
+	}
+	glUseProgram(programID);
+
+	// the instances are spread over the view in a grid, each
+	// small enough that the pixels cost little
+	std::vector<ShapeMeshes::INSTANCE_DATA> instances = BuildMeshBenchmarkInstances(instanceCount, g_InstanceScale);
+
+	// the same meshes in the order they are generated, and
+	// reordered for the vertex cache
+	ShapeMeshes generatedMeshes;
+	ShapeMeshes optimizedMeshes;
+	generatedMeshes.SetVertexCacheOptimization(false);
+	optimizedMeshes.SetVertexCacheOptimization(true);
+	LoadMeshBenchmarkMeshes(generatedMeshes);
+	LoadMeshBenchmarkMeshes(optimizedMeshes);
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"benchmark\": \"VertexCacheBenchmark\",\n"
+		<< "  \"glVersion\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+		<< "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+		<< "  \"instances\": " << instanceCount << ",\n"
+		<< "  \"passes\": " << passes << ",\n"
+		<< "  \"meshes\": [\n";
+
+	bool bFirst = true;
+	for (int i = 0; i < ShapeMeshes::MESH_COUNT; i++)
+	{
+		ShapeMeshes::MESH_TYPE mesh = (ShapeMeshes::MESH_TYPE)i;
+
+		for (int lod = 0; lod < optimizedMeshes.GetMeshLodCount(mesh); lod++)
+		{
+			ORDER_RESULT generated;
+			ORDER_RESULT optimized;
+
+			for (int c = 0; c < g_CacheSizeCount; c++)
+			{
+				generatedMeshes.GetMeshCacheStats(mesh, lod, g_CacheSizes[c], generated.cacheStats[c]);
+				optimizedMeshes.GetMeshCacheStats(mesh, lod, g_CacheSizes[c], optimized.cacheStats[c]);
+			}
+			MeasureThroughput(generatedMeshes, mesh, lod, instances, passes, generated);
+			MeasureThroughput(optimizedMeshes, mesh, lod, instances, passes, optimized);
+
+			json << (bFirst ? "" : ",\n")
+				<< "    {\n"
+				<< "      \"mesh\": \"" << GetMeshBenchmarkName(mesh) << "\",\n"
+				<< "      \"lod\": " << lod << ",\n"
+				<< "      \"triangles\": " << optimizedMeshes.GetMeshTriangleCount(mesh, lod) << ",\n"
+				<< "      \"generated\": ";
+			WriteOrderResult(json, generated);
+			json << ",\n"
+				<< "      \"optimized\": ";
+			WriteOrderResult(json, optimized);
+			json << "\n"
+				<< "    }";
+			bFirst = false;
+		}
+	}
+	json << "\n  ]\n}\n";
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
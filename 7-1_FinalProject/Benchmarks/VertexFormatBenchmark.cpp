@@ -0,0 +1,269 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexformatbenchmark.cpp
+// ============
+// measure what packing the vertices of the shape meshes costs in accuracy
+// and gains in vertex fetch, reported as JSON - for every level of detail
+// of every mesh, stored as floats and packed
+//
+// The quantization error is measured on the CPU, by packing every vertex
+// and reading it back the way the GPU does.  The fetch pass draws many
+// instances of each mesh with the rasterizer turned off and a vertex
+// shader that does little more than read the attributes, so the time is
+// spent fetching vertices, and is timed until glFinish() returns.  Must be
+// run from the project directory, like the other benchmarks.
+//
+//  usage: VertexFormatBenchmark [--instances N] [--passes N]
+//                               [--output results.json]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "ShapeMeshes.h"
+#include "HeadlessContext.h"
+#include "MeshBenchmark.h"
+#include "Benchmark.h"
+
+namespace
+{
+	const int DEFAULT_INSTANCES = 1000;
+	const int DEFAULT_PASSES = 10;
+
+	// size of the offscreen framebuffer, and of every instance in it
+	const int g_FramebufferSize = 512;
+	const float g_InstanceScale = 0.004f;
+
+	// reads every attribute, moving the position and unfolding the
+	// normal the same way as the scene vertex shader when the
+	// vertices are packed, and keeps them all live through a tiny
+	// offset of the position
+	const char* g_VertexShader =
+		"#version 330 core\n"
+		"layout(location = 0) in vec3 position;\n"
+		"layout(location = 1) in vec3 normal;\n"
+		"layout(location = 2) in vec2 uv;\n"
+		"layout(location = 3) in mat4 model;\n"
+		"layout(location = 9) in vec3 decodeScale;\n"
+		"layout(location = 10) in vec3 decodeOffset;\n"
+		"uniform bool bPackedVertices = false;\n"
+		"void main()\n"
+		"{\n"
+		"	vec3 p = position;\n"
+		"	vec3 n = normal;\n"
+		"	if (bPackedVertices)\n"
+		"	{\n"
+		"		p = position * decodeScale + decodeOffset;\n"
+		"		n = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));\n"
+		"		if (n.z < 0.0)\n"
+		"		{\n"
+		"			n.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);\n"
+		"		}\n"
+		"		n = normalize(n);\n"
+		"	}\n"
+		"	gl_Position = model * vec4(p, 1.0);\n"
+		"	gl_Position.xy += 1.0e-6 * (n.xy + uv);\n"
+		"}\n";
+	const char* g_FragmentShader =
+		"#version 330 core\n"
+		"out vec4 fragmentColor;\n"
+		"void main()\n"
+		"{\n"
+		"	fragmentColor = vec4(1.0);\n"
+		"}\n";
+
+	// the fetch results of one level of detail with one format
+	struct FORMAT_RESULT
+	{
+		double vertexBytes;         // size of the vertices of the level
+		double drawMs;
+		double verticesPerSecond;   // vertices drawn, before any reuse
+	};
+}
+
+/***********************************************************
+ *  MeasureFetch()
+ *
+ *  Draw the instances of a level of detail of a mesh the
+ *  passed in number of times, filling in the time of one
+ *  pass.  The position decode of the level is passed
+ *  with every instance.
+ ***********************************************************/
+static void MeasureFetch(
+	ShapeMeshes& meshes,
+	ShapeMeshes::MESH_TYPE mesh,
+	int lod,
+	std::vector<ShapeMeshes::INSTANCE_DATA> instances,
+	int passes,
+	GLint packedUniform,
+	FORMAT_RESULT& result)
+{
+	GLsizei instanceCount = (GLsizei)instances.size();
+	double vertices = (double)meshes.GetMeshTriangleCount(mesh, lod) * 3.0 * instanceCount;
+	ShapeMeshes::POSITION_DECODE decode = meshes.GetMeshPositionDecode(mesh, lod);
+
+	for (GLsizei i = 0; i < instanceCount; i++)
+	{
+		instances[i].positionDecode = decode;
+	}
+	glUniform1i(packedUniform, (meshes.GetVertexFormat() == ShapeMeshes::VERTEX_FORMAT_PACKED) ? 1 : 0);
+
+	// the other meshes bind their own VAO between the passes
+	meshes.ResetBindings();
+
+	// one pass first, so the buffers are resident before timing
+	meshes.DrawMeshInstanced(mesh, instances.data(), instanceCount, lod);
+	glFinish();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < passes; i++)
+	{
+		meshes.DrawMeshInstanced(mesh, instances.data(), instanceCount, lod);
+	}
+	glFinish();
+
+	result.vertexBytes = (double)meshes.GetMeshVertexCount(mesh, lod) * meshes.GetVertexSize();
+	result.drawMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+	result.verticesPerSecond = (result.drawMs > 0.0) ? vertices / (result.drawMs * 1.0e-3) : 0.0;
+}
+
+/***********************************************************
+ *  WriteFormatResult()
+ *
+ *  Write the results of one vertex format as a JSON object.
+ ***********************************************************/
+static void WriteFormatResult(std::ostringstream& json, const FORMAT_RESULT& result)
+{
+	json << "{ "
+		<< "\"vertexBytes\": " << result.vertexBytes << ", "
+		<< "\"drawMs\": " << result.drawMs << ", "
+		<< "\"verticesPerSecond\": " << result.verticesPerSecond
+		<< " }";
+}
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int instanceCount = DEFAULT_INSTANCES;
+	int passes = DEFAULT_PASSES;
+	const char* outputFile = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--instances") == 0) && (i + 1 < argc))
+		{
+			instanceCount = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--passes") == 0) && (i + 1 < argc))
+		{
+			passes = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else
+		{
+			passes = 0;
+			break;
+		}
+	}
+
+	if ((instanceCount <= 0) || (passes <= 0))
+	{
+		std::cerr << "usage: VertexFormatBenchmark [--instances N] [--passes N] [--output results.json]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	HeadlessContext context;
+	if (CreateMeshBenchmarkContext(context, g_FramebufferSize) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	GLuint programID = CompileMeshBenchmarkProgram(g_VertexShader, g_FragmentShader);
+	if (0 == programID)
+	{
+		return(EXIT_FAILURE);
+	}
+	glUseProgram(programID);
+	GLint packedUniform = glGetUniformLocation(programID, "bPackedVertices");
+	// only the vertex stage is measured
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	// the instances are spread over the view in a grid
+	std::vector<ShapeMeshes::INSTANCE_DATA> instances = BuildMeshBenchmarkInstances(instanceCount, g_InstanceScale);
+
+	// the same meshes stored as floats and packed
+	ShapeMeshes floatMeshes;
+	ShapeMeshes packedMeshes;
+	floatMeshes.SetVertexFormat(ShapeMeshes::VERTEX_FORMAT_FLOAT);
+	packedMeshes.SetVertexFormat(ShapeMeshes::VERTEX_FORMAT_PACKED);
+	LoadMeshBenchmarkMeshes(floatMeshes);
+	LoadMeshBenchmarkMeshes(packedMeshes);
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"benchmark\": \"VertexFormatBenchmark\",\n"
+		<< "  \"glVersion\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+		<< "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+		<< "  \"instances\": " << instanceCount << ",\n"
+		<< "  \"passes\": " << passes << ",\n"
+		<< "  \"floatVertexSize\": " << floatMeshes.GetVertexSize() << ",\n"
+		<< "  \"packedVertexSize\": " << packedMeshes.GetVertexSize() << ",\n"
+		<< "  \"meshes\": [\n";
+
+	bool bFirst = true;
+	for (int i = 0; i < ShapeMeshes::MESH_COUNT; i++)
+	{
+		ShapeMeshes::MESH_TYPE mesh = (ShapeMeshes::MESH_TYPE)i;
+		ShapeMeshes::MESH_BOUNDS bounds;
+		packedMeshes.GetMeshBounds(mesh, bounds);
+
+		for (int lod = 0; lod < packedMeshes.GetMeshLodCount(mesh); lod++)
+		{
+			ShapeMeshes::QUANTIZATION_ERROR error;
+			FORMAT_RESULT floatResult;
+			FORMAT_RESULT packedResult;
+
+			packedMeshes.GetMeshQuantizationError(mesh, lod, error);
+			MeasureFetch(floatMeshes, mesh, lod, instances, passes, packedUniform, floatResult);
+			MeasureFetch(packedMeshes, mesh, lod, instances, passes, packedUniform, packedResult);
+
+			json << (bFirst ? "" : ",\n")
+				<< "    {\n"
+				<< "      \"mesh\": \"" << GetMeshBenchmarkName(mesh) << "\",\n"
+				<< "      \"lod\": " << lod << ",\n"
+				<< "      \"vertices\": " << packedMeshes.GetMeshVertexCount(mesh, lod) << ",\n"
+				<< "      \"positionError\": " << error.position << ",\n"
+				<< "      \"positionErrorOfRadius\": " << ((bounds.sphereRadius > 0.0f) ? error.position / bounds.sphereRadius : 0.0f) << ",\n"
+				<< "      \"normalErrorDegrees\": " << error.normalDegrees << ",\n"
+				<< "      \"uvError\": " << error.uv << ",\n"
+				<< "      \"float\": ";
+			WriteFormatResult(json, floatResult);
+			json << ",\n"
+				<< "      \"packed\": ";
+			WriteFormatResult(json, packedResult);
+			json << "\n"
+				<< "    }";
+			bFirst = false;
+		}
+	}
+	json << "\n  ]\n}\n";
+
+	if (WriteResults(json.str(), outputFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
@@ -1,5 +1,7 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <chrono>           // headless frame timing
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,6 +15,7 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "HeadlessContext.h"
 
 // Namespace for declaring global variables
 namespace
@@ -22,6 +25,9 @@ namespace
 
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
+	// hidden window whose context shares objects with the main
+	// window, for compiling the shaders when their files are saved
+	GLFWwindow* g_CompileWindow = nullptr;
 
 	// scene manager object for managing the 3D scene prepare and render
 	SceneManager* g_SceneManager = nullptr;
@@ -29,12 +35,23 @@ namespace
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+
+	// offscreen context used instead of the window when running headless
+	HeadlessContext* g_HeadlessContext = nullptr;
+	// number of frames to render before exiting, 0 to run until closed
+	int g_HeadlessFrames = 0;
+	// optional image file for the last headless frame
+	const char* g_HeadlessOutput = nullptr;
+	// seconds advanced by every headless frame, so runs are repeatable
+	const float g_HeadlessTimestep = 1.0f / 60.0f;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
+bool ParseCommandLine(int argc, char* argv[]);
 bool InitializeGLFW();
 bool InitializeGLEW();
+void EnableShaderHotReload();
 
 
 /***********************************************************
@@ -45,8 +62,23 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// check for the headless rendering options
+	if (ParseCommandLine(argc, argv) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// headless rendering uses an offscreen context instead of GLFW
+	if (g_HeadlessFrames > 0)
+	{
+		g_HeadlessContext = new HeadlessContext();
+		if (g_HeadlessContext->CreateContext() == false)
+		{
+			return(EXIT_FAILURE);
+		}
+	}
 	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
+	else if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
@@ -58,7 +90,10 @@ int main(int argc, char* argv[])
 		g_ShaderManager);
 
 	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	if (NULL == g_HeadlessContext)
+	{
+		g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	}
 
 	// if GLEW fails initialization, then terminate the application
 	if (InitializeGLEW() == false)
@@ -66,19 +101,48 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
+	// draw into an offscreen framebuffer the size of the window
+	if (NULL != g_HeadlessContext)
+	{
+		if (g_HeadlessContext->CreateFramebuffer(ViewManager::WINDOW_WIDTH, ViewManager::WINDOW_HEIGHT) == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		g_ViewManager->CreateOffscreenView();
+		g_ViewManager->SetFixedTimestep(g_HeadlessTimestep);
+	}
+
 	// load the shader code from the external GLSL files
 	g_ShaderManager->LoadShaders(
 		"../../Utilities/shaders/vertexShader.glsl",
 		"../../Utilities/shaders/fragmentShader.glsl");
 	g_ShaderManager->use();
 
+	// headless frames always use the shaders they started with,
+	// so that runs can be compared
+	if (NULL == g_HeadlessContext)
+	{
+		EnableShaderHotReload();
+	}
+
 	// try to create a new scene manager object and prepare the 3D scene
 	g_SceneManager = new SceneManager(g_ShaderManager);
 	g_SceneManager->PrepareScene();
 
+	// the window shows the placeholder textures until the images
+	// are decoded, but headless frames must match between runs
+	if (NULL != g_HeadlessContext)
+	{
+		g_SceneManager->WaitForTextures();
+	}
+
+	int frame = 0;
+	auto startTime = std::chrono::steady_clock::now();
+
 	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
+	// or until an error has occurred, or until all of the
+	// headless frames have been rendered
+	while ((NULL != g_HeadlessContext) ? (frame < g_HeadlessFrames) : !glfwWindowShouldClose(g_Window))
 	{
 		// Enable z-depth
 		glEnable(GL_DEPTH_TEST);
@@ -87,13 +151,33 @@ int main(int argc, char* argv[])
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		// swap in the shaders once an edit has compiled and linked
+		g_ShaderManager->UpdateHotReload();
+
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
 
-		// refresh the 3D scene
+		// pick the object under the mouse cursor when the scene is
+		// clicked, which the scene manager highlights until the
+		// next click
+		glm::vec3 rayOrigin;
+		glm::vec3 rayDirection;
+		if (g_ViewManager->GetCursorRay(rayOrigin, rayDirection) == true)
+		{
+			g_SceneManager->PickNode(rayOrigin, rayDirection);
+		}
+
+		// cull the 3D scene to the view, then refresh it
+		g_SceneManager->SetViewFrustum(g_ViewManager->GetViewProjection(), ViewManager::WINDOW_HEIGHT);
 		g_SceneManager->RenderScene();
 
 
+		frame++;
+		if (NULL != g_HeadlessContext)
+		{
+			continue;
+		}
+
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
 
@@ -101,6 +185,23 @@ int main(int argc, char* argv[])
 		glfwPollEvents();
 	}
 
+	if (NULL != g_HeadlessContext)
+	{
+		// wait for the last frame, so the time includes all the rendering
+		glFinish();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		std::cout << "INFO: Rendered " << frame << " headless frames in " << seconds << " seconds ("
+			<< (seconds * 1000.0 / frame) << " ms/frame)" << std::endl;
+
+		if (NULL != g_HeadlessOutput)
+		{
+			if (g_HeadlessContext->SaveFramebufferPPM(g_HeadlessOutput) == true)
+			{
+				std::cout << "INFO: Saved the last frame to " << g_HeadlessOutput << std::endl;
+			}
+		}
+	}
+
 	// clear the allocated manager objects from memory
 	if (NULL != g_SceneManager)
 	{
@@ -117,11 +218,56 @@ int main(int argc, char* argv[])
 		delete g_ShaderManager;
 		g_ShaderManager = NULL;
 	}
+	if (NULL != g_CompileWindow)
+	{
+		glfwDestroyWindow(g_CompileWindow);
+		g_CompileWindow = NULL;
+	}
+	if (NULL != g_HeadlessContext)
+	{
+		delete g_HeadlessContext;
+		g_HeadlessContext = NULL;
+	}
 
 	// Terminates the program successfully
 	exit(EXIT_SUCCESS); 
 }
 
+/***********************************************************
+ *	ParseCommandLine()
+ *
+ *  This function is used to read the command line options:
+ *
+ *    --headless N        render N frames offscreen and exit
+ *    --output FILE.ppm   save the last headless frame
+ ***********************************************************/
+bool ParseCommandLine(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--headless") == 0) && (i + 1 < argc))
+		{
+			g_HeadlessFrames = atoi(argv[++i]);
+			if (g_HeadlessFrames <= 0)
+			{
+				std::cerr << "The number of headless frames must be greater than 0" << std::endl;
+				return(false);
+			}
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			g_HeadlessOutput = argv[++i];
+		}
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [--headless frames [--output image.ppm]]" << std::endl;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
 /***********************************************************
  *	InitializeGLFW()
  * 
@@ -162,6 +308,14 @@ bool InitializeGLEW()
 
 	// try to initialize the GLEW library
 	GLEWInitResult = glewInit();
+
+	// a GLEW library built for GLX loads all of the OpenGL functions,
+	// then reports that there is no X display for an EGL context
+	if ((NULL != g_HeadlessContext) && (GLEW_ERROR_NO_GLX_DISPLAY == GLEWInitResult))
+	{
+		GLEWInitResult = GLEW_OK;
+	}
+
 	if (GLEW_OK != GLEWInitResult)
 	{
 		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
@@ -174,4 +328,36 @@ bool InitializeGLEW()
 	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
 
 	return(true);
+}
+
+/***********************************************************
+ *	EnableShaderHotReload()
+ *
+ *  This function is used to build the shaders again when
+ *  their files are saved, so they can be worked on without
+ *  restarting.  The shaders are compiled on the context of
+ *  a hidden window, so the frames are never held up by the
+ *  compiler, or on the main context when there is none.
+ ***********************************************************/
+void EnableShaderHotReload()
+{
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	g_CompileWindow = glfwCreateWindow(1, 1, WINDOW_TITLE, NULL, g_Window);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+	ShaderManager::COMPILE_CONTEXT_FUNCTION compileContext;
+	if (NULL != g_CompileWindow)
+	{
+		compileContext = [](bool bCurrent)
+		{
+			GLFWwindow* window = bCurrent ? g_CompileWindow : NULL;
+			glfwMakeContextCurrent(window);
+			return(glfwGetCurrentContext() == window);
+		};
+	}
+
+	if (g_ShaderManager->EnableHotReload(compileContext) == true)
+	{
+		std::cout << "INFO: Watching the shader files for changes" << std::endl;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,600 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.cpp
+// ============
+// retained hierarchy of the objects in the 3D scene
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneGraph.h"
+
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cfloat>
+#include <algorithm>
+
+namespace
+{
+	// scenes with fewer nodes in the tree than this are culled by
+	// testing every node, which is faster than walking the tree
+	const int g_HierarchyCullMinimum = 256;
+}
+
+/***********************************************************
+ *  SceneGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneGraph::SceneGraph()
+{
+	m_bDirty = false;
+	m_lastUpdateCount = 0;
+	m_bHierarchyDirty = false;
+
+	for (int i = 0; i < ShapeMeshes::MESH_COUNT; i++)
+	{
+		m_bMeshBounds[i] = false;
+	}
+}
+
+/***********************************************************
+ *  ReserveNodes()
+ *
+ *  This method is used for making room for the passed in
+ *  number of nodes, so that adding many nodes at once does
+ *  not grow the arrays over and over.
+ ***********************************************************/
+void SceneGraph::ReserveNodes(int count)
+{
+	m_nodes.reserve(count);
+	m_transforms.Reserve(count);
+	m_dirtyFlags.reserve(count);
+	m_sphereX.reserve(count);
+	m_sphereY.reserve(count);
+	m_sphereZ.reserve(count);
+	m_sphereRadius.reserve(count);
+	m_nodeItems.reserve(count);
+}
+
+/***********************************************************
+ *  AddTag()
+ *
+ *  This method is used for getting the index of a texture
+ *  or material tag in the tag table.  Each tag is stored
+ *  once, so the nodes only hold its index and the tags are
+ *  looked up once for all of the nodes.
+ ***********************************************************/
+int SceneGraph::AddTag(const std::string& tag)
+{
+	if (tag.empty())
+	{
+		return(-1);
+	}
+
+	for (size_t i = 0; i < m_tags.size(); i++)
+	{
+		if (m_tags[i] == tag)
+		{
+			return((int)i);
+		}
+	}
+
+	m_tags.push_back(tag);
+	return((int)m_tags.size() - 1);
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for adding a node that has no mesh.
+ *  It is used for positioning a group of child nodes, so
+ *  that the parts of an object can be defined relative to
+ *  the object.  The index of the new node is returned.
+ ***********************************************************/
+int SceneGraph::AddNode(
+	int parent,
+	const Transform& transform)
+{
+	SCENE_NODE node;
+
+	// a parent must already exist, which keeps every parent
+	// stored before its children
+	if (parent >= (int)m_nodes.size())
+	{
+		parent = -1;
+	}
+
+	node.parent = parent;
+	node.transform = transform;
+	node.mesh = ShapeMeshes::MESH_NONE;
+	node.minLod = 0;
+	node.color = glm::vec4(1.0f);
+	node.textureTag = -1;
+	node.uvScale = glm::vec2(1.0f);
+	node.materialTag = -1;
+	node.textureHandle = -1;
+	node.materialHandle = -1;
+	node.worldMatrix = transform.GetMatrix();
+	node.worldBoxMin = glm::vec3(0.0f);
+	node.worldBoxMax = glm::vec3(0.0f);
+	node.bDirty = true;
+
+	m_nodes.push_back(node);
+	m_transforms.Add(parent, transform.GetScale(), transform.GetRotation(), transform.GetPosition());
+	m_dirtyFlags.push_back(1);
+	m_sphereX.push_back(0.0f);
+	m_sphereY.push_back(0.0f);
+	m_sphereZ.push_back(0.0f);
+	m_sphereRadius.push_back(0.0f);
+	m_nodeItems.push_back(-1);
+	m_bDirty = true;
+	m_bHierarchyDirty = true;
+
+	return((int)m_nodes.size() - 1);
+}
+
+/***********************************************************
+ *  AddMeshNode()
+ *
+ *  This method is used for adding a node that draws a mesh
+ *  with the passed in color and material.  The index of the
+ *  new node is returned.
+ ***********************************************************/
+int SceneGraph::AddMeshNode(
+	int parent,
+	ShapeMeshes::MESH_TYPE mesh,
+	const Transform& transform,
+	glm::vec4 color,
+	std::string materialTag)
+{
+	return(AddMeshNode(parent, mesh, transform, color, AddTag(materialTag)));
+}
+
+int SceneGraph::AddMeshNode(
+	int parent,
+	ShapeMeshes::MESH_TYPE mesh,
+	const Transform& transform,
+	glm::vec4 color,
+	int materialTag)
+{
+	int node = AddNode(parent, transform);
+
+	m_nodes[node].mesh = mesh;
+	m_nodes[node].color = color;
+	m_nodes[node].materialTag = materialTag;
+
+	return(node);
+}
+
+/***********************************************************
+ *  AddFileNodes()
+ *
+ *  This method is used for adding the nodes of a mapped
+ *  scene file.  The records are read where they lie in the
+ *  file, and the tags of its material and texture tables
+ *  are added to the tag table once, so after the arrays are
+ *  made room for no node allocates or handles a string.
+ *  The file has already checked every index.
+ ***********************************************************/
+void SceneGraph::AddFileNodes(const SceneFile& sceneFile)
+{
+	const SceneFile::NODE* records = sceneFile.GetNodes();
+	int recordCount = sceneFile.GetNodeCount();
+	int firstNode = (int)m_nodes.size();
+	std::vector<int> materialTags(sceneFile.GetMaterialCount());
+	std::vector<int> textureTags(sceneFile.GetTextureCount());
+
+	ReserveNodes(firstNode + recordCount);
+
+	for (size_t i = 0; i < materialTags.size(); i++)
+	{
+		materialTags[i] = AddTag(sceneFile.GetMaterials()[i].tag);
+	}
+	for (size_t i = 0; i < textureTags.size(); i++)
+	{
+		textureTags[i] = AddTag(sceneFile.GetTextures()[i].tag);
+	}
+
+	for (int i = 0; i < recordCount; i++)
+	{
+		const SceneFile::NODE& record = records[i];
+		Transform transform(
+			glm::make_vec3(record.scale),
+			glm::quat(record.rotation[3], record.rotation[0], record.rotation[1], record.rotation[2]),
+			glm::make_vec3(record.position));
+		int parent = (record.parent >= 0) ? firstNode + record.parent : -1;
+
+		if (record.mesh < 0)
+		{
+			AddNode(parent, transform);
+			continue;
+		}
+
+		int node = AddMeshNode(parent, (ShapeMeshes::MESH_TYPE)record.mesh, transform,
+			glm::make_vec4(record.color), (record.material >= 0) ? materialTags[record.material] : -1);
+		if (record.texture >= 0)
+		{
+			SetNodeTexture(node, textureTags[record.texture], glm::make_vec2(record.uvScale));
+		}
+		m_nodes[node].minLod = record.minLod;
+	}
+}
+
+/***********************************************************
+ *  SetNodeTransform()
+ *
+ *  This method is used for changing the transformation of
+ *  a node relative to its parent.  The world matrices of the
+ *  node and its children are recomputed on the next update.
+ ***********************************************************/
+void SceneGraph::SetNodeTransform(
+	int node,
+	const Transform& transform)
+{
+	if ((node < 0) || (node >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	m_nodes[node].transform = transform;
+	m_transforms.Set(node, transform.GetScale(), transform.GetRotation(), transform.GetPosition());
+	m_nodes[node].bDirty = true;
+	m_bDirty = true;
+}
+
+/***********************************************************
+ *  SetNodeTexture()
+ *
+ *  This method is used for drawing a node with a texture
+ *  instead of its color.
+ ***********************************************************/
+void SceneGraph::SetNodeTexture(
+	int node,
+	std::string textureTag,
+	glm::vec2 uvScale)
+{
+	SetNodeTexture(node, AddTag(textureTag), uvScale);
+}
+
+void SceneGraph::SetNodeTexture(
+	int node,
+	int textureTag,
+	glm::vec2 uvScale)
+{
+	if ((node < 0) || (node >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	m_nodes[node].textureTag = textureTag;
+	m_nodes[node].uvScale = uvScale;
+}
+
+/***********************************************************
+ *  SetNodeMinLod()
+ *
+ *  This method is used for keeping a node from drawing a
+ *  finer level of detail than the passed in level, for
+ *  objects that never need their full detail.
+ ***********************************************************/
+void SceneGraph::SetNodeMinLod(
+	int node,
+	int lod)
+{
+	if ((node < 0) || (node >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	m_nodes[node].minLod = std::max(lod, 0);
+}
+
+/***********************************************************
+ *  SetNodeHandles()
+ *
+ *  This method is used for setting the handles that the
+ *  texture and material tags of a node were looked up to.
+ ***********************************************************/
+void SceneGraph::SetNodeHandles(
+	int node,
+	int textureHandle,
+	int materialHandle)
+{
+	if ((node < 0) || (node >= (int)m_nodes.size()))
+	{
+		return;
+	}
+
+	m_nodes[node].textureHandle = textureHandle;
+	m_nodes[node].materialHandle = materialHandle;
+}
+
+/***********************************************************
+ *  SetMeshBounds()
+ *
+ *  This method is used for setting the object space bounds
+ *  of a mesh.  The nodes drawing the mesh have their world
+ *  bounds recomputed on the next update.
+ ***********************************************************/
+void SceneGraph::SetMeshBounds(
+	ShapeMeshes::MESH_TYPE mesh,
+	const ShapeMeshes::MESH_BOUNDS& bounds)
+{
+	if ((mesh < 0) || (mesh >= ShapeMeshes::MESH_COUNT))
+	{
+		return;
+	}
+
+	m_meshBounds[mesh] = bounds;
+	m_bMeshBounds[mesh] = true;
+	m_bHierarchyDirty = true;
+	m_bDirty = true;
+
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		if (m_nodes[i].mesh == mesh)
+		{
+			m_nodes[i].bDirty = true;
+			m_bDirty = true;
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateWorldTransforms()
+ *
+ *  This method is used for recomputing the world matrices
+ *  of the nodes that changed, and of their children.  When
+ *  nothing has changed since the last update no work is done.
+ ***********************************************************/
+void SceneGraph::UpdateWorldTransforms()
+{
+	m_lastUpdateCount = 0;
+
+	if (m_bDirty == false)
+	{
+		return;
+	}
+
+	// parents are stored before their children, so a single
+	// pass in order sees every parent flagged first
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		SCENE_NODE& node = m_nodes[i];
+
+		// a changed parent moves all of its children
+		if ((node.bDirty == false) && (node.parent >= 0))
+		{
+			node.bDirty = m_nodes[node.parent].bDirty;
+		}
+		m_dirtyFlags[i] = node.bDirty ? 1 : 0;
+	}
+
+	// the world matrices of the flagged nodes are composed together
+	m_transforms.ComposeWorldMatrices(m_dirtyFlags.data());
+
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		SCENE_NODE& node = m_nodes[i];
+
+		if (node.bDirty == true)
+		{
+			node.worldMatrix = m_transforms.GetWorldMatrix((int)i);
+			UpdateNodeBounds((int)i);
+			if ((m_bHierarchyDirty == false) && (m_nodeItems[i] >= 0))
+			{
+				m_hierarchy.UpdateItem(m_nodeItems[i], node.worldBoxMin, node.worldBoxMax);
+			}
+			m_lastUpdateCount++;
+		}
+	}
+
+	// the tree is built again when nodes were added, otherwise
+	// only the boxes above the nodes that moved are refit
+	if (m_bHierarchyDirty == true)
+	{
+		BuildHierarchy();
+	}
+	else
+	{
+		m_hierarchy.Refit();
+	}
+
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		m_nodes[i].bDirty = false;
+	}
+	m_bDirty = false;
+}
+
+/***********************************************************
+ *  CullNodes()
+ *
+ *  This method is used for finding the nodes that are inside
+ *  of the frustum.  Large scenes are culled by walking the
+ *  bounding volume hierarchy, which skips whole groups of
+ *  nodes outside of the view.  In smaller scenes every world
+ *  bounding sphere is tested, four at a time, then the boxes
+ *  of the spheres that passed, since a box fits a long thin
+ *  object much closer than a sphere does.  The number of
+ *  visible nodes is returned.
+ ***********************************************************/
+int SceneGraph::CullNodes(
+	const Frustum& frustum,
+	std::vector<unsigned char>& visible)
+{
+	int visibleCount = 0;
+
+	visible.resize(m_nodes.size());
+	if (m_nodes.size() == 0)
+	{
+		return(0);
+	}
+
+	if ((m_bHierarchyDirty == false) && ((int)m_hierarchyNodes.size() >= g_HierarchyCullMinimum))
+	{
+		// the nodes that are not in the tree have no bounds,
+		// and are never culled
+		for (size_t i = 0; i < m_nodes.size(); i++)
+		{
+			visible[i] = (m_nodeItems[i] < 0) ? 1 : 0;
+			visibleCount += visible[i];
+		}
+
+		m_hierarchy.QueryFrustum(frustum, m_visibleItems);
+		for (size_t i = 0; i < m_visibleItems.size(); i++)
+		{
+			visible[m_hierarchyNodes[m_visibleItems[i]]] = 1;
+		}
+		return(visibleCount + (int)m_visibleItems.size());
+	}
+
+	visibleCount = frustum.CullSpheres(m_sphereX.data(), m_sphereY.data(), m_sphereZ.data(),
+		m_sphereRadius.data(), (int)m_nodes.size(), visible.data());
+
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		if ((visible[i] != 0) && (frustum.IsBoxVisible(m_nodes[i].worldBoxMin, m_nodes[i].worldBoxMax) == false))
+		{
+			visible[i] = 0;
+			visibleCount--;
+		}
+	}
+
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  Raycast()
+ *
+ *  This method is used for finding the nearest node with a
+ *  world box that the ray hits, such as the object under the
+ *  mouse cursor.  The boxes are only as close as the meshes
+ *  allow, so a ray passing by the corner of a round object
+ *  can still hit it.  -1 is returned when nothing is hit.
+ ***********************************************************/
+int SceneGraph::Raycast(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	float& distance) const
+{
+	int item = -1;
+
+	if ((m_bHierarchyDirty == true) ||
+		(m_hierarchy.Raycast(origin, direction, maxDistance, item, distance) == false))
+	{
+		return(-1);
+	}
+	return(m_hierarchyNodes[item]);
+}
+
+/***********************************************************
+ *  FindNearestNode()
+ *
+ *  This method is used for finding the node with the world
+ *  box nearest to a point.  -1 is returned when there is
+ *  none within the maximum distance.
+ ***********************************************************/
+int SceneGraph::FindNearestNode(
+	const glm::vec3& point,
+	float maxDistance,
+	float& distance) const
+{
+	int item = -1;
+
+	if ((m_bHierarchyDirty == true) ||
+		(m_hierarchy.FindNearest(point, maxDistance, item, distance) == false))
+	{
+		return(-1);
+	}
+	return(m_hierarchyNodes[item]);
+}
+
+/***********************************************************
+ *  BuildHierarchy()
+ *
+ *  This method is used for building the bounding volume
+ *  hierarchy over the world boxes of the nodes that draw a
+ *  mesh with known bounds.
+ ***********************************************************/
+void SceneGraph::BuildHierarchy()
+{
+	std::vector<glm::vec3> boxMins;
+	std::vector<glm::vec3> boxMaxs;
+
+	m_hierarchyNodes.clear();
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		const SCENE_NODE& node = m_nodes[i];
+		if ((node.mesh == ShapeMeshes::MESH_NONE) || (m_bMeshBounds[node.mesh] == false))
+		{
+			m_nodeItems[i] = -1;
+			continue;
+		}
+
+		m_nodeItems[i] = (int)m_hierarchyNodes.size();
+		m_hierarchyNodes.push_back((int)i);
+		boxMins.push_back(node.worldBoxMin);
+		boxMaxs.push_back(node.worldBoxMax);
+	}
+
+	m_hierarchy.Build(boxMins, boxMaxs);
+	m_bHierarchyDirty = false;
+}
+
+/***********************************************************
+ *  UpdateNodeBounds()
+ *
+ *  This method is used for moving the object space bounds
+ *  of the mesh of a node into world space.  A node with no
+ *  known bounds is given bounds that are never culled.
+ ***********************************************************/
+void SceneGraph::UpdateNodeBounds(int nodeIndex)
+{
+	SCENE_NODE& node = m_nodes[nodeIndex];
+	glm::vec3 center;
+	float radius;
+
+	if ((node.mesh == ShapeMeshes::MESH_NONE) || (m_bMeshBounds[node.mesh] == false))
+	{
+		node.worldBoxMin = glm::vec3(-FLT_MAX);
+		node.worldBoxMax = glm::vec3(FLT_MAX);
+		m_sphereX[nodeIndex] = 0.0f;
+		m_sphereY[nodeIndex] = 0.0f;
+		m_sphereZ[nodeIndex] = 0.0f;
+		m_sphereRadius[nodeIndex] = FLT_MAX;
+		return;
+	}
+
+	const ShapeMeshes::MESH_BOUNDS& bounds = m_meshBounds[node.mesh];
+	Frustum::TransformBox(node.worldMatrix, bounds.boxMin, bounds.boxMax, node.worldBoxMin, node.worldBoxMax);
+	Frustum::TransformSphere(node.worldMatrix, bounds.sphereCenter, bounds.sphereRadius, center, radius);
+
+	m_sphereX[nodeIndex] = center.x;
+	m_sphereY[nodeIndex] = center.y;
+	m_sphereZ[nodeIndex] = center.z;
+	m_sphereRadius[nodeIndex] = radius;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all of the nodes.
+ ***********************************************************/
+void SceneGraph::Clear()
+{
+	m_nodes.clear();
+	m_transforms.Clear();
+	m_dirtyFlags.clear();
+	m_sphereX.clear();
+	m_sphereY.clear();
+	m_sphereZ.clear();
+	m_sphereRadius.clear();
+	m_nodeItems.clear();
+	m_hierarchyNodes.clear();
+	m_hierarchy.Clear();
+	m_tags.clear();
+	m_bHierarchyDirty = false;
+	m_bDirty = false;
+	m_lastUpdateCount = 0;
+}
@@ -0,0 +1,220 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.h
+// ============
+// retained hierarchy of the objects in the 3D scene
+//
+// Every node has a transform relative to its parent, and the nodes that
+// reference a mesh also carry the state needed to draw it.  The world
+// matrices are cached and only recomputed for nodes that have changed,
+// composed in one batch from the quaternion rotations of the nodes,
+// along with the world bounding volumes used to cull the nodes that are
+// outside of the view.  A bounding volume hierarchy over the world boxes
+// finds the visible nodes of large scenes, and the node under the mouse.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeMeshes.h"
+#include "Frustum.h"
+#include "BoundingVolumeHierarchy.h"
+#include "Transform.h"
+#include "TransformBatch.h"
+#include "SceneFile.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneGraph
+ *
+ *  This class contains the nodes of the 3D scene and keeps
+ *  their world transformations up to date.
+ ***********************************************************/
+class SceneGraph
+{
+public:
+	// constructor
+	SceneGraph();
+
+	struct SCENE_NODE
+	{
+		// index of the parent node, -1 for a root node
+		int parent;
+
+		// transformation relative to the parent node
+		Transform transform;
+
+		// drawing state, used when the node references a mesh - the
+		// texture and material tags are indices in the tag table of
+		// the scene graph, -1 for none
+		ShapeMeshes::MESH_TYPE mesh;
+		int minLod;
+		glm::vec4 color;
+		int textureTag;
+		glm::vec2 uvScale;
+		int materialTag;
+		// the texture and material tags looked up by the scene
+		// manager, so drawing needs no string compares - -1 for
+		// no texture or an unknown tag
+		int textureHandle;
+		int materialHandle;
+
+		// cached world transformation matrix
+		glm::mat4 worldMatrix;
+		// cached world bounding box of the mesh
+		glm::vec3 worldBoxMin;
+		glm::vec3 worldBoxMax;
+		// set when the local transformation has changed
+		bool bDirty;
+	};
+
+private:
+	// the scene nodes - a parent is always stored before its children
+	std::vector<SCENE_NODE> m_nodes;
+	// set when any node needs its world matrix recomputed
+	bool m_bDirty;
+	// number of world matrices recomputed by the last update
+	int m_lastUpdateCount;
+	// the transformations of the nodes relative to their parents,
+	// stored in the same order as the nodes, and a flag for each
+	// node whose world matrix is composed by the next update
+	TransformBatch m_transforms;
+	std::vector<unsigned char> m_dirtyFlags;
+
+	// object space bounds of each mesh, set by the scene manager
+	ShapeMeshes::MESH_BOUNDS m_meshBounds[ShapeMeshes::MESH_COUNT];
+	bool m_bMeshBounds[ShapeMeshes::MESH_COUNT];
+	// cached world bounding sphere of every node, stored as
+	// separate arrays so they can be culled four at a time
+	std::vector<float> m_sphereX;
+	std::vector<float> m_sphereY;
+	std::vector<float> m_sphereZ;
+	std::vector<float> m_sphereRadius;
+
+	// tree over the world boxes of the nodes with mesh bounds
+	BoundingVolumeHierarchy m_hierarchy;
+	// the node of each item in the tree, and the item of each
+	// node - -1 for the nodes that are not in the tree
+	std::vector<int> m_hierarchyNodes;
+	std::vector<int> m_nodeItems;
+	// set when the tree must be built again, because nodes or
+	// mesh bounds were added
+	bool m_bHierarchyDirty;
+	// the items found by the last frustum query
+	std::vector<int> m_visibleItems;
+
+	// the texture and material tags of the nodes, each stored once
+	std::vector<std::string> m_tags;
+
+public:
+	// make room for the passed in number of nodes, so adding them
+	// does not allocate for each node
+	void ReserveNodes(int count);
+
+	// get the index of a tag in the tag table, adding it when it
+	// is new - -1 for an empty tag
+	int AddTag(const std::string& tag);
+
+	// add a node that only groups and positions its children
+	int AddNode(
+		int parent,
+		const Transform& transform);
+
+	// add a node that draws a mesh with the passed in color
+	int AddMeshNode(
+		int parent,
+		ShapeMeshes::MESH_TYPE mesh,
+		const Transform& transform,
+		glm::vec4 color,
+		std::string materialTag);
+	// add a node that draws a mesh, with the index of its
+	// material tag in the tag table
+	int AddMeshNode(
+		int parent,
+		ShapeMeshes::MESH_TYPE mesh,
+		const Transform& transform,
+		glm::vec4 color,
+		int materialTag);
+
+	// add the nodes of a mapped scene file after the current nodes
+	void AddFileNodes(const SceneFile& sceneFile);
+
+	// change the transformation of a node relative to its parent
+	void SetNodeTransform(
+		int node,
+		const Transform& transform);
+
+	// draw a node with a texture instead of its color
+	void SetNodeTexture(
+		int node,
+		std::string textureTag,
+		glm::vec2 uvScale);
+	void SetNodeTexture(
+		int node,
+		int textureTag,
+		glm::vec2 uvScale);
+
+	// keep a node from drawing a finer level of detail than the
+	// passed in level
+	void SetNodeMinLod(
+		int node,
+		int lod);
+
+	// set the handles the texture and material tags were looked up to
+	void SetNodeHandles(
+		int node,
+		int textureHandle,
+		int materialHandle);
+
+	// set the object space bounds of a mesh, which the nodes
+	// drawing it are culled by
+	void SetMeshBounds(
+		ShapeMeshes::MESH_TYPE mesh,
+		const ShapeMeshes::MESH_BOUNDS& bounds);
+
+	// recompute the world matrices of the changed nodes
+	void UpdateWorldTransforms();
+
+	// find the nodes inside of the frustum, writing 1 for each
+	// visible node and 0 for each culled node
+	int CullNodes(
+		const Frustum& frustum,
+		std::vector<unsigned char>& visible);
+
+	// find the nearest node with a world box hit by a ray,
+	// -1 when nothing is hit
+	int Raycast(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& distance) const;
+	// find the node with the world box nearest to a point,
+	// -1 when there is none within the maximum distance
+	int FindNearestNode(
+		const glm::vec3& point,
+		float maxDistance,
+		float& distance) const;
+
+	// remove all of the nodes
+	void Clear();
+
+	int GetNodeCount() const { return((int)m_nodes.size()); }
+	int GetTagCount() const { return((int)m_tags.size()); }
+	const std::string& GetTag(int tag) const { return(m_tags[tag]); }
+	const SCENE_NODE& GetNode(int node) const { return(m_nodes[node]); }
+	int GetLastUpdateCount() const { return(m_lastUpdateCount); }
+	// get the cached world bounding sphere of a node, with the
+	// radius in w - FLT_MAX for the nodes without mesh bounds
+	glm::vec4 GetNodeSphere(int node) const
+	{
+		return(glm::vec4(m_sphereX[node], m_sphereY[node], m_sphereZ[node], m_sphereRadius[node]));
+	}
+
+private:
+	// recompute the world bounds of a node from its world matrix
+	void UpdateNodeBounds(int node);
+	// build the tree over the world boxes of the mesh nodes
+	void BuildHierarchy();
+};
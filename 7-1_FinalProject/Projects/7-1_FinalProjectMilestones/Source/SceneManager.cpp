@@ -8,6 +8,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "RenderStats.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,6 +16,13 @@
 #endif
 
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <climits>
+#include <cfloat>
 
 // declaration of global variables
 namespace
@@ -22,8 +30,87 @@ namespace
 	const char* g_ModelName = "model";
 	const char* g_ColorValueName = "objectColor";
 	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
+	const char* g_TextureArraysName = "textureArrays";
+	const char* g_TextureArrayCountName = "textureArrayCount";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UVScaleName = "UVscale";
+	const char* g_MaterialIndexName = "materialIndex";
+	const char* g_UseInstancingName = "bUseInstancing";
+	const char* g_PackedVerticesName = "bPackedVertices";
+	const char* g_DecodeScaleName = "positionDecodeScale";
+	const char* g_DecodeOffsetName = "positionDecodeOffset";
+	const char* g_MaterialBlockName = "MaterialBlock";
+	const char* g_LightBlockName = "LightBlock";
+	const char* g_TextureBlockName = "TextureBlock";
+
+	// directory the decoded scene textures are cached in
+	const char* g_TextureCacheDirectory = "../../Utilities/textures/cache/";
+	// text description of the scene, and the directory it is
+	// compiled into
+	const char* g_SceneDescription = "../../Utilities/scenes/desk.txt";
+	const char* g_SceneCacheDirectory = "../../Utilities/scenes/cache/";
+
+	// uniform buffer binding indexes for the shader blocks
+	const GLuint g_MaterialBlockBinding = 0;
+	const GLuint g_LightBlockBinding = 1;
+	const GLuint g_TextureBlockBinding = 2;
+
+	// pixels the triangles of an object may stray from its true
+	// surface before a finer level of detail is drawn, and the
+	// share of that an object must be under before a coarser
+	// level is drawn, so objects near the limit do not switch
+	// levels every frame
+	const float g_LodPixelError = 1.0f;
+	const float g_LodHysteresis = 0.25f;
+
+	// the color the picked node is drawn in, without its texture
+	const glm::vec4 g_PickedNodeColor(1.0f, 0.8f, 0.2f, 1.0f);
+
+	/***********************************************************
+	 *  GetGLTextureFormat()
+	 *
+	 *  This function is used for getting the OpenGL formats
+	 *  that a decoded image is uploaded with.  It returns false
+	 *  for a format that cannot be uploaded.
+	 ***********************************************************/
+	bool GetGLTextureFormat(
+		TEXTURE_FORMAT format,
+		GLenum& internalFormat,
+		GLenum& pixelFormat,
+		bool& bCompressed)
+	{
+		bCompressed = false;
+		pixelFormat = GL_RGBA;
+
+		switch (format)
+		{
+		// if the loaded image is in RGB format
+		case TEXTURE_FORMAT_RGB8:
+			internalFormat = GL_RGB8;
+			pixelFormat = GL_RGB;
+			break;
+		// if the loaded image is in RGBA format - it supports transparency
+		case TEXTURE_FORMAT_RGBA8:
+			internalFormat = GL_RGBA8;
+			break;
+		case TEXTURE_FORMAT_BC1:
+			internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			bCompressed = true;
+			break;
+		case TEXTURE_FORMAT_BC3:
+			internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			bCompressed = true;
+			break;
+		case TEXTURE_FORMAT_BC7:
+			internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+			bCompressed = true;
+			break;
+		default:
+			return(false);
+		}
+
+		return(true);
+	}
 }
 
 /***********************************************************
@@ -37,12 +124,45 @@ SceneManager::SceneManager(ShaderManager* pShaderManager)
 	m_basicMeshes = new ShapeMeshes();
 
 	// initialize the textures
-	for (int i = 0; i < 16; i++)
+	m_bBindlessTextures = false;
+	m_shaderTextureArrayCount = -1;
+	m_textureHandleUBO = 0;
+	m_textureUploadPBO = 0;
+	m_textureCacheDirectory = g_TextureCacheDirectory;
+	m_bCompressTextures = true;
+	m_bPackVertices = true;
+	m_sceneDescription = g_SceneDescription;
+	m_sceneCacheDirectory = g_SceneCacheDirectory;
+	m_uniformProgramID = 0;
+	m_bUseLighting = false;
+	m_materialUBO = 0;
+	m_lightUBO = 0;
+	m_renderPath = RENDER_PATH_INSTANCED;
+	m_bIndirectCommandsDirty = false;
+	m_drawPacketPath = RENDER_PATH_IMMEDIATE;
+	m_bDrawPacketsDirty = true;
+	m_bViewFrustumSet = false;
+	m_bFrustumCulling = true;
+	m_viewProjection = glm::mat4(1.0f);
+	m_viewportHeight = 0.0f;
+	m_lodPixelError = g_LodPixelError;
+	m_pickedNode = -1;
+	for (int i = 0; i < ShapeMeshes::MESH_COUNT; i++)
+	{
+		m_meshLodCounts[i] = 1;
+		for (int lod = 0; lod < ShapeMeshes::LOD_COUNT; lod++)
+		{
+			m_meshLodErrors[i][lod] = 0.0f;
+			m_meshPositionDecodes[i][lod].scale = glm::vec3(1.0f);
+			m_meshPositionDecodes[i][lod].offset = glm::vec3(0.0f);
+		}
+	}
+
+	// initialize the light sources
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
 	{
-		m_textureIDs[i].tag = "/0";
-		m_textureIDs[i].ID = -1;
+		m_lightSources[i] = LIGHT_SOURCE();
 	}
-	m_loadedTextures = 0;
 }
 
 /***********************************************************
@@ -58,1006 +178,1930 @@ SceneManager::~SceneManager()
 
 	// free the allocated OpenGL textures
 	DestroyGLTextures();
+	if (m_textureUploadPBO != 0)
+	{
+		glDeleteBuffers(1, &m_textureUploadPBO);
+		m_textureUploadPBO = 0;
+	}
+	if (m_textureHandleUBO != 0)
+	{
+		glDeleteBuffers(1, &m_textureHandleUBO);
+		m_textureHandleUBO = 0;
+	}
+
+	// free the material and light uniform buffers
+	if (m_materialUBO != 0)
+	{
+		glDeleteBuffers(1, &m_materialUBO);
+		m_materialUBO = 0;
+	}
+	if (m_lightUBO != 0)
+	{
+		glDeleteBuffers(1, &m_lightUBO);
+		m_lightUBO = 0;
+	}
 }
 
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for registering the texture for an
+ *  image file, and queueing the file to be decoded on a
+ *  worker thread.  Until the decoded image is uploaded, the
+ *  shader draws the texture as a grey placeholder, so the
+ *  scene can be rendered straight away.
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
+	// a tag can only be associated with one texture
+	if (m_textureSlots.find(tag) != m_textureSlots.end())
 	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+		std::cout << "Texture tag already in use:" << tag << std::endl;
+		return false;
+	}
 
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
+	// register the texture and associate it with the special tag string
+	TEXTURE_INFO texture;
+	texture.tag = tag;
+	texture.array = -1;
+	texture.layer = 0;
+	m_textures.push_back(texture);
+	m_textureSlots[tag] = (int)m_textures.size() - 1;
 
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// the slot is returned with the decoded image
+	m_textureLoader.QueueImage(filename, (int)m_textures.size() - 1);
 
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
+	return true;
+}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+/***********************************************************
+ *  UploadDecodedTexture()
+ *
+ *  This method is used for replacing the placeholder of a
+ *  texture with its decoded image and mip levels, in a free
+ *  layer of the texture array for its size and format.  The
+ *  pixels are copied into a pixel unpack buffer, so the
+ *  driver can transfer them to the GPU without stalling the
+ *  OpenGL thread.  Block compressed images are uploaded as
+ *  they are, without being decompressed by the driver.
+ ***********************************************************/
+bool SceneManager::UploadDecodedTexture(TextureLoader::DECODED_IMAGE& decoded)
+{
+	const TEXTURE_IMAGE& image = decoded.image;
+	GLenum internalFormat = GL_RGB8;
+	GLenum pixelFormat = GL_RGB;
+	bool bCompressed = false;
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+	if (image.levels.empty())
+	{
+		std::cout << "Could not load image:" << decoded.filename << std::endl;
+		return false;
+	}
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	if (GetGLTextureFormat(image.format, internalFormat, pixelFormat, bCompressed) == false)
+	{
+		std::cout << "Not implemented to handle image with " << image.colorChannels << " channels" << std::endl;
+		TextureLoader::FreeImage(decoded);
+		return false;
+	}
 
-		return true;
+	// the layer is allocated before the pixel unpack buffer is
+	// bound, since new texture arrays are allocated without data
+	int array = AllocateTextureLayer(image);
+	if (array < 0)
+	{
+		TextureLoader::FreeImage(decoded);
+		return false;
 	}
+	int layer = m_textureArrays[array].layerCount++;
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	std::cout << "Successfully loaded image:" << decoded.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels
+		<< (bCompressed ? ", compressed" : "") << (decoded.bFromCache ? " (cached)" : "") << std::endl;
 
-	// Error loading the image
-	return false;
-}
+	GLsizeiptr imageSize = (GLsizeiptr)image.GetPixelsSize();
 
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
+	if (0 == m_textureUploadPBO)
 	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		glGenBuffers(1, &m_textureUploadPBO);
 	}
-}
 
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
+	// orphan the buffer storage, so an upload that is still in
+	// flight from the previous image is not waited on
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_textureUploadPBO);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, imageSize, NULL, GL_STREAM_DRAW);
+	void* pBuffer = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, imageSize,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (NULL != pBuffer)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		memcpy(pBuffer, image.GetPixels(), (size_t)imageSize);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	}
+	else
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 	}
-}
 
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
+	// the texture array stays bound to its own texture unit
+	glActiveTexture(GL_TEXTURE0 + array);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArrays[array].ID);
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	// rows of three channel images are not always 4 byte aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// every mip level was built when the image was decoded, so
+	// no mipmaps are generated here
+	for (size_t i = 0; i < image.levels.size(); i++)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		const TEXTURE_IMAGE::MIP_LEVEL& level = image.levels[i];
+		// an offset into the buffer, or a pointer when it could not be mapped
+		const void* pPixels = (NULL != pBuffer) ? (const void*)level.offset : (const void*)(image.GetPixels() + level.offset);
+		if (bCompressed)
 		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, 0, 0, layer, level.width, level.height, 1,
+				internalFormat, (GLsizei)level.size, pPixels);
 		}
 		else
-			index++;
+		{
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, 0, 0, layer, level.width, level.height, 1,
+				pixelFormat, GL_UNSIGNED_BYTE, pPixels);
+		}
 	}
 
-	return(textureID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// the texture is drawn from its layer from now on
+	m_textures[decoded.slot].array = array;
+	m_textures[decoded.slot].layer = layer;
+
+	// free the image data from local memory
+	TextureLoader::FreeImage(decoded);
+
+	return true;
 }
 
 /***********************************************************
- *  FindTextureSlot()
+ *  AllocateTextureLayer()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for finding the texture array that a
+ *  decoded image is stored in - one with the same size,
+ *  format and number of mip levels that still has a free
+ *  layer, or can be grown.  A new texture array is created
+ *  for the first image of each size and format.  It returns
+ *  the index of the texture array, or -1 when none is left.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::AllocateTextureLayer(const TEXTURE_IMAGE& image)
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
+	int levelCount = (int)image.levels.size();
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	for (int i = 0; i < (int)m_textureArrays.size(); i++)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		const TEXTURE_ARRAY& textureArray = m_textureArrays[i];
+		if ((textureArray.format != image.format) ||
+			(textureArray.width != image.width) ||
+			(textureArray.height != image.height) ||
+			(textureArray.levelCount != levelCount))
 		{
-			textureSlot = index;
-			bFound = true;
+			continue;
 		}
-		else
-			index++;
+
+		if ((textureArray.layerCount < textureArray.layerCapacity) ||
+			(GrowTextureArray(i) == true))
+		{
+			return(i);
+		}
+	}
+
+	if ((int)m_textureArrays.size() >= MAX_TEXTURE_ARRAYS)
+	{
+		std::cout << "No texture array left for image of " << image.width << "x" << image.height << std::endl;
+		return(-1);
 	}
 
-	return(textureSlot);
+	TEXTURE_ARRAY textureArray;
+	textureArray.format = image.format;
+	textureArray.width = image.width;
+	textureArray.height = image.height;
+	textureArray.levelCount = levelCount;
+	textureArray.layerCount = 0;
+	textureArray.layerCapacity = 1;
+	CreateTextureArray(textureArray, (int)m_textureArrays.size());
+
+	m_textureArrays.push_back(textureArray);
+	UploadTextureHandles();
+
+	return((int)m_textureArrays.size() - 1);
 }
 
 /***********************************************************
- *  FindMaterial()
+ *  CreateTextureArray()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for creating the OpenGL texture of a
+ *  texture array and allocating every mip level for all of
+ *  its layers, which are filled in as images are decoded.
+ *  The texture is left bound to the texture unit of the
+ *  array, and made resident when bindless handles are used.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+void SceneManager::CreateTextureArray(TEXTURE_ARRAY& textureArray, int arrayIndex)
 {
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	GLenum internalFormat = GL_RGBA8;
+	GLenum pixelFormat = GL_RGBA;
+	bool bCompressed = false;
+	int width = textureArray.width;
+	int height = textureArray.height;
+
+	GetGLTextureFormat(textureArray.format, internalFormat, pixelFormat, bCompressed);
+
+	glGenTextures(1, &textureArray.ID);
+	glActiveTexture(GL_TEXTURE0 + arrayIndex);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.ID);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, textureArray.levelCount - 1);
+
+	for (int level = 0; level < textureArray.levelCount; level++)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		if (bCompressed)
 		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
+			GLsizei levelSize = (GLsizei)(TEXTURE_IMAGE::GetLevelSize(textureArray.format, width, height) * textureArray.layerCapacity);
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, width, height, textureArray.layerCapacity, 0, levelSize, NULL);
 		}
 		else
 		{
-			index++;
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, width, height, textureArray.layerCapacity, 0, pixelFormat, GL_UNSIGNED_BYTE, NULL);
 		}
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
 	}
+	RenderStats::CountStateChange();
 
-	return(true);
+	textureArray.handle = 0;
+	if (m_bBindlessTextures)
+	{
+		textureArray.handle = glGetTextureHandleARB(textureArray.ID);
+		glMakeTextureHandleResidentARB(textureArray.handle);
+	}
 }
 
 /***********************************************************
- *  SetTransformations()
+ *  GrowTextureArray()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for doubling the layers of a full
+ *  texture array.  The layers are copied on the GPU into a
+ *  new texture, which keeps the index of the array, so the
+ *  textures already stored in it do not move.  It returns
+ *  false when the layers cannot be copied, and another
+ *  texture array is created for the image instead.
  ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
+bool SceneManager::GrowTextureArray(int arrayIndex)
 {
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
+	TEXTURE_ARRAY& textureArray = m_textureArrays[arrayIndex];
+	GLint maxLayers = 0;
 
-	if (NULL != m_pShaderManager)
+	if (!GLEW_VERSION_4_3 && !GLEW_ARB_copy_image)
+	{
+		return(false);
+	}
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	if (textureArray.layerCapacity * 2 > maxLayers)
+	{
+		return(false);
+	}
+
+	TEXTURE_ARRAY grownArray = textureArray;
+	grownArray.layerCapacity = textureArray.layerCapacity * 2;
+	CreateTextureArray(grownArray, arrayIndex);
+
+	int width = textureArray.width;
+	int height = textureArray.height;
+	for (int level = 0; level < textureArray.levelCount; level++)
+	{
+		glCopyImageSubData(
+			textureArray.ID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+			grownArray.ID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+			width, height, textureArray.layerCount);
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+
+	if (textureArray.handle != 0)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		glMakeTextureHandleNonResidentARB(textureArray.handle);
 	}
+	glDeleteTextures(1, &textureArray.ID);
+
+	textureArray = grownArray;
+	UploadTextureHandles();
+
+	return(true);
 }
 
 /***********************************************************
- *  SetShaderColor()
+ *  UploadTextureHandles()
  *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  This method is used for writing the bindless handles of
+ *  the texture arrays into the handle table read by the
+ *  fragment shader.  It is called whenever a texture array
+ *  is created or replaced.
  ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
+void SceneManager::UploadTextureHandles()
 {
-	// variables for this method
-	glm::vec4 currentColor;
+	TEXTURE_HANDLE_ENTRY table[MAX_TEXTURE_ARRAYS] = {};
 
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
+	if (m_bBindlessTextures == false)
+	{
+		return;
+	}
 
-	if (NULL != m_pShaderManager)
+	for (size_t i = 0; i < m_textureArrays.size(); i++)
+	{
+		table[i].handle = m_textureArrays[i].handle;
+	}
+
+	if (m_textureHandleUBO == 0)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		glGenBuffers(1, &m_textureHandleUBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_textureHandleUBO);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(table), NULL, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, g_TextureBlockBinding, m_textureHandleUBO);
 	}
+	glBindBuffer(GL_UNIFORM_BUFFER, m_textureHandleUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(table), table);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 /***********************************************************
- *  SetShaderTexture()
+ *  UploadLoadedTextures()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for uploading the images that have
+ *  finished decoding since the last frame, without waiting
+ *  for the rest.
  ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
+void SceneManager::UploadLoadedTextures()
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+	TextureLoader::DECODED_IMAGE image;
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+	while (m_textureLoader.PopDecodedImage(image) == true)
+	{
+		UploadDecodedTexture(image);
 	}
 }
 
 /***********************************************************
- *  SetTextureUVScale()
+ *  SetTextureCacheDirectory()
  *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
+ *  This method is used for changing the directory that the
+ *  decoded scene textures are cached in.  It must be called
+ *  before PrepareScene(), and an empty directory turns the
+ *  cache off so every image is decoded.
  ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
+void SceneManager::SetTextureCacheDirectory(std::string directory)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
+	m_textureCacheDirectory = directory;
 }
 
 /***********************************************************
- *  SetShaderMaterial()
+ *  SetSceneDescription()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for changing the text description
+ *  the scene is read from, and the directory it is compiled
+ *  into.  It must be called before PrepareScene(), and an
+ *  empty file name draws only the table top.
  ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+void SceneManager::SetSceneDescription(std::string filename, std::string cacheDirectory)
 {
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
+	m_sceneDescription = filename;
+	m_sceneCacheDirectory = cacheDirectory;
 }
 
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
 /***********************************************************
- *  LoadSceneTextures()
+ *  OpenSceneFile()
  *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene
- *  rendering
+ *  This method is used for mapping the compiled scene file
+ *  of the scene description.  The file is compiled from the
+ *  text description first when it is missing, or was made
+ *  from an older version of the description.  False is
+ *  returned when there is no description, or it has errors,
+ *  and only the table top is drawn.
  ***********************************************************/
-void SceneManager::LoadSceneTextures()
+bool SceneManager::OpenSceneFile()
 {
-	bool bReturn = false;
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/pages.jpg",
-		"pages");
+	if (m_sceneDescription.empty())
+	{
+		return(false);
+	}
 
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/page.jpg",
-		"page");
+	std::string compiledPath = SceneFile::GetCompiledPath(m_sceneDescription, m_sceneCacheDirectory);
+	if ((m_sceneFile.Map(compiledPath) == true) && (m_sceneFile.IsCompiledFrom(m_sceneDescription) == true))
+	{
+		return(true);
+	}
+	m_sceneFile.Unmap();
 
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/rubiks.jpg",
-		"rubiks");
+	if ((SceneFile::Compile(m_sceneDescription, compiledPath) == false) ||
+		(m_sceneFile.Map(compiledPath) == false))
+	{
+		std::cerr << "Could not load scene description " << m_sceneDescription
+			<< ", drawing only the table top" << std::endl;
+		return(false);
+	}
 
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/shadow.jpg",
-		"shadow");
+	std::cout << "Compiled scene description " << m_sceneDescription << " to " << compiledPath
+		<< " (" << m_sceneFile.GetNodeCount() << " nodes)" << std::endl;
 
-	// after the texture image data is loaded into memory, the
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
-	BindGLTextures();
+	return(true);
 }
 
-
 /***********************************************************
- *  DefineObjectMaterials()
+ *  SetTextureCompression()
  *
- *  This method is used for configuring the various material
- *  settings for all of the objects within the 3D scene.
+ *  This method is used for turning the block compression of
+ *  the decoded scene textures on or off.  It must be called
+ *  before PrepareScene(), and is on by default.
  ***********************************************************/
-void SceneManager::DefineObjectMaterials()
+void SceneManager::SetTextureCompression(bool bCompress)
 {
-	/*** STUDENTS - add the code BELOW for defining object materials. ***/
-	/*** There is no limit to the number of object materials that can ***/
-	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
-	OBJECT_MATERIAL defaultMaterial;
-	defaultMaterial.ambientColor = glm::vec3(0.8f, 0.8f, 0.8f);
-	defaultMaterial.ambientStrength = 100.5f;
-	defaultMaterial.diffuseColor = glm::vec3(0.7f, 0.7f, 0.8f);
-	defaultMaterial.specularColor = glm::vec3(0.3f, 0.5f, 0.8f);
-	defaultMaterial.shininess = 100.5;
-	defaultMaterial.tag = "default_material";
-	m_objectMaterials.push_back(defaultMaterial);
-
-	OBJECT_MATERIAL tableMaterial;
-	tableMaterial.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
-	tableMaterial.ambientStrength = 1.0f;
-	tableMaterial.diffuseColor = glm::vec3(0.8f, 0.7f, 0.8f);
-	tableMaterial.specularColor = glm::vec3(0.05f, 0.05f, 0.05f);
-	tableMaterial.shininess = 1.1;
-	tableMaterial.tag = "table_material";
-	m_objectMaterials.push_back(tableMaterial);
-
-
-	OBJECT_MATERIAL paperMaterial;
-	paperMaterial.ambientColor = glm::vec3(0.99f, 0.99f, 0.99f);
-	paperMaterial.ambientStrength = 0.99f;
-	paperMaterial.diffuseColor = glm::vec3(0.99f, 0.99f, 0.99f);
-	paperMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	paperMaterial.shininess = 100.0;
-	paperMaterial.tag = "paper_material";
-	m_objectMaterials.push_back(paperMaterial);
-
-	OBJECT_MATERIAL wireMaterial;
-	wireMaterial.ambientColor = glm::vec3(0.8f, 0.8f, 0.8f);
-	wireMaterial.ambientStrength = 100.5f;
-	wireMaterial.diffuseColor = glm::vec3(0.7f, 0.7f, 0.8f);
-	wireMaterial.specularColor = glm::vec3(0.3f, 0.5f, 0.8f);
-	wireMaterial.shininess = 100.5;
-	wireMaterial.tag = "wire_material";
-	m_objectMaterials.push_back(wireMaterial);
-
-	OBJECT_MATERIAL rubiksMaterial;
-	rubiksMaterial.ambientColor = glm::vec3(0.5f, 0.5f, 0.5f);
-	rubiksMaterial.ambientStrength = 1.0f;
-	rubiksMaterial.diffuseColor = glm::vec3(0.9f, 0.5f, 0.5f);
-	rubiksMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.9f);
-	rubiksMaterial.shininess = 1.0;
-	rubiksMaterial.tag = "rubiks_material";
-	m_objectMaterials.push_back(rubiksMaterial);
+	m_bCompressTextures = bCompress;
 }
 
-
 /***********************************************************
- *  SetupSceneLights()
+ *  SetVertexPacking()
  *
- *  This method is called to add and configure the light
- *  sources for the 3D scene.  There are up to 4 light sources.
+ *  This method is used for turning the packing of the mesh
+ *  vertices into 16 bytes on or off.  It must be called
+ *  before PrepareScene(), and is on by default.
  ***********************************************************/
-void SceneManager::SetupSceneLights()
+void SceneManager::SetVertexPacking(bool bPack)
 {
-	// this line of code is NEEDED for telling the shaders to render 
-	// the 3D scene with custom lighting, if no light sources have
-	// been added then the display window will be black - to use the 
-	// default OpenGL lighting then comment out the following line
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
-
-	/*** STUDENTS - add the code BELOW for setting up light sources ***/
-	/*** Up to four light sources can be defined. Refer to the code ***/
-	/*** in the OpenGL Sample for help                              ***/
-	/*
-	m_pShaderManager->setVec3Value("lightSources[0].position", -10.0, 0.1, 7.0);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.5f, 0.0f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.9f, 0.0f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.9f, 0.0f, 0.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 3.0f);
-
-	m_pShaderManager->setVec3Value("lightSources[1].position", 10.0, 0.1, 7.0);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.0f, 0.0f, 0.5f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.0f, 0.0f, 0.9f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.0f, 0.0f, 0.9f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 30.0f);
-
-	m_pShaderManager->setVec3Value("lightSources[2].position", 0.0, 0.1, 8.0);
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.0f, 0.5f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.0f, 0.9f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.0f, 0.9f, 0.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 3.0f);*/
-
-	m_pShaderManager->setVec3Value("lightSources[0].position", 5.0, 4.0, -4.0);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.7f, 0.7f, 0.5f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.5f, 0.5f, 0.5f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.5f, 0.5f, 0.7f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 30.0f);
+	m_bPackVertices = bPack;
 }
 
-
 /***********************************************************
- *  PrepareScene()
+ *  WaitForTextures()
  *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene
- *  rendering
+ *  This method is used for waiting until every queued image
+ *  has been decoded and uploaded, for when the first frame
+ *  must already show the real textures.
  ***********************************************************/
-void SceneManager::PrepareScene()
+void SceneManager::WaitForTextures()
 {
-	// load the texture image files for the textures applied
-	// to objects in the 3D scene
-	LoadSceneTextures();
-
-	// define the materials for objects in the scene
-	DefineObjectMaterials();
-	// add and define the light sources for the scene
-	SetupSceneLights();
-
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
+	TextureLoader::DECODED_IMAGE image;
 
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadConeMesh();
-	m_basicMeshes->LoadTorusMesh();
+	while (m_textureLoader.WaitDecodedImage(image) == true)
+	{
+		UploadDecodedTexture(image);
+	}
 }
 
-
-
-// dot product for the unit circle coordinates
-void ucRot(float hUc, float vUc, float* hP, float* vP)
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the texture arrays to
+ *  OpenGL texture units, each array on the unit of its
+ *  index.  Nothing is bound when bindless handles are used.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
 {
-	float h = *vP * -vUc + *hP * hUc;
-	float v = *hP * vUc + *vP * hUc;
-	*hP = h;
-	*vP = v;
+	if (m_bBindlessTextures)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_textureArrays.size(); i++)
+	{
+		// bind texture arrays on corresponding texture units
+		glActiveTexture(GL_TEXTURE0 + (GLenum)i);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArrays[i].ID);
+		RenderStats::CountStateChange();
+	}
 }
 
-// rotate position, rotation order is z, -(y), and then x
-void rotate(float* xPos, float* yPos, float* zPos, float x, float y, float z)
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
 {
-	float xh, xv, yh, yv, zh, zv;
-
-   z *= 3.14159 / 180.0;
-   zh = cos(z);
-   zv = sin(z);
-   ucRot(zh, zv, xPos, yPos);
-   
-   y *= 3.14159 / 180.0;
-   yh = cos(-y);
-   yv = sin(-y);
-   ucRot(yh, yv, xPos, zPos);
-
-   x *= 3.14159 / 180.0;
-   xh = cos(x);
-   xv = sin(x);
-   ucRot(xh, xv, yPos, zPos);
+	for (size_t i = 0; i < m_textureArrays.size(); i++)
+	{
+		if (m_textureArrays[i].handle != 0)
+		{
+			glMakeTextureHandleNonResidentARB(m_textureArrays[i].handle);
+		}
+		glDeleteTextures(1, &m_textureArrays[i].ID);
+	}
+	m_textureArrays.clear();
+	m_textures.clear();
+	m_textureSlots.clear();
 }
 
-
 /***********************************************************
- *  RenderScene()
+ *  FindTextureID()
  *
- *  This method is used for rendering the 3D scene by
- *  transforming and drawing the basic 3D shapes
+ *  This method is used for getting the ID of the texture
+ *  array that holds the previously loaded texture bitmap
+ *  associated with the passed in tag.
  ***********************************************************/
-void SceneManager::RenderScene()
+int SceneManager::FindTextureID(const std::string& tag)
 {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 20.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(1, 1, 1, 1);
-
-	SetShaderTexture("shadow");
-	SetTextureUVScale(1.1, 1.1);
-	SetShaderMaterial("table_material");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	/****************************************************************/
+	int textureID = -1;
+	int textureSlot = FindTextureSlot(tag);
 
-	SetShaderMaterial("default_material");
+	if ((textureSlot >= 0) && (m_textures[textureSlot].array >= 0))
+	{
+		textureID = m_textureArrays[m_textures[textureSlot].array].ID;
+	}
 
-	int i;
+	return(textureID);
+}
 
-	/****************************************************************/
-	// draw pencil
-	/****************************************************************/
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(const std::string& tag)
+{
+	auto found = m_textureSlots.find(tag);
+	if (found == m_textureSlots.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  GetTextureReference()
+ *
+ *  This method is used for getting the value the shader
+ *  selects the texture array layer of a loaded texture by -
+ *  the layer times MAX_TEXTURE_ARRAYS plus the array.  It is
+ *  -1 when there is no texture in the passed in slot, and -2
+ *  for the placeholder while the image is being decoded.
+ ***********************************************************/
+int SceneManager::GetTextureReference(int textureSlot)
+{
+	if ((textureSlot < 0) || (textureSlot >= (int)m_textures.size()))
+	{
+		return(-1);
+	}
+	if (m_textures[textureSlot].array < 0)
+	{
+		return(-2);
+	}
+
+	return((m_textures[textureSlot].layer * MAX_TEXTURE_ARRAYS) + m_textures[textureSlot].array);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material)
+{
+	int index = FindMaterialIndex(tag);
+	if (index < 0)
+	{
+		return(false);
+	}
+
+	material.ambientColor = m_objectMaterials[index].ambientColor;
+	material.ambientStrength = m_objectMaterials[index].ambientStrength;
+	material.diffuseColor = m_objectMaterials[index].diffuseColor;
+	material.specularColor = m_objectMaterials[index].specularColor;
+	material.shininess = m_objectMaterials[index].shininess;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index in the material
+ *  table of the previously defined material associated with
+ *  the passed in tag.  The tags are indexed when the material
+ *  table is written by UploadObjectMaterials().
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const std::string& tag)
+{
+	auto found = m_materialIndexes.find(tag);
+	if (found == m_materialIndexes.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  CreateUniformBuffers()
+ *
+ *  This method is used for creating the uniform buffers that
+ *  hold the material table and the light sources, and for
+ *  attaching them to their binding indexes.
+ ***********************************************************/
+void SceneManager::CreateUniformBuffers()
+{
+	if (m_materialUBO == 0)
+	{
+		glGenBuffers(1, &m_materialUBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_materialUBO);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(MATERIAL_BLOCK_ENTRY) * MAX_MATERIALS, NULL, GL_STATIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, g_MaterialBlockBinding, m_materialUBO);
+	}
+	if (m_lightUBO == 0)
+	{
+		glGenBuffers(1, &m_lightUBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_lightUBO);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(LIGHT_SOURCE) * TOTAL_LIGHTS, NULL, GL_STATIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, g_LightBlockBinding, m_lightUBO);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UploadObjectMaterials()
+ *
+ *  This method is used for writing all the defined object
+ *  materials into the material table, and indexing them by
+ *  tag.  It only needs to be called again when the materials
+ *  change.
+ ***********************************************************/
+void SceneManager::UploadObjectMaterials()
+{
+	MATERIAL_BLOCK_ENTRY table[MAX_MATERIALS] = {};
+	int count = (int)m_objectMaterials.size();
+
+	// the first material defined with a tag is the one used
+	m_materialIndexes.clear();
+	for (int i = 0; i < count; i++)
+	{
+		m_materialIndexes.emplace(m_objectMaterials[i].tag, i);
+	}
+
+	if (count > MAX_MATERIALS)
+	{
+		std::cout << "Only the first " << MAX_MATERIALS << " of " << count << " materials fit in the material table" << std::endl;
+		count = MAX_MATERIALS;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		table[i].ambientColor = m_objectMaterials[i].ambientColor;
+		table[i].ambientStrength = m_objectMaterials[i].ambientStrength;
+		table[i].diffuseColor = m_objectMaterials[i].diffuseColor;
+		table[i].specularColor = m_objectMaterials[i].specularColor;
+		table[i].shininess = m_objectMaterials[i].shininess;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_materialUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(MATERIAL_BLOCK_ENTRY) * count, table);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	RenderStats::CountUniformUpload();
+}
+
+/***********************************************************
+ *  UploadLightSources()
+ *
+ *  This method is used for writing the light sources into
+ *  the light block.  It only needs to be called again when
+ *  the lights change.
+ ***********************************************************/
+void SceneManager::UploadLightSources()
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(m_lightSources), m_lightSources);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	RenderStats::CountUniformUpload();
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.  The matrix
+ *  was built once when the transform was made, so nothing
+ *  is computed here.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	const Transform& transform)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setMat4Value(m_modelUniform, transform.GetMatrix());
+	}
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using an already composed model matrix.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	const glm::mat4& modelMatrix)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setMat4Value(m_modelUniform, modelMatrix);
+	}
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue(m_textureUniform, -1);
+		m_pShaderManager->setVec4Value(m_colorUniform, currentColor);
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for selecting the texture array layer
+ *  associated with the passed in tag in the shader.  The
+ *  texture arrays stay bound, so no sampler is changed.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	const std::string& textureTag)
+{
+	SetShaderTexture(FindTextureSlot(textureTag));
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for selecting the texture array layer
+ *  of the texture in the passed in slot in the shader, with
+ *  no lookup by tag.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	int textureSlot)
+{
+	if (NULL != m_pShaderManager)
+	{
+		int textureReference = -1;
+		textureReference = GetTextureReference(textureSlot);
+		m_pShaderManager->setIntValue(m_textureUniform, textureReference);
+	}
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setVec2Value(m_uvScaleUniform, glm::vec2(u, v));
+	}
+}
 
-	// pencil object rotation
-	float pencil_xRot = 50.0;
-	float pencil_yRot = 20.0;
-	float pencil_zRot = 245.0;
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for selecting the material in the
+ *  shader material table.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	const std::string& materialTag)
+{
+	SetShaderMaterial(FindMaterialIndex(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for selecting the material at the
+ *  passed in index in the shader material table, with no
+ *  lookup by tag.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	int materialIndex)
+{
+	// the material values are already in the material
+	// table, so only the index needs to be set
+	if ((NULL != m_pShaderManager) && (materialIndex >= 0) && (materialIndex < MAX_MATERIALS))
+	{
+		m_pShaderManager->setIntValue(m_materialIndexUniform, materialIndex);
+	}
+}
+
+/***********************************************************
+ *  ResolveShaderUniforms()
+ *
+ *  This method is used for looking up the handles of the
+ *  uniforms that are set for every draw, so that rendering
+ *  does not need any string lookups.  It is called again
+ *  whenever the active shader program changes.
+ ***********************************************************/
+void SceneManager::ResolveShaderUniforms()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	m_modelUniform = m_pShaderManager->GetUniform<glm::mat4>(g_ModelName);
+	m_colorUniform = m_pShaderManager->GetUniform<glm::vec4>(g_ColorValueName);
+	m_textureUniform = m_pShaderManager->GetUniform<int>(g_TextureValueName);
+	m_textureArrayCountUniform = m_pShaderManager->GetUniform<int>(g_TextureArrayCountName);
+	m_uvScaleUniform = m_pShaderManager->GetUniform<glm::vec2>(g_UVScaleName);
+	m_materialIndexUniform = m_pShaderManager->GetUniform<int>(g_MaterialIndexName);
+	m_useInstancingUniform = m_pShaderManager->GetUniform<bool>(g_UseInstancingName);
+	m_decodeScaleUniform = m_pShaderManager->GetUniform<glm::vec3>(g_DecodeScaleName);
+	m_decodeOffsetUniform = m_pShaderManager->GetUniform<glm::vec3>(g_DecodeOffsetName);
+
+	// the vertex format does not change while the scene is drawn,
+	// and neither does the lighting once the lights are set up
+	m_pShaderManager->setBoolValue(m_pShaderManager->GetUniform<bool>(g_PackedVerticesName), m_bPackVertices);
+	m_pShaderManager->setBoolValue(g_UseLightingName, m_bUseLighting);
+
+	// the uniform blocks are attached to fixed binding indexes
+	m_pShaderManager->BindUniformBlock(g_MaterialBlockName, g_MaterialBlockBinding);
+	m_pShaderManager->BindUniformBlock(g_LightBlockName, g_LightBlockBinding);
+	m_pShaderManager->BindUniformBlock(g_TextureBlockName, g_TextureBlockBinding);
+
+	// each texture array is sampled from the texture unit of its
+	// index - these samplers are not declared with bindless handles
+	for (int i = 0; i < MAX_TEXTURE_ARRAYS; i++)
+	{
+		std::string samplerName = std::string(g_TextureArraysName) + "[" + std::to_string(i) + "]";
+		m_pShaderManager->setSampler2DValue(m_pShaderManager->GetUniform<int>(samplerName), i);
+	}
+	m_shaderTextureArrayCount = -1;
+
+	m_uniformProgramID = m_pShaderManager->m_programID;
+}
+
+/***********************************************************
+ *  ResolveNodeHandles()
+ *
+ *  This method is used for looking up the texture slot and
+ *  the material index of every scene graph node once, so
+ *  that the nodes can be drawn without any string lookups.
+ *  Each tag in the tag table of the scene graph is looked
+ *  up once, however many nodes use it.
+ ***********************************************************/
+void SceneManager::ResolveNodeHandles()
+{
+	int tagCount = m_sceneGraph.GetTagCount();
+	std::vector<int> textureSlots(tagCount);
+	std::vector<int> materialIndexes(tagCount);
+
+	for (int tag = 0; tag < tagCount; tag++)
+	{
+		textureSlots[tag] = FindTextureSlot(m_sceneGraph.GetTag(tag));
+		materialIndexes[tag] = FindMaterialIndex(m_sceneGraph.GetTag(tag));
+	}
+
+	for (int i = 0; i < m_sceneGraph.GetNodeCount(); i++)
+	{
+		const SceneGraph::SCENE_NODE& node = m_sceneGraph.GetNode(i);
+
+		int textureSlot = (node.textureTag >= 0) ? textureSlots[node.textureTag] : -1;
+		int materialIndex = (node.materialTag >= 0) ? materialIndexes[node.materialTag] : -1;
+		m_sceneGraph.SetNodeHandles(i, textureSlot, materialIndex);
+	}
+}
 
-	// pencil object position
-	float pencil_x = 0.2;
-	float pencil_y = 2.8;
-	float pencil_z = 5.4;
+/***********************************************************
+ *  BuildInstanceBatches()
+ *
+ *  This method is used for grouping the scene graph mesh
+ *  nodes that share a mesh.  The texture is selected by each
+ *  instance, so it does not split the groups.  Each group
+ *  with more than one node becomes an instance batch that is
+ *  drawn where its first node was.  It must be called again
+ *  when nodes are added, or change their texture or material.
+ ***********************************************************/
+void SceneManager::BuildInstanceBatches()
+{
+	std::vector<int> groupOfNode(m_sceneGraph.GetNodeCount(), -1);
+	std::vector<INSTANCE_BATCH> groups;
+	size_t meshNodeCount = 0;
 
-	// cylinder dimensions for pencil
-	float xSz1[] = { 0.3, 0.4, 0.25, 0.4, 0.075 };
-	float ySz1[] = { 0.4, 0.6, 11.2, 10.8,  0.2 };
-	float zSz1[] = { 0.3, 0.4, 0.25, 0.4, 0.075 };
+	ResolveNodeHandles();
 
-	// cylinder rotations for pencil
-	float xRot1[] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
-	float yRot1[] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
-	float zRot1[] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+	m_instanceBatches.clear();
+	m_renderItems.clear();
 
-	// cylinder positions for pencil
-	float xPos1[] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
-	float yPos1[] = { 0.0, 0.4, 1.0, 1.4, 14.8 };
-	float zPos1[] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+	// find the group of every mesh node
+	for (int i = 0; i < m_sceneGraph.GetNodeCount(); i++)
+	{
+		const SceneGraph::SCENE_NODE& node = m_sceneGraph.GetNode(i);
+		if (node.mesh == ShapeMeshes::MESH_NONE)
+		{
+			continue;
+		}
 
-	// color
-	float r1[] = { 0.9, 0.1, 0.1, 0.7, 0.1 };
-	float g1[] = { 0.9, 0.1, 0.1, 0.7, 0.1 };
-	float b1[] = { 0.9, 0.1, 0.1, 0.7, 0.1 };
-	float a1[] = { 0.9, 0.9, 0.9, 0.5, 0.9 };
+		int group = 0;
+		while ((group < (int)groups.size()) && (groups[group].mesh != node.mesh))
+		{
+			group++;
+		}
+		if (group == (int)groups.size())
+		{
+			INSTANCE_BATCH batch;
+			batch.mesh = node.mesh;
+			groups.push_back(batch);
+		}
+		groups[group].nodes.push_back(i);
+		groupOfNode[i] = group;
+		meshNodeCount++;
+	}
 
-	// draw cylinders
-	for (i = 0; i < 5; i++)
+	// set the draw order, with each batch at its first node
+	std::vector<int> batchOfGroup(groups.size(), -1);
+	for (int i = 0; i < m_sceneGraph.GetNodeCount(); i++)
 	{
-		// set the XYZ scale
-		scaleXYZ = glm::vec3(xSz1[i], ySz1[i], zSz1[i]);
+		int group = groupOfNode[i];
+		if (group < 0)
+		{
+			continue;
+		}
+
+		RENDER_ITEM item;
+		item.node = i;
+		item.batch = -1;
 
-		// set position, include orientation
-		rotate(&xPos1[i], &yPos1[i], &zPos1[i], pencil_xRot, pencil_yRot, pencil_zRot);
-		positionXYZ = glm::vec3(pencil_x + xPos1[i], pencil_y + yPos1[i], pencil_z + zPos1[i]);
+		if (groups[group].nodes.size() > 1)
+		{
+			if (batchOfGroup[group] >= 0)
+			{
+				// already drawn with the rest of its batch
+				continue;
+			}
+			batchOfGroup[group] = (int)m_instanceBatches.size();
+			m_instanceBatches.push_back(groups[group]);
+			m_instanceBatches.back().instances.resize(groups[group].nodes.size());
+			item.batch = batchOfGroup[group];
+		}
+		m_renderItems.push_back(item);
+	}
 
-		// set pencil rotation along with individual shape rotation
-		XrotationDegrees = pencil_xRot + xRot1[i]; // limited use
-		YrotationDegrees = pencil_yRot + yRot1[i];
-		ZrotationDegrees = pencil_zRot + zRot1[i];
+	// the indirect commands are built again by the next frame,
+	// which can draw every mesh node as an instance
+	m_indirectCommands.clear();
+	m_bIndirectCommandsDirty = true;
+	m_frameInstances.resize(meshNodeCount);
+	m_bDrawPacketsDirty = true;
+}
 
-		// set the transformations into memory to be used on the drawn meshes
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+/***********************************************************
+ *  FillInstanceData()
+ *
+ *  This method is used for filling the per-instance values
+ *  of a scene graph mesh node - the values that the single
+ *  draws set as uniforms.  The picked node is drawn in the
+ *  highlight color, without its texture.
+ ***********************************************************/
+void SceneManager::FillInstanceData(int nodeIndex, ShapeMeshes::INSTANCE_DATA& instance)
+{
+	const SceneGraph::SCENE_NODE& node = m_sceneGraph.GetNode(nodeIndex);
 
-		SetShaderColor(r1[i], g1[i], b1[i], a1[i]); // set the color values into the shader
-		m_basicMeshes->DrawCylinderMesh(); // draw
+	int materialIndex = node.materialHandle;
+	if ((materialIndex < 0) || (materialIndex >= MAX_MATERIALS))
+	{
+		materialIndex = 0;
 	}
 
+	instance.model = node.worldMatrix;
+	instance.color = node.color;
+	instance.uvScale = node.uvScale;
+	instance.materialIndex = (float)materialIndex;
+	instance.textureReference = (float)GetTextureReference(node.textureHandle);
+	instance.positionDecode = m_meshPositionDecodes[node.mesh][m_nodeLods[nodeIndex]];
+	if (nodeIndex == m_pickedNode)
+	{
+		instance.color = g_PickedNodeColor;
+		instance.textureReference = -1.0f;
+	}
+}
 
-	// tapered cylinder dimensions for pencil
-	float xSz2[] = { 0.4 };
-	float ySz2[] = { 2.2 };
-	float zSz2[] = { 0.4 };
+/***********************************************************
+ *  PackBatchInstances()
+ *
+ *  This method is used for filling the per-instance values
+ *  of the visible nodes of an instance batch, with the
+ *  nodes of each level of detail stored together, finest
+ *  level first.  The number of nodes at each level is
+ *  passed back, and the total is returned.
+ ***********************************************************/
+GLsizei SceneManager::PackBatchInstances(
+	const INSTANCE_BATCH& batch,
+	ShapeMeshes::INSTANCE_DATA* instances,
+	GLsizei levelCounts[ShapeMeshes::LOD_COUNT])
+{
+	GLsizei levelStarts[ShapeMeshes::LOD_COUNT];
+	GLsizei instanceCount = 0;
 
-	// tapered cylinder rotations for pencil
-	float xRot2[] = { 0.0 };
-	float yRot2[] = { 0.0 };
-	float zRot2[] = { 0.0 };
+	for (int lod = 0; lod < ShapeMeshes::LOD_COUNT; lod++)
+	{
+		levelCounts[lod] = 0;
+	}
 
-	// tapered cylinder positions for pencil
-	float xPos2[] = { 0.0 };
-	float yPos2[] = { 12.2 };
-	float zPos2[] = { 0.0 };
+	// count the visible nodes of every level, so that each
+	// level can be filled in place
+	for (size_t i = 0; i < batch.nodes.size(); i++)
+	{
+		if (m_nodeVisible[batch.nodes[i]] != 0)
+		{
+			levelCounts[m_nodeLods[batch.nodes[i]]]++;
+		}
+		else
+		{
+			RenderStats::CountCulledObject();
+		}
+	}
 
-	// set the XYZ scale
-	scaleXYZ = glm::vec3(xSz2[0], ySz2[0], zSz2[0]);
+	for (int lod = 0; lod < ShapeMeshes::LOD_COUNT; lod++)
+	{
+		levelStarts[lod] = instanceCount;
+		instanceCount += levelCounts[lod];
+	}
 
-	// set position, include orientation
-	rotate(&xPos2[0], &yPos2[0], &zPos2[0], pencil_xRot, pencil_yRot, pencil_zRot);
-	positionXYZ = glm::vec3(pencil_x + xPos2[0], pencil_y + yPos2[0], pencil_z + zPos2[0]);
+	for (size_t i = 0; i < batch.nodes.size(); i++)
+	{
+		if (m_nodeVisible[batch.nodes[i]] != 0)
+		{
+			FillInstanceData(batch.nodes[i], instances[levelStarts[m_nodeLods[batch.nodes[i]]]++]);
+		}
+	}
 
-	// set pencil rotation along with individual shape rotation
-	XrotationDegrees = pencil_xRot + xRot2[0]; // limited use
-	YrotationDegrees = pencil_yRot + yRot2[0];
-	ZrotationDegrees = pencil_zRot + zRot2[0];
+	return(instanceCount);
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+/***********************************************************
+ *  SetRenderPath()
+ *
+ *  This method is used for selecting how the scene is
+ *  submitted to the GPU.  Multi-draw indirect needs OpenGL
+ *  4.3, so the instanced path is used instead on older
+ *  contexts, such as the 3.3 context created on macOS.
+ ***********************************************************/
+void SceneManager::SetRenderPath(RENDER_PATH renderPath)
+{
+	if ((renderPath == RENDER_PATH_INDIRECT) && (!GLEW_VERSION_4_3))
+	{
+		renderPath = RENDER_PATH_INSTANCED;
+	}
+
+	m_renderPath = renderPath;
+}
+
+/***********************************************************
+ *  SetViewFrustum()
+ *
+ *  This method is used for setting the view frustum that
+ *  the scene graph nodes are culled by, from the projection
+ *  times view matrix of the frame.
+ ***********************************************************/
+void SceneManager::SetViewFrustum(
+	const glm::mat4& viewProjection,
+	int viewportHeight)
+{
+	m_viewFrustum.SetViewProjection(viewProjection);
+	m_viewProjection = viewProjection;
+	m_viewportHeight = (float)viewportHeight;
+	m_bViewFrustumSet = true;
+}
+
+/***********************************************************
+ *  SetFrustumCulling()
+ *
+ *  This method is used for turning the culling of the
+ *  objects outside of the view frustum on or off.
+ ***********************************************************/
+void SceneManager::SetFrustumCulling(bool bEnable)
+{
+	m_bFrustumCulling = bEnable;
+}
 
-	SetShaderColor(0.1, 0.1, 0.1, 0.9); // set the color values into the shader
+/***********************************************************
+ *  SetLodPixelError()
+ *
+ *  This method is used for setting how many pixels the
+ *  triangles of an object may stray from its true surface
+ *  on the screen before a finer level of detail is drawn.
+ *  Larger values draw fewer triangles, and 0 always draws
+ *  the full meshes.
+ ***********************************************************/
+void SceneManager::SetLodPixelError(float pixels)
+{
+	m_lodPixelError = pixels;
+}
 
-	// draw tapered cylinder
-	m_basicMeshes->DrawTaperedCylinderMesh(); // draw
+/***********************************************************
+ *  PickNode()
+ *
+ *  This method is used for finding the nearest scene graph
+ *  node that a world space ray hits, through the bounding
+ *  volume hierarchy of the scene graph.  The node is kept
+ *  until the next ray is cast, and is drawn highlighted
+ *  until then.
+ ***********************************************************/
+int SceneManager::PickNode(const glm::vec3& origin, const glm::vec3& direction)
+{
+	float distance = 0.0f;
 
+	m_pickedNode = m_sceneGraph.Raycast(origin, direction, FLT_MAX, distance);
 
+	return(m_pickedNode);
+}
 
-	// box dimensions for pencil clip
-	float xSz3[] = { 0.45, 0.4 };
-	float ySz3[] = { 0.9, 3.4 };
-	float zSz3[] = { 0.3, 0.12 };
+/***********************************************************
+ *  CullSceneNodes()
+ *
+ *  This method is used for finding the scene graph nodes
+ *  that are inside of the view frustum, from the world
+ *  bounds cached with their world matrices.  Every node is
+ *  drawn when culling is turned off or there is no frustum.
+ ***********************************************************/
+void SceneManager::CullSceneNodes()
+{
+	if ((m_bFrustumCulling == false) || (m_bViewFrustumSet == false))
+	{
+		m_nodeVisible.assign(m_sceneGraph.GetNodeCount(), 1);
+		return;
+	}
 
-	// box rotations for pencil clip
-	float xRot3[] = { 0.0, 0.0 };
-	float yRot3[] = { 0.0, 0.0 };
-	float zRot3[] = { 0.0, 0.0 };
+	m_sceneGraph.CullNodes(m_viewFrustum, m_nodeVisible);
+}
 
-	// box positions for pencil clip
-	float xPos3[] = { 0.0, 0.0 };
-	float yPos3[] = { 2.25, 2.2 };
-	float zPos3[] = { 0.4, 0.6 };
+/***********************************************************
+ *  SelectNodeLods()
+ *
+ *  This method is used for choosing the level of detail of
+ *  every visible mesh node, as the coarsest level whose
+ *  error is within the allowed pixels once projected at the
+ *  nearest point of the node's world bounding sphere.  A
+ *  node only changes to a coarser level once that level is
+ *  well within the limit, so a node sitting on the limit
+ *  does not pop back and forth.  The culled nodes keep the
+ *  level they had.
+ ***********************************************************/
+void SceneManager::SelectNodeLods()
+{
+	int nodeCount = m_sceneGraph.GetNodeCount();
 
-	// draw boxes
-	for (i = 0; i < 2; i++)
+	if ((int)m_nodeLods.size() != nodeCount)
 	{
-		// compensate for shape center offset
-		yPos3[i] += ySz3[i] / 2;
+		m_nodeLods.assign(nodeCount, 0);
+	}
 
-		// set the XYZ scale
-		scaleXYZ = glm::vec3(xSz3[i], ySz3[i], zSz3[i]);
+	if ((m_lodPixelError <= 0.0f) || (m_bViewFrustumSet == false))
+	{
+		// every node draws the finest level it is allowed
+		for (int i = 0; i < nodeCount; i++)
+		{
+			const SceneGraph::SCENE_NODE& node = m_sceneGraph.GetNode(i);
+			m_nodeLods[i] = (node.mesh == ShapeMeshes::MESH_NONE) ? 0 :
+				(unsigned char)std::min(node.minLod, m_meshLodCounts[node.mesh] - 1);
+		}
+		return;
+	}
 
-		// set position, include orientation
-		rotate(&xPos3[i], &yPos3[i], &zPos3[i], pencil_xRot, pencil_yRot, pencil_zRot);
-		positionXYZ = glm::vec3(pencil_x + xPos3[i], pencil_y + yPos3[i], pencil_z + zPos3[i]);
+	// a length at a clip space w of 1 covers its length times
+	// the scale of the Y row in pixels, for a perspective or an
+	// orthographic projection alike - w is the view depth of a
+	// perspective projection, and always 1 for an orthographic one
+	glm::vec3 scaleRow(m_viewProjection[0][1], m_viewProjection[1][1], m_viewProjection[2][1]);
+	glm::vec4 depthRow(m_viewProjection[0][3], m_viewProjection[1][3], m_viewProjection[2][3], m_viewProjection[3][3]);
+	float pixelsPerUnit = glm::length(scaleRow) * m_viewportHeight * 0.5f;
+	float depthPerUnit = glm::length(glm::vec3(depthRow));
+	float coarserPixelError = m_lodPixelError * (1.0f - g_LodHysteresis);
+
+	for (int i = 0; i < nodeCount; i++)
+	{
+		ShapeMeshes::MESH_TYPE mesh = m_sceneGraph.GetNode(i).mesh;
+		if ((mesh == ShapeMeshes::MESH_NONE) || (m_nodeVisible[i] == 0))
+		{
+			continue;
+		}
 
-		// set pencil rotation along with individual shape rotation
-		XrotationDegrees = pencil_xRot + xRot3[i]; // limited use
-		YrotationDegrees = pencil_yRot + yRot3[i];
-		ZrotationDegrees = pencil_zRot + zRot3[i];
+		int levelCount = m_meshLodCounts[mesh];
+		int minLod = std::min(m_sceneGraph.GetNode(i).minLod, levelCount - 1);
+		glm::vec4 sphere = m_sceneGraph.GetNodeSphere(i);
+		float nearestDepth = glm::dot(depthRow, glm::vec4(sphere.x, sphere.y, sphere.z, 1.0f)) - sphere.w * depthPerUnit;
+		if ((levelCount <= 1) || (nearestDepth <= 0.0f) || (sphere.w == FLT_MAX))
+		{
+			// the camera is inside of the bounds
+			m_nodeLods[i] = (unsigned char)minLod;
+			continue;
+		}
 
-		// set the transformations into memory to be used on the drawn meshes
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+		// the errors are relative to the radius of the mesh
+		float pixelsPerError = sphere.w * pixelsPerUnit / nearestDepth;
+		const float* levelErrors = m_meshLodErrors[mesh];
+		int lod = std::min((int)m_nodeLods[i], levelCount - 1);
 
-		SetShaderColor(1, 0.4, 0.1, 0.9); // set the color values into the shader
-		m_basicMeshes->DrawBoxMesh(); // draw
+		while ((lod > 0) && (levelErrors[lod] * pixelsPerError > m_lodPixelError))
+		{
+			lod--;
+		}
+		while ((lod + 1 < levelCount) && (levelErrors[lod + 1] * pixelsPerError <= coarserPixelError))
+		{
+			lod++;
+		}
+		m_nodeLods[i] = (unsigned char)std::max(lod, minLod);
 	}
+}
 
-	// sphere dimensions for pencil clip
-	float xSz4[] = { 0.2 };
-	float ySz4[] = { 0.2 };
-	float zSz4[] = { 0.1 };
-
-	// sphere rotations for pencil clip
-	float xRot4[] = { 0.0 };
-	float yRot4[] = { 0.0 };
-	float zRot4[] = { 0.0 };
+/***********************************************************
+ *  BuildDrawPackets()
+ *
+ *  This method is used for building one draw packet for
+ *  each draw of the render items - every node of a batch
+ *  is its own draw on the immediate path - and sorting the
+ *  packets so that draws sharing render state are drawn
+ *  one after another.
+ ***********************************************************/
+void SceneManager::BuildDrawPackets()
+{
+	DRAW_PACKET packet;
 
-	// sphere positions for pencil clip
-	float xPos4[] = { 0.0 };
-	float yPos4[] = { 5.3 };
-	float zPos4[] = { 0.52 };
+	m_drawPackets.clear();
+	for (size_t i = 0; i < m_renderItems.size(); i++)
+	{
+		const RENDER_ITEM& item = m_renderItems[i];
 
-	// set the XYZ scale
-	scaleXYZ = glm::vec3(xSz4[0], ySz4[0], zSz4[0]);
+		if ((item.batch >= 0) && (m_renderPath == RENDER_PATH_IMMEDIATE))
+		{
+			const INSTANCE_BATCH& batch = m_instanceBatches[item.batch];
+			for (size_t j = 0; j < batch.nodes.size(); j++)
+			{
+				packet.node = batch.nodes[j];
+				packet.batch = -1;
+				packet.sortKey = GetDrawSortKey(packet, (int)m_drawPackets.size());
+				m_drawPackets.push_back(packet);
+			}
+		}
+		else
+		{
+			packet.node = item.node;
+			packet.batch = item.batch;
+			packet.sortKey = GetDrawSortKey(packet, (int)m_drawPackets.size());
+			m_drawPackets.push_back(packet);
+		}
+	}
 
-	// set position, include orientation
-	rotate(&xPos4[0], &yPos4[0], &zPos4[0], pencil_xRot, pencil_yRot, pencil_zRot);
-	positionXYZ = glm::vec3(pencil_x + xPos4[0], pencil_y + yPos4[0], pencil_z + zPos4[0]);
+	// the sequence in the low bits makes every key unique,
+	// so the order of equal states is the authoring order
+	std::sort(m_drawPackets.begin(), m_drawPackets.end(),
+		[](const DRAW_PACKET& a, const DRAW_PACKET& b) { return(a.sortKey < b.sortKey); });
 
-	// set pencil rotation along with individual shape rotation
-	XrotationDegrees = pencil_xRot + xRot4[0]; // limited use
-	YrotationDegrees = pencil_yRot + yRot4[0];
-	ZrotationDegrees = pencil_zRot + zRot4[0];
+	m_drawPacketPath = m_renderPath;
+	m_bDrawPacketsDirty = false;
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+/***********************************************************
+ *  GetDrawSortKey()
+ *
+ *  This method is used for getting the key a draw packet
+ *  is sorted by.  From the highest bits down the key holds
+ *  the shader path, the texture, the material, the mesh
+ *  and the authoring order.  Translucent draws are sorted
+ *  after all the opaque draws, in authoring order, so they
+ *  still blend over what is drawn behind them.
+ ***********************************************************/
+uint64_t SceneManager::GetDrawSortKey(const DRAW_PACKET& packet, int sequence)
+{
+	const uint64_t BLENDED_BIT = (uint64_t)1 << 63;
+	uint64_t key = (uint64_t)sequence & 0x3FFFFF;
 
-	SetShaderColor(1, 0.4, 0.1, 0.7); // set the color values into the shader
+	if (packet.batch >= 0)
+	{
+		// each instance selects its own texture and material,
+		// so a batch is only sorted by its mesh
+		const INSTANCE_BATCH& batch = m_instanceBatches[packet.batch];
+		for (size_t i = 0; i < batch.nodes.size(); i++)
+		{
+			const SceneGraph::SCENE_NODE& node = m_sceneGraph.GetNode(batch.nodes[i]);
+			if ((node.textureHandle < 0) && (node.color.a < 1.0f))
+			{
+				return(BLENDED_BIT | key);
+			}
+		}
+		key |= (uint64_t)1 << 62;
+		key |= (uint64_t)((batch.mesh + 1) & 0xFF) << 22;
+		return(key);
+	}
 
-	// draw sphere
-	m_basicMeshes->DrawSphereMesh(); // draw
+	const SceneGraph::SCENE_NODE& node = m_sceneGraph.GetNode(packet.node);
+	if ((node.textureHandle < 0) && (node.color.a < 1.0f))
+	{
+		return(BLENDED_BIT | key);
+	}
+	key |= (uint64_t)((node.textureHandle + 1) & 0xFFFF) << 46;
+	key |= (uint64_t)((node.materialHandle + 1) & 0xFFFF) << 30;
+	key |= (uint64_t)((node.mesh + 1) & 0xFF) << 22;
+	return(key);
+}
 
+/***********************************************************
+ *  SetShaderInstancing()
+ *
+ *  This method is used for selecting whether the shader
+ *  reads the per-instance values or the uniforms, unless
+ *  the last draw already selected the same.
+ ***********************************************************/
+void SceneManager::SetShaderInstancing(bool bInstancing, DRAW_STATE& state)
+{
+	if (state.instancing == (int)bInstancing)
+	{
+		RenderStats::CountEliminatedStateChange();
+		return;
+	}
 
-	// cone dimensions for pencil point
-	float xSz5[] = { 0.2 };
-	float ySz5[] = { 0.6 };
-	float zSz5[] = { 0.2 };
+	m_pShaderManager->setBoolValue(m_useInstancingUniform, bInstancing);
+	state.instancing = (int)bInstancing;
+}
 
-	// cone rotations for pencil point
-	float xRot5[] = { 0.0 };
-	float yRot5[] = { 0.0 };
-	float zRot5[] = { 0.0 };
+/***********************************************************
+ *  RenderNode()
+ *
+ *  This method is used for drawing a single scene graph
+ *  mesh node with its own draw command.  The color, texture,
+ *  UV scale and material are only set into the shader when
+ *  they differ from the values of the last draw.  The picked
+ *  node is drawn in the highlight color, without its texture.
+ ***********************************************************/
+void SceneManager::RenderNode(int nodeIndex, DRAW_STATE& state)
+{
+	const SceneGraph::SCENE_NODE& node = m_sceneGraph.GetNode(nodeIndex);
+	glm::vec4 color = node.color;
+	int textureReference = GetTextureReference(node.textureHandle);
+	if (nodeIndex == m_pickedNode)
+	{
+		color = g_PickedNodeColor;
+		textureReference = -1;
+	}
 
-	// cone positions for pencil point
-	float xPos5[] = { 0.0 };
-	float yPos5[] = { 14.4 };
-	float zPos5[] = { 0.0 };
+	SetShaderInstancing(false, state);
 
-	// set the XYZ scale
-	scaleXYZ = glm::vec3(xSz5[0], ySz5[0], zSz5[0]);
+	// set the cached world matrix into the shader
+	SetTransformations(node.worldMatrix);
 
-	// set position, include orientation
-	rotate(&xPos5[0], &yPos5[0], &zPos5[0], pencil_xRot, pencil_yRot, pencil_zRot);
-	positionXYZ = glm::vec3(pencil_x + xPos5[0], pencil_y + yPos5[0], pencil_z + zPos5[0]);
+	// the shader moves packed positions into the object space of
+	// the mesh, and the decode only changes with the mesh and level
+	const ShapeMeshes::POSITION_DECODE& decode = m_meshPositionDecodes[node.mesh][m_nodeLods[nodeIndex]];
+	if ((state.positionDecode.scale != decode.scale) || (state.positionDecode.offset != decode.offset))
+	{
+		m_pShaderManager->setVec3Value(m_decodeScaleUniform, decode.scale);
+		m_pShaderManager->setVec3Value(m_decodeOffsetUniform, decode.offset);
+		state.positionDecode = decode;
+	}
+	else
+	{
+		RenderStats::CountEliminatedStateChange();
+	}
 
-	// set pencil rotation along with individual shape rotation
-	XrotationDegrees = pencil_xRot + xRot5[0]; // limited use
-	YrotationDegrees = pencil_yRot + yRot5[0];
-	ZrotationDegrees = pencil_zRot + zRot5[0];
+	if (state.color != color)
+	{
+		m_pShaderManager->setVec4Value(m_colorUniform, color);
+		state.color = color;
+	}
+	else
+	{
+		RenderStats::CountEliminatedStateChange();
+	}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	if (state.textureReference != textureReference)
+	{
+		m_pShaderManager->setIntValue(m_textureUniform, textureReference);
+		state.textureReference = textureReference;
+	}
+	else
+	{
+		RenderStats::CountEliminatedStateChange();
+	}
 
-	SetShaderColor(0.1, 0.1, 0.1, 0.9); // set the color values into the shader
+	// the UV scale is only read for textured nodes
+	if (node.textureHandle >= 0)
+	{
+		if (state.uvScale != node.uvScale)
+		{
+			m_pShaderManager->setVec2Value(m_uvScaleUniform, node.uvScale);
+			state.uvScale = node.uvScale;
+		}
+		else
+		{
+			RenderStats::CountEliminatedStateChange();
+		}
+	}
 
-	// draw cone
-	m_basicMeshes->DrawConeMesh(); // draw
+	if ((node.materialHandle >= 0) && (node.materialHandle < MAX_MATERIALS))
+	{
+		if (state.materialIndex != node.materialHandle)
+		{
+			m_pShaderManager->setIntValue(m_materialIndexUniform, node.materialHandle);
+			state.materialIndex = node.materialHandle;
+		}
+		else
+		{
+			RenderStats::CountEliminatedStateChange();
+		}
+	}
 
-	/****************************************************************/
-	// end of draw pencil
-	/****************************************************************/
+	// draw the mesh with the transformation values
+	m_basicMeshes->DrawMesh(node.mesh, m_nodeLods[nodeIndex]);
+}
 
+/***********************************************************
+ *  RenderInstanceBatch()
+ *
+ *  This method is used for drawing all the nodes of an
+ *  instance batch with one draw command for each level of
+ *  detail in use.  The transform, color, UV scale, material
+ *  and texture of each node are passed as per-instance
+ *  values instead of uniforms.
+ ***********************************************************/
+void SceneManager::RenderInstanceBatch(INSTANCE_BATCH& batch, DRAW_STATE& state)
+{
+	GLsizei levelCounts[ShapeMeshes::LOD_COUNT];
+	GLsizei firstInstance = 0;
 
-	/****************************************************************/
-	// draw notebook
-	/****************************************************************/
+	// only the visible nodes are packed into the instances
+	if (PackBatchInstances(batch, batch.instances.data(), levelCounts) == 0)
+	{
+		return;
+	}
 
-	// notebook object rotation
-	float notebook_xRot = 0.0;
-	float notebook_yRot = 5.0;
-	float notebook_zRot = 0.0;
+	SetShaderInstancing(true, state);
+	for (int lod = 0; lod < ShapeMeshes::LOD_COUNT; lod++)
+	{
+		if (levelCounts[lod] > 0)
+		{
+			m_basicMeshes->DrawMeshInstanced(batch.mesh, batch.instances.data() + firstInstance, levelCounts[lod], lod);
+			firstInstance += levelCounts[lod];
+		}
+	}
+}
 
-	// notebook object position
-	float notebook_x = 5.5;
-	float notebook_y = 0.0;
-	float notebook_z = 0.0;
+/***********************************************************
+ *  RenderSceneIndirect()
+ *
+ *  This method is used for drawing the whole scene from the
+ *  indirect draw commands.  The per-instance values of every
+ *  node are uploaded once, then every command is drawn with
+ *  one multi-draw command, since each instance selects its
+ *  own texture, so the number of GL calls no longer grows
+ *  with the number of objects or textures.
+ ***********************************************************/
+void SceneManager::RenderSceneIndirect()
+{
+	size_t instance = 0;
+	size_t commandCount = 0;
+	unsigned int triangles = 0;
+
+	// the instance values of the visible nodes are packed in
+	// render item order, and each item has one command for
+	// every level of detail its visible nodes are drawn with
+	for (size_t i = 0; i < m_renderItems.size(); i++)
+	{
+		const RENDER_ITEM& item = m_renderItems[i];
+		GLsizei levelCounts[ShapeMeshes::LOD_COUNT] = { 0 };
+		ShapeMeshes::MESH_TYPE mesh;
 
-	// box dimensions for notebook
-	float xSz6[] = { 10.0 };
-	float ySz6[] = { 2.0 };
-	float zSz6[] = { 14.0 };
+		if (item.batch >= 0)
+		{
+			const INSTANCE_BATCH& batch = m_instanceBatches[item.batch];
+			mesh = batch.mesh;
+			PackBatchInstances(batch, m_frameInstances.data() + instance, levelCounts);
+		}
+		else
+		{
+			mesh = m_sceneGraph.GetNode(item.node).mesh;
+			if (m_nodeVisible[item.node] != 0)
+			{
+				FillInstanceData(item.node, m_frameInstances[instance]);
+				levelCounts[m_nodeLods[item.node]] = 1;
+			}
+			else
+			{
+				RenderStats::CountCulledObject();
+			}
+		}
 
-	// box rotations for notebook
-	float xRot6[] = { 0.0 };
-	float yRot6[] = { 0.0 };
-	float zRot6[] = { 0.0 };
+		for (int lod = 0; lod < ShapeMeshes::LOD_COUNT; lod++)
+		{
+			ShapeMeshes::DRAW_INDIRECT_COMMAND command;
+
+			if ((levelCounts[lod] > 0) &&
+				(m_basicMeshes->GetMeshDrawCommand(mesh, (GLuint)levelCounts[lod], (GLuint)instance, command, lod) == true))
+			{
+				if (commandCount == m_indirectCommands.size())
+				{
+					m_indirectCommands.push_back(command);
+					m_bIndirectCommandsDirty = true;
+				}
+				else if (memcmp(&m_indirectCommands[commandCount], &command, sizeof(command)) != 0)
+				{
+					m_indirectCommands[commandCount] = command;
+					m_bIndirectCommandsDirty = true;
+				}
+				commandCount++;
+				triangles += (command.count / 3) * command.instanceCount;
+			}
+			instance += levelCounts[lod];
+		}
+	}
 
-	// box positions for notebook
-	float xPos6[] = { 0.0 };
-	float yPos6[] = { 0.0 };
-	float zPos6[] = { 0.0 };
+	if (commandCount < m_indirectCommands.size())
+	{
+		m_indirectCommands.resize(commandCount);
+		m_bIndirectCommandsDirty = true;
+	}
 
-	// compensate for shape center offset
-	yPos6[0] += ySz6[0] / 2;
+	if (commandCount == 0)
+	{
+		return;
+	}
+	m_basicMeshes->UploadInstanceData(m_frameInstances.data(), (GLsizei)instance);
 
-	// set the XYZ scale
-	scaleXYZ = glm::vec3(xSz6[0], ySz6[0], zSz6[0]);
+	// the commands only change when the scene graph is rebuilt,
+	// or when a different set of nodes is culled or the nodes
+	// change their level of detail
+	if (m_bIndirectCommandsDirty == true)
+	{
+		m_basicMeshes->UploadDrawCommands(m_indirectCommands.data(), (GLsizei)m_indirectCommands.size());
+		m_bIndirectCommandsDirty = false;
+	}
 
-	// set position, include orientation
-	rotate(&xPos6[0], &yPos6[0], &zPos6[0], notebook_xRot, notebook_yRot, notebook_zRot);
-	positionXYZ = glm::vec3(notebook_x + xPos6[0], notebook_y + yPos6[0], notebook_z + zPos6[0]);
+	m_pShaderManager->setBoolValue(m_useInstancingUniform, true);
+	m_basicMeshes->DrawMeshesIndirect(0, (GLsizei)m_indirectCommands.size());
+	RenderStats::CountTriangles(triangles);
+	m_pShaderManager->setBoolValue(m_useInstancingUniform, false);
+}
 
-	// set notebook rotation along with individual shape rotation
-	XrotationDegrees = notebook_xRot + xRot6[0]; // limited use
-	YrotationDegrees = notebook_yRot + yRot6[0];
-	ZrotationDegrees = notebook_zRot + zRot6[0];
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+/***********************************************************
+ *  LoadSceneTextures()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene
+ *  rendering
+ ***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	// images decoded on an earlier run are read from the cache
+	m_textureLoader.SetCacheDirectory(m_textureCacheDirectory);
+
+	// the images are compressed to a block format the driver can
+	// sample - S3TC first, since BC1 takes half the memory of BC7
+	// for the opaque scene textures, then BC7, which is core since
+	// OpenGL 4.2 for drivers that do not have S3TC
+	TEXTURE_COMPRESSION compression = TEXTURE_COMPRESSION_NONE;
+	if (m_bCompressTextures)
+	{
+		if (GLEW_EXT_texture_compression_s3tc)
+		{
+			compression = TEXTURE_COMPRESSION_S3TC;
+		}
+		else if (GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc)
+		{
+			compression = TEXTURE_COMPRESSION_BPTC;
+		}
+	}
+	m_textureLoader.SetCompression(compression);
 
-	SetShaderColor(1, 1, 1, 1); // set the color values into the shader
+	// the texture arrays are sampled through bindless handles
+	// when the driver has them - the fragment shader checks for
+	// the same extension, so the two always agree
+	m_bBindlessTextures = (GLEW_ARB_bindless_texture != 0);
 
-	SetShaderTexture("pages");
-	SetTextureUVScale(1.0, 1.0);
+	// the scene file lists the textures it uses, and nothing
+	// is textured without one - a tag that is already in use
+	// is reported and skipped
+	for (int i = 0; i < m_sceneFile.GetTextureCount(); i++)
+	{
+		const SceneFile::TEXTURE& texture = m_sceneFile.GetTextures()[i];
+		CreateGLTexture(texture.path, texture.tag);
+	}
 
-	// draw box
-	m_basicMeshes->DrawBoxMesh(); // draw
+	// the images replace the placeholders as they are decoded, in
+	// the layers of the texture arrays for their sizes and formats
+}
 
 
-	// plane dimensions for page
-	float xSz7[] = { 5.0 };
-	float ySz7[] = { 1.0 };
-	float zSz7[] = { 7.0 };
+/***********************************************************
+ *  DefineObjectMaterials()
+ *
+ *  This method is used for configuring the various material
+ *  settings for all of the objects within the 3D scene.
+ ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	// the scene file holds the material table
+	if (m_sceneFile.IsMapped())
+	{
+		for (int i = 0; i < m_sceneFile.GetMaterialCount(); i++)
+		{
+			const SceneFile::MATERIAL& record = m_sceneFile.GetMaterials()[i];
+			OBJECT_MATERIAL material;
+			material.ambientColor = glm::make_vec3(record.ambientColor);
+			material.ambientStrength = record.ambientStrength;
+			material.diffuseColor = glm::make_vec3(record.diffuseColor);
+			material.specularColor = glm::make_vec3(record.specularColor);
+			material.shininess = record.shininess;
+			material.tag = record.tag;
+			m_objectMaterials.push_back(material);
+		}
+		return;
+	}
 
-	// plane rotations for page
-	float xRot7[] = { 0.0 };
-	float yRot7[] = { -1.0 };
-	float zRot7[] = { 0.0 };
+	// without a scene file the table top is drawn with a plain
+	// material of its own
+	OBJECT_MATERIAL defaultMaterial;
+	defaultMaterial.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	defaultMaterial.ambientStrength = 1.0f;
+	defaultMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+	defaultMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	defaultMaterial.shininess = 1.0f;
+	defaultMaterial.tag = "default_material";
+	m_objectMaterials.push_back(defaultMaterial);
+}
 
-	// plane positions for page
-	float xPos7[] = { 0.1 };
-	float yPos7[] = { 2.02 };
-	float zPos7[] = { 0.0 };
 
-	// set the XYZ scale
-	scaleXYZ = glm::vec3(xSz7[0], ySz7[0], zSz7[0]);
+/***********************************************************
+ *  SetupSceneLights()
+ *
+ *  This method is called to add and configure the light
+ *  sources for the 3D scene.  There are up to 4 light sources.
+ ***********************************************************/
+void SceneManager::SetupSceneLights()
+{
+	// this line of code is NEEDED for telling the shaders to render 
+	// the 3D scene with custom lighting, if no light sources have
+	// been added then the display window will be black - to use the 
+	// default OpenGL lighting then comment out the following line
+	m_bUseLighting = true;
+	m_pShaderManager->setBoolValue(g_UseLightingName, m_bUseLighting);
 
-	// set position, include orientation
-	rotate(&xPos7[0], &yPos7[0], &zPos7[0], notebook_xRot, notebook_yRot, notebook_zRot);
-	positionXYZ = glm::vec3(notebook_x + xPos7[0], notebook_y + yPos7[0], notebook_z + zPos7[0]);
+	// the scene file holds the light sources, and without one
+	// a single white light shines down on the table top
+	if (m_sceneFile.IsMapped())
+	{
+		for (int i = 0; (i < m_sceneFile.GetLightCount()) && (i < TOTAL_LIGHTS); i++)
+		{
+			const SceneFile::LIGHT& light = m_sceneFile.GetLights()[i];
+			m_lightSources[i].position = glm::make_vec3(light.position);
+			m_lightSources[i].ambientColor = glm::make_vec3(light.ambientColor);
+			m_lightSources[i].diffuseColor = glm::make_vec3(light.diffuseColor);
+			m_lightSources[i].specularColor = glm::make_vec3(light.specularColor);
+			m_lightSources[i].specularIntensity = light.specularIntensity;
+			m_lightSources[i].focalStrength = light.focalStrength;
+		}
+	}
+	else
+	{
+		m_lightSources[0].position = glm::vec3(0.0f, 10.0f, 0.0f);
+		m_lightSources[0].ambientColor = glm::vec3(0.5f, 0.5f, 0.5f);
+		m_lightSources[0].diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
+		m_lightSources[0].specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
+		m_lightSources[0].specularIntensity = 30.0f;
+	}
 
-	// set notebook rotation along with individual shape rotation
-	XrotationDegrees = notebook_xRot + xRot7[0]; // limited use
-	YrotationDegrees = notebook_yRot + yRot7[0];
-	ZrotationDegrees = notebook_zRot + zRot7[0];
+	// write the lights into the light block once
+	UploadLightSources();
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 
-	SetShaderColor(1, 1, 1, 1); // set the color values into the shader
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// look up the per-draw shader uniforms once
+	ResolveShaderUniforms();
 
-	SetShaderTexture("page");
-	SetTextureUVScale(1.0, 1.0);
-	SetShaderMaterial("paper_material");
+	// the textures, materials, lights and objects are read from
+	// the compiled scene file, and only the table top is drawn
+	// when it cannot be loaded
+	OpenSceneFile();
 
-	//draw plane
-	m_basicMeshes->DrawPlaneMesh();
+	// load the texture image files for the textures applied
+	// to objects in the 3D scene
+	LoadSceneTextures();
 
-	SetShaderMaterial("default_material");
+	// create the uniform buffers for the materials and lights
+	CreateUniformBuffers();
 
-	// ring dimensions for notebook
-	float xSz8[17];
-	float ySz8[17];
-	float zSz8[17];
+	// define the materials for objects in the scene
+	DefineObjectMaterials();
+	// write the material table once
+	UploadObjectMaterials();
+	// add and define the light sources for the scene
+	SetupSceneLights();
 
-	// ring rotations for notebook
-	float xRot8[17];
-	float yRot8[17];
-	float zRot8[17];
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn
+	// in the rendered 3D scene
 
-	// ring positions for notebook
-	float xPos8[17];
-	float yPos8[17];
-	float zPos8[17];
+	m_basicMeshes->SetVertexFormat(m_bPackVertices ? ShapeMeshes::VERTEX_FORMAT_PACKED : ShapeMeshes::VERTEX_FORMAT_FLOAT);
+	m_basicMeshes->LoadPlaneMesh();
+	m_basicMeshes->LoadCylinderMesh();
+	m_basicMeshes->LoadTaperedCylinderMesh();
+	m_basicMeshes->LoadBoxMesh();
+	m_basicMeshes->LoadSphereMesh();
+	m_basicMeshes->LoadConeMesh();
+	m_basicMeshes->LoadTorusMesh();
 
-	// draw rings
-	for (i = 0; i < 17; i++)
+	// the scene graph nodes are culled by the bounds of
+	// the meshes they draw, and draw a level of detail chosen
+	// by the errors of the levels
+	for (int i = 0; i < ShapeMeshes::MESH_COUNT; i++)
 	{
-		xSz8[i] = 0.25;
-		ySz8[i] = 0.25;
-		zSz8[i] = 0.25;
-		xRot8[i] = 0.0;
-		yRot8[i] = 0.0;
-		zRot8[i] = 0.0;
-		xPos8[i] = -5.0;
-		yPos8[i] = 1.0;
-		zPos8[i] = 13.5 / 17 * (8 - i); // place each ring
+		ShapeMeshes::MESH_TYPE mesh = (ShapeMeshes::MESH_TYPE)i;
+		ShapeMeshes::MESH_BOUNDS bounds;
+		if (m_basicMeshes->GetMeshBounds(mesh, bounds) == true)
+		{
+			m_sceneGraph.SetMeshBounds(mesh, bounds);
+		}
 
-		// compensate for shape center offset
-		yPos8[i] += ySz8[i] / 2;
+		m_meshLodCounts[i] = std::max(m_basicMeshes->GetMeshLodCount(mesh), 1);
+		for (int lod = 0; lod < m_meshLodCounts[i]; lod++)
+		{
+			m_meshLodErrors[i][lod] = m_basicMeshes->GetMeshLodError(mesh, lod);
+			m_meshPositionDecodes[i][lod] = m_basicMeshes->GetMeshPositionDecode(mesh, lod);
+		}
+	}
 
-		// set the XYZ scale
-		scaleXYZ = glm::vec3(xSz8[i], ySz8[i], zSz8[i]);
+	// define the objects of the scene from the loaded meshes
+	BuildSceneGraph();
+	// the scene file is not needed once the nodes are added
+	m_sceneFile.Unmap();
 
-		// set position, include orientation
-		rotate(&xPos8[i], &yPos8[i], &zPos8[i], notebook_xRot, notebook_yRot, notebook_zRot);
-		positionXYZ = glm::vec3(notebook_x + xPos8[i], notebook_y + yPos8[i], notebook_z + zPos8[i]);
+	// submit the whole scene with multi-draw indirect
+	// where the OpenGL version supports it
+	SetRenderPath(RENDER_PATH_INDIRECT);
+}
 
-		// set notebook rotation along with individual shape rotation
-		XrotationDegrees = notebook_xRot + xRot8[i]; // limited use
-		YrotationDegrees = notebook_yRot + yRot8[i];
-		ZrotationDegrees = notebook_zRot + zRot8[i];
 
-		// set the transformations into memory to be used on the drawn meshes
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+/***********************************************************
+ *  BuildSceneGraph()
+ *
+ *  This method is used for defining the objects of the 3D
+ *  scene as nodes in the scene graph, from the nodes of the
+ *  mapped scene file.  The parts of each object are children
+ *  of an object node, so they follow the position and
+ *  orientation of the object.
+ ***********************************************************/
+void SceneManager::BuildSceneGraph()
+{
+	// the node indexes of the old scene graph are gone
+	m_pickedNode = -1;
 
-		SetShaderColor(0.7, 0.7, 0.7, 0.9); // set the color values into the shader
-		m_basicMeshes->DrawTorusMesh(); // draw
+	m_sceneGraph.Clear();
+	if (m_sceneFile.IsMapped())
+	{
+		m_sceneGraph.AddFileNodes(m_sceneFile);
+	}
+	else
+	{
+		// only the table top is drawn without a scene file
+		m_sceneGraph.AddMeshNode(-1, ShapeMeshes::MESH_PLANE,
+			Transform(glm::vec3(20.0f, 1.0f, 20.0f), glm::vec3(0.0f)),
+			glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), "default_material");
 	}
-	/****************************************************************/
-	// end of draw notebook
-	/****************************************************************/
-
-
-	/****************************************************************/
-	// draw rubik's cubes
-	/****************************************************************/
 
-	// rubiks object rotation
-	float rubiks_xRot = 0.0;
-	float rubiks_yRot = 0.0;
-	float rubiks_zRot = 0.0;
+	// compute all of the world matrices once
+	m_sceneGraph.UpdateWorldTransforms();
 
-	// rubiks object position
-	float rubiks_x = -5.5;
-	float rubiks_y = 0.0;
-	float rubiks_z = 0.0;
+	// repeated meshes are drawn with instancing
+	BuildInstanceBatches();
+}
 
-	// box dimensions for rubiks
-	float xSz9[] = { 3.0, 3.0, 3.0, 3.0 };
-	float ySz9[] = { 3.0, 3.0, 3.0, 3.0 };
-	float zSz9[] = { 3.0, 3.0, 3.0, 3.0 };
 
-	// box rotations for rubiks
-	float xRot9[] = { 0.0, 180.0, 0.0, 90.0 };
-	float yRot9[] = { 0.0, 0.0, -90.0, 180.0 };//-45
-	float zRot9[] = { -90.0, 0.0, 0.0, 135.0 };
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by
+ *  drawing the meshes of the scene graph nodes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	// the uniform handles are only valid for the program
+	// they were resolved from
+	if (m_uniformProgramID != m_pShaderManager->m_programID)
+	{
+		ResolveShaderUniforms();
+	}
 
-	// box positions for rubiks
-	float xPos9[] = { 0.0, -3.0, -3.0, -1.5 };
-	float yPos9[] = { 0.0, 0.0, 0.0, 3.0 };
-	float zPos9[] = { 0.0, 1.5, -1.5, 0.0 };
+	// swap in the textures that finished decoding
+	UploadLoadedTextures();
 
-	// draw rings
-	for (i = 0; i < 4; i++)
+	// the shader only looks through the texture arrays in use
+	if (m_shaderTextureArrayCount != (int)m_textureArrays.size())
 	{
-		// compensate for shape center offset
-		yPos9[i] += ySz9[i] / 2;
+		m_shaderTextureArrayCount = (int)m_textureArrays.size();
+		m_pShaderManager->setIntValue(m_textureArrayCountUniform, m_shaderTextureArrayCount);
+		BindGLTextures();
+	}
 
-		// set the XYZ scale
-		scaleXYZ = glm::vec3(xSz9[i], ySz9[i], zSz9[i]);
+	// only the nodes that changed since the last frame have
+	// their world matrices recomputed
+	m_sceneGraph.UpdateWorldTransforms();
 
-		// set position, include orientation
-		rotate(&xPos9[i], &yPos9[i], &zPos9[i], rubiks_xRot, rubiks_yRot, rubiks_zRot);
-		positionXYZ = glm::vec3(rubiks_x + xPos9[i], rubiks_y + yPos9[i], rubiks_z + zPos9[i]);
+	// the nodes outside of the view are not drawn, and the
+	// rest are drawn with fewer triangles the smaller they are
+	CullSceneNodes();
+	SelectNodeLods();
 
-		// set rubiks rotation along with individual shape rotation
-		XrotationDegrees = rubiks_xRot + xRot9[i]; // limited use
-		YrotationDegrees = rubiks_yRot + yRot9[i];
-		ZrotationDegrees = rubiks_zRot + zRot9[i];
+	// the mesh buffers may have been bound again outside
+	// of the scene since the last frame
+	m_basicMeshes->ResetBindings();
 
-		// set the transformations into memory to be used on the drawn meshes
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	if (m_renderPath == RENDER_PATH_INDIRECT)
+	{
+		RenderSceneIndirect();
+		return;
+	}
 
-		SetShaderColor(1, 1, 1, 1); // set the color values into the shader
+	// the packets only change when the batches are rebuilt
+	if ((m_bDrawPacketsDirty == true) || (m_drawPacketPath != m_renderPath))
+	{
+		BuildDrawPackets();
+	}
 
-		SetShaderTexture("rubiks");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("rubiks_material");
+	// other code can set the same uniforms between frames, so
+	// every value starts out unknown - NaN never compares equal
+	// and no draw uses the other starting values
+	DRAW_STATE state;
+	state.instancing = -1;
+	state.textureReference = INT_MIN;
+	state.color = glm::vec4(std::numeric_limits<float>::quiet_NaN());
+	state.uvScale = glm::vec2(std::numeric_limits<float>::quiet_NaN());
+	state.materialIndex = -1;
+	state.positionDecode.scale = glm::vec3(std::numeric_limits<float>::quiet_NaN());
+	state.positionDecode.offset = glm::vec3(std::numeric_limits<float>::quiet_NaN());
+
+	for (size_t i = 0; i < m_drawPackets.size(); i++)
+	{
+		const DRAW_PACKET& packet = m_drawPackets[i];
 
-		// draw box
-		m_basicMeshes->DrawBoxMesh(); // draw
+		if (packet.batch >= 0)
+		{
+			RenderInstanceBatch(m_instanceBatches[packet.batch], state);
+		}
+		else if (m_nodeVisible[packet.node] != 0)
+		{
+			RenderNode(packet.node, state);
+		}
+		else
+		{
+			RenderStats::CountCulledObject();
+		}
 	}
 
-	/****************************************************************/
-	// end of rubik's cubes
-	/****************************************************************/
+	// leave the shader reading the uniforms, as single draws
+	// made outside of the scene expect
+	if (state.instancing == 1)
+	{
+		SetShaderInstancing(false, state);
+	}
 }
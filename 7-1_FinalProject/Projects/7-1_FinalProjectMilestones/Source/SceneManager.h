@@ -11,9 +11,14 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "SceneGraph.h"
+#include "TextureLoader.h"
+#include "SceneFile.h"
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <cstdint>
 
 /***********************************************************
  *  SceneManager
@@ -29,10 +34,38 @@ public:
 	// destructor
 	~SceneManager();
 
+	// number of texture arrays, which must match the
+	// MAX_TEXTURE_ARRAYS define in the fragment shader - there
+	// is no limit on the number of textures in each array
+	static const int MAX_TEXTURE_ARRAYS = 16;
+
+	// a scene texture, stored in one layer of a texture array
 	struct TEXTURE_INFO
 	{
 		std::string tag;
-		uint32_t ID;
+		int array;              // texture array, or -1 until the image is decoded
+		int layer;              // layer of the image in the texture array
+	};
+
+	// textures with the same size, format and number of mip
+	// levels, packed into the layers of one texture array
+	struct TEXTURE_ARRAY
+	{
+		GLuint ID;
+		GLuint64 handle;        // bindless handle, or 0 when not used
+		TEXTURE_FORMAT format;
+		int width;
+		int height;
+		int levelCount;
+		int layerCount;         // layers that hold a texture
+		int layerCapacity;      // layers allocated for the array
+	};
+
+	// one entry of the bindless handle table, laid out for std140
+	struct TEXTURE_HANDLE_ENTRY
+	{
+		GLuint64 handle;
+		GLuint64 padding;
 	};
 
 	struct OBJECT_MATERIAL
@@ -45,38 +78,263 @@ public:
 		std::string tag;
 	};
 
+	// sizes of the uniform block arrays, which must match the
+	// MAX_MATERIALS and TOTAL_LIGHTS defines in the fragment shader
+	static const int MAX_MATERIALS = 32;
+	static const int TOTAL_LIGHTS = 1;
+
+	// one entry of the material table, laid out for std140
+	struct MATERIAL_BLOCK_ENTRY
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		float padding0;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	// one light source in the light block, laid out for std140
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 position;
+		float focalStrength;
+		glm::vec3 ambientColor;
+		float specularIntensity;
+		glm::vec3 diffuseColor;
+		float padding0;
+		glm::vec3 specularColor;
+		float padding1;
+	};
+
+	// scene graph mesh nodes with the same mesh, drawn together
+	// with one instanced draw command - each instance selects
+	// its own texture
+	struct INSTANCE_BATCH
+	{
+		ShapeMeshes::MESH_TYPE mesh;
+		std::vector<int> nodes;
+		std::vector<ShapeMeshes::INSTANCE_DATA> instances;
+	};
+
+	// one entry in the draw order of the scene - either a single
+	// scene graph node or an instance batch
+	struct RENDER_ITEM
+	{
+		int node;
+		int batch;
+	};
+
+	// one draw of the immediate or instanced paths - a single
+	// scene graph node or an instance batch - with the key the
+	// draws are sorted by
+	struct DRAW_PACKET
+	{
+		uint64_t sortKey;
+		int node;
+		int batch;
+	};
+
+	// the shader values left by the last draw of the frame, so
+	// that draws with the same values do not set them again
+	struct DRAW_STATE
+	{
+		int instancing;
+		int textureReference;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+		int materialIndex;
+		ShapeMeshes::POSITION_DECODE positionDecode;
+	};
+
+	// the ways the scene can be submitted to the GPU
+	enum RENDER_PATH
+	{
+		RENDER_PATH_IMMEDIATE,  // one draw with uniforms per mesh node
+		RENDER_PATH_INSTANCED,  // one instanced draw per batch, for GL 3.3
+		RENDER_PATH_INDIRECT    // one multi-draw indirect for the scene
+	};
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
+	// retained hierarchy of the objects in the scene
+	SceneGraph m_sceneGraph;
+	// instance batches built from the scene graph
+	std::vector<INSTANCE_BATCH> m_instanceBatches;
+	// draw order of the single nodes and instance batches
+	std::vector<RENDER_ITEM> m_renderItems;
+	// draws of the render items, sorted by render state
+	std::vector<DRAW_PACKET> m_drawPackets;
+	// render path the draw packets were built for
+	RENDER_PATH m_drawPacketPath;
+	// set when the draw packets must be built again
+	bool m_bDrawPacketsDirty;
+
+	// how the scene is submitted to the GPU
+	RENDER_PATH m_renderPath;
+	// indirect draw commands for the render items
+	std::vector<ShapeMeshes::DRAW_INDIRECT_COMMAND> m_indirectCommands;
+	// set when the indirect commands must be sent to the GPU
+	bool m_bIndirectCommandsDirty;
+	// per-instance values of every draw in the frame
+	std::vector<ShapeMeshes::INSTANCE_DATA> m_frameInstances;
+
+	// view frustum of the camera, set for every frame
+	Frustum m_viewFrustum;
+	// projection times view matrix of the frame, and the height
+	// of the viewport it maps onto, that the objects are sized by
+	glm::mat4 m_viewProjection;
+	float m_viewportHeight;
+	// set once a view frustum has been passed in
+	bool m_bViewFrustumSet;
+	// set when the nodes outside of the frustum are not drawn
+	bool m_bFrustumCulling;
+	// 1 for each scene graph node that is drawn this frame
+	std::vector<unsigned char> m_nodeVisible;
+	// pixels the triangles of an object may stray from its true
+	// surface on the screen, 0 to always draw the full meshes
+	float m_lodPixelError;
+	// scene graph node the last picking ray hit, which is drawn
+	// highlighted, -1 for none
+	int m_pickedNode;
+	// levels of detail loaded for each mesh, and how far each
+	// level strays from the true surface of the mesh
+	int m_meshLodCounts[ShapeMeshes::MESH_COUNT];
+	float m_meshLodErrors[ShapeMeshes::MESH_COUNT][ShapeMeshes::LOD_COUNT];
+	// scales and offsets moving the stored positions of each
+	// level of detail into the object space of its mesh
+	ShapeMeshes::POSITION_DECODE m_meshPositionDecodes[ShapeMeshes::MESH_COUNT][ShapeMeshes::LOD_COUNT];
+	// level of detail each scene graph node is drawn with, kept
+	// from frame to frame so that the changes can lag behind
+	std::vector<unsigned char> m_nodeLods;
 	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
+	std::vector<TEXTURE_INFO> m_textures;
+	// slot in the loaded textures of each texture tag
+	std::unordered_map<std::string, int> m_textureSlots;
+	// texture arrays holding the decoded textures
+	std::vector<TEXTURE_ARRAY> m_textureArrays;
+	// number of texture arrays the shader was last told about
+	int m_shaderTextureArrayCount;
+	// set when the texture arrays are sampled through bindless
+	// handles instead of texture units
+	bool m_bBindlessTextures;
+	// uniform buffer holding the bindless handle table
+	GLuint m_textureHandleUBO;
+	// decodes the texture image files on worker threads
+	TextureLoader m_textureLoader;
+	// pixel unpack buffer the decoded images are uploaded through
+	GLuint m_textureUploadPBO;
+	// directory the decoded images are cached in, empty for none
+	std::string m_textureCacheDirectory;
+	// set when decoded images are block compressed
+	bool m_bCompressTextures;
+	// set when the mesh vertices are packed into 16 bytes
+	bool m_bPackVertices;
+	// text description the scene is read from, empty for only
+	// the table top, and the directory it is compiled into
+	std::string m_sceneDescription;
+	std::string m_sceneCacheDirectory;
+	// the compiled scene file, mapped while the scene is prepared
+	SceneFile m_sceneFile;
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// index in the defined materials of each material tag
+	std::unordered_map<std::string, int> m_materialIndexes;
+	// light sources for the scene
+	LIGHT_SOURCE m_lightSources[TOTAL_LIGHTS];
+	// set when the shaders use the custom lighting
+	bool m_bUseLighting;
+	// uniform buffers holding the material table and the lights
+	GLuint m_materialUBO;
+	GLuint m_lightUBO;
 
-	// load texture images and convert to OpenGL texture data
+	// program the uniform handles below were resolved from
+	GLuint m_uniformProgramID;
+	// pre-resolved shader uniforms that are set for every draw
+	ShaderUniform<glm::mat4> m_modelUniform;
+	ShaderUniform<glm::vec4> m_colorUniform;
+	ShaderUniform<int> m_textureUniform;
+	ShaderUniform<int> m_textureArrayCountUniform;
+	ShaderUniform<glm::vec2> m_uvScaleUniform;
+	ShaderUniform<int> m_materialIndexUniform;
+	ShaderUniform<bool> m_useInstancingUniform;
+	ShaderUniform<glm::vec3> m_decodeScaleUniform;
+	ShaderUniform<glm::vec3> m_decodeOffsetUniform;
+
+	// look up the uniform handles for the active shader program
+	void ResolveShaderUniforms();
+
+	// register a texture and queue its image for decoding
 	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
+	// replace a placeholder texture with its decoded image
+	bool UploadDecodedTexture(TextureLoader::DECODED_IMAGE& decoded);
+	// find or allocate a free layer in a texture array for an image
+	int AllocateTextureLayer(const TEXTURE_IMAGE& image);
+	// create the OpenGL texture of a texture array on its texture unit
+	void CreateTextureArray(TEXTURE_ARRAY& textureArray, int arrayIndex);
+	// copy the layers of a full texture array into a larger one
+	bool GrowTextureArray(int arrayIndex);
+	// write the bindless handles of the texture arrays to the shader
+	void UploadTextureHandles();
+	// bind the texture arrays to their texture units
 	void BindGLTextures();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
 	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
+	int FindTextureID(const std::string& tag);
+	int FindTextureSlot(const std::string& tag);
+	// get the value the shader selects a texture array layer by
+	int GetTextureReference(int textureSlot);
 	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material);
+	int FindMaterialIndex(const std::string& tag);
+
+	// create the uniform buffers for the materials and lights
+	void CreateUniformBuffers();
+	// write the defined materials into the material table
+	void UploadObjectMaterials();
+	// write the light sources into the light block
+	void UploadLightSources();
+
+	// look up the texture and material tags of the scene graph nodes
+	void ResolveNodeHandles();
+	// group the scene graph mesh nodes into instance batches
+	void BuildInstanceBatches();
+	// fill the per-instance values of a scene graph mesh node
+	void FillInstanceData(int node, ShapeMeshes::INSTANCE_DATA& instance);
+	// fill the per-instance values of the visible nodes of an
+	// instance batch, grouped by level of detail
+	GLsizei PackBatchInstances(
+		const INSTANCE_BATCH& batch,
+		ShapeMeshes::INSTANCE_DATA* instances,
+		GLsizei levelCounts[ShapeMeshes::LOD_COUNT]);
+	// build the draw packets of the render items, sorted by state
+	void BuildDrawPackets();
+	// get the key a draw packet is sorted by
+	uint64_t GetDrawSortKey(const DRAW_PACKET& packet, int sequence);
+	// select the instanced or single draw path in the shader
+	void SetShaderInstancing(bool bInstancing, DRAW_STATE& state);
+	// draw a single scene graph mesh node
+	void RenderNode(int node, DRAW_STATE& state);
+	// draw all the nodes of an instance batch at once
+	void RenderInstanceBatch(INSTANCE_BATCH& batch, DRAW_STATE& state);
+	// draw the whole scene from the indirect draw commands
+	void RenderSceneIndirect();
+	// find the scene graph nodes inside of the view frustum
+	void CullSceneNodes();
+	// choose the level of detail of the visible nodes from
+	// their size on the screen
+	void SelectNodeLods();
 
 	// set the transformation values 
 	// into the transform buffer
 	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
+		const Transform& transform);
+	void SetTransformations(
+		const glm::mat4& modelMatrix);
 
 	// set the color values into the shader
 	void SetShaderColor(
@@ -85,17 +343,23 @@ private:
 		float blueColorValue,
 		float alphaValue);
 
-	// set the texture data into the shader
+	// set the texture data into the shader, by tag or by
+	// the slot returned by FindTextureSlot()
+	void SetShaderTexture(
+		const std::string& textureTag);
 	void SetShaderTexture(
-		std::string textureTag);
+		int textureSlot);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
 		float u, float v);
 
-	// set the object material into the shader
+	// set the object material into the shader, by tag or by
+	// the index returned by FindMaterialIndex()
 	void SetShaderMaterial(
-		std::string materialTag);
+		const std::string& materialTag);
+	void SetShaderMaterial(
+		int materialIndex);
 
 public:
 
@@ -104,11 +368,52 @@ public:
 	void PrepareScene();
 	void RenderScene();
 
+	// select how the scene is submitted to the GPU - the indirect
+	// path falls back to instancing without OpenGL 4.3
+	void SetRenderPath(RENDER_PATH renderPath);
+	RENDER_PATH GetRenderPath() const { return(m_renderPath); }
+
+	// set the projection times view matrix that the next frame
+	// is culled by, and the height in pixels of the viewport it
+	// maps onto - nothing is culled until it is first set
+	void SetViewFrustum(
+		const glm::mat4& viewProjection,
+		int viewportHeight);
+	// turn the culling of objects outside of the view on or off
+	void SetFrustumCulling(bool bEnable);
+	// set how many pixels the triangles of an object may stray
+	// from its true surface before a finer level of detail is
+	// drawn - 0 always draws the full meshes
+	void SetLodPixelError(float pixels);
+	// find the scene graph node hit by a world space ray, such as
+	// the ray through the mouse cursor, and highlight it - -1 when
+	// nothing is hit
+	int PickNode(const glm::vec3& origin, const glm::vec3& direction);
+	// get the node the last picking ray hit, -1 for none
+	int GetPickedNode() const { return(m_pickedNode); }
+
 	// load all of the needed textures before rendering
 	void LoadSceneTextures();
+	// upload the texture images that have finished decoding
+	void UploadLoadedTextures();
+	// wait for every texture image to be decoded and uploaded
+	void WaitForTextures();
+	// set the directory the decoded texture images are cached in
+	void SetTextureCacheDirectory(std::string directory);
+	// turn the block compression of decoded texture images on or off
+	void SetTextureCompression(bool bCompress);
+	// turn the packing of the mesh vertices on or off
+	void SetVertexPacking(bool bPack);
+	// set the text description the scene is read from, and the
+	// directory it is compiled into
+	void SetSceneDescription(std::string filename, std::string cacheDirectory);
+	// map the compiled scene file, compiling it when needed
+	bool OpenSceneFile();
 	// define all the object materials before rendering
 	void DefineObjectMaterials();
 	// add and define the light sources before rendering
 	void SetupSceneLights();
+	// define the objects of the scene as scene graph nodes
+	void BuildSceneGraph();
 
 };
@@ -17,21 +17,26 @@
 // declaration of the global variables and defines
 namespace
 {
-	// Variables for window width and height
-	const int WINDOW_WIDTH = 1000;
-	const int WINDOW_HEIGHT = 800;
 	const char* g_ViewName = "view";
 	const char* g_ProjectionName = "projection";
+	const char* g_ViewPositionName = "viewPosition";
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
 	Camera* g_pCamera = nullptr;
 
 	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
+	float gLastX = ViewManager::WINDOW_WIDTH / 2.0f;
+	float gLastY = ViewManager::WINDOW_HEIGHT / 2.0f;
 	bool gFirstMouse = true;
 
+	// cursor position in normalized device coordinates, and
+	// whether the scene was clicked since the last pick ray
+	// was taken
+	float gCursorX = 0.0f;
+	float gCursorY = 0.0f;
+	bool gPickRequested = false;
+
     // vertical scroll wheel variable that can modify movement speed
     double scrollVarCoefficient = 1.0f; 
 
@@ -55,6 +60,9 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_fixedTimestep = 0.0f;
+	m_uniformProgramID = 0;
+	m_viewProjection = glm::mat4(1.0f);
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(2.0f, 5.5f, 16.0f);
@@ -105,6 +113,9 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 
 	// this callback is used to receive mouse moving events
 	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+
+	// this callback is used to receive mouse button events
+	glfwSetMouseButtonCallback(window, &ViewManager::Mouse_Button_Callback);
     
     // this callback is used to receive scroll events
     glfwSetScrollCallback(window, &ViewManager::Scroll_Callback);
@@ -121,6 +132,23 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	return(window);
 }
 
+/***********************************************************
+ *  CreateOffscreenView()
+ *
+ *  This method is used to set up the view for rendering
+ *  into an offscreen framebuffer.  There is no window, so
+ *  no input callbacks are registered and the camera stays
+ *  at its default position.
+ ***********************************************************/
+void ViewManager::CreateOffscreenView()
+{
+	// enable blending for supporting tranparent rendering
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	m_pWindow = NULL;
+}
+
 
 
 /***********************************************************
@@ -173,6 +201,57 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
 
 	// move the 3D camera according to the calculated offsets
 	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+
+	// remember where the cursor is for picking the object under it
+	if ((width > 0) && (height > 0))
+	{
+		gCursorX = (2.0f * (float)xMousePos / width) - 1.0f;
+		gCursorY = 1.0f - (2.0f * (float)yMousePos / height);
+	}
+}
+
+/***********************************************************
+ *  Mouse_Button_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  a mouse button is pressed or released within the active
+ *  GLFW display window.  A left click picks the object
+ *  under the cursor on the next frame.
+ ***********************************************************/
+void ViewManager::Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if ((button == GLFW_MOUSE_BUTTON_LEFT) && (action == GLFW_PRESS))
+	{
+		gPickRequested = true;
+	}
+}
+
+/***********************************************************
+ *  GetCursorRay()
+ *
+ *  This method is used to get the ray from the camera through
+ *  the mouse cursor, in world space, for picking the object
+ *  under the cursor.  The cursor is moved back through the
+ *  projection and view of the last prepared frame.  False is
+ *  returned when the scene has not been clicked since the
+ *  last ray, so the scene is only searched on a click.
+ ***********************************************************/
+bool ViewManager::GetCursorRay(glm::vec3& origin, glm::vec3& direction)
+{
+	if (gPickRequested == false)
+	{
+		return(false);
+	}
+	gPickRequested = false;
+
+	glm::mat4 inverseViewProjection = glm::inverse(m_viewProjection);
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(gCursorX, gCursorY, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(gCursorX, gCursorY, 1.0f, 1.0f);
+
+	origin = glm::vec3(nearPoint) / nearPoint.w;
+	direction = glm::normalize((glm::vec3(farPoint) / farPoint.w) - origin);
+
+	return(true);
 }
 
 /***********************************************************
@@ -251,6 +330,45 @@ void ViewManager::ProcessKeyboardEvents()
     }
 }
 
+/***********************************************************
+ *  SetFixedTimestep()
+ *
+ *  This method is used to advance every frame by the passed
+ *  in number of seconds, instead of the time measured since
+ *  the last frame.  Passing 0 goes back to the wall clock.
+ ***********************************************************/
+void ViewManager::SetFixedTimestep(float seconds)
+{
+	if (seconds < 0.0f)
+	{
+		seconds = 0.0f;
+	}
+	m_fixedTimestep = seconds;
+	gDeltaTime = seconds;
+}
+
+/***********************************************************
+ *  GetDeltaTime()
+ *
+ *  This method is used to get the number of seconds that
+ *  the last frame advanced by.
+ ***********************************************************/
+float ViewManager::GetDeltaTime() const
+{
+	return(gDeltaTime);
+}
+
+/***********************************************************
+ *  GetCamera()
+ *
+ *  This method is used to get the camera, so that it can be
+ *  moved by something other than the keyboard and mouse.
+ ***********************************************************/
+Camera* ViewManager::GetCamera() const
+{
+	return(g_pCamera);
+}
+
 /***********************************************************
  *  PrepareSceneView()
  *
@@ -263,14 +381,26 @@ void ViewManager::PrepareSceneView()
 	glm::mat4 view;
 	glm::mat4 projection;
 
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
+	// per-frame timing - a fixed timestep makes every run
+	// advance by the same amount, whatever the frame rate
+	if (m_fixedTimestep > 0.0f)
+	{
+		gDeltaTime = m_fixedTimestep;
+	}
+	else if (NULL != m_pWindow)
+	{
+		float currentFrame = glfwGetTime();
+		gDeltaTime = currentFrame - gLastFrame;
+		gLastFrame = currentFrame;
+	}
 
-	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
+	// there is no keyboard input without a window
+	if (NULL != m_pWindow)
+	{
+		// process any keyboard events that may be waiting in the 
+		// event queue
+		ProcessKeyboardEvents();
+	}
 
 	// get the current view matrix from the camera
 	view = g_pCamera->GetViewMatrix();
@@ -301,14 +431,26 @@ void ViewManager::PrepareSceneView()
 		}
 	}
 
+	m_viewProjection = projection * view;
+
 	// if the shader manager object is valid
 	if (NULL != m_pShaderManager)
 	{
+		// the shader program is loaded after this object is created,
+		// so the uniform handles are resolved on first use
+		if (m_uniformProgramID != m_pShaderManager->m_programID)
+		{
+			m_viewUniform = m_pShaderManager->GetUniform<glm::mat4>(g_ViewName);
+			m_projectionUniform = m_pShaderManager->GetUniform<glm::mat4>(g_ProjectionName);
+			m_viewPositionUniform = m_pShaderManager->GetUniform<glm::vec3>(g_ViewPositionName);
+			m_uniformProgramID = m_pShaderManager->m_programID;
+		}
+
 		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
+		m_pShaderManager->setMat4Value(m_viewUniform, view);
 		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
+		m_pShaderManager->setMat4Value(m_projectionUniform, projection);
 		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		m_pShaderManager->setVec3Value(m_viewPositionUniform, g_pCamera->Position);
 	}
 }
@@ -24,8 +24,16 @@ public:
 	// destructor
 	~ViewManager();
 
+	// size of the display window, and of the offscreen
+	// framebuffer when rendering headless
+	static const int WINDOW_WIDTH = 1000;
+	static const int WINDOW_HEIGHT = 800;
+
 	// mouse position callback for mouse interaction with the 3D scene
 	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+
+	// mouse button callback for picking objects in the 3D scene
+	static void Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods);
 	
 	// mouse scroll wheel callback
 	static void Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset);
@@ -35,6 +43,17 @@ private:
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// seconds advanced every frame, 0 to use the wall clock
+	float m_fixedTimestep;
+
+	// program the uniform handles below were resolved from
+	GLuint m_uniformProgramID;
+	// pre-resolved shader uniforms for the scene view
+	ShaderUniform<glm::mat4> m_viewUniform;
+	ShaderUniform<glm::mat4> m_projectionUniform;
+	ShaderUniform<glm::vec3> m_viewPositionUniform;
+	// projection times view matrix of the last prepared frame
+	glm::mat4 m_viewProjection;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
@@ -42,7 +61,24 @@ private:
 public:
 	// create the initial OpenGL display window
 	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	// set up the view for rendering into an offscreen framebuffer,
+	// with no window or keyboard and mouse input
+	void CreateOffscreenView();
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// advance every frame by the same number of seconds instead of
+	// the measured time, so that camera movement is repeatable
+	void SetFixedTimestep(float seconds);
+	// the time the last frame advanced by, in seconds
+	float GetDeltaTime() const;
+	// the camera used for viewing the 3D scene
+	Camera* GetCamera() const;
+	// the projection times view matrix set by PrepareSceneView(),
+	// which the scene is culled by
+	const glm::mat4& GetViewProjection() const { return(m_viewProjection); }
+	// get the world space ray through the mouse cursor, false when
+	// the scene has not been clicked since the last ray was taken
+	bool GetCursorRay(glm::vec3& origin, glm::vec3& direction);
 };
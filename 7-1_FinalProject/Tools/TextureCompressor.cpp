@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecompressor.cpp
+// ============
+// convert image files to block compressed KTX2 textures offline
+//
+// The image is decoded and flipped for OpenGL, its mip levels are built
+// and every level is block compressed, the same as the texture loader does
+// at run time.  The KTX2 file can then be passed to CreateGLTexture() in
+// place of the source image, so the scene skips all of that work.
+//
+//  usage: TextureCompressor [--compression none|s3tc|bptc] input output.ktx2
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "TextureCache.h"
+#include "BlockCompressor.h"
+#include "Ktx2File.h"
+
+/***********************************************************
+ *  main(int, char*)
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	TEXTURE_COMPRESSION compression = TEXTURE_COMPRESSION_BPTC;
+	const char* inputFile = NULL;
+	const char* outputFile = NULL;
+	bool bValid = true;
+
+	for (int i = 1; (i < argc) && bValid; i++)
+	{
+		if ((strcmp(argv[i], "--compression") == 0) && (i + 1 < argc))
+		{
+			const char* name = argv[++i];
+			if (strcmp(name, "none") == 0)
+			{
+				compression = TEXTURE_COMPRESSION_NONE;
+			}
+			else if (strcmp(name, "s3tc") == 0)
+			{
+				compression = TEXTURE_COMPRESSION_S3TC;
+			}
+			else if (strcmp(name, "bptc") == 0)
+			{
+				compression = TEXTURE_COMPRESSION_BPTC;
+			}
+			else
+			{
+				bValid = false;
+			}
+		}
+		else if (NULL == inputFile)
+		{
+			inputFile = argv[i];
+		}
+		else if (NULL == outputFile)
+		{
+			outputFile = argv[i];
+		}
+		else
+		{
+			bValid = false;
+		}
+	}
+
+	if ((bValid == false) || (NULL == outputFile))
+	{
+		std::cerr << "usage: TextureCompressor [--compression none|s3tc|bptc] input output.ktx2" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* pixels = stbi_load(inputFile, &width, &height, &colorChannels, 0);
+	if (NULL == pixels)
+	{
+		std::cerr << "Could not load image:" << inputFile << std::endl;
+		return(EXIT_FAILURE);
+	}
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		std::cerr << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+		stbi_image_free(pixels);
+		return(EXIT_FAILURE);
+	}
+
+	TEXTURE_IMAGE::MIP_LEVEL level;
+	level.width = width;
+	level.height = height;
+	level.offset = 0;
+	level.size = (size_t)width * height * colorChannels;
+
+	TEXTURE_IMAGE image;
+	image.width = width;
+	image.height = height;
+	image.colorChannels = colorChannels;
+	image.format = (colorChannels == 4) ? TEXTURE_FORMAT_RGBA8 : TEXTURE_FORMAT_RGB8;
+	image.levels.push_back(level);
+	image.decodedPixels.assign(pixels, pixels + level.size);
+	stbi_image_free(pixels);
+
+	TextureCache::BuildMipLevels(image);
+	size_t uncompressedSize = image.GetPixelsSize();
+	BlockCompressor::CompressImage(image, compression);
+
+	if (Ktx2File::Write(outputFile, image) == false)
+	{
+		std::cerr << "Could not write " << outputFile << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << outputFile << ": " << width << "x" << height << ", " << image.levels.size() << " levels, "
+		<< uncompressedSize << " -> " << image.GetPixelsSize() << " bytes in " << milliseconds << " ms" << std::endl;
+
+	return(EXIT_SUCCESS);
+}
@@ -0,0 +1,669 @@
+///////////////////////////////////////////////////////////////////////////////
+// blockcompressor.cpp
+// ============
+// compress texture images to the BC1, BC3 and BC7 block formats
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BlockCompressor.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+	// texels in a 4x4 block
+	const int g_BlockTexels = 16;
+
+	// the weight of the second endpoint for each BC1 2 bit index,
+	// out of 3
+	const int g_BC1Weights[4] = { 0, 3, 1, 2 };
+	// the weight of the second endpoint for each BC7 4 bit index,
+	// out of 64
+	const int g_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// the endpoints are fitted, then refined this many times
+	const int g_RefineSteps = 2;
+
+	// positions along the endpoint line in the index lookup tables
+	const int g_LookupSteps = 64;
+
+	// the palette index nearest to each position along the line
+	// between the endpoints
+	struct INDEX_LOOKUP
+	{
+		unsigned char indices[g_LookupSteps + 1];
+
+		INDEX_LOOKUP(const int* weights, int paletteSize, int totalWeight)
+		{
+			for (int i = 0; i <= g_LookupSteps; i++)
+			{
+				int bestIndex = 0;
+				for (int p = 1; p < paletteSize; p++)
+				{
+					if (std::abs(weights[p] * g_LookupSteps - i * totalWeight) <
+						std::abs(weights[bestIndex] * g_LookupSteps - i * totalWeight))
+					{
+						bestIndex = p;
+					}
+				}
+				indices[i] = (unsigned char)bestIndex;
+			}
+		}
+	};
+
+	// the texels of one block as floats, with up to four channels
+	struct BLOCK_TEXELS
+	{
+		float values[g_BlockTexels][4];
+		int channels;
+	};
+
+	// two endpoint colors
+	struct ENDPOINTS
+	{
+		float start[4];
+		float end[4];
+	};
+
+	// writes values into a block, lowest bit first
+	struct BIT_WRITER
+	{
+		unsigned char* pBlock;
+		int position;
+
+		void Write(uint32_t value, int bits)
+		{
+			for (int i = 0; i < bits; i++)
+			{
+				if ((value >> i) & 1)
+				{
+					pBlock[position >> 3] |= (unsigned char)(1 << (position & 7));
+				}
+				position++;
+			}
+		}
+	};
+
+	/***********************************************************
+	 *  LoadTexels()
+	 *
+	 *  Get the channels of the texels of a block as floats.
+	 ***********************************************************/
+	void LoadTexels(const unsigned char* texels, int channels, BLOCK_TEXELS& block)
+	{
+		block.channels = channels;
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				block.values[i][c] = (c < channels) ? (float)texels[i * 4 + c] : 0.0f;
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  FitEndpoints()
+	 *
+	 *  Find the two endpoints of the line that best fits the
+	 *  texels of a block - the principal axis through their
+	 *  mean, clipped to the range of the texels along it.
+	 ***********************************************************/
+	void FitEndpoints(const BLOCK_TEXELS& block, ENDPOINTS& endpoints)
+	{
+		const int channels = block.channels;
+		float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				mean[c] += block.values[i][c] / g_BlockTexels;
+			}
+		}
+
+		float covariance[4][4] = {};
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++)
+				{
+					covariance[a][b] += (block.values[i][a] - mean[a]) * (block.values[i][b] - mean[b]);
+				}
+			}
+		}
+
+		// a few power iterations are enough to find the axis of
+		// the largest spread
+		float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float length = 0.0f;
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				length = std::max(length, std::fabs(next[a]));
+			}
+			if (length < 1e-6f)
+			{
+				break;
+			}
+			for (int a = 0; a < channels; a++)
+			{
+				axis[a] = next[a] / length;
+			}
+		}
+
+		float axisLength = 0.0f;
+		for (int c = 0; c < channels; c++)
+		{
+			axisLength += axis[c] * axis[c];
+		}
+
+		float minimum = 0.0f;
+		float maximum = 0.0f;
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < channels; c++)
+			{
+				t += (block.values[i][c] - mean[c]) * axis[c];
+			}
+			t /= axisLength;
+			minimum = std::min(minimum, t);
+			maximum = std::max(maximum, t);
+		}
+
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints.start[c] = std::min(std::max(mean[c] + axis[c] * minimum, 0.0f), 255.0f);
+			endpoints.end[c] = std::min(std::max(mean[c] + axis[c] * maximum, 0.0f), 255.0f);
+		}
+	}
+
+	/***********************************************************
+	 *  RefineEndpoints()
+	 *
+	 *  Find the endpoints that best fit the texels by least
+	 *  squares, for the weight of the end endpoint that was
+	 *  picked for each texel.  The endpoints are kept when the
+	 *  weights do not determine them.
+	 ***********************************************************/
+	void RefineEndpoints(const BLOCK_TEXELS& block, const float* weights, ENDPOINTS& endpoints)
+	{
+		float startSquares = 0.0f;
+		float endSquares = 0.0f;
+		float products = 0.0f;
+		float startSums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float endSums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			float endWeight = weights[i];
+			float startWeight = 1.0f - endWeight;
+			startSquares += startWeight * startWeight;
+			endSquares += endWeight * endWeight;
+			products += startWeight * endWeight;
+			for (int c = 0; c < block.channels; c++)
+			{
+				startSums[c] += startWeight * block.values[i][c];
+				endSums[c] += endWeight * block.values[i][c];
+			}
+		}
+
+		float determinant = startSquares * endSquares - products * products;
+		if (std::fabs(determinant) < 1e-6f)
+		{
+			return;
+		}
+
+		for (int c = 0; c < block.channels; c++)
+		{
+			float start = (startSums[c] * endSquares - endSums[c] * products) / determinant;
+			float end = (endSums[c] * startSquares - startSums[c] * products) / determinant;
+			endpoints.start[c] = std::min(std::max(start, 0.0f), 255.0f);
+			endpoints.end[c] = std::min(std::max(end, 0.0f), 255.0f);
+		}
+	}
+
+	/***********************************************************
+	 *  PickIndices()
+	 *
+	 *  Pick the palette color for each texel, returning the
+	 *  total squared error of the block.  The palette colors
+	 *  lie on the line between the endpoints, so each texel is
+	 *  projected onto that line and the index of the nearest
+	 *  weight is looked up, instead of measuring every color.
+	 *  The first and last colors are the endpoints.
+	 ***********************************************************/
+	float PickIndices(const BLOCK_TEXELS& block, const int (*palette)[4], int first, int last, const INDEX_LOOKUP& lookup, int* indices)
+	{
+		float direction[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float lengthSquared = 0.0f;
+		for (int c = 0; c < block.channels; c++)
+		{
+			direction[c] = (float)(palette[last][c] - palette[first][c]);
+			lengthSquared += direction[c] * direction[c];
+		}
+		float scale = (lengthSquared > 0.0f) ? g_LookupSteps / lengthSquared : 0.0f;
+
+		float totalError = 0.0f;
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < block.channels; c++)
+			{
+				t += (block.values[i][c] - (float)palette[first][c]) * direction[c];
+			}
+			int step = std::min(std::max((int)(t * scale + 0.5f), 0), g_LookupSteps);
+			indices[i] = lookup.indices[step];
+
+			for (int c = 0; c < block.channels; c++)
+			{
+				float difference = block.values[i][c] - (float)palette[indices[i]][c];
+				totalError += difference * difference;
+			}
+		}
+
+		return(totalError);
+	}
+
+	/***********************************************************
+	 *  Expand565()
+	 *
+	 *  Get the 8 bit channels of a 5:6:5 color.
+	 ***********************************************************/
+	void Expand565(uint16_t color, int* channels)
+	{
+		int r = (color >> 11) & 31;
+		int g = (color >> 5) & 63;
+		int b = color & 31;
+		channels[0] = (r << 3) | (r >> 2);
+		channels[1] = (g << 2) | (g >> 4);
+		channels[2] = (b << 3) | (b >> 2);
+		channels[3] = 255;
+	}
+
+	/***********************************************************
+	 *  Quantize565()
+	 *
+	 *  Round an endpoint to the nearest 5:6:5 color.
+	 ***********************************************************/
+	uint16_t Quantize565(const float* color)
+	{
+		int r = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+		int g = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+		int b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+		return((uint16_t)((r << 11) | (g << 5) | b));
+	}
+
+	/***********************************************************
+	 *  EncodeColorBlock()
+	 *
+	 *  Compress the colors of a block to the 8 byte BC1 color
+	 *  block that BC1 and BC3 share.  The first endpoint is
+	 *  always the larger, so all four colors are opaque.
+	 ***********************************************************/
+	void EncodeColorBlock(const unsigned char* texels, unsigned char* pBlock)
+	{
+		static const INDEX_LOOKUP lookup(g_BC1Weights, 4, 3);
+
+		BLOCK_TEXELS block;
+		LoadTexels(texels, 3, block);
+
+		ENDPOINTS endpoints;
+		FitEndpoints(block, endpoints);
+
+		float bestError = 1e30f;
+		uint16_t bestColors[2] = { 0, 0 };
+		int bestIndices[g_BlockTexels] = {};
+
+		for (int step = 0; step <= g_RefineSteps; step++)
+		{
+			uint16_t colors[2] = { Quantize565(endpoints.start), Quantize565(endpoints.end) };
+			if (colors[0] < colors[1])
+			{
+				std::swap(colors[0], colors[1]);
+			}
+
+			int palette[4][4];
+			Expand565(colors[0], palette[0]);
+			Expand565(colors[1], palette[1]);
+			for (int c = 0; c < 4; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+			}
+
+			int indices[g_BlockTexels];
+			float error = PickIndices(block, palette, 0, 1, lookup, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				bestColors[0] = colors[0];
+				bestColors[1] = colors[1];
+				memcpy(bestIndices, indices, sizeof(indices));
+			}
+
+			float texelWeights[g_BlockTexels];
+			for (int i = 0; i < g_BlockTexels; i++)
+			{
+				texelWeights[i] = g_BC1Weights[indices[i]] / 3.0f;
+			}
+			// the endpoints may have been swapped to order the colors
+			for (int c = 0; c < 4; c++)
+			{
+				endpoints.start[c] = (float)palette[0][c];
+				endpoints.end[c] = (float)palette[1][c];
+			}
+			RefineEndpoints(block, texelWeights, endpoints);
+		}
+
+		pBlock[0] = (unsigned char)(bestColors[0] & 0xFF);
+		pBlock[1] = (unsigned char)(bestColors[0] >> 8);
+		pBlock[2] = (unsigned char)(bestColors[1] & 0xFF);
+		pBlock[3] = (unsigned char)(bestColors[1] >> 8);
+
+		uint32_t indexBits = 0;
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			indexBits |= (uint32_t)bestIndices[i] << (i * 2);
+		}
+		memcpy(pBlock + 4, &indexBits, 4);
+	}
+
+	/***********************************************************
+	 *  EncodeAlphaBlock()
+	 *
+	 *  Compress the alpha of a block to the 8 byte BC3 alpha
+	 *  block, with eight alpha values between the smallest and
+	 *  the largest alpha of the block.
+	 ***********************************************************/
+	void EncodeAlphaBlock(const unsigned char* texels, unsigned char* pBlock)
+	{
+		int minimum = 255;
+		int maximum = 0;
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			minimum = std::min(minimum, (int)texels[i * 4 + 3]);
+			maximum = std::max(maximum, (int)texels[i * 4 + 3]);
+		}
+
+		int palette[8];
+		palette[0] = maximum;
+		palette[1] = minimum;
+		for (int i = 1; i < 7; i++)
+		{
+			palette[i + 1] = ((7 - i) * maximum + i * minimum + 3) / 7;
+		}
+
+		uint64_t indexBits = 0;
+		for (int i = 0; (i < g_BlockTexels) && (maximum > minimum); i++)
+		{
+			int alpha = texels[i * 4 + 3];
+			int bestIndex = 0;
+			for (int p = 1; p < 8; p++)
+			{
+				if (std::abs(palette[p] - alpha) < std::abs(palette[bestIndex] - alpha))
+				{
+					bestIndex = p;
+				}
+			}
+			indexBits |= (uint64_t)bestIndex << (i * 3);
+		}
+
+		pBlock[0] = (unsigned char)maximum;
+		pBlock[1] = (unsigned char)minimum;
+		for (int i = 0; i < 6; i++)
+		{
+			pBlock[2 + i] = (unsigned char)(indexBits >> (i * 8));
+		}
+	}
+
+	/***********************************************************
+	 *  QuantizeBC7Endpoint()
+	 *
+	 *  Round an endpoint to 7 bits per channel and a shared
+	 *  lowest bit, picking the lowest bit that fits best.
+	 ***********************************************************/
+	void QuantizeBC7Endpoint(const float* color, int* channels, int& pBit)
+	{
+		float bestError = 1e30f;
+
+		for (int p = 0; p < 2; p++)
+		{
+			int quantized[4];
+			float error = 0.0f;
+			for (int c = 0; c < 4; c++)
+			{
+				quantized[c] = std::min(std::max((int)((color[c] - p) / 2.0f + 0.5f), 0), 127);
+				float difference = color[c] - (float)((quantized[c] << 1) | p);
+				error += difference * difference;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				pBit = p;
+				memcpy(channels, quantized, sizeof(quantized));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GetCompressedFormat()
+ *
+ *  This method is used to get the format an image with the
+ *  passed in number of channels is compressed to.
+ ***********************************************************/
+TEXTURE_FORMAT BlockCompressor::GetCompressedFormat(TEXTURE_COMPRESSION compression, int colorChannels)
+{
+	switch (compression)
+	{
+	case TEXTURE_COMPRESSION_S3TC:
+		return((colorChannels == 4) ? TEXTURE_FORMAT_BC3 : TEXTURE_FORMAT_BC1);
+	case TEXTURE_COMPRESSION_BPTC:
+		return(TEXTURE_FORMAT_BC7);
+	default:
+		return((colorChannels == 4) ? TEXTURE_FORMAT_RGBA8 : TEXTURE_FORMAT_RGB8);
+	}
+}
+
+/***********************************************************
+ *  CompressImage()
+ *
+ *  This method is used to compress every mip level of a
+ *  decoded RGB8 or RGBA8 image, replacing its pixels.  The
+ *  blocks on the right and top edges of levels that are not
+ *  a multiple of 4 repeat their last column and row.
+ ***********************************************************/
+bool BlockCompressor::CompressImage(TEXTURE_IMAGE& image, TEXTURE_COMPRESSION compression)
+{
+	const int channels = image.colorChannels;
+	if ((NULL != image.pMappedPixels) || image.levels.empty() ||
+		((image.format != TEXTURE_FORMAT_RGB8) && (image.format != TEXTURE_FORMAT_RGBA8)))
+	{
+		return(false);
+	}
+
+	TEXTURE_FORMAT format = GetCompressedFormat(compression, channels);
+	if (format == image.format)
+	{
+		return(true);
+	}
+
+	size_t totalSize = 0;
+	for (size_t i = 0; i < image.levels.size(); i++)
+	{
+		totalSize += TEXTURE_IMAGE::GetLevelSize(format, image.levels[i].width, image.levels[i].height);
+	}
+	std::vector<unsigned char> compressed(totalSize, 0);
+	const size_t blockSize = TEXTURE_IMAGE::GetLevelSize(format, 1, 1);
+
+	size_t offset = 0;
+	for (size_t i = 0; i < image.levels.size(); i++)
+	{
+		TEXTURE_IMAGE::MIP_LEVEL& level = image.levels[i];
+		const unsigned char* pSource = image.decodedPixels.data() + level.offset;
+		unsigned char* pTarget = compressed.data() + offset;
+
+		for (int blockY = 0; blockY < level.height; blockY += 4)
+		{
+			for (int blockX = 0; blockX < level.width; blockX += 4)
+			{
+				unsigned char texels[g_BlockTexels * 4];
+				for (int i = 0; i < g_BlockTexels; i++)
+				{
+					int x = std::min(blockX + (i & 3), level.width - 1);
+					int y = std::min(blockY + (i >> 2), level.height - 1);
+					const unsigned char* pTexel = pSource + ((size_t)y * level.width + x) * channels;
+					texels[i * 4 + 0] = pTexel[0];
+					texels[i * 4 + 1] = pTexel[1];
+					texels[i * 4 + 2] = pTexel[2];
+					texels[i * 4 + 3] = (channels == 4) ? pTexel[3] : 255;
+				}
+
+				if (format == TEXTURE_FORMAT_BC1)
+				{
+					EncodeBC1Block(texels, pTarget);
+				}
+				else if (format == TEXTURE_FORMAT_BC3)
+				{
+					EncodeBC3Block(texels, pTarget);
+				}
+				else
+				{
+					EncodeBC7Block(texels, pTarget);
+				}
+				pTarget += blockSize;
+			}
+		}
+
+		level.offset = offset;
+		level.size = TEXTURE_IMAGE::GetLevelSize(format, level.width, level.height);
+		offset += level.size;
+	}
+
+	image.decodedPixels.swap(compressed);
+	image.format = format;
+
+	return(true);
+}
+
+/***********************************************************
+ *  EncodeBC1Block()
+ *
+ *  This method is used to compress a block to BC1, two
+ *  5:6:5 endpoints and a 2 bit index for each texel.  The
+ *  alpha of the texels is ignored.
+ ***********************************************************/
+void BlockCompressor::EncodeBC1Block(const unsigned char* texels, unsigned char* block)
+{
+	EncodeColorBlock(texels, block);
+}
+
+/***********************************************************
+ *  EncodeBC3Block()
+ *
+ *  This method is used to compress a block to BC3, an alpha
+ *  block followed by a BC1 color block.
+ ***********************************************************/
+void BlockCompressor::EncodeBC3Block(const unsigned char* texels, unsigned char* block)
+{
+	EncodeAlphaBlock(texels, block);
+	EncodeColorBlock(texels, block + 8);
+}
+
+/***********************************************************
+ *  EncodeBC7Block()
+ *
+ *  This method is used to compress a block to BC7 mode 6,
+ *  two RGBA endpoints of 7 bits per channel plus a shared
+ *  lowest bit each, and a 4 bit index for each texel.
+ ***********************************************************/
+void BlockCompressor::EncodeBC7Block(const unsigned char* texels, unsigned char* block)
+{
+	static const INDEX_LOOKUP lookup(g_BC7Weights, 16, 64);
+
+	BLOCK_TEXELS blockTexels;
+	LoadTexels(texels, 4, blockTexels);
+
+	ENDPOINTS endpoints;
+	FitEndpoints(blockTexels, endpoints);
+
+	float bestError = 1e30f;
+	int bestEndpoints[2][4] = {};
+	int bestPBits[2] = { 0, 0 };
+	int bestIndices[g_BlockTexels] = {};
+
+	for (int step = 0; step <= g_RefineSteps; step++)
+	{
+		int quantized[2][4];
+		int pBits[2];
+		QuantizeBC7Endpoint(endpoints.start, quantized[0], pBits[0]);
+		QuantizeBC7Endpoint(endpoints.end, quantized[1], pBits[1]);
+
+		int palette[16][4];
+		for (int p = 0; p < 16; p++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				int start = (quantized[0][c] << 1) | pBits[0];
+				int end = (quantized[1][c] << 1) | pBits[1];
+				palette[p][c] = ((64 - g_BC7Weights[p]) * start + g_BC7Weights[p] * end + 32) >> 6;
+			}
+		}
+
+		int indices[g_BlockTexels];
+		float error = PickIndices(blockTexels, palette, 0, 15, lookup, indices);
+		if (error < bestError)
+		{
+			bestError = error;
+			memcpy(bestEndpoints, quantized, sizeof(quantized));
+			memcpy(bestPBits, pBits, sizeof(pBits));
+			memcpy(bestIndices, indices, sizeof(indices));
+		}
+
+		float texelWeights[g_BlockTexels];
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			texelWeights[i] = g_BC7Weights[indices[i]] / 64.0f;
+		}
+		RefineEndpoints(blockTexels, texelWeights, endpoints);
+	}
+
+	// the highest bit of the first index is not stored, so the
+	// endpoints are swapped when it would be set
+	if (bestIndices[0] >= 8)
+	{
+		std::swap(bestEndpoints[0], bestEndpoints[1]);
+		std::swap(bestPBits[0], bestPBits[1]);
+		for (int i = 0; i < g_BlockTexels; i++)
+		{
+			bestIndices[i] = 15 - bestIndices[i];
+		}
+	}
+
+	memset(block, 0, 16);
+	BIT_WRITER writer = { block, 0 };
+	writer.Write(1 << 6, 7);
+	for (int c = 0; c < 4; c++)
+	{
+		writer.Write(bestEndpoints[0][c], 7);
+		writer.Write(bestEndpoints[1][c], 7);
+	}
+	writer.Write(bestPBits[0], 1);
+	writer.Write(bestPBits[1], 1);
+	writer.Write(bestIndices[0], 3);
+	for (int i = 1; i < g_BlockTexels; i++)
+	{
+		writer.Write(bestIndices[i], 4);
+	}
+}
@@ -0,0 +1,32 @@
+///////////////////////////////////////////////////////////////////////////////
+// blockcompressor.h
+// ============
+// compress texture images to the BC1, BC3 and BC7 block formats
+//
+// Every 4x4 block of texels is fitted with two endpoint colors along the
+// principal axis of its colors, which are then refined by least squares
+// for the indices that were picked.  BC7 blocks only use mode 6, a single
+// RGBA endpoint pair with 16 interpolated colors, which suits the smooth
+// photographic textures of the scene.  Images can be compressed on the
+// texture loader threads and in the offline TextureCompressor.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureCache.h"
+
+class BlockCompressor
+{
+public:
+	// get the format an image is compressed to, TEXTURE_FORMAT_RGB8 or
+	// TEXTURE_FORMAT_RGBA8 when it is left uncompressed
+	static TEXTURE_FORMAT GetCompressedFormat(TEXTURE_COMPRESSION compression, int colorChannels);
+
+	// compress every mip level of an uncompressed image in place
+	static bool CompressImage(TEXTURE_IMAGE& image, TEXTURE_COMPRESSION compression);
+
+	// compress one block of 16 RGBA texels, in the order they are stored
+	static void EncodeBC1Block(const unsigned char* texels, unsigned char* block);
+	static void EncodeBC3Block(const unsigned char* texels, unsigned char* block);
+	static void EncodeBC7Block(const unsigned char* texels, unsigned char* block);
+};
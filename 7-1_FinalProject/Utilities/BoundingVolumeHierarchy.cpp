@@ -0,0 +1,713 @@
+///////////////////////////////////////////////////////////////////////////////
+// boundingvolumehierarchy.cpp
+// ============
+// tree of bounding boxes over the objects of a scene, for culling, picking
+// and nearest object queries that do not visit every object
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BoundingVolumeHierarchy.h"
+
+#include <cfloat>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+	// bins the item centers are sorted into along each axis
+	const int g_BinCount = 12;
+	// a node with more items than this is always split
+	const int g_MaxLeafItems = 8;
+	// cost of visiting a node, relative to testing an item box
+	const float g_TraversalCost = 1.0f;
+	// every node is swept by a refit once more leaves than one in
+	// this many nodes are listed
+	const size_t g_RefitSweepShare = 64;
+	// largest inverse ray direction - a ray along a slab plane
+	// would otherwise multiply 0 by infinity, which is NaN
+	const float g_MaxInverseDirection = 1.0e30f;
+
+	// the items of a node that have their centers in one bin
+	struct BIN
+	{
+		glm::vec3 boxMin;
+		glm::vec3 boxMax;
+		int count;
+	};
+
+	// a node waiting to be visited by a query, with the distance
+	// it was found at
+	typedef std::pair<int, float> PENDING_NODE;
+
+	/***********************************************************
+	 *  GetSurfaceArea()
+	 *
+	 *  Get the surface area of a box.
+	 ***********************************************************/
+	float GetSurfaceArea(const glm::vec3& boxMin, const glm::vec3& boxMax)
+	{
+		glm::vec3 size = boxMax - boxMin;
+		return(2.0f * ((size.x * size.y) + (size.y * size.z) + (size.z * size.x)));
+	}
+
+	/***********************************************************
+	 *  FitItemBoxes()
+	 *
+	 *  Get the box holding a run of the item order, with the
+	 *  boxes stored by item as they are passed in to a build.
+	 ***********************************************************/
+	void FitItemBoxes(
+		const std::vector<int>& itemOrder,
+		int first,
+		int count,
+		const std::vector<glm::vec3>& boxMins,
+		const std::vector<glm::vec3>& boxMaxs,
+		glm::vec3& boxMin,
+		glm::vec3& boxMax)
+	{
+		boxMin = glm::vec3(FLT_MAX);
+		boxMax = glm::vec3(-FLT_MAX);
+		for (int i = first; i < first + count; i++)
+		{
+			boxMin = glm::min(boxMin, boxMins[itemOrder[i]]);
+			boxMax = glm::max(boxMax, boxMaxs[itemOrder[i]]);
+		}
+	}
+
+	/***********************************************************
+	 *  IntersectRayBox()
+	 *
+	 *  Get the distance along a ray to where it enters a box,
+	 *  which is 0 when the ray starts inside of the box.  False
+	 *  is returned when the box is missed, or is entered past
+	 *  the maximum distance.
+	 ***********************************************************/
+	bool IntersectRayBox(
+		const glm::vec3& origin,
+		const glm::vec3& inverseDirection,
+		const glm::vec3& boxMin,
+		const glm::vec3& boxMax,
+		float maxDistance,
+		float& entry)
+	{
+		glm::vec3 slab0 = (boxMin - origin) * inverseDirection;
+		glm::vec3 slab1 = (boxMax - origin) * inverseDirection;
+		glm::vec3 slabNear = glm::min(slab0, slab1);
+		glm::vec3 slabFar = glm::max(slab0, slab1);
+
+		entry = glm::max(glm::max(slabNear.x, slabNear.y), glm::max(slabNear.z, 0.0f));
+		float exit = glm::min(glm::min(slabFar.x, slabFar.y), glm::min(slabFar.z, maxDistance));
+
+		return(entry <= exit);
+	}
+
+	/***********************************************************
+	 *  GetBoxDistance()
+	 *
+	 *  Get the distance from a point to the nearest point of
+	 *  a box, 0 when the point is inside of the box.
+	 ***********************************************************/
+	float GetBoxDistance(const glm::vec3& point, const glm::vec3& boxMin, const glm::vec3& boxMax)
+	{
+		glm::vec3 outside = glm::max(glm::max(boxMin - point, point - boxMax), glm::vec3(0.0f));
+		return(glm::length(outside));
+	}
+}
+
+/***********************************************************
+ *  BoundingVolumeHierarchy()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+{
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used to build the tree over the passed in
+ *  item boxes.  Nodes are split from the root down until the
+ *  surface area heuristic finds that testing the items of
+ *  a node is cheaper than splitting it.
+ ***********************************************************/
+void BoundingVolumeHierarchy::Build(
+	const std::vector<glm::vec3>& boxMins,
+	const std::vector<glm::vec3>& boxMaxs)
+{
+	int count = (int)std::min(boxMins.size(), boxMaxs.size());
+
+	Clear();
+	if (count == 0)
+	{
+		return;
+	}
+
+	m_itemOrder.resize(count);
+	m_itemLeaf.resize(count);
+
+	std::vector<glm::vec3> centers(count);
+	for (int i = 0; i < count; i++)
+	{
+		centers[i] = (boxMins[i] + boxMaxs[i]) * 0.5f;
+		m_itemOrder[i] = i;
+	}
+
+	// a tree of n items never has more than 2n - 1 nodes, so
+	// the nodes are never moved while they are being split
+	m_nodes.reserve(2 * count - 1);
+
+	BVH_NODE root;
+	root.first = 0;
+	root.itemCount = count;
+	root.parent = -1;
+	FitItemBoxes(m_itemOrder, 0, count, boxMins, boxMaxs, root.boxMin, root.boxMax);
+	m_nodes.push_back(root);
+
+	std::vector<int> pending(1, 0);
+	while (pending.empty() == false)
+	{
+		int node = pending.back();
+		pending.pop_back();
+
+		if (SplitNode(node, centers, boxMins, boxMaxs) == true)
+		{
+			pending.push_back(m_nodes[node].first);
+			pending.push_back(m_nodes[node].first + 1);
+		}
+	}
+
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		for (int j = 0; j < m_nodes[i].itemCount; j++)
+		{
+			m_itemLeaf[m_itemOrder[m_nodes[i].first + j]] = (int)i;
+		}
+	}
+
+	// the boxes are moved into the item order, so that the
+	// items of a leaf are read one after another
+	m_itemEntry.resize(count);
+	m_itemMin.resize(count);
+	m_itemMax.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		m_itemEntry[m_itemOrder[i]] = i;
+		m_itemMin[i] = boxMins[m_itemOrder[i]];
+		m_itemMax[i] = boxMaxs[m_itemOrder[i]];
+	}
+	m_nodeRefit.assign(m_nodes.size(), 0);
+}
+
+/***********************************************************
+ *  SplitNode()
+ *
+ *  This method is used to split the items of a leaf between
+ *  two new children.  The item centers are sorted into bins
+ *  along each axis, and the split between two bins with the
+ *  lowest surface area cost is used.  False is returned when
+ *  the node is cheaper to keep as a leaf.
+ ***********************************************************/
+bool BoundingVolumeHierarchy::SplitNode(
+	int nodeIndex,
+	const std::vector<glm::vec3>& centers,
+	const std::vector<glm::vec3>& boxMins,
+	const std::vector<glm::vec3>& boxMaxs)
+{
+	int first = m_nodes[nodeIndex].first;
+	int count = m_nodes[nodeIndex].itemCount;
+
+	if (count <= 1)
+	{
+		return(false);
+	}
+
+	glm::vec3 centerMin = centers[m_itemOrder[first]];
+	glm::vec3 centerMax = centerMin;
+	for (int i = first + 1; i < first + count; i++)
+	{
+		centerMin = glm::min(centerMin, centers[m_itemOrder[i]]);
+		centerMax = glm::max(centerMax, centers[m_itemOrder[i]]);
+	}
+
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	int bestBin = 0;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = centerMax[axis] - centerMin[axis];
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		BIN bins[g_BinCount];
+		for (int b = 0; b < g_BinCount; b++)
+		{
+			bins[b].boxMin = glm::vec3(FLT_MAX);
+			bins[b].boxMax = glm::vec3(-FLT_MAX);
+			bins[b].count = 0;
+		}
+
+		float binScale = g_BinCount / extent;
+		for (int i = first; i < first + count; i++)
+		{
+			int item = m_itemOrder[i];
+			int b = std::min(g_BinCount - 1, (int)((centers[item][axis] - centerMin[axis]) * binScale));
+			bins[b].boxMin = glm::min(bins[b].boxMin, boxMins[item]);
+			bins[b].boxMax = glm::max(bins[b].boxMax, boxMaxs[item]);
+			bins[b].count++;
+		}
+
+		// the area and items on the left of each split, then
+		// the cost of each split swept in from the right
+		float leftArea[g_BinCount - 1];
+		int leftCount[g_BinCount - 1];
+		glm::vec3 boxMin(FLT_MAX);
+		glm::vec3 boxMax(-FLT_MAX);
+		int itemCount = 0;
+		for (int b = 0; b < g_BinCount - 1; b++)
+		{
+			boxMin = glm::min(boxMin, bins[b].boxMin);
+			boxMax = glm::max(boxMax, bins[b].boxMax);
+			itemCount += bins[b].count;
+			leftArea[b] = (itemCount > 0) ? GetSurfaceArea(boxMin, boxMax) : 0.0f;
+			leftCount[b] = itemCount;
+		}
+
+		boxMin = glm::vec3(FLT_MAX);
+		boxMax = glm::vec3(-FLT_MAX);
+		itemCount = 0;
+		for (int b = g_BinCount - 1; b > 0; b--)
+		{
+			boxMin = glm::min(boxMin, bins[b].boxMin);
+			boxMax = glm::max(boxMax, bins[b].boxMax);
+			itemCount += bins[b].count;
+			if ((itemCount == 0) || (leftCount[b - 1] == 0))
+			{
+				continue;
+			}
+
+			float cost = (leftArea[b - 1] * leftCount[b - 1]) + (GetSurfaceArea(boxMin, boxMax) * itemCount);
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = b - 1;
+			}
+		}
+	}
+
+	int middle = first + (count / 2);
+	if (bestAxis < 0)
+	{
+		// every center is in the same place, so there is no
+		// better split than halving a node that is too large
+		if (count <= g_MaxLeafItems)
+		{
+			return(false);
+		}
+	}
+	else
+	{
+		float nodeArea = GetSurfaceArea(m_nodes[nodeIndex].boxMin, m_nodes[nodeIndex].boxMax);
+		float splitCost = g_TraversalCost + ((nodeArea > 0.0f) ? (bestCost / nodeArea) : (float)count);
+		if ((splitCost >= (float)count) && (count <= g_MaxLeafItems))
+		{
+			return(false);
+		}
+
+		float binScale = g_BinCount / (centerMax[bestAxis] - centerMin[bestAxis]);
+		float axisMin = centerMin[bestAxis];
+		int axis = bestAxis;
+		int splitBin = bestBin;
+		std::vector<int>::iterator split = std::partition(
+			m_itemOrder.begin() + first, m_itemOrder.begin() + first + count,
+			[&](int item) { return(std::min(g_BinCount - 1, (int)((centers[item][axis] - axisMin) * binScale)) <= splitBin); });
+
+		if ((split != m_itemOrder.begin() + first) && (split != m_itemOrder.begin() + first + count))
+		{
+			middle = (int)(split - m_itemOrder.begin());
+		}
+	}
+
+	int left = (int)m_nodes.size();
+	BVH_NODE child;
+	child.parent = nodeIndex;
+
+	child.first = first;
+	child.itemCount = middle - first;
+	FitItemBoxes(m_itemOrder, child.first, child.itemCount, boxMins, boxMaxs, child.boxMin, child.boxMax);
+	m_nodes.push_back(child);
+
+	child.first = middle;
+	child.itemCount = first + count - middle;
+	FitItemBoxes(m_itemOrder, child.first, child.itemCount, boxMins, boxMaxs, child.boxMin, child.boxMax);
+	m_nodes.push_back(child);
+
+	m_nodes[nodeIndex].first = left;
+	m_nodes[nodeIndex].itemCount = 0;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FitLeafBox()
+ *
+ *  This method is used to set the box of a leaf to hold
+ *  every one of its items.
+ ***********************************************************/
+void BoundingVolumeHierarchy::FitLeafBox(int nodeIndex)
+{
+	BVH_NODE& node = m_nodes[nodeIndex];
+
+	node.boxMin = glm::vec3(FLT_MAX);
+	node.boxMax = glm::vec3(-FLT_MAX);
+	for (int i = node.first; i < node.first + node.itemCount; i++)
+	{
+		node.boxMin = glm::min(node.boxMin, m_itemMin[i]);
+		node.boxMax = glm::max(node.boxMax, m_itemMax[i]);
+	}
+}
+
+/***********************************************************
+ *  UpdateItem()
+ *
+ *  This method is used to change the box of an item.  Only
+ *  its leaf is listed for the next refit, which lists the
+ *  nodes above it as it goes.
+ ***********************************************************/
+void BoundingVolumeHierarchy::UpdateItem(
+	int item,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax)
+{
+	if ((item < 0) || (item >= (int)m_itemEntry.size()))
+	{
+		return;
+	}
+
+	m_itemMin[m_itemEntry[item]] = boxMin;
+	m_itemMax[m_itemEntry[item]] = boxMax;
+
+	int leaf = m_itemLeaf[item];
+	if (m_nodeRefit[leaf] == 0)
+	{
+		m_nodeRefit[leaf] = 1;
+		m_refitNodes.push_back(leaf);
+	}
+}
+
+/***********************************************************
+ *  Refit()
+ *
+ *  This method is used to fit the boxes of the listed leaves
+ *  and every node above them to their items and children
+ *  again.  Children are stored after their parents, so
+ *  taking the highest listed node first fits every child
+ *  before its parent, and each parent is listed once its
+ *  child is fit.  A short list is kept as a heap, and when
+ *  many leaves are listed the flags of every node are swept
+ *  instead, which costs less than the heap.  The tree is not
+ *  changed, so it should be built again after the objects
+ *  have moved far from where they were built.
+ ***********************************************************/
+void BoundingVolumeHierarchy::Refit()
+{
+	if (m_refitNodes.size() * g_RefitSweepShare > m_nodes.size())
+	{
+		for (int i = (int)m_nodes.size() - 1; i >= 0; i--)
+		{
+			if (m_nodeRefit[i] != 0)
+			{
+				FitNodeBox(i);
+				m_nodeRefit[i] = 0;
+				if (m_nodes[i].parent >= 0)
+				{
+					m_nodeRefit[m_nodes[i].parent] = 1;
+				}
+			}
+		}
+	}
+	else
+	{
+		std::make_heap(m_refitNodes.begin(), m_refitNodes.end());
+
+		while (m_refitNodes.empty() == false)
+		{
+			std::pop_heap(m_refitNodes.begin(), m_refitNodes.end());
+			int node = m_refitNodes.back();
+			m_refitNodes.pop_back();
+
+			FitNodeBox(node);
+			m_nodeRefit[node] = 0;
+
+			int parent = m_nodes[node].parent;
+			if ((parent >= 0) && (m_nodeRefit[parent] == 0))
+			{
+				m_nodeRefit[parent] = 1;
+				m_refitNodes.push_back(parent);
+				std::push_heap(m_refitNodes.begin(), m_refitNodes.end());
+			}
+		}
+	}
+	m_refitNodes.clear();
+}
+
+/***********************************************************
+ *  FitNodeBox()
+ *
+ *  This method is used to fit the box of a node to its
+ *  items, or to the boxes of its two children.
+ ***********************************************************/
+void BoundingVolumeHierarchy::FitNodeBox(int nodeIndex)
+{
+	BVH_NODE& node = m_nodes[nodeIndex];
+
+	if (node.itemCount > 0)
+	{
+		FitLeafBox(nodeIndex);
+	}
+	else
+	{
+		node.boxMin = glm::min(m_nodes[node.first].boxMin, m_nodes[node.first + 1].boxMin);
+		node.boxMax = glm::max(m_nodes[node.first].boxMax, m_nodes[node.first + 1].boxMax);
+	}
+}
+
+/***********************************************************
+ *  QueryFrustum()
+ *
+ *  This method is used to find the items with boxes inside
+ *  of the frustum.  Nodes outside of the frustum are skipped
+ *  with all of their items, and every item below a node
+ *  entirely inside of the frustum is found without testing.
+ ***********************************************************/
+int BoundingVolumeHierarchy::QueryFrustum(
+	const Frustum& frustum,
+	std::vector<int>& items) const
+{
+	items.clear();
+	if (m_nodes.empty() == true)
+	{
+		return(0);
+	}
+
+	// the second value is 1 for nodes known to be inside
+	std::vector<std::pair<int, int> > pending;
+	pending.reserve(64);
+	pending.push_back(std::make_pair(0, 0));
+
+	while (pending.empty() == false)
+	{
+		const BVH_NODE& node = m_nodes[pending.back().first];
+		bool bInside = (pending.back().second != 0);
+		pending.pop_back();
+
+		if (bInside == false)
+		{
+			Frustum::CONTAINMENT containment = frustum.ClassifyBox(node.boxMin, node.boxMax);
+			if (containment == Frustum::CONTAINMENT_OUTSIDE)
+			{
+				continue;
+			}
+			bInside = (containment == Frustum::CONTAINMENT_INSIDE);
+		}
+
+		if (node.itemCount > 0)
+		{
+			for (int i = node.first; i < node.first + node.itemCount; i++)
+			{
+				if (bInside || frustum.IsBoxVisible(m_itemMin[i], m_itemMax[i]))
+				{
+					items.push_back(m_itemOrder[i]);
+				}
+			}
+		}
+		else
+		{
+			pending.push_back(std::make_pair(node.first, bInside ? 1 : 0));
+			pending.push_back(std::make_pair(node.first + 1, bInside ? 1 : 0));
+		}
+	}
+
+	return((int)items.size());
+}
+
+/***********************************************************
+ *  Raycast()
+ *
+ *  This method is used to find the nearest item box that a
+ *  ray hits.  The nearer child of each node is visited first,
+ *  and nodes entered past the nearest hit so far are skipped.
+ *  The distance is 0 when the ray starts inside of the box.
+ ***********************************************************/
+bool BoundingVolumeHierarchy::Raycast(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	int& item,
+	float& distance) const
+{
+	float length = glm::length(direction);
+	float entry = 0.0f;
+
+	item = -1;
+	distance = maxDistance;
+	if ((m_nodes.empty() == true) || (length <= 0.0f))
+	{
+		return(false);
+	}
+
+	// a direction component of 0 gives a finite inverse, so a ray
+	// along a slab is never tested with NaN - adding 0 turns -0
+	// into +0, so a ray along a face of a box always hits the box
+	// at its low face and misses it at its high face
+	glm::vec3 inverseDirection = glm::clamp(
+		1.0f / (direction / length + glm::vec3(0.0f)),
+		glm::vec3(-g_MaxInverseDirection),
+		glm::vec3(g_MaxInverseDirection));
+
+	if (IntersectRayBox(origin, inverseDirection, m_nodes[0].boxMin, m_nodes[0].boxMax, distance, entry) == false)
+	{
+		return(false);
+	}
+
+	std::vector<PENDING_NODE> pending;
+	pending.reserve(64);
+	pending.push_back(PENDING_NODE(0, entry));
+
+	while (pending.empty() == false)
+	{
+		PENDING_NODE next = pending.back();
+		pending.pop_back();
+		if (next.second > distance)
+		{
+			continue;
+		}
+
+		const BVH_NODE& node = m_nodes[next.first];
+		if (node.itemCount > 0)
+		{
+			for (int i = node.first; i < node.first + node.itemCount; i++)
+			{
+				if ((IntersectRayBox(origin, inverseDirection, m_itemMin[i], m_itemMax[i], distance, entry) == true) &&
+					((item < 0) || (entry < distance)))
+				{
+					item = m_itemOrder[i];
+					distance = entry;
+				}
+			}
+			continue;
+		}
+
+		float entries[2];
+		bool bHit[2];
+		for (int c = 0; c < 2; c++)
+		{
+			const BVH_NODE& child = m_nodes[node.first + c];
+			bHit[c] = IntersectRayBox(origin, inverseDirection, child.boxMin, child.boxMax, distance, entries[c]);
+		}
+
+		// the nearer child is pushed last, so it is visited first
+		int nearer = (entries[1] < entries[0]) ? 1 : 0;
+		if (bHit[1 - nearer] == true)
+		{
+			pending.push_back(PENDING_NODE(node.first + 1 - nearer, entries[1 - nearer]));
+		}
+		if (bHit[nearer] == true)
+		{
+			pending.push_back(PENDING_NODE(node.first + nearer, entries[nearer]));
+		}
+	}
+
+	return(item >= 0);
+}
+
+/***********************************************************
+ *  FindNearest()
+ *
+ *  This method is used to find the item box nearest to a
+ *  point.  The nearer child of each node is visited first,
+ *  and nodes farther away than the nearest item so far are
+ *  skipped.
+ ***********************************************************/
+bool BoundingVolumeHierarchy::FindNearest(
+	const glm::vec3& point,
+	float maxDistance,
+	int& item,
+	float& distance) const
+{
+	item = -1;
+	distance = maxDistance;
+	if (m_nodes.empty() == true)
+	{
+		return(false);
+	}
+
+	std::vector<PENDING_NODE> pending;
+	pending.reserve(64);
+	pending.push_back(PENDING_NODE(0, GetBoxDistance(point, m_nodes[0].boxMin, m_nodes[0].boxMax)));
+
+	while (pending.empty() == false)
+	{
+		PENDING_NODE next = pending.back();
+		pending.pop_back();
+		if (next.second > distance)
+		{
+			continue;
+		}
+
+		const BVH_NODE& node = m_nodes[next.first];
+		if (node.itemCount > 0)
+		{
+			for (int i = node.first; i < node.first + node.itemCount; i++)
+			{
+				float candidateDistance = GetBoxDistance(point, m_itemMin[i], m_itemMax[i]);
+				if ((candidateDistance <= distance) && ((item < 0) || (candidateDistance < distance)))
+				{
+					item = m_itemOrder[i];
+					distance = candidateDistance;
+				}
+			}
+			continue;
+		}
+
+		float distances[2];
+		for (int c = 0; c < 2; c++)
+		{
+			const BVH_NODE& child = m_nodes[node.first + c];
+			distances[c] = GetBoxDistance(point, child.boxMin, child.boxMax);
+		}
+
+		int nearer = (distances[1] < distances[0]) ? 1 : 0;
+		if (distances[1 - nearer] <= distance)
+		{
+			pending.push_back(PENDING_NODE(node.first + 1 - nearer, distances[1 - nearer]));
+		}
+		if (distances[nearer] <= distance)
+		{
+			pending.push_back(PENDING_NODE(node.first + nearer, distances[nearer]));
+		}
+	}
+
+	return(item >= 0);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used to remove all of the items and
+ *  nodes.
+ ***********************************************************/
+void BoundingVolumeHierarchy::Clear()
+{
+	m_nodes.clear();
+	m_itemOrder.clear();
+	m_itemLeaf.clear();
+	m_itemEntry.clear();
+	m_itemMin.clear();
+	m_itemMax.clear();
+	m_refitNodes.clear();
+	m_nodeRefit.clear();
+}
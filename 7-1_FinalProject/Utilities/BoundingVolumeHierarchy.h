@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// boundingvolumehierarchy.h
+// ============
+// tree of bounding boxes over the objects of a scene, for culling, picking
+// and nearest object queries that do not visit every object
+//
+// The tree is built top down, splitting each node where the surface area
+// heuristic estimates the cheapest queries, with the objects binned by the
+// centers of their boxes.  When objects move the boxes of the nodes above
+// them are refit without changing the tree, and only the nodes above the
+// objects that moved are visited.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Frustum.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class BoundingVolumeHierarchy
+{
+public:
+	// constructor
+	BoundingVolumeHierarchy();
+
+	// one node of the tree - the two children of an interior node are
+	// stored side by side, and a leaf holds a run of the item order
+	struct BVH_NODE
+	{
+		glm::vec3 boxMin;
+		int first;          // first child, or first entry of the item order
+		glm::vec3 boxMax;
+		int itemCount;      // number of items of a leaf, 0 for an interior node
+		int parent;         // parent node, -1 for the root
+	};
+
+	// build the tree over the passed in item boxes - an item is
+	// referenced by its index in the arrays
+	void Build(
+		const std::vector<glm::vec3>& boxMins,
+		const std::vector<glm::vec3>& boxMaxs);
+
+	// change the box of an item, which is refit by the next Refit()
+	void UpdateItem(
+		int item,
+		const glm::vec3& boxMin,
+		const glm::vec3& boxMax);
+	// grow or shrink the node boxes above the items that changed
+	void Refit();
+
+	// find the items with boxes inside of the frustum, returning
+	// the number found
+	int QueryFrustum(
+		const Frustum& frustum,
+		std::vector<int>& items) const;
+
+	// find the nearest item box hit by a ray within the maximum
+	// distance, measured along the normalized direction
+	bool Raycast(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		int& item,
+		float& distance) const;
+
+	// find the item box nearest to a point within the maximum distance
+	bool FindNearest(
+		const glm::vec3& point,
+		float maxDistance,
+		int& item,
+		float& distance) const;
+
+	// remove all of the items and nodes
+	void Clear();
+
+	int GetItemCount() const { return((int)m_itemOrder.size()); }
+	int GetNodeCount() const { return((int)m_nodes.size()); }
+
+private:
+	// the nodes, every child stored after its parent
+	std::vector<BVH_NODE> m_nodes;
+	// the items of the leaves, leaf by leaf
+	std::vector<int> m_itemOrder;
+	// the leaf holding each item, and its entry in the item order
+	std::vector<int> m_itemLeaf;
+	std::vector<int> m_itemEntry;
+	// the box of each entry of the item order
+	std::vector<glm::vec3> m_itemMin;
+	std::vector<glm::vec3> m_itemMax;
+
+	// nodes whose boxes must be refit, and a flag for each node
+	// so that a node is only listed once
+	std::vector<int> m_refitNodes;
+	std::vector<unsigned char> m_nodeRefit;
+
+	// split a node in two, false when it is kept as a leaf
+	bool SplitNode(
+		int node,
+		const std::vector<glm::vec3>& centers,
+		const std::vector<glm::vec3>& boxMins,
+		const std::vector<glm::vec3>& boxMaxs);
+	// set the box of a node to hold all of its items
+	void FitLeafBox(int node);
+	// set the box of a node to hold its items or children
+	void FitNodeBox(int node);
+};
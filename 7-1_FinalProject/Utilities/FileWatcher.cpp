@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.cpp
+// ============
+// notice when files are saved, without blocking the thread that asks
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FileWatcher.h"
+#include "MappedFile.h"
+
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+namespace
+{
+	// how often the files are compared when they are polled
+	const std::chrono::milliseconds g_PollInterval(250);
+}
+
+/***********************************************************
+ *  FileWatcher()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FileWatcher::FileWatcher()
+{
+	m_notifyDescriptor = -1;
+	m_lastPoll = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  ~FileWatcher()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FileWatcher::~FileWatcher()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Watch()
+ *
+ *  This method is used to start watching a file.  On Linux
+ *  its directory is added to the inotify instance, which is
+ *  created with the first file, and the file is polled when
+ *  that fails.
+ ***********************************************************/
+bool FileWatcher::Watch(const std::string& filename)
+{
+	WATCHED_FILE file;
+	file.filename = filename;
+	if (MappedFile::GetFileStamp(filename, file.size, file.time) == false)
+	{
+		std::cout << "Could not watch " << filename << std::endl;
+		return(false);
+	}
+
+	size_t nameStart = filename.find_last_of("/\\");
+	if (nameStart == std::string::npos)
+	{
+		file.directory = ".";
+		file.name = filename;
+	}
+	else
+	{
+		file.directory = filename.substr(0, nameStart);
+		file.name = filename.substr(nameStart + 1);
+	}
+
+#if defined(__linux__)
+	if (m_notifyDescriptor < 0)
+	{
+		m_notifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	}
+	if (m_notifyDescriptor >= 0)
+	{
+		// a directory that is already watched returns the same
+		// descriptor, so files in one directory share it
+		file.watchDescriptor = inotify_add_watch(m_notifyDescriptor, file.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	}
+#endif
+
+	m_files.push_back(file);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used to stop watching all of the files
+ *  and close the inotify instance.
+ ***********************************************************/
+void FileWatcher::Clear()
+{
+#if defined(__linux__)
+	if (m_notifyDescriptor >= 0)
+	{
+		// closing the instance removes all of its watches
+		close(m_notifyDescriptor);
+		m_notifyDescriptor = -1;
+	}
+#endif
+	m_files.clear();
+}
+
+/***********************************************************
+ *  HasChanged()
+ *
+ *  This method is used to check whether any of the watched
+ *  files were saved since the last call.  All the pending
+ *  changes are taken at once, so saving several files
+ *  together is reported once.
+ ***********************************************************/
+bool FileWatcher::HasChanged()
+{
+	bool bChanged = ReadNotifications();
+
+	// the files that inotify could not watch are polled
+	if (PollFiles() == true)
+	{
+		bChanged = true;
+	}
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  ReadNotifications()
+ *
+ *  This method is used to read the inotify events that are
+ *  waiting, without blocking, and check whether any of them
+ *  names a watched file.
+ ***********************************************************/
+bool FileWatcher::ReadNotifications()
+{
+	bool bChanged = false;
+
+#if defined(__linux__)
+	if (m_notifyDescriptor < 0)
+	{
+		return(false);
+	}
+
+	alignas(struct inotify_event) char buffer[4096];
+	while (true)
+	{
+		ssize_t length = read(m_notifyDescriptor, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			// nothing more is waiting
+			break;
+		}
+
+		for (ssize_t offset = 0; offset < length; )
+		{
+			const struct inotify_event* pEvent = (const struct inotify_event*)&buffer[offset];
+			offset += sizeof(struct inotify_event) + pEvent->len;
+
+			// events were dropped, so any file may have changed
+			if ((pEvent->mask & IN_Q_OVERFLOW) != 0)
+			{
+				bChanged = true;
+				continue;
+			}
+			if (pEvent->len == 0)
+			{
+				continue;
+			}
+
+			for (size_t i = 0; i < m_files.size(); i++)
+			{
+				if ((m_files[i].watchDescriptor == pEvent->wd) && (m_files[i].name == pEvent->name))
+				{
+					bChanged = true;
+				}
+			}
+		}
+	}
+#endif
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  PollFiles()
+ *
+ *  This method is used to compare the size and modification
+ *  time of the files that are not watched by inotify with
+ *  the last time they were checked.  A file that is missing
+ *  is checked again later, since it may be in the middle of
+ *  being saved.
+ ***********************************************************/
+bool FileWatcher::PollFiles()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now - m_lastPoll < g_PollInterval)
+	{
+		return(false);
+	}
+	m_lastPoll = now;
+
+	bool bChanged = false;
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		WATCHED_FILE& file = m_files[i];
+		if (file.watchDescriptor >= 0)
+		{
+			continue;
+		}
+
+		uint64_t size = 0;
+		int64_t time = 0;
+		if (MappedFile::GetFileStamp(file.filename, size, time) == false)
+		{
+			continue;
+		}
+		if ((size != file.size) || (time != file.time))
+		{
+			file.size = size;
+			file.time = time;
+			bChanged = true;
+		}
+	}
+
+	return(bChanged);
+}
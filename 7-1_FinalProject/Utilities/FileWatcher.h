@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.h
+// ============
+// notice when files are saved, without blocking the thread that asks
+//
+// On Linux the directories of the watched files are watched with inotify,
+// so the files are only looked at when the kernel reports a change - the
+// directories are watched instead of the files because editors often save
+// by writing a new file and renaming it over the old one.  Elsewhere the
+// size and modification time of the files are compared a few times a
+// second.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+class FileWatcher
+{
+public:
+	// constructor
+	FileWatcher();
+	// destructor - stops watching the files
+	~FileWatcher();
+
+	// start watching a file, false when it cannot be watched
+	bool Watch(const std::string& filename);
+
+	// stop watching all of the files
+	void Clear();
+
+	// check whether any watched file was saved since the last call,
+	// which returns right away when nothing changed
+	bool HasChanged();
+
+private:
+	// a watched file and what it looked like when last checked
+	struct WATCHED_FILE
+	{
+		std::string filename;
+		// the directory and the name in it, as inotify reports them
+		std::string directory;
+		std::string name;
+		int watchDescriptor = -1;
+		uint64_t size = 0;
+		int64_t time = 0;
+	};
+
+	std::vector<WATCHED_FILE> m_files;
+	// inotify instance, -1 when the files are polled
+	int m_notifyDescriptor;
+	// when the files were last polled
+	std::chrono::steady_clock::time_point m_lastPoll;
+
+	// read the pending inotify events
+	bool ReadNotifications();
+	// compare the files with the last time they were checked
+	bool PollFiles();
+};
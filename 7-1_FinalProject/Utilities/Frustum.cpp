@@ -0,0 +1,260 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustum.cpp
+// ============
+// test bounding volumes against the view frustum of the camera
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Frustum.h"
+
+// only declared when the project is built with GLM_FORCE_INTRINSICS
+#include <glm/simd/common.h>
+
+#include <cmath>
+
+/***********************************************************
+ *  Frustum()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Frustum::Frustum()
+{
+	// planes with no normal and no distance put every volume
+	// on their inside
+	for (int i = 0; i < PLANE_COUNT; i++)
+	{
+		m_planes[i] = glm::vec4(0.0f);
+	}
+}
+
+/***********************************************************
+ *  SetViewProjection()
+ *
+ *  This method is used to take the six planes of the view
+ *  frustum from the rows of the view-projection matrix, so
+ *  that they are in world space.  The planes are normalized
+ *  so that the sphere radii can be compared to distances.
+ ***********************************************************/
+void Frustum::SetViewProjection(const glm::mat4& viewProjection)
+{
+	glm::vec4 rows[4];
+
+	// glm matrices are stored by column
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	m_planes[PLANE_LEFT] = rows[3] + rows[0];
+	m_planes[PLANE_RIGHT] = rows[3] - rows[0];
+	m_planes[PLANE_BOTTOM] = rows[3] + rows[1];
+	m_planes[PLANE_TOP] = rows[3] - rows[1];
+	m_planes[PLANE_NEAR] = rows[3] + rows[2];
+	m_planes[PLANE_FAR] = rows[3] - rows[2];
+
+	for (int i = 0; i < PLANE_COUNT; i++)
+	{
+		float length = glm::length(glm::vec3(m_planes[i]));
+		if (length > 0.0f)
+		{
+			m_planes[i] /= length;
+		}
+	}
+}
+
+/***********************************************************
+ *  IsSphereVisible()
+ *
+ *  This method is used to test whether any part of a sphere
+ *  is inside the frustum.  Spheres that only cross a corner
+ *  outside of the frustum are kept, so the test is never
+ *  wrong about a sphere that can be seen.
+ ***********************************************************/
+bool Frustum::IsSphereVisible(const glm::vec3& center, float radius) const
+{
+	for (int i = 0; i < PLANE_COUNT; i++)
+	{
+		if (glm::dot(glm::vec3(m_planes[i]), center) + m_planes[i].w < -radius)
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  IsBoxVisible()
+ *
+ *  This method is used to test whether any part of a world
+ *  space box is inside the frustum, by testing the corner
+ *  of the box farthest along the normal of each plane.
+ ***********************************************************/
+bool Frustum::IsBoxVisible(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	for (int i = 0; i < PLANE_COUNT; i++)
+	{
+		glm::vec3 corner(
+			(m_planes[i].x >= 0.0f) ? boxMax.x : boxMin.x,
+			(m_planes[i].y >= 0.0f) ? boxMax.y : boxMin.y,
+			(m_planes[i].z >= 0.0f) ? boxMax.z : boxMin.z);
+
+		if (glm::dot(glm::vec3(m_planes[i]), corner) + m_planes[i].w < 0.0f)
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  ClassifyBox()
+ *
+ *  This method is used to find where a world space box is
+ *  relative to the frustum.  The box is outside when its
+ *  corner farthest along the normal of any plane is behind
+ *  that plane, and entirely inside when its nearest corner
+ *  is in front of every plane.
+ ***********************************************************/
+Frustum::CONTAINMENT Frustum::ClassifyBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	CONTAINMENT containment = CONTAINMENT_INSIDE;
+
+	for (int i = 0; i < PLANE_COUNT; i++)
+	{
+		glm::vec3 normal = glm::vec3(m_planes[i]);
+		glm::vec3 farCorner(
+			(normal.x >= 0.0f) ? boxMax.x : boxMin.x,
+			(normal.y >= 0.0f) ? boxMax.y : boxMin.y,
+			(normal.z >= 0.0f) ? boxMax.z : boxMin.z);
+		glm::vec3 nearCorner(
+			(normal.x >= 0.0f) ? boxMin.x : boxMax.x,
+			(normal.y >= 0.0f) ? boxMin.y : boxMax.y,
+			(normal.z >= 0.0f) ? boxMin.z : boxMax.z);
+
+		if (glm::dot(normal, farCorner) + m_planes[i].w < 0.0f)
+		{
+			return(CONTAINMENT_OUTSIDE);
+		}
+		if (glm::dot(normal, nearCorner) + m_planes[i].w < 0.0f)
+		{
+			containment = CONTAINMENT_INTERSECTING;
+		}
+	}
+	return(containment);
+}
+
+/***********************************************************
+ *  CullSpheres()
+ *
+ *  This method is used to test many spheres at once.  Each
+ *  plane is tested against four spheres with one set of SSE
+ *  operations, and the spheres left over at the end of the
+ *  arrays, or every sphere without SSE, are tested one at a
+ *  time.  The number of visible spheres is returned.
+ ***********************************************************/
+int Frustum::CullSpheres(
+	const float* centerX,
+	const float* centerY,
+	const float* centerZ,
+	const float* radius,
+	int count,
+	unsigned char* visible) const
+{
+	int visibleCount = 0;
+	int i = 0;
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+	glm_vec4 planeX[PLANE_COUNT];
+	glm_vec4 planeY[PLANE_COUNT];
+	glm_vec4 planeZ[PLANE_COUNT];
+	glm_vec4 planeW[PLANE_COUNT];
+
+	for (int p = 0; p < PLANE_COUNT; p++)
+	{
+		planeX[p] = _mm_set1_ps(m_planes[p].x);
+		planeY[p] = _mm_set1_ps(m_planes[p].y);
+		planeZ[p] = _mm_set1_ps(m_planes[p].z);
+		planeW[p] = _mm_set1_ps(m_planes[p].w);
+	}
+
+	for (; i + 4 <= count; i += 4)
+	{
+		glm_vec4 x = _mm_loadu_ps(centerX + i);
+		glm_vec4 y = _mm_loadu_ps(centerY + i);
+		glm_vec4 z = _mm_loadu_ps(centerZ + i);
+		glm_vec4 negativeRadius = glm_vec4_sub(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+		glm_vec4 outside = _mm_setzero_ps();
+
+		for (int p = 0; p < PLANE_COUNT; p++)
+		{
+			glm_vec4 distance = glm_vec4_fma(x, planeX[p], glm_vec4_fma(y, planeY[p], glm_vec4_fma(z, planeZ[p], planeW[p])));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+		}
+
+		int outsideMask = _mm_movemask_ps(outside);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			visible[i + lane] = (unsigned char)(((outsideMask >> lane) & 1) ^ 1);
+			visibleCount += visible[i + lane];
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		visible[i] = IsSphereVisible(glm::vec3(centerX[i], centerY[i], centerZ[i]), radius[i]) ? 1 : 0;
+		visibleCount += visible[i];
+	}
+
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  TransformBox()
+ *
+ *  This method is used to get the world bounding box of an
+ *  object space box.  The center is moved by the matrix and
+ *  each world half size is the sum of the half sizes scaled
+ *  by the absolute matrix values, which is the smallest box
+ *  around the moved corners without moving all eight.
+ ***********************************************************/
+void Frustum::TransformBox(
+	const glm::mat4& matrix,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	glm::vec3& worldMin,
+	glm::vec3& worldMax)
+{
+	glm::vec3 center = (boxMin + boxMax) * 0.5f;
+	glm::vec3 halfSize = (boxMax - boxMin) * 0.5f;
+
+	glm::vec3 worldCenter = glm::vec3(matrix * glm::vec4(center, 1.0f));
+	glm::vec3 worldHalfSize =
+		glm::abs(glm::vec3(matrix[0])) * halfSize.x +
+		glm::abs(glm::vec3(matrix[1])) * halfSize.y +
+		glm::abs(glm::vec3(matrix[2])) * halfSize.z;
+
+	worldMin = worldCenter - worldHalfSize;
+	worldMax = worldCenter + worldHalfSize;
+}
+
+/***********************************************************
+ *  TransformSphere()
+ *
+ *  This method is used to get the world bounding sphere of
+ *  an object space sphere.  The radius is scaled by the
+ *  largest scale of the matrix axes, so that the sphere
+ *  still holds the object when it is stretched.
+ ***********************************************************/
+void Frustum::TransformSphere(
+	const glm::mat4& matrix,
+	const glm::vec3& center,
+	float radius,
+	glm::vec3& worldCenter,
+	float& worldRadius)
+{
+	float scale = glm::max(glm::length(glm::vec3(matrix[0])),
+		glm::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+
+	worldCenter = glm::vec3(matrix * glm::vec4(center, 1.0f));
+	worldRadius = radius * scale;
+}
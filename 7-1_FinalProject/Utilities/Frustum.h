@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustum.h
+// ============
+// test bounding volumes against the view frustum of the camera
+//
+// The six planes are taken from the view-projection matrix, with their
+// normals pointing into the frustum, so a volume is outside when it is
+// entirely behind any one plane.  Spheres can be tested four at a time
+// from separate x, y, z and radius arrays with the SSE kernels of glm.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+class Frustum
+{
+public:
+	// constructor - every volume is visible until the planes are set
+	Frustum();
+
+	// the planes of the frustum, in the order they are stored
+	enum PLANE
+	{
+		PLANE_LEFT,
+		PLANE_RIGHT,
+		PLANE_BOTTOM,
+		PLANE_TOP,
+		PLANE_NEAR,
+		PLANE_FAR,
+		PLANE_COUNT
+	};
+
+	// where a volume is relative to the frustum
+	enum CONTAINMENT
+	{
+		CONTAINMENT_OUTSIDE,
+		CONTAINMENT_INTERSECTING,
+		CONTAINMENT_INSIDE
+	};
+
+	// take the planes from the projection times the view matrix
+	void SetViewProjection(const glm::mat4& viewProjection);
+
+	// test a single sphere or box in world space
+	bool IsSphereVisible(const glm::vec3& center, float radius) const;
+	bool IsBoxVisible(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+	// find whether a box is outside, partly inside or entirely inside
+	CONTAINMENT ClassifyBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+
+	// test many spheres, writing 1 for a visible sphere and 0 for a
+	// culled one - the number of visible spheres is returned
+	int CullSpheres(
+		const float* centerX,
+		const float* centerY,
+		const float* centerZ,
+		const float* radius,
+		int count,
+		unsigned char* visible) const;
+
+	// get the world bounding box of an object space box moved by the
+	// passed in matrix
+	static void TransformBox(
+		const glm::mat4& matrix,
+		const glm::vec3& boxMin,
+		const glm::vec3& boxMax,
+		glm::vec3& worldMin,
+		glm::vec3& worldMax);
+
+	// get the world bounding sphere of an object space sphere moved by
+	// the passed in matrix, which may scale each axis differently
+	static void TransformSphere(
+		const glm::mat4& matrix,
+		const glm::vec3& center,
+		float radius,
+		glm::vec3& worldCenter,
+		float& worldRadius);
+
+private:
+	// normal in xyz, distance in w, normalized
+	glm::vec4 m_planes[PLANE_COUNT];
+};
@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// headlesscontext.cpp
+// ============
+// create an OpenGL context without a display window, for rendering the 3D
+// scene offscreen on machines that have no GPU or windowing system
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HeadlessContext.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+#if defined(__linux__)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <string.h>
+#endif
+
+namespace
+{
+	// OpenGL versions to try, newest first - the scene needs 4.3
+	// for multi-draw indirect, and falls back to instancing on 3.3
+	const int g_ContextVersions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 3 }, { 3, 3 } };
+	const int g_ContextVersionCount = sizeof(g_ContextVersions) / sizeof(g_ContextVersions[0]);
+}
+
+/***********************************************************
+ *  HeadlessContext()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+HeadlessContext::HeadlessContext()
+{
+	m_display = NULL;
+	m_context = NULL;
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  ~HeadlessContext()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+HeadlessContext::~HeadlessContext()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  CreateContext()
+ *
+ *  This method is used to create the OpenGL context through
+ *  EGL and make it current with no surface.  The Mesa
+ *  surfaceless platform is used when it is available, so no
+ *  display server is needed.
+ ***********************************************************/
+bool HeadlessContext::CreateContext()
+{
+#if defined(__linux__)
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLint majorVersion = 0;
+	EGLint minorVersion = 0;
+
+	// prefer the surfaceless platform, which needs no X11 or
+	// Wayland display and no GPU device
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if ((NULL != clientExtensions) && (NULL != getPlatformDisplay) &&
+		(NULL != strstr(clientExtensions, "EGL_MESA_platform_surfaceless")))
+	{
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (EGL_NO_DISPLAY == display)
+	{
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	if ((EGL_NO_DISPLAY == display) || (eglInitialize(display, &majorVersion, &minorVersion) == EGL_FALSE))
+	{
+		std::cout << "Failed to initialize the EGL display" << std::endl;
+		return(false);
+	}
+	m_display = display;
+
+	if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE)
+	{
+		std::cout << "EGL does not support the OpenGL API" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	// any config will do, since the scene is only ever drawn
+	// into a framebuffer object
+	EGLConfig config = NULL;
+	EGLint configCount = 0;
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE };
+	const char* displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+	if ((NULL == displayExtensions) || (NULL == strstr(displayExtensions, "EGL_KHR_no_config_context")))
+	{
+		if ((eglChooseConfig(display, configAttributes, &config, 1, &configCount) == EGL_FALSE) || (configCount == 0))
+		{
+			std::cout << "Failed to find an EGL config for OpenGL" << std::endl;
+			Destroy();
+			return(false);
+		}
+	}
+
+	// create the newest core profile context that is supported
+	EGLContext context = EGL_NO_CONTEXT;
+	for (int i = 0; (i < g_ContextVersionCount) && (EGL_NO_CONTEXT == context); i++)
+	{
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, g_ContextVersions[i][0],
+			EGL_CONTEXT_MINOR_VERSION, g_ContextVersions[i][1],
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE };
+		context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	}
+	if (EGL_NO_CONTEXT == context)
+	{
+		std::cout << "Failed to create the EGL OpenGL context" << std::endl;
+		Destroy();
+		return(false);
+	}
+	m_context = context;
+
+	if (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_FALSE)
+	{
+		std::cout << "Failed to make the EGL context current" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	return(true);
+#else
+	std::cout << "Headless rendering is only available on Linux" << std::endl;
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  CreateFramebuffer()
+ *
+ *  This method is used to create the offscreen framebuffer
+ *  with a color and a depth attachment, and bind it so that
+ *  all of the following drawing goes into it.
+ ***********************************************************/
+bool HeadlessContext::CreateFramebuffer(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Offscreen framebuffer is not complete" << std::endl;
+		return(false);
+	}
+
+	glViewport(0, 0, width, height);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SaveFramebufferPPM()
+ *
+ *  This method is used to read back the offscreen
+ *  framebuffer and save it as a binary PPM image, which is
+ *  simple enough to compare between runs.
+ ***********************************************************/
+bool HeadlessContext::SaveFramebufferPPM(const char* filename)
+{
+	if ((0 == m_framebuffer) || (NULL == filename))
+	{
+		return(false);
+	}
+
+	std::vector<unsigned char> pixels(m_width * m_height * 3);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+	std::ofstream file(filename, std::ios::out | std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open " << filename << " for writing" << std::endl;
+		return(false);
+	}
+
+	file << "P6\n" << m_width << " " << m_height << "\n255\n";
+
+	// OpenGL rows start at the bottom, PPM rows at the top
+	for (int row = m_height - 1; row >= 0; row--)
+	{
+		file.write((const char*)&pixels[row * m_width * 3], m_width * 3);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the framebuffer and the
+ *  OpenGL context.
+ ***********************************************************/
+void HeadlessContext::Destroy()
+{
+#if defined(__linux__)
+	if (NULL != m_context)
+	{
+		if (0 != m_framebuffer)
+		{
+			glDeleteRenderbuffers(1, &m_depthBuffer);
+			glDeleteRenderbuffers(1, &m_colorBuffer);
+			glDeleteFramebuffers(1, &m_framebuffer);
+			m_framebuffer = 0;
+			m_colorBuffer = 0;
+			m_depthBuffer = 0;
+		}
+
+		eglMakeCurrent((EGLDisplay)m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext((EGLDisplay)m_display, (EGLContext)m_context);
+		m_context = NULL;
+	}
+	if (NULL != m_display)
+	{
+		eglTerminate((EGLDisplay)m_display);
+		m_display = NULL;
+	}
+#endif
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// headlesscontext.h
+// ============
+// create an OpenGL context without a display window, for rendering the 3D
+// scene offscreen on machines that have no GPU or windowing system
+//
+// The context is created through EGL, which Mesa provides with the
+// llvmpipe software renderer, and the scene is drawn into a framebuffer
+// object instead of a window.  Only available on Linux.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+class HeadlessContext
+{
+public:
+	// constructor
+	HeadlessContext();
+	// destructor
+	~HeadlessContext();
+
+	// create the OpenGL context and make it current - must be
+	// called before the GLEW library is initialized
+	bool CreateContext();
+
+	// create the offscreen framebuffer that the scene is drawn
+	// into - must be called after the GLEW library is initialized
+	bool CreateFramebuffer(int width, int height);
+
+	// save the contents of the offscreen framebuffer as a PPM image
+	bool SaveFramebufferPPM(const char* filename);
+
+	// free the framebuffer and the OpenGL context
+	void Destroy();
+
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+
+private:
+	// EGL display and context - stored as the EGL handle types,
+	// which are pointers, so EGL is only included by the source
+	void* m_display;
+	void* m_context;
+
+	// offscreen framebuffer and its color and depth attachments
+	GLuint m_framebuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+	int m_width;
+	int m_height;
+};
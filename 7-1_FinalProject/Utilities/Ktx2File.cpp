@@ -0,0 +1,462 @@
+///////////////////////////////////////////////////////////////////////////////
+// ktx2file.cpp
+// ============
+// read and write texture images in the KTX2 container
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Ktx2File.h"
+
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace
+{
+	// the first bytes of every KTX2 file
+	const unsigned char g_Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	// the header and index that follow the identifier, packed so the
+	// 64 bit fields are not padded to 8 bytes
+#pragma pack(push, 4)
+	struct KTX2_HEADER
+	{
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+
+	// one entry of the level index, which follows the header
+	struct KTX2_LEVEL
+	{
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+#pragma pack(pop)
+
+	// the Vulkan formats of the supported texture formats
+	const uint32_t VK_FORMAT_R8G8B8_UNORM = 23;
+	const uint32_t VK_FORMAT_R8G8B8A8_UNORM = 37;
+	const uint32_t VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131;
+	const uint32_t VK_FORMAT_BC3_UNORM_BLOCK = 137;
+	const uint32_t VK_FORMAT_BC7_UNORM_BLOCK = 145;
+
+	// the data format descriptor color models
+	const uint8_t KHR_DF_MODEL_RGBSDA = 1;
+	const uint8_t KHR_DF_MODEL_BC1A = 128;
+	const uint8_t KHR_DF_MODEL_BC3 = 130;
+	const uint8_t KHR_DF_MODEL_BC7 = 134;
+
+	// no image is ever this deep, so larger counts are corrupt
+	const uint32_t g_MaxLevels = 32;
+	const char* g_Writer = "7-1_FinalProject";
+}
+
+/***********************************************************
+ *  GetVkFormat()
+ *
+ *  Get the Vulkan format that KTX2 uses for a texture
+ *  format, or 0 when there is none.
+ ***********************************************************/
+static uint32_t GetVkFormat(TEXTURE_FORMAT format)
+{
+	switch (format)
+	{
+	case TEXTURE_FORMAT_RGB8:
+		return(VK_FORMAT_R8G8B8_UNORM);
+	case TEXTURE_FORMAT_RGBA8:
+		return(VK_FORMAT_R8G8B8A8_UNORM);
+	case TEXTURE_FORMAT_BC1:
+		return(VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+	case TEXTURE_FORMAT_BC3:
+		return(VK_FORMAT_BC3_UNORM_BLOCK);
+	case TEXTURE_FORMAT_BC7:
+		return(VK_FORMAT_BC7_UNORM_BLOCK);
+	default:
+		return(0);
+	}
+}
+
+/***********************************************************
+ *  GetTextureFormat()
+ *
+ *  Get the texture format for a Vulkan format, or
+ *  TEXTURE_FORMAT_UNKNOWN when it is not supported.
+ ***********************************************************/
+static TEXTURE_FORMAT GetTextureFormat(uint32_t vkFormat)
+{
+	switch (vkFormat)
+	{
+	case VK_FORMAT_R8G8B8_UNORM:
+		return(TEXTURE_FORMAT_RGB8);
+	case VK_FORMAT_R8G8B8A8_UNORM:
+		return(TEXTURE_FORMAT_RGBA8);
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		return(TEXTURE_FORMAT_BC1);
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+		return(TEXTURE_FORMAT_BC3);
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+		return(TEXTURE_FORMAT_BC7);
+	default:
+		return(TEXTURE_FORMAT_UNKNOWN);
+	}
+}
+
+/***********************************************************
+ *  AppendUint()
+ *
+ *  Append a little endian value to a block of file data.
+ ***********************************************************/
+static void AppendUint(std::vector<unsigned char>& data, uint32_t value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+	{
+		data.push_back((unsigned char)(value >> (i * 8)));
+	}
+}
+
+/***********************************************************
+ *  BuildDataFormat()
+ *
+ *  Build the data format descriptor of a texture format - a
+ *  basic descriptor block with one sample per channel for
+ *  the uncompressed formats, and one per 64 bit half of a
+ *  block for the compressed ones.
+ ***********************************************************/
+static std::vector<unsigned char> BuildDataFormat(TEXTURE_FORMAT format)
+{
+	// the channel id and the bit length of every sample
+	std::vector<std::pair<uint8_t, int> > samples;
+	uint8_t colorModel = KHR_DF_MODEL_RGBSDA;
+	uint8_t blockSize = 1;
+	uint8_t bytesPerBlock = 0;
+
+	switch (format)
+	{
+	case TEXTURE_FORMAT_RGB8:
+	case TEXTURE_FORMAT_RGBA8:
+		samples.push_back(std::make_pair((uint8_t)0, 8));
+		samples.push_back(std::make_pair((uint8_t)1, 8));
+		samples.push_back(std::make_pair((uint8_t)2, 8));
+		if (format == TEXTURE_FORMAT_RGBA8)
+		{
+			samples.push_back(std::make_pair((uint8_t)15, 8));
+		}
+		bytesPerBlock = (uint8_t)samples.size();
+		break;
+	case TEXTURE_FORMAT_BC1:
+		colorModel = KHR_DF_MODEL_BC1A;
+		blockSize = 4;
+		bytesPerBlock = 8;
+		samples.push_back(std::make_pair((uint8_t)0, 64));
+		break;
+	case TEXTURE_FORMAT_BC3:
+		colorModel = KHR_DF_MODEL_BC3;
+		blockSize = 4;
+		bytesPerBlock = 16;
+		samples.push_back(std::make_pair((uint8_t)15, 64));
+		samples.push_back(std::make_pair((uint8_t)0, 64));
+		break;
+	default:
+		colorModel = KHR_DF_MODEL_BC7;
+		blockSize = 4;
+		bytesPerBlock = 16;
+		samples.push_back(std::make_pair((uint8_t)0, 128));
+		break;
+	}
+
+	uint32_t blockLength = 24 + 16 * (uint32_t)samples.size();
+	std::vector<unsigned char> data;
+	AppendUint(data, 4 + blockLength, 4);
+	// Khronos vendor, basic descriptor type, version 1.3
+	AppendUint(data, 0, 4);
+	AppendUint(data, 2 | (blockLength << 16), 4);
+	// the color model, BT.709 primaries, linear transfer and
+	// straight alpha
+	data.push_back(colorModel);
+	data.push_back(1);
+	data.push_back(1);
+	data.push_back(0);
+	// the texel block dimensions, each minus one
+	data.push_back(blockSize - 1);
+	data.push_back(blockSize - 1);
+	data.push_back(0);
+	data.push_back(0);
+	// the bytes of the only plane
+	data.push_back(bytesPerBlock);
+	for (int i = 1; i < 8; i++)
+	{
+		data.push_back(0);
+	}
+
+	int bitOffset = 0;
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		int bitLength = samples[i].second;
+		AppendUint(data, bitOffset, 2);
+		data.push_back((uint8_t)(bitLength - 1));
+		data.push_back(samples[i].first);
+		AppendUint(data, 0, 4);
+		AppendUint(data, 0, 4);
+		AppendUint(data, (bitLength >= 32) ? 0xFFFFFFFF : ((1u << bitLength) - 1), 4);
+		bitOffset += bitLength;
+	}
+
+	return(data);
+}
+
+/***********************************************************
+ *  IsKtx2()
+ *
+ *  This method is used to check whether file data starts
+ *  with the KTX2 identifier.
+ ***********************************************************/
+bool Ktx2File::IsKtx2(const unsigned char* data, size_t size)
+{
+	return((size >= sizeof(g_Identifier)) && (memcmp(data, g_Identifier, sizeof(g_Identifier)) == 0));
+}
+
+/***********************************************************
+ *  Read()
+ *
+ *  This method is used to read the mip levels of a KTX2
+ *  file that is in memory.  The pixels are not copied, and
+ *  the level offsets are from the first byte of level data
+ *  in the file, which is returned in pixelsStart.  False is
+ *  returned when the file is not a supported 2D image.
+ ***********************************************************/
+bool Ktx2File::Read(const unsigned char* data, size_t size, TEXTURE_IMAGE& image, size_t& pixelsStart)
+{
+	KTX2_HEADER header;
+	if ((IsKtx2(data, size) == false) || (size < sizeof(g_Identifier) + sizeof(header)))
+	{
+		return(false);
+	}
+	memcpy(&header, data + sizeof(g_Identifier), sizeof(header));
+
+	TEXTURE_FORMAT format = GetTextureFormat(header.vkFormat);
+	size_t indexStart = sizeof(g_Identifier) + sizeof(header);
+	if ((format == TEXTURE_FORMAT_UNKNOWN) ||
+		(header.pixelWidth == 0) || (header.pixelHeight == 0) || (header.pixelDepth != 0) ||
+		(header.layerCount != 0) || (header.faceCount != 1) ||
+		(header.levelCount == 0) || (header.levelCount > g_MaxLevels) ||
+		(header.supercompressionScheme != 0) ||
+		(indexStart + header.levelCount * sizeof(KTX2_LEVEL) > size))
+	{
+		return(false);
+	}
+
+	std::vector<KTX2_LEVEL> levels(header.levelCount);
+	memcpy(levels.data(), data + indexStart, header.levelCount * sizeof(KTX2_LEVEL));
+
+	pixelsStart = size;
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		int width = std::max((int)(header.pixelWidth >> i), 1);
+		int height = std::max((int)(header.pixelHeight >> i), 1);
+		if ((levels[i].byteOffset > size) || (levels[i].byteLength > size - levels[i].byteOffset) ||
+			(levels[i].byteLength != TEXTURE_IMAGE::GetLevelSize(format, width, height)))
+		{
+			return(false);
+		}
+		pixelsStart = std::min(pixelsStart, (size_t)levels[i].byteOffset);
+	}
+
+	image.levels.clear();
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		TEXTURE_IMAGE::MIP_LEVEL level;
+		level.width = std::max((int)(header.pixelWidth >> i), 1);
+		level.height = std::max((int)(header.pixelHeight >> i), 1);
+		level.offset = (size_t)levels[i].byteOffset - pixelsStart;
+		level.size = (size_t)levels[i].byteLength;
+		image.levels.push_back(level);
+	}
+
+	image.width = (int)header.pixelWidth;
+	image.height = (int)header.pixelHeight;
+	image.format = format;
+	// opaque images are written with a swizzle that sets alpha to one
+	std::string swizzle = GetValue(data, size, "KTXswizzle");
+	if ((format == TEXTURE_FORMAT_RGB8) || (format == TEXTURE_FORMAT_BC1) ||
+		((swizzle.size() == 4) && (swizzle[3] == '1')))
+	{
+		image.colorChannels = 3;
+	}
+	else
+	{
+		image.colorChannels = 4;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetValue()
+ *
+ *  This method is used to get the value of a key/value
+ *  entry of a KTX2 file that is in memory, without its
+ *  terminating zero.  An empty string is returned when
+ *  there is no such key.
+ ***********************************************************/
+std::string Ktx2File::GetValue(const unsigned char* data, size_t size, const char* key)
+{
+	KTX2_HEADER header;
+	if ((IsKtx2(data, size) == false) || (size < sizeof(g_Identifier) + sizeof(header)))
+	{
+		return("");
+	}
+	memcpy(&header, data + sizeof(g_Identifier), sizeof(header));
+	if ((header.kvdByteOffset > size) || (header.kvdByteLength > size - header.kvdByteOffset))
+	{
+		return("");
+	}
+
+	size_t keyLength = strlen(key);
+	size_t position = header.kvdByteOffset;
+	size_t end = (size_t)header.kvdByteOffset + header.kvdByteLength;
+	while (position + 4 <= end)
+	{
+		uint32_t length = 0;
+		memcpy(&length, data + position, 4);
+		position += 4;
+		if (length > end - position)
+		{
+			break;
+		}
+
+		// the key is followed by a zero, then by its value
+		const char* pEntry = (const char*)(data + position);
+		if ((length > keyLength) && (memcmp(pEntry, key, keyLength) == 0) && (pEntry[keyLength] == '\0'))
+		{
+			std::string value(pEntry + keyLength + 1, length - keyLength - 1);
+			if ((value.empty() == false) && (value[value.size() - 1] == '\0'))
+			{
+				value.resize(value.size() - 1);
+			}
+			return(value);
+		}
+
+		// every entry is padded to 4 bytes
+		position += (length + 3) & ~3u;
+	}
+
+	return("");
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used to write an image to a KTX2 file.
+ *  The smallest level is stored first, as KTX2 requires,
+ *  and every level starts on a multiple of its block size
+ *  and of 4 bytes.
+ ***********************************************************/
+bool Ktx2File::Write(const std::string& filename, const TEXTURE_IMAGE& image, const char* key, const std::string& value)
+{
+	uint32_t vkFormat = GetVkFormat(image.format);
+	if ((vkFormat == 0) || image.levels.empty() || (image.levels.size() > g_MaxLevels))
+	{
+		return(false);
+	}
+
+	// the key/value entries must be sorted by key
+	std::vector<std::pair<std::string, std::string> > values;
+	values.push_back(std::make_pair(std::string("KTXorientation"), std::string("ru")));
+	values.push_back(std::make_pair(std::string("KTXswizzle"), std::string((image.colorChannels == 3) ? "rgb1" : "rgba")));
+	values.push_back(std::make_pair(std::string("KTXwriter"), std::string(g_Writer)));
+	if (NULL != key)
+	{
+		values.push_back(std::make_pair(std::string(key), value));
+	}
+	std::sort(values.begin(), values.end());
+
+	std::vector<unsigned char> keyValueData;
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		uint32_t length = (uint32_t)(values[i].first.size() + 1 + values[i].second.size() + 1);
+		AppendUint(keyValueData, length, 4);
+		keyValueData.insert(keyValueData.end(), values[i].first.begin(), values[i].first.end());
+		keyValueData.push_back(0);
+		keyValueData.insert(keyValueData.end(), values[i].second.begin(), values[i].second.end());
+		keyValueData.push_back(0);
+		while (keyValueData.size() % 4 != 0)
+		{
+			keyValueData.push_back(0);
+		}
+	}
+
+	std::vector<unsigned char> dataFormat = BuildDataFormat(image.format);
+
+	KTX2_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.vkFormat = vkFormat;
+	header.typeSize = 1;
+	header.pixelWidth = (uint32_t)image.width;
+	header.pixelHeight = (uint32_t)image.height;
+	header.faceCount = 1;
+	header.levelCount = (uint32_t)image.levels.size();
+	header.dfdByteOffset = (uint32_t)(sizeof(g_Identifier) + sizeof(header) + image.levels.size() * sizeof(KTX2_LEVEL));
+	header.dfdByteLength = (uint32_t)dataFormat.size();
+	header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+	header.kvdByteLength = (uint32_t)keyValueData.size();
+
+	// the alignment of the levels is the least common multiple
+	// of the texel block size and 4
+	size_t blockBytes = TEXTURE_IMAGE::GetLevelSize(image.format, 1, 1);
+	size_t alignment = blockBytes;
+	while (alignment % 4 != 0)
+	{
+		alignment += blockBytes;
+	}
+
+	std::vector<KTX2_LEVEL> levels(image.levels.size());
+	size_t position = header.kvdByteOffset + header.kvdByteLength;
+	for (size_t i = image.levels.size(); i-- > 0; )
+	{
+		position = (position + alignment - 1) / alignment * alignment;
+		levels[i].byteOffset = position;
+		levels[i].byteLength = image.levels[i].size;
+		levels[i].uncompressedByteLength = image.levels[i].size;
+		position += image.levels[i].size;
+	}
+
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return(false);
+	}
+
+	file.write((const char*)g_Identifier, sizeof(g_Identifier));
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)levels.data(), levels.size() * sizeof(KTX2_LEVEL));
+	file.write((const char*)dataFormat.data(), dataFormat.size());
+	file.write((const char*)keyValueData.data(), keyValueData.size());
+
+	size_t written = header.kvdByteOffset + header.kvdByteLength;
+	const char padding[16] = {};
+	for (size_t i = image.levels.size(); i-- > 0; )
+	{
+		file.write(padding, (size_t)levels[i].byteOffset - written);
+		file.write((const char*)(image.GetPixels() + image.levels[i].offset), image.levels[i].size);
+		written = (size_t)(levels[i].byteOffset + levels[i].byteLength);
+	}
+	file.close();
+
+	return(file.fail() == false);
+}
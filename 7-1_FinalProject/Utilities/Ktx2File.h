@@ -0,0 +1,34 @@
+///////////////////////////////////////////////////////////////////////////////
+// ktx2file.h
+// ============
+// read and write texture images in the KTX2 container
+//
+// Only the parts of KTX2 the scene uses are supported - one 2D image with
+// its mip levels, in RGB8, RGBA8, BC1, BC3 or BC7, without supercompression.
+// Images are stored with their bottom row first, as OpenGL expects, which
+// is recorded in the KTXorientation value.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureCache.h"
+
+#include <string>
+#include <cstddef>
+
+class Ktx2File
+{
+public:
+	// check for the KTX2 identifier at the start of a file
+	static bool IsKtx2(const unsigned char* data, size_t size);
+
+	// read the levels of a KTX2 file in memory - the level offsets
+	// are from pixelsStart, the first byte of level data in the file
+	static bool Read(const unsigned char* data, size_t size, TEXTURE_IMAGE& image, size_t& pixelsStart);
+
+	// get a key/value entry of a KTX2 file in memory, empty when missing
+	static std::string GetValue(const unsigned char* data, size_t size, const char* key);
+
+	// write an image to a KTX2 file, with an optional extra key/value
+	static bool Write(const std::string& filename, const TEXTURE_IMAGE& image, const char* key = NULL, const std::string& value = "");
+};
@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// map whole files into memory for reading, and get their size and time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  Map()
+ *
+ *  This method is used to map a whole file into memory for
+ *  reading.  Any view that was passed in is unmapped first.
+ ***********************************************************/
+bool MappedFile::Map(const std::string& filename, VIEW& view)
+{
+	Unmap(view);
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (INVALID_HANDLE_VALUE == file)
+	{
+		return(false);
+	}
+	LARGE_INTEGER fileSize;
+	if ((GetFileSizeEx(file, &fileSize) == FALSE) || (fileSize.QuadPart == 0))
+	{
+		CloseHandle(file);
+		return(false);
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (NULL == mapping)
+	{
+		CloseHandle(file);
+		return(false);
+	}
+	const unsigned char* pData = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (NULL == pData)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return(false);
+	}
+	view.pData = pData;
+	view.size = (size_t)fileSize.QuadPart;
+	view.file = file;
+	view.mapping = mapping;
+#else
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+	struct stat fileStatus;
+	if ((fstat(file, &fileStatus) != 0) || (fileStatus.st_size == 0))
+	{
+		close(file);
+		return(false);
+	}
+	size_t size = (size_t)fileStatus.st_size;
+	void* pMapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+	// the mapping stays valid after the file is closed
+	close(file);
+	if (MAP_FAILED == pMapped)
+	{
+		return(false);
+	}
+	view.pData = (const unsigned char*)pMapped;
+	view.size = size;
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  Unmap()
+ *
+ *  This method is used to unmap a view and close its file.
+ ***********************************************************/
+void MappedFile::Unmap(VIEW& view)
+{
+	if (NULL != view.pData)
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile(view.pData);
+		CloseHandle((HANDLE)view.mapping);
+		CloseHandle((HANDLE)view.file);
+#else
+		munmap((void*)view.pData, view.size);
+#endif
+	}
+	view.pData = NULL;
+	view.size = 0;
+	view.file = NULL;
+	view.mapping = NULL;
+}
+
+/***********************************************************
+ *  GetFileStamp()
+ *
+ *  This method is used to get the size and modification
+ *  time of a file, false when it does not exist.  The time
+ *  is in nanoseconds, so two saves in the same second have
+ *  different stamps where the file system records it.
+ ***********************************************************/
+bool MappedFile::GetFileStamp(const std::string& filename, uint64_t& size, int64_t& time)
+{
+#if defined(_WIN32)
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &attributes) == FALSE)
+	{
+		return(false);
+	}
+	size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	// the write time is in 100 nanosecond intervals
+	uint64_t writeTime = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+		attributes.ftLastWriteTime.dwLowDateTime;
+	time = (int64_t)(writeTime * 100);
+#else
+	struct stat fileStatus;
+	if (stat(filename.c_str(), &fileStatus) != 0)
+	{
+		return(false);
+	}
+	size = (uint64_t)fileStatus.st_size;
+#if defined(__APPLE__)
+	time = (int64_t)fileStatus.st_mtimespec.tv_sec * 1000000000 + fileStatus.st_mtimespec.tv_nsec;
+#else
+	time = (int64_t)fileStatus.st_mtim.tv_sec * 1000000000 + fileStatus.st_mtim.tv_nsec;
+#endif
+#endif
+
+	return(true);
+}
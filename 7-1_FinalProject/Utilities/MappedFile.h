@@ -0,0 +1,37 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map whole files into memory for reading, and get their size and time
+//
+// The texture cache entries, the compiled scene files and the watched files
+// all go through here, so the Win32 and POSIX calls are only written once.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile
+{
+public:
+	// a read-only view of a whole file, with the handles needed to
+	// unmap it - empty when nothing is mapped
+	struct VIEW
+	{
+		const unsigned char* pData = NULL;
+		size_t size = 0;
+		void* file = NULL;
+		void* mapping = NULL;
+	};
+
+	// map a file, false when it is missing or empty
+	static bool Map(const std::string& filename, VIEW& view);
+	// unmap a view, which may already be empty
+	static void Unmap(VIEW& view);
+
+	// get the size and modification time of a file, with the time
+	// in nanoseconds, false when it does not exist
+	static bool GetFileStamp(const std::string& filename, uint64_t& size, int64_t& time);
+};
@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstats.h
+// ============
+// count the OpenGL calls made while rendering, so that the cost of a frame
+// can be compared between runs and between the scene render paths
+//
+// The counters are only ever incremented, and are reset by whoever is
+// measuring - normally once at the start of every frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+struct RENDER_STATS
+{
+	// draw commands submitted, a multi-draw counts as one
+	unsigned int drawCalls;
+	// vertex array, buffer, texture and shader program binds
+	unsigned int stateChanges;
+	// uniform values set, and uniform buffer updates
+	unsigned int uniformUploads;
+	// binds and uniform values skipped, because the same
+	// value was already in place
+	unsigned int eliminatedStateChanges;
+	// objects not drawn, because they are outside of the view
+	unsigned int culledObjects;
+	// triangles drawn, counted once for every instance
+	unsigned int triangles;
+};
+
+namespace RenderStats
+{
+	// the counters shared by every object that draws
+	inline RENDER_STATS& Get()
+	{
+		static RENDER_STATS stats = { 0, 0, 0, 0, 0, 0 };
+		return(stats);
+	}
+
+	// clear all of the counters
+	inline void Reset()
+	{
+		RENDER_STATS& stats = Get();
+		stats.drawCalls = 0;
+		stats.stateChanges = 0;
+		stats.uniformUploads = 0;
+		stats.eliminatedStateChanges = 0;
+		stats.culledObjects = 0;
+		stats.triangles = 0;
+	}
+
+	inline void CountDrawCall() { Get().drawCalls++; }
+	inline void CountStateChange() { Get().stateChanges++; }
+	inline void CountUniformUpload() { Get().uniformUploads++; }
+	inline void CountEliminatedStateChange() { Get().eliminatedStateChanges++; }
+	inline void CountCulledObject() { Get().culledObjects++; }
+	inline void CountTriangles(unsigned int count) { Get().triangles += count; }
+}
@@ -0,0 +1,665 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// compiled binary description of a 3D scene, mapped and read in place
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+#include "ShapeMeshes.h"
+#include "Transform.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	// the first bytes of every scene file, and the version of the
+	// layout - files written with another version are compiled again
+	const char g_Identifier[8] = { 'F', 'P', 'S', 'C', 'E', 'N', 'E', '\0' };
+	const uint32_t g_Version = 1;
+	const char* g_CompiledExtension = ".scene";
+
+	// the header at the start of a scene file - every table starts
+	// on a multiple of 8 bytes, so the records can be read in place
+	struct SCENE_FILE_HEADER
+	{
+		char identifier[8];
+		uint32_t version;
+		uint32_t headerSize;
+		uint64_t sourceSize;
+		int64_t sourceTime;
+		uint32_t nodeCount;
+		uint32_t materialCount;
+		uint32_t textureCount;
+		uint32_t lightCount;
+		uint64_t nodeOffset;
+		uint64_t materialOffset;
+		uint64_t textureOffset;
+		uint64_t lightOffset;
+	};
+
+	// the names of the meshes in a text description
+	struct MESH_NAME
+	{
+		const char* name;
+		ShapeMeshes::MESH_TYPE mesh;
+	};
+	const MESH_NAME g_MeshNames[] = {
+		{ "box", ShapeMeshes::MESH_BOX },
+		{ "cone", ShapeMeshes::MESH_CONE },
+		{ "cylinder", ShapeMeshes::MESH_CYLINDER },
+		{ "plane", ShapeMeshes::MESH_PLANE },
+		{ "prism", ShapeMeshes::MESH_PRISM },
+		{ "pyramid3", ShapeMeshes::MESH_PYRAMID3 },
+		{ "pyramid4", ShapeMeshes::MESH_PYRAMID4 },
+		{ "sphere", ShapeMeshes::MESH_SPHERE },
+		{ "tapered_cylinder", ShapeMeshes::MESH_TAPERED_CYLINDER },
+		{ "torus", ShapeMeshes::MESH_TORUS } };
+	const int g_MeshNameCount = sizeof(g_MeshNames) / sizeof(g_MeshNames[0]);
+
+	// round a file offset up to the alignment of the tables
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return((offset + 7) & ~(uint64_t)7);
+	}
+
+	// check that a table lies within the file
+	bool IsTableInFile(uint64_t offset, uint64_t count, size_t recordSize, size_t fileSize)
+	{
+		return(((offset % 8) == 0) && (offset <= fileSize) &&
+			(count <= (fileSize - offset) / recordSize));
+	}
+
+	// check that a fixed size string is terminated
+	bool IsTerminated(const char* text, int length)
+	{
+		return(memchr(text, '\0', length) != NULL);
+	}
+
+	// copy a string into a fixed size record field
+	bool CopyText(char* destination, int length, const std::string& text)
+	{
+		if ((int)text.size() >= length)
+		{
+			return(false);
+		}
+		memset(destination, 0, length);
+		memcpy(destination, text.data(), text.size());
+		return(true);
+	}
+
+	// a key of a text record followed by a number of floats
+	struct FLOAT_FIELD
+	{
+		const char* key;
+		float* values;
+		int count;
+	};
+
+	// read the floats of the field with the passed in key, false
+	// when there is no such field or the values are missing
+	bool ReadFloatField(
+		std::istringstream& line,
+		const std::string& key,
+		const FLOAT_FIELD* fields,
+		int fieldCount)
+	{
+		int field = 0;
+		while ((field < fieldCount) && (key != fields[field].key))
+		{
+			field++;
+		}
+		if (field == fieldCount)
+		{
+			return(false);
+		}
+
+		for (int i = 0; i < fields[field].count; i++)
+		{
+			if (!(line >> fields[field].values[i]))
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_nodeCount = 0;
+	m_pNodes = NULL;
+	m_materialCount = 0;
+	m_pMaterials = NULL;
+	m_textureCount = 0;
+	m_pTextures = NULL;
+	m_lightCount = 0;
+	m_pLights = NULL;
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	Unmap();
+}
+
+/***********************************************************
+ *  Map()
+ *
+ *  This method is used to map a scene file into memory and
+ *  check its records.  The records are not copied, so the
+ *  time taken only depends on the pages that are touched.
+ ***********************************************************/
+bool SceneFile::Map(const std::string& filename)
+{
+	Unmap();
+
+	if (MappedFile::Map(filename, m_view) == false)
+	{
+		return(false);
+	}
+
+	if (ReadTables() == false)
+	{
+		Unmap();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Unmap()
+ *
+ *  This method is used to unmap the scene file.
+ ***********************************************************/
+void SceneFile::Unmap()
+{
+	MappedFile::Unmap(m_view);
+	m_nodeCount = 0;
+	m_pNodes = NULL;
+	m_materialCount = 0;
+	m_pMaterials = NULL;
+	m_textureCount = 0;
+	m_pTextures = NULL;
+	m_lightCount = 0;
+	m_pLights = NULL;
+}
+
+/***********************************************************
+ *  ReadTables()
+ *
+ *  This method is used to check the header and records of
+ *  the mapped file, and point the tables at them.  Every
+ *  index is checked here, once, so the records can be used
+ *  without any further checks.
+ ***********************************************************/
+bool SceneFile::ReadTables()
+{
+	if (m_view.size < sizeof(SCENE_FILE_HEADER))
+	{
+		return(false);
+	}
+
+	const SCENE_FILE_HEADER* pHeader = (const SCENE_FILE_HEADER*)m_view.pData;
+	if ((memcmp(pHeader->identifier, g_Identifier, sizeof(g_Identifier)) != 0) ||
+		(pHeader->version != g_Version) ||
+		(pHeader->headerSize != sizeof(SCENE_FILE_HEADER)) ||
+		(IsTableInFile(pHeader->nodeOffset, pHeader->nodeCount, sizeof(NODE), m_view.size) == false) ||
+		(IsTableInFile(pHeader->materialOffset, pHeader->materialCount, sizeof(MATERIAL), m_view.size) == false) ||
+		(IsTableInFile(pHeader->textureOffset, pHeader->textureCount, sizeof(TEXTURE), m_view.size) == false) ||
+		(IsTableInFile(pHeader->lightOffset, pHeader->lightCount, sizeof(LIGHT), m_view.size) == false) ||
+		(pHeader->nodeCount > 0x7FFFFFFF))
+	{
+		return(false);
+	}
+
+	const NODE* pNodes = (const NODE*)(m_view.pData + pHeader->nodeOffset);
+	const MATERIAL* pMaterials = (const MATERIAL*)(m_view.pData + pHeader->materialOffset);
+	const TEXTURE* pTextures = (const TEXTURE*)(m_view.pData + pHeader->textureOffset);
+	int nodeCount = (int)pHeader->nodeCount;
+	int materialCount = (int)pHeader->materialCount;
+	int textureCount = (int)pHeader->textureCount;
+
+	for (int i = 0; i < materialCount; i++)
+	{
+		if (IsTerminated(pMaterials[i].tag, MAX_TAG_LENGTH) == false)
+		{
+			return(false);
+		}
+	}
+	for (int i = 0; i < textureCount; i++)
+	{
+		if ((IsTerminated(pTextures[i].tag, MAX_TAG_LENGTH) == false) ||
+			(IsTerminated(pTextures[i].path, MAX_PATH_LENGTH) == false))
+		{
+			return(false);
+		}
+	}
+
+	// a parent is always stored before its children
+	for (int i = 0; i < nodeCount; i++)
+	{
+		const NODE& node = pNodes[i];
+		if ((node.parent < -1) || (node.parent >= i) ||
+			(node.mesh < -1) || (node.mesh >= ShapeMeshes::MESH_COUNT) ||
+			(node.minLod < 0) || (node.minLod >= ShapeMeshes::LOD_COUNT) ||
+			(node.material < -1) || (node.material >= materialCount) ||
+			(node.texture < -1) || (node.texture >= textureCount))
+		{
+			return(false);
+		}
+	}
+
+	m_nodeCount = nodeCount;
+	m_pNodes = pNodes;
+	m_materialCount = materialCount;
+	m_pMaterials = pMaterials;
+	m_textureCount = textureCount;
+	m_pTextures = pTextures;
+	m_lightCount = (int)pHeader->lightCount;
+	m_pLights = (const LIGHT*)(m_view.pData + pHeader->lightOffset);
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsCompiledFrom()
+ *
+ *  This method is used to check that the mapped file was
+ *  compiled from a text description as it is now, by the
+ *  size and modification time the file recorded.
+ ***********************************************************/
+bool SceneFile::IsCompiledFrom(const std::string& textFilename) const
+{
+	uint64_t size = 0;
+	int64_t time = 0;
+
+	if ((IsMapped() == false) || (MappedFile::GetFileStamp(textFilename, size, time) == false))
+	{
+		return(false);
+	}
+
+	const SCENE_FILE_HEADER* pHeader = (const SCENE_FILE_HEADER*)m_view.pData;
+	return((pHeader->sourceSize == size) && (pHeader->sourceTime == time));
+}
+
+/***********************************************************
+ *  Import()
+ *
+ *  This method is used to read a text description of a
+ *  scene.  Each line is a texture, material, light or node
+ *  record, followed by its values:
+ *
+ *    texture TAG PATH
+ *    material TAG [ambient R G B] [strength S] [diffuse R G B]
+ *        [specular R G B] [shininess S]
+ *    light [position X Y Z] [ambient R G B] [diffuse R G B]
+ *        [specular R G B] [intensity S] [focal S]
+ *    node NAME [parent NAME] [mesh MESH] [lod N] [scale X Y Z]
+ *        [rotation X Y Z] [position X Y Z] [color R G B A]
+ *        [material TAG] [texture TAG] [uv U V]
+ *
+ *  The rotations are in degrees about the X axis, then the
+ *  Y axis, then the Z axis, and are turned into quaternions
+ *  here.  A node named - cannot be a parent.  Parents,
+ *  materials and textures must be defined before they are
+ *  used, and text after a # is ignored.
+ ***********************************************************/
+bool SceneFile::Import(const std::string& textFilename, SCENE_DESCRIPTION& scene)
+{
+	std::ifstream file(textFilename.c_str());
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open scene description " << textFilename << std::endl;
+		return(false);
+	}
+
+	std::map<std::string, int> nodeIndices;
+	std::map<std::string, int> materialIndices;
+	std::map<std::string, int> textureIndices;
+	std::string text;
+	int lineNumber = 0;
+
+	scene.nodes.clear();
+	scene.materials.clear();
+	scene.textures.clear();
+	scene.lights.clear();
+
+	while (std::getline(file, text))
+	{
+		lineNumber++;
+
+		size_t comment = text.find('#');
+		if (comment != std::string::npos)
+		{
+			text.erase(comment);
+		}
+
+		std::istringstream line(text);
+		std::string record;
+		if (!(line >> record))
+		{
+			continue;
+		}
+
+		bool bValid = true;
+		std::string key;
+
+		if (record == "texture")
+		{
+			TEXTURE texture;
+			std::string tag;
+			std::string path;
+			bValid = (line >> tag >> path) &&
+				(textureIndices.count(tag) == 0) &&
+				CopyText(texture.tag, MAX_TAG_LENGTH, tag) &&
+				CopyText(texture.path, MAX_PATH_LENGTH, path);
+			if (bValid)
+			{
+				textureIndices[tag] = (int)scene.textures.size();
+				scene.textures.push_back(texture);
+			}
+		}
+		else if (record == "material")
+		{
+			MATERIAL material;
+			std::string tag;
+			memset(&material, 0, sizeof(material));
+			bValid = (line >> tag) &&
+				(materialIndices.count(tag) == 0) &&
+				CopyText(material.tag, MAX_TAG_LENGTH, tag);
+			const FLOAT_FIELD fields[] = {
+				{ "ambient", material.ambientColor, 3 },
+				{ "strength", &material.ambientStrength, 1 },
+				{ "diffuse", material.diffuseColor, 3 },
+				{ "specular", material.specularColor, 3 },
+				{ "shininess", &material.shininess, 1 } };
+			while (bValid && (line >> key))
+			{
+				bValid = ReadFloatField(line, key, fields, sizeof(fields) / sizeof(fields[0]));
+			}
+			if (bValid)
+			{
+				materialIndices[tag] = (int)scene.materials.size();
+				scene.materials.push_back(material);
+			}
+		}
+		else if (record == "light")
+		{
+			LIGHT light;
+			memset(&light, 0, sizeof(light));
+			const FLOAT_FIELD fields[] = {
+				{ "position", light.position, 3 },
+				{ "ambient", light.ambientColor, 3 },
+				{ "diffuse", light.diffuseColor, 3 },
+				{ "specular", light.specularColor, 3 },
+				{ "intensity", &light.specularIntensity, 1 },
+				{ "focal", &light.focalStrength, 1 } };
+			while (bValid && (line >> key))
+			{
+				bValid = ReadFloatField(line, key, fields, sizeof(fields) / sizeof(fields[0]));
+			}
+			if (bValid)
+			{
+				scene.lights.push_back(light);
+			}
+		}
+		else if (record == "node")
+		{
+			NODE node;
+			std::string name;
+			std::string value;
+			glm::vec3 rotationDegrees(0.0f);
+
+			node.parent = -1;
+			node.mesh = -1;
+			node.minLod = 0;
+			node.material = -1;
+			node.texture = -1;
+			for (int i = 0; i < 3; i++)
+			{
+				node.scale[i] = 1.0f;
+				node.position[i] = 0.0f;
+			}
+			for (int i = 0; i < 4; i++)
+			{
+				node.color[i] = 1.0f;
+			}
+			node.uvScale[0] = 1.0f;
+			node.uvScale[1] = 1.0f;
+
+			const FLOAT_FIELD fields[] = {
+				{ "scale", node.scale, 3 },
+				{ "rotation", &rotationDegrees[0], 3 },
+				{ "position", node.position, 3 },
+				{ "color", node.color, 4 },
+				{ "uv", node.uvScale, 2 } };
+
+			bValid = (line >> name) && ((name == "-") || (nodeIndices.count(name) == 0));
+			while (bValid && (line >> key))
+			{
+				// the values that are not floats are names, looked
+				// up in the records read so far
+				if (key == "lod")
+				{
+					bValid = (line >> node.minLod) && (node.minLod >= 0) && (node.minLod < ShapeMeshes::LOD_COUNT);
+				}
+				else if ((key == "parent") || (key == "material") || (key == "texture") || (key == "mesh"))
+				{
+					bValid = !(line >> value).fail();
+					if (bValid && (key == "parent"))
+					{
+						bValid = (nodeIndices.count(value) != 0);
+						node.parent = bValid ? nodeIndices[value] : -1;
+					}
+					else if (bValid && (key == "material"))
+					{
+						bValid = (materialIndices.count(value) != 0);
+						node.material = bValid ? materialIndices[value] : -1;
+					}
+					else if (bValid && (key == "texture"))
+					{
+						bValid = (textureIndices.count(value) != 0);
+						node.texture = bValid ? textureIndices[value] : -1;
+					}
+					else if (bValid)
+					{
+						int i = 0;
+						while ((i < g_MeshNameCount) && (value != g_MeshNames[i].name))
+						{
+							i++;
+						}
+						bValid = (i < g_MeshNameCount);
+						node.mesh = bValid ? g_MeshNames[i].mesh : -1;
+					}
+				}
+				else
+				{
+					bValid = ReadFloatField(line, key, fields, sizeof(fields) / sizeof(fields[0]));
+				}
+			}
+			if (bValid)
+			{
+				glm::quat rotation = Transform::RotationFromEulerDegrees(rotationDegrees);
+				node.rotation[0] = rotation.x;
+				node.rotation[1] = rotation.y;
+				node.rotation[2] = rotation.z;
+				node.rotation[3] = rotation.w;
+
+				if (name != "-")
+				{
+					nodeIndices[name] = (int)scene.nodes.size();
+				}
+				scene.nodes.push_back(node);
+			}
+		}
+		else
+		{
+			bValid = false;
+		}
+
+		if (bValid == false)
+		{
+			std::cerr << textFilename << "(" << lineNumber << "): could not read the "
+				<< record << " record" << std::endl;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used to write a scene file.  It is
+ *  written to a temporary file first and then renamed, so a
+ *  scene file that is being read is never partly written.
+ ***********************************************************/
+bool SceneFile::Write(
+	const std::string& filename,
+	const SCENE_DESCRIPTION& scene,
+	uint64_t sourceSize,
+	int64_t sourceTime)
+{
+	SCENE_FILE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.identifier, g_Identifier, sizeof(g_Identifier));
+	header.version = g_Version;
+	header.headerSize = sizeof(SCENE_FILE_HEADER);
+	header.sourceSize = sourceSize;
+	header.sourceTime = sourceTime;
+	header.nodeCount = (uint32_t)scene.nodes.size();
+	header.materialCount = (uint32_t)scene.materials.size();
+	header.textureCount = (uint32_t)scene.textures.size();
+	header.lightCount = (uint32_t)scene.lights.size();
+	header.nodeOffset = AlignOffset(sizeof(header));
+	header.materialOffset = AlignOffset(header.nodeOffset + scene.nodes.size() * sizeof(NODE));
+	header.textureOffset = AlignOffset(header.materialOffset + scene.materials.size() * sizeof(MATERIAL));
+	header.lightOffset = AlignOffset(header.textureOffset + scene.textures.size() * sizeof(TEXTURE));
+
+	std::string temporaryPath = filename + ".tmp";
+	std::ofstream file(temporaryPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open " << temporaryPath << " for writing" << std::endl;
+		return(false);
+	}
+
+	const char padding[8] = {};
+	uint64_t written = sizeof(header);
+	file.write((const char*)&header, sizeof(header));
+
+	file.write(padding, (size_t)(header.nodeOffset - written));
+	file.write((const char*)scene.nodes.data(), scene.nodes.size() * sizeof(NODE));
+	written = header.nodeOffset + scene.nodes.size() * sizeof(NODE);
+
+	file.write(padding, (size_t)(header.materialOffset - written));
+	file.write((const char*)scene.materials.data(), scene.materials.size() * sizeof(MATERIAL));
+	written = header.materialOffset + scene.materials.size() * sizeof(MATERIAL);
+
+	file.write(padding, (size_t)(header.textureOffset - written));
+	file.write((const char*)scene.textures.data(), scene.textures.size() * sizeof(TEXTURE));
+	written = header.textureOffset + scene.textures.size() * sizeof(TEXTURE);
+
+	file.write(padding, (size_t)(header.lightOffset - written));
+	file.write((const char*)scene.lights.data(), scene.lights.size() * sizeof(LIGHT));
+	file.close();
+
+	if (file.fail())
+	{
+		remove(temporaryPath.c_str());
+		return(false);
+	}
+
+	// a scene file is replaced, so the old one must go first on
+	// systems where rename does not overwrite
+	remove(filename.c_str());
+	if (rename(temporaryPath.c_str(), filename.c_str()) != 0)
+	{
+		remove(temporaryPath.c_str());
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method is used to import a text description and
+ *  write it as a scene file that records the size and time
+ *  of the text file.
+ ***********************************************************/
+bool SceneFile::Compile(const std::string& textFilename, const std::string& filename)
+{
+	SCENE_DESCRIPTION scene;
+	uint64_t sourceSize = 0;
+	int64_t sourceTime = 0;
+
+	if ((MappedFile::GetFileStamp(textFilename, sourceSize, sourceTime) == false) ||
+		(Import(textFilename, scene) == false))
+	{
+		return(false);
+	}
+
+	return(Write(filename, scene, sourceSize, sourceTime));
+}
+
+/***********************************************************
+ *  GetCompiledPath()
+ *
+ *  This method is used to get the file name of the compiled
+ *  scene file for a text description.  The directory is
+ *  created when it is missing, and an empty directory puts
+ *  the scene file next to the text description.
+ ***********************************************************/
+std::string SceneFile::GetCompiledPath(const std::string& textFilename, const std::string& directory)
+{
+	size_t nameStart = textFilename.find_last_of("/\\");
+	nameStart = (nameStart == std::string::npos) ? 0 : nameStart + 1;
+	size_t nameEnd = textFilename.find_last_of('.');
+	if ((nameEnd == std::string::npos) || (nameEnd < nameStart))
+	{
+		nameEnd = textFilename.size();
+	}
+
+	if (directory.empty())
+	{
+		return(textFilename.substr(0, nameEnd) + g_CompiledExtension);
+	}
+
+	std::string path = directory;
+	char last = path[path.size() - 1];
+	if ((last == '/') || (last == '\\'))
+	{
+		path.erase(path.size() - 1);
+	}
+#if defined(_WIN32)
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+
+	return(path + "/" + textFilename.substr(nameStart, nameEnd - nameStart) + g_CompiledExtension);
+}
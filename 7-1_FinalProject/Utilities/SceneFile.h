@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// compiled binary description of a 3D scene, mapped and read in place
+//
+// A scene file holds a header followed by four tables of fixed size
+// records - the nodes with their transforms, meshes and levels of detail,
+// then the materials, the textures and the lights.  The nodes and tables
+// reference each other by index, so nothing needs to be parsed or
+// allocated when the file is read - it is mapped into memory, checked
+// once, and the records are used where they lie.  Scene files are
+// compiled from a text description with Compile(), which records the
+// size and time of the text file so a stale scene file is noticed.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class SceneFile
+{
+public:
+	// length of the tags and texture paths, including the null
+	static const int MAX_TAG_LENGTH = 32;
+	static const int MAX_PATH_LENGTH = 256;
+
+	// one node of the scene, stored after its parent
+	struct NODE
+	{
+		int32_t parent;         // index of the parent node, -1 for none
+		int32_t mesh;           // ShapeMeshes::MESH_TYPE, -1 for none
+		int32_t minLod;         // finest level of detail the node draws
+		int32_t material;       // index in the material table, -1 for none
+		int32_t texture;        // index in the texture table, -1 for none
+		float scale[3];
+		float rotation[4];      // unit quaternion, x, y, z, w
+		float position[3];
+		float color[4];
+		float uvScale[2];
+	};
+
+	struct MATERIAL
+	{
+		float ambientColor[3];
+		float ambientStrength;
+		float diffuseColor[3];
+		float specularColor[3];
+		float shininess;
+		char tag[MAX_TAG_LENGTH];
+	};
+
+	struct TEXTURE
+	{
+		char tag[MAX_TAG_LENGTH];
+		char path[MAX_PATH_LENGTH];
+	};
+
+	struct LIGHT
+	{
+		float position[3];
+		float ambientColor[3];
+		float diffuseColor[3];
+		float specularColor[3];
+		float specularIntensity;
+		float focalStrength;
+	};
+
+	// the records of a scene held in memory, for writing a file
+	struct SCENE_DESCRIPTION
+	{
+		std::vector<NODE> nodes;
+		std::vector<MATERIAL> materials;
+		std::vector<TEXTURE> textures;
+		std::vector<LIGHT> lights;
+	};
+
+	// constructor and destructor, which unmaps the file
+	SceneFile();
+	~SceneFile();
+
+	// map a scene file and check its records, false when it is
+	// missing or damaged
+	bool Map(const std::string& filename);
+	// unmap the file, after which the records are gone
+	void Unmap();
+	bool IsMapped() const { return(NULL != m_view.pData); }
+
+	// check that the mapped file was compiled from the current
+	// contents of a text description
+	bool IsCompiledFrom(const std::string& textFilename) const;
+
+	int GetNodeCount() const { return(m_nodeCount); }
+	const NODE* GetNodes() const { return(m_pNodes); }
+	int GetMaterialCount() const { return(m_materialCount); }
+	const MATERIAL* GetMaterials() const { return(m_pMaterials); }
+	int GetTextureCount() const { return(m_textureCount); }
+	const TEXTURE* GetTextures() const { return(m_pTextures); }
+	int GetLightCount() const { return(m_lightCount); }
+	const LIGHT* GetLights() const { return(m_pLights); }
+
+	// read a text description, reporting the line of the first error
+	static bool Import(const std::string& textFilename, SCENE_DESCRIPTION& scene);
+	// write a scene file, with the size and time of the text
+	// description it was compiled from, or 0 for none
+	static bool Write(
+		const std::string& filename,
+		const SCENE_DESCRIPTION& scene,
+		uint64_t sourceSize = 0,
+		int64_t sourceTime = 0);
+	// import a text description and write it as a scene file
+	static bool Compile(const std::string& textFilename, const std::string& filename);
+
+	// the file name of the compiled scene file for a text
+	// description, in the passed in directory
+	static std::string GetCompiledPath(const std::string& textFilename, const std::string& directory);
+
+private:
+	// the mapped file
+	MappedFile::VIEW m_view;
+
+	// the tables, pointing into the mapped file
+	int m_nodeCount;
+	const NODE* m_pNodes;
+	int m_materialCount;
+	const MATERIAL* m_pMaterials;
+	int m_textureCount;
+	const TEXTURE* m_pTextures;
+	int m_lightCount;
+	const LIGHT* m_pLights;
+
+	// check the records of the mapped file
+	bool ReadTables();
+};
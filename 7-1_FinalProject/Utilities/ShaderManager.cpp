@@ -14,6 +14,39 @@ using namespace std;
 
 #include "ShaderManager.h"
 
+// reported by GL_KHR_parallel_shader_compile and its ARB twin
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+/***********************************************************
+ *  ~ShaderManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderManager::~ShaderManager()
+{
+	if (m_compileThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_compileMutex);
+			m_bStopCompiling = true;
+		}
+		m_compileRequested.notify_all();
+		m_compileThread.join();
+	}
+
+	// free the builds that were never swapped in
+	if (0 != m_compiledProgram)
+	{
+		glDeleteSync(m_compiledFence);
+		glDeleteProgram(m_compiledProgram);
+		m_compiledFence = 0;
+		m_compiledProgram = 0;
+	}
+	FreeProgramBuild(m_pendingBuild);
+}
+
 /***********************************************************
  *  LoadShaders()
  *
@@ -22,98 +55,550 @@ using namespace std;
  ***********************************************************/
 GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
 
-	// Create the shaders
-	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
-	// Read the Vertex Shader code from the file
+	// Read the Vertex and Fragment Shader code from the files
 	std::string VertexShaderCode;
-	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-	if(VertexShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << VertexShaderStream.rdbuf();
-		VertexShaderCode = sstr.str();
-		VertexShaderStream.close();
-	}else{
-		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
-		getchar();
+	std::string FragmentShaderCode;
+	if ((ReadShaderFile(vertex_file_path, VertexShaderCode) == false) ||
+		(ReadShaderFile(fragment_file_path, FragmentShaderCode) == false))
+	{
 		return 0;
 	}
 
-	// Read the Fragment Shader code from the file
-	std::string FragmentShaderCode;
-	std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-	if(FragmentShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << FragmentShaderStream.rdbuf();
-		FragmentShaderCode = sstr.str();
-		FragmentShaderStream.close();
+	// the files are read again when they are saved
+	m_vertexFilePath = vertex_file_path;
+	m_fragmentFilePath = fragment_file_path;
+
+	// Compile the shaders and link the program, waiting for the results
+	PROGRAM_BUILD build = BeginProgramBuild(VertexShaderCode, FragmentShaderCode, vertex_file_path, fragment_file_path);
+	GLuint ProgramID = FinishProgramBuild(build);
+	if (ProgramID == 0)
+	{
+		return 0;
 	}
 
-	GLint Result = GL_FALSE;
-	int InfoLogLength;
+	// resolve all the uniform locations once, so setting values
+	// while rendering never needs to query the driver by name
+	SwapProgram(ProgramID);
 
+	return ProgramID;
+}
 
-	// Compile Vertex Shader
-	printf("Compiling shader : %s...", vertex_file_path);
-	char const * VertexSourcePointer = VertexShaderCode.c_str();
-	glShaderSource(VertexShaderID, 1, &VertexSourcePointer , NULL);
-	glCompileShader(VertexShaderID);
-
-	// Check Vertex Shader
-	glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(VertexShaderID, InfoLogLength, NULL, &VertexShaderErrorMessage[0]);
-		printf("\n%s\n", &VertexShaderErrorMessage[0]);
+/***********************************************************
+ *  EnableHotReload()
+ *
+ *  This method is used to start watching the shader files.
+ *  With a compile context the shaders are built on a thread
+ *  of their own, and without one they are built on the
+ *  render context and only checked once the driver reports
+ *  the build is complete, when it can.
+ ***********************************************************/
+bool ShaderManager::EnableHotReload(COMPILE_CONTEXT_FUNCTION compileContext)
+{
+	if (m_bHotReload == true)
+	{
+		return(true);
+	}
+	if (m_vertexFilePath.empty() || m_fragmentFilePath.empty())
+	{
+		printf("The shaders must be loaded before they can be reloaded\n");
+		return(false);
 	}
 
-	printf("success\n");
+	if ((m_shaderWatcher.Watch(m_vertexFilePath) == false) ||
+		(m_shaderWatcher.Watch(m_fragmentFilePath) == false))
+	{
+		m_shaderWatcher.Clear();
+		return(false);
+	}
 
-	// Compile Fragment Shader
-	printf("Compiling shader : %s...", fragment_file_path);
-	char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-	glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , NULL);
-	glCompileShader(FragmentShaderID);
-
-	// Check Fragment Shader
-	glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(FragmentShaderID, InfoLogLength, NULL, &FragmentShaderErrorMessage[0]);
-		printf("\n%s\n", &FragmentShaderErrorMessage[0]);
+	m_bParallelCompile = EnableParallelCompile();
+
+	if (compileContext)
+	{
+		m_compileContext = compileContext;
+		m_compileThread = std::thread(&ShaderManager::CompileLoop, this);
+
+		// the thread has exited when its context could not be
+		// made current, and the render context is used instead
+		std::unique_lock<std::mutex> lock(m_compileMutex);
+		m_compileStarted.wait(lock, [this]() { return(m_bCompileContextReady || m_bCompileContextFailed); });
+		if (m_bCompileContextFailed == true)
+		{
+			lock.unlock();
+			m_compileThread.join();
+			printf("Could not use the shader compile context, the shaders are built on the render context\n");
+		}
 	}
 
-	printf("success\n");
+	m_bHotReload = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  UpdateHotReload()
+ *
+ *  This method is used to start building the shaders when
+ *  their files were saved, and to swap in the program once
+ *  it has linked.  A program with errors is never swapped
+ *  in, so the scene keeps drawing with the last one that
+ *  worked until the errors are fixed.
+ ***********************************************************/
+bool ShaderManager::UpdateHotReload()
+{
+	if (m_bHotReload == false)
+	{
+		return(false);
+	}
+
+	// a newer save replaces a build that has not finished
+	if (m_shaderWatcher.HasChanged() == true)
+	{
+		std::string vertexCode;
+		std::string fragmentCode;
+		if ((ReadShaderFile(m_vertexFilePath, vertexCode) == true) &&
+			(ReadShaderFile(m_fragmentFilePath, fragmentCode) == true))
+		{
+			printf("The shader files changed, building the shaders again\n");
+			QueueProgramBuild(vertexCode, fragmentCode);
+		}
+	}
+
+	GLuint program = TakeBuiltProgram();
+	if (0 == program)
+	{
+		return(false);
+	}
+
+	SwapProgram(program);
+	use();
+	printf("Swapped in the new shader program\n");
+
+	return(true);
+}
+
+/***********************************************************
+ *  CacheActiveUniforms()
+ *
+ *  This method is called after the shader program has been
+ *  linked to look up the location of every active uniform.
+ *  Uniform arrays are registered by their base name and by
+ *  each of their element names.
+ ***********************************************************/
+void ShaderManager::CacheActiveUniforms()
+{
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+
+	m_uniformLocations.clear();
+
+	glGetProgramiv(m_programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(m_programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	if ((uniformCount <= 0) || (maxNameLength <= 0))
+	{
+		return;
+	}
+
+	std::vector<char> nameBuffer(maxNameLength + 1);
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		GLenum type = GL_NONE;
+
+		glGetActiveUniform(m_programID, (GLuint)i, maxNameLength, &nameLength, &arraySize, &type, &nameBuffer[0]);
+		std::string name(&nameBuffer[0], nameLength);
+
+		// members of uniform blocks have no location
+		GLint location = glGetUniformLocation(m_programID, name.c_str());
+		if (location < 0)
+		{
+			continue;
+		}
+		m_uniformLocations[name] = location;
+
+		// arrays are reported as "name[0]" - register the base
+		// name and the location of every other element
+		size_t bracket = name.rfind("[0]");
+		if ((bracket != std::string::npos) && (bracket + 3 == name.size()))
+		{
+			std::string baseName = name.substr(0, bracket);
+			m_uniformLocations[baseName] = location;
+			for (GLint element = 1; element < arraySize; element++)
+			{
+				std::string elementName = baseName + "[" + std::to_string(element) + "]";
+				m_uniformLocations[elementName] = glGetUniformLocation(m_programID, elementName.c_str());
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  SwapProgram()
+ *
+ *  This method is used to replace the current program with
+ *  one that linked.  The uniform handles other objects hold
+ *  are resolved again when they see the program change.
+ ***********************************************************/
+void ShaderManager::SwapProgram(GLuint program)
+{
+	if (0 != m_programID)
+	{
+		glDeleteProgram(m_programID);
+	}
+	m_programID = program;
+
+	CacheActiveUniforms();
+}
+
+/***********************************************************
+ *  QueueProgramBuild()
+ *
+ *  This method is used to hand the shader sources to the
+ *  compile thread, which builds the newest ones it was
+ *  given.  Without the thread the build is started on the
+ *  render context, replacing any unfinished build.
+ ***********************************************************/
+void ShaderManager::QueueProgramBuild(const std::string& vertexCode, const std::string& fragmentCode)
+{
+	if (m_compileThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_compileMutex);
+			m_queuedVertexCode = vertexCode;
+			m_queuedFragmentCode = fragmentCode;
+			m_bSourcesQueued = true;
+		}
+		m_compileRequested.notify_all();
+		return;
+	}
+
+	FreeProgramBuild(m_pendingBuild);
+	m_pendingBuild = BeginProgramBuild(vertexCode, fragmentCode, m_vertexFilePath, m_fragmentFilePath);
+}
+
+/***********************************************************
+ *  TakeBuiltProgram()
+ *
+ *  This method is used to get a program that finished
+ *  building, without waiting.  A program from the compile
+ *  thread is only taken once the fence after its link has
+ *  been signalled, so the render context sees all of it.
+ ***********************************************************/
+GLuint ShaderManager::TakeBuiltProgram()
+{
+	if (m_compileThread.joinable())
+	{
+		std::lock_guard<std::mutex> lock(m_compileMutex);
+		if (0 == m_compiledProgram)
+		{
+			return(0);
+		}
+
+		GLenum result = glClientWaitSync(m_compiledFence, 0, 0);
+		if (GL_TIMEOUT_EXPIRED == result)
+		{
+			return(0);
+		}
+
+		GLuint program = m_compiledProgram;
+		glDeleteSync(m_compiledFence);
+		m_compiledFence = 0;
+		m_compiledProgram = 0;
+		if (GL_WAIT_FAILED == result)
+		{
+			glDeleteProgram(program);
+			return(0);
+		}
+		return(program);
+	}
+
+	if ((0 == m_pendingBuild.program) ||
+		(IsProgramBuildComplete(m_pendingBuild, m_bParallelCompile) == false))
+	{
+		return(0);
+	}
+
+	return(FinishProgramBuild(m_pendingBuild));
+}
+
+/***********************************************************
+ *  CompileLoop()
+ *
+ *  This method is run by the compile thread, which makes
+ *  the shared context current and builds the queued shader
+ *  sources until the shader manager is destroyed.  Waiting
+ *  for the compiler here only holds up this thread.
+ ***********************************************************/
+void ShaderManager::CompileLoop()
+{
+	bool bCurrent = m_compileContext(true);
+	{
+		std::lock_guard<std::mutex> lock(m_compileMutex);
+		m_bCompileContextReady = bCurrent;
+		m_bCompileContextFailed = !bCurrent;
+	}
+	m_compileStarted.notify_all();
+	if (bCurrent == false)
+	{
+		return;
+	}
+
+	// the driver can still compile the two shaders side by side
+	EnableParallelCompile();
+
+	while (true)
+	{
+		std::string vertexCode;
+		std::string fragmentCode;
+
+		{
+			std::unique_lock<std::mutex> lock(m_compileMutex);
+			m_compileRequested.wait(lock, [this]() { return(m_bStopCompiling || m_bSourcesQueued); });
+			if (m_bStopCompiling)
+			{
+				break;
+			}
+			vertexCode.swap(m_queuedVertexCode);
+			fragmentCode.swap(m_queuedFragmentCode);
+			m_bSourcesQueued = false;
+		}
+
+		PROGRAM_BUILD build = BeginProgramBuild(vertexCode, fragmentCode, m_vertexFilePath, m_fragmentFilePath);
+		GLuint program = FinishProgramBuild(build);
+		if (0 == program)
+		{
+			continue;
+		}
+
+		// the render context waits for the fence before using the
+		// program, and the flush makes sure it is signalled
+		GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+
+		{
+			std::lock_guard<std::mutex> lock(m_compileMutex);
+			// a program that was never taken is replaced by the newer one
+			if (0 != m_compiledProgram)
+			{
+				glDeleteSync(m_compiledFence);
+				glDeleteProgram(m_compiledProgram);
+			}
+			m_compiledProgram = program;
+			m_compiledFence = fence;
+		}
+	}
+
+	m_compileContext(false);
+}
+
+/***********************************************************
+ *  ReadShaderFile()
+ *
+ *  This method is used to read the code of a shader file.
+ ***********************************************************/
+bool ShaderManager::ReadShaderFile(const std::string& filename, std::string& code)
+{
+	std::ifstream ShaderStream(filename.c_str(), std::ios::in);
+	if (!ShaderStream.is_open())
+	{
+		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", filename.c_str());
+		return(false);
+	}
+
+	std::stringstream sstr;
+	sstr << ShaderStream.rdbuf();
+	code = sstr.str();
+
+	return(true);
+}
+
+/***********************************************************
+ *  EnableParallelCompile()
+ *
+ *  This method is used to let the driver compile and link
+ *  on as many threads of its own as it likes.  With either
+ *  extension the driver also reports when a shader or
+ *  program is complete, so the status is never waited on.
+ ***********************************************************/
+bool ShaderManager::EnableParallelCompile()
+{
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		return(true);
+	}
+	if (GLEW_ARB_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		return(true);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  BeginProgramBuild()
+ *
+ *  This method is used to start compiling the shaders and
+ *  linking the program.  None of the results are asked for
+ *  here, so a driver that compiles in the background has
+ *  not been waited on when this returns.
+ ***********************************************************/
+ShaderManager::PROGRAM_BUILD ShaderManager::BeginProgramBuild(
+	const std::string& vertexCode,
+	const std::string& fragmentCode,
+	const std::string& vertexName,
+	const std::string& fragmentName)
+{
+	PROGRAM_BUILD build;
+	build.vertexName = vertexName;
+	build.fragmentName = fragmentName;
+
+	// Compile Vertex Shader
+	build.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	char const * VertexSourcePointer = vertexCode.c_str();
+	glShaderSource(build.vertexShader, 1, &VertexSourcePointer , NULL);
+	glCompileShader(build.vertexShader);
+
+	// Compile Fragment Shader
+	build.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	char const * FragmentSourcePointer = fragmentCode.c_str();
+	glShaderSource(build.fragmentShader, 1, &FragmentSourcePointer , NULL);
+	glCompileShader(build.fragmentShader);
 
 	// Link the program
-	printf("Linking shader program...");
-	GLuint ProgramID = glCreateProgram();
-	m_programID = ProgramID;
-	glAttachShader(ProgramID, VertexShaderID);
-	glAttachShader(ProgramID, FragmentShaderID);
-	glLinkProgram(ProgramID);
+	build.program = glCreateProgram();
+	glAttachShader(build.program, build.vertexShader);
+	glAttachShader(build.program, build.fragmentShader);
+	glLinkProgram(build.program);
+
+	return(build);
+}
+
+/***********************************************************
+ *  IsProgramBuildComplete()
+ *
+ *  This method is used to check whether a build is complete
+ *  without waiting for it.  When the driver cannot report
+ *  it, the build is treated as complete and its results
+ *  are waited on when they are asked for.
+ ***********************************************************/
+bool ShaderManager::IsProgramBuildComplete(const PROGRAM_BUILD& build, bool bParallelCompile)
+{
+	if (bParallelCompile == false)
+	{
+		return(true);
+	}
+
+	// the link is only complete once both shaders are
+	GLint Result = GL_FALSE;
+	glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &Result);
+
+	return(Result == GL_TRUE);
+}
+
+/***********************************************************
+ *  FinishProgramBuild()
+ *
+ *  This method is used to report the results of a build
+ *  and free its shaders.  The program is deleted when
+ *  anything failed to compile or link.
+ ***********************************************************/
+GLuint ShaderManager::FinishProgramBuild(PROGRAM_BUILD& build)
+{
+	// Check the shaders
+	bool bCompiled = CheckShaderCompile(build.vertexShader, build.vertexName);
+	if (CheckShaderCompile(build.fragmentShader, build.fragmentName) == false)
+	{
+		bCompiled = false;
+	}
 
 	// Check the program
-	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
-	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+
+	printf("Linking shader program...");
+	glGetProgramiv(build.program, GL_LINK_STATUS, &Result);
+	glGetProgramiv(build.program, GL_INFO_LOG_LENGTH, &InfoLogLength);
 	if ( InfoLogLength > 1 ){
 		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
-		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
+		glGetProgramInfoLog(build.program, InfoLogLength, NULL, &ProgramErrorMessage[0]);
 		printf("\n%s\n", &ProgramErrorMessage[0]);
 	}
 
+	GLuint ProgramID = build.program;
+	if ((bCompiled == false) || (Result != GL_TRUE))
+	{
+		printf("failed\n");
+		FreeProgramBuild(build);
+		return 0;
+	}
+
 	printf("success\n");
-	
-	glDetachShader(ProgramID, VertexShaderID);
-	glDetachShader(ProgramID, FragmentShaderID);
-	
-	glDeleteShader(VertexShaderID);
-	glDeleteShader(FragmentShaderID);
+
+	glDetachShader(ProgramID, build.vertexShader);
+	glDetachShader(ProgramID, build.fragmentShader);
+
+	// the program is handed to the caller
+	build.program = 0;
+	FreeProgramBuild(build);
 
 	return ProgramID;
 }
 
+/***********************************************************
+ *  FreeProgramBuild()
+ *
+ *  This method is used to delete the shaders and program
+ *  of a build, finished or not.
+ ***********************************************************/
+void ShaderManager::FreeProgramBuild(PROGRAM_BUILD& build)
+{
+	if (0 != build.vertexShader)
+	{
+		glDeleteShader(build.vertexShader);
+		build.vertexShader = 0;
+	}
+	if (0 != build.fragmentShader)
+	{
+		glDeleteShader(build.fragmentShader);
+		build.fragmentShader = 0;
+	}
+	if (0 != build.program)
+	{
+		glDeleteProgram(build.program);
+		build.program = 0;
+	}
+}
 
+/***********************************************************
+ *  CheckShaderCompile()
+ *
+ *  This method is used to report the result of compiling
+ *  one shader, with its compiler messages.
+ ***********************************************************/
+bool ShaderManager::CheckShaderCompile(GLuint shader, const std::string& name)
+{
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+
+	printf("Compiling shader : %s...", name.c_str());
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &Result);
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 0 ){
+		std::vector<char> ShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(shader, InfoLogLength, NULL, &ShaderErrorMessage[0]);
+		printf("\n%s\n", &ShaderErrorMessage[0]);
+	}
+
+	if (Result != GL_TRUE)
+	{
+		printf("failed\n");
+		return(false);
+	}
+
+	printf("success\n");
+
+	return(true);
+}
@@ -2,6 +2,9 @@
 
 #include <GL/glew.h>        // GLEW library
 
+#include "RenderStats.h"
+#include "FileWatcher.h"
+
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -10,94 +13,308 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/***********************************************************
+ *  ShaderUniform
+ *
+ *  A uniform location that was resolved once after the
+ *  shader program was linked.  The template parameter is
+ *  the value type the uniform accepts, so a handle can only
+ *  be passed to the matching set method.
+ ***********************************************************/
+template <typename T>
+struct ShaderUniform
+{
+	GLint location = -1;
+
+	bool IsValid() const { return(location >= 0); }
+};
 
 class ShaderManager
 {
 public:
-	unsigned int m_programID;
-	
+	unsigned int m_programID = 0;
+
+	// makes a context that shares its objects with the context the
+	// scene is drawn with current on the calling thread, or releases
+	// it when passed false
+	typedef std::function<bool(bool)> COMPILE_CONTEXT_FUNCTION;
+
+	// destructor - stops the shader compile thread
+	~ShaderManager();
+
+	// compile and link the shaders, waiting for the result - the
+	// current program is kept when they have errors
 	GLuint LoadShaders(
-		const char* vertex_file_path, 
+		const char* vertex_file_path,
 		const char* fragment_file_path);
 
+	// compile the shaders again whenever their files are saved, on a
+	// thread of its own when a compile context is passed in - must be
+	// called after the shaders are loaded
+	bool EnableHotReload(COMPILE_CONTEXT_FUNCTION compileContext = COMPILE_CONTEXT_FUNCTION());
+
+	// start building the shaders when their files were saved, and swap
+	// in a program that finished linking, true when the program changed
+	// - never waits for the compiler, so it is called every frame
+	bool UpdateHotReload();
+
 	// activate the shader
 	// ------------------------------------------------------------------------
 	inline void use()
 	{
 		glUseProgram(m_programID);
+		RenderStats::CountStateChange();
+	}
+
+	// resolve a typed handle for the named uniform from the
+	// cache that was filled when the program was linked
+	// ------------------------------------------------------------------------
+	template <typename T>
+	inline ShaderUniform<T> GetUniform(const std::string &name) const
+	{
+		ShaderUniform<T> uniform;
+		uniform.location = FindUniformLocation(name);
+		return(uniform);
+	}
+
+	// attach the named uniform block to a uniform buffer binding index
+	// ------------------------------------------------------------------------
+	inline void BindUniformBlock(const char* blockName, GLuint bindingIndex) const
+	{
+		GLuint blockIndex = glGetUniformBlockIndex(m_programID, blockName);
+		if (blockIndex != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(m_programID, blockIndex, bindingIndex);
+		}
 	}
 
 	// utility uniform functions
 	// ------------------------------------------------------------------------
 	inline void setBoolValue(const std::string &name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+		glUniform1i(FindUniformLocation(name), (int)value);
+		RenderStats::CountUniformUpload();
+	}
+	inline void setBoolValue(ShaderUniform<bool> uniform, bool value) const
+	{
+		glUniform1i(uniform.location, (int)value);
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setIntValue(const std::string &name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1i(FindUniformLocation(name), value);
+		RenderStats::CountUniformUpload();
+	}
+	inline void setIntValue(ShaderUniform<int> uniform, int value) const
+	{
+		glUniform1i(uniform.location, value);
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setFloatValue(const std::string &name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1f(FindUniformLocation(name), value);
+		RenderStats::CountUniformUpload();
+	}
+	inline void setFloatValue(ShaderUniform<float> uniform, float value) const
+	{
+		glUniform1f(uniform.location, value);
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
 	{
-		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform2fv(FindUniformLocation(name), 1, &value[0]);
+		RenderStats::CountUniformUpload();
+	}
+	inline void setVec2Value(ShaderUniform<glm::vec2> uniform, const glm::vec2 &value) const
+	{
+		glUniform2fv(uniform.location, 1, &value[0]);
+		RenderStats::CountUniformUpload();
 	}
 
 	inline void setVec2Value(const std::string &name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+		glUniform2f(FindUniformLocation(name), x, y);
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
 	{
-		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform3fv(FindUniformLocation(name), 1, &value[0]);
+		RenderStats::CountUniformUpload();
+	}
+	inline void setVec3Value(ShaderUniform<glm::vec3> uniform, const glm::vec3 &value) const
+	{
+		glUniform3fv(uniform.location, 1, &value[0]);
+		RenderStats::CountUniformUpload();
 	}
 	inline void setVec3Value(const std::string &name, float x, float y, float z) const
 	{
-		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+		glUniform3f(FindUniformLocation(name), x, y, z);
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
 	{
-		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform4fv(FindUniformLocation(name), 1, &value[0]);
+		RenderStats::CountUniformUpload();
+	}
+	inline void setVec4Value(ShaderUniform<glm::vec4> uniform, const glm::vec4 &value) const
+	{
+		glUniform4fv(uniform.location, 1, &value[0]);
+		RenderStats::CountUniformUpload();
 	}
 	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
 	{
-		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+		glUniform4f(FindUniformLocation(name), x, y, z, w);
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
 	{
-		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glUniformMatrix2fv(FindUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
 	{
-		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glUniformMatrix3fv(FindUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+		RenderStats::CountUniformUpload();
+	}
+	inline void setMat3Value(ShaderUniform<glm::mat3> uniform, const glm::mat3 &mat) const
+	{
+		glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		glUniformMatrix4fv(FindUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
+		RenderStats::CountUniformUpload();
+	}
+	inline void setMat4Value(ShaderUniform<glm::mat4> uniform, const glm::mat4 &mat) const
+	{
+		glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(mat));
+		RenderStats::CountUniformUpload();
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setSampler2DValue(const std::string& name, const int &value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1i(FindUniformLocation(name), value);
+		RenderStats::CountUniformUpload();
+	}
+	inline void setSampler2DValue(ShaderUniform<int> uniform, const int &value) const
+	{
+		glUniform1i(uniform.location, value);
+		RenderStats::CountUniformUpload();
+	}
+
+private:
+	// the shader objects and program of a build, which the driver
+	// may still be compiling
+	struct PROGRAM_BUILD
+	{
+		std::string vertexName;
+		std::string fragmentName;
+		GLuint vertexShader = 0;
+		GLuint fragmentShader = 0;
+		GLuint program = 0;
+	};
+
+	// locations of all the active uniforms in the linked program
+	std::unordered_map<std::string, GLint> m_uniformLocations;
+
+	// shader files the program was loaded from
+	std::string m_vertexFilePath;
+	std::string m_fragmentFilePath;
+	// reports when the shader files are saved
+	FileWatcher m_shaderWatcher;
+	bool m_bHotReload = false;
+	// set when the driver reports that a build is complete, so it
+	// can be checked without waiting
+	bool m_bParallelCompile = false;
+	// build started on the render context when there is no compile thread
+	PROGRAM_BUILD m_pendingBuild;
+
+	// thread that builds the shaders on a shared context
+	COMPILE_CONTEXT_FUNCTION m_compileContext;
+	std::thread m_compileThread;
+	std::mutex m_compileMutex;
+	// signalled when sources are queued or the thread must exit
+	std::condition_variable m_compileRequested;
+	// signalled when the thread made its context current, or failed to
+	std::condition_variable m_compileStarted;
+	bool m_bCompileContextReady = false;
+	bool m_bCompileContextFailed = false;
+	bool m_bStopCompiling = false;
+	// the newest sources waiting for the compile thread
+	bool m_bSourcesQueued = false;
+	std::string m_queuedVertexCode;
+	std::string m_queuedFragmentCode;
+	// program linked by the compile thread, with the fence that is
+	// signalled once it can be used on the render context
+	GLuint m_compiledProgram = 0;
+	GLsync m_compiledFence = 0;
+
+	// fill the uniform location cache from the linked program
+	void CacheActiveUniforms();
+
+	// replace the current program with a newly linked one
+	void SwapProgram(GLuint program);
+	// build the passed in sources on the compile thread, or start
+	// building them on the render context
+	void QueueProgramBuild(const std::string& vertexCode, const std::string& fragmentCode);
+	// take a program that finished building, 0 for none
+	GLuint TakeBuiltProgram();
+	// build the queued sources until the shader manager is destroyed
+	void CompileLoop();
+
+	// read the code of a shader file
+	static bool ReadShaderFile(const std::string& filename, std::string& code);
+	// let the driver compile on threads of its own, false when it
+	// cannot report that a build is complete
+	static bool EnableParallelCompile();
+	// start compiling and linking the passed in sources
+	static PROGRAM_BUILD BeginProgramBuild(
+		const std::string& vertexCode,
+		const std::string& fragmentCode,
+		const std::string& vertexName,
+		const std::string& fragmentName);
+	// check whether a build is complete, without waiting
+	static bool IsProgramBuildComplete(const PROGRAM_BUILD& build, bool bParallelCompile);
+	// report the results of a build and free its shaders - the
+	// linked program, or 0 when there were errors
+	static GLuint FinishProgramBuild(PROGRAM_BUILD& build);
+	// free the shaders and program of a build
+	static void FreeProgramBuild(PROGRAM_BUILD& build);
+	// report the result of compiling one shader
+	static bool CheckShaderCompile(GLuint shader, const std::string& name);
+
+	// look up a uniform location in the cache, -1 if not active
+	inline GLint FindUniformLocation(const std::string &name) const
+	{
+		auto found = m_uniformLocations.find(name);
+		if (found == m_uniformLocations.end())
+		{
+			return(-1);
+		}
+		return(found->second);
 	}
-};
\ No newline at end of file
+};
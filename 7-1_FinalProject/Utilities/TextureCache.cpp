@@ -0,0 +1,280 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.cpp
+// ============
+// on-disk cache of decoded and mipmapped texture images
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCache.h"
+#include "Ktx2File.h"
+
+#include <cstdio>
+#include <sstream>
+#include <iomanip>
+
+#if defined(_WIN32)
+#include <direct.h>
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// the key of the value that ties an entry to its source file,
+	// and the version of the entries - entries written by another
+	// version are ignored
+	const char* g_SourceKey = "FinalProjectSource";
+	const char* g_EntryVersion = "2";
+	const char* g_EntryExtension = ".ktx2";
+
+	// the file name suffix of the entries for each compression
+	const char* g_CompressionNames[] = { "-rgb", "-s3tc", "-bptc" };
+}
+
+/***********************************************************
+ *  TextureCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureCache::TextureCache()
+{
+	m_storeCount = 0;
+}
+
+/***********************************************************
+ *  SetDirectory()
+ *
+ *  This method is used to set the directory that the cache
+ *  entries are kept in.  Only the last directory in the
+ *  path is created when it is missing.
+ ***********************************************************/
+void TextureCache::SetDirectory(const std::string& directory)
+{
+	m_directory = directory;
+	if (m_directory.empty())
+	{
+		return;
+	}
+
+	char last = m_directory[m_directory.size() - 1];
+	if ((last != '/') && (last != '\\'))
+	{
+		m_directory += '/';
+	}
+
+	std::string path = m_directory.substr(0, m_directory.size() - 1);
+#if defined(_WIN32)
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+/***********************************************************
+ *  HashBytes()
+ *
+ *  This method is used to hash the contents of a source
+ *  image file with 64 bit FNV-1a.
+ ***********************************************************/
+uint64_t TextureCache::HashBytes(const unsigned char* data, size_t size)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  GetEntryPath()
+ *
+ *  This method is used to get the file name of the cache
+ *  entry for a source file hash.
+ ***********************************************************/
+std::string TextureCache::GetEntryPath(uint64_t sourceHash, TEXTURE_COMPRESSION compression) const
+{
+	std::ostringstream path;
+	path << m_directory << std::hex << std::setw(16) << std::setfill('0') << sourceHash
+		<< g_CompressionNames[compression] << g_EntryExtension;
+	return(path.str());
+}
+
+/***********************************************************
+ *  GetSourceValue()
+ *
+ *  This method is used to get the value that is stored in
+ *  an entry to tie it to its source file, so an entry of
+ *  another version, or of a source file of another size
+ *  whose contents happen to hash the same, is not loaded.
+ ***********************************************************/
+std::string TextureCache::GetSourceValue(uint64_t sourceHash, size_t sourceSize)
+{
+	std::ostringstream value;
+	value << g_EntryVersion << " " << std::hex << std::setw(16) << std::setfill('0') << sourceHash
+		<< " " << std::dec << sourceSize;
+	return(value.str());
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used to map the cache entry for a source
+ *  file hash.  False is returned when there is no entry, or
+ *  when the entry does not match the source file.
+ ***********************************************************/
+bool TextureCache::Load(uint64_t sourceHash, size_t sourceSize, TEXTURE_COMPRESSION compression, TEXTURE_IMAGE& image) const
+{
+	if (IsEnabled() == false)
+	{
+		return(false);
+	}
+
+	if (MappedFile::Map(GetEntryPath(sourceHash, compression), image.mappedEntry) == false)
+	{
+		return(false);
+	}
+	const unsigned char* pView = image.mappedEntry.pData;
+	size_t viewSize = image.mappedEntry.size;
+
+	// check that the entry is complete and was made from the
+	// same source file
+	size_t pixelsStart = 0;
+	if ((Ktx2File::GetValue(pView, viewSize, g_SourceKey) != GetSourceValue(sourceHash, sourceSize)) ||
+		(Ktx2File::Read(pView, viewSize, image, pixelsStart) == false))
+	{
+		FreeImage(image);
+		return(false);
+	}
+
+	image.pMappedPixels = pView + pixelsStart;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Store()
+ *
+ *  This method is used to write the cache entry for a
+ *  source file hash.  The entry is written to a temporary
+ *  file first, so a half written entry is never loaded.
+ ***********************************************************/
+bool TextureCache::Store(uint64_t sourceHash, size_t sourceSize, TEXTURE_COMPRESSION compression, const TEXTURE_IMAGE& image)
+{
+	if ((IsEnabled() == false) || image.levels.empty())
+	{
+		return(false);
+	}
+
+	std::string path = GetEntryPath(sourceHash, compression);
+	// the process id keeps the temporary files of processes that
+	// fill the same cache at once apart, and the count those of
+	// the threads in this process
+	std::ostringstream temporaryPath;
+#if defined(_WIN32)
+	temporaryPath << path << ".tmp" << _getpid() << "-" << m_storeCount++;
+#else
+	temporaryPath << path << ".tmp" << getpid() << "-" << m_storeCount++;
+#endif
+
+	if (Ktx2File::Write(temporaryPath.str(), image, g_SourceKey, GetSourceValue(sourceHash, sourceSize)) == false)
+	{
+		remove(temporaryPath.str().c_str());
+		return(false);
+	}
+
+	// another thread or process may have written the same entry
+	// already, in which case its copy is kept
+	if (rename(temporaryPath.str().c_str(), path.c_str()) != 0)
+	{
+		remove(temporaryPath.str().c_str());
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BuildMipLevels()
+ *
+ *  This method is used to fill in the smaller mip levels of
+ *  an uncompressed image that only has its first level, by averaging
+ *  each 2x2 block of texels of the level above - the same
+ *  box filter that glGenerateMipmap uses.
+ ***********************************************************/
+void TextureCache::BuildMipLevels(TEXTURE_IMAGE& image)
+{
+	if ((image.levels.size() != 1) ||
+		((image.format != TEXTURE_FORMAT_RGB8) && (image.format != TEXTURE_FORMAT_RGBA8)))
+	{
+		return;
+	}
+
+	const int channels = image.colorChannels;
+
+	// find the size of every level down to 1x1 first, so the
+	// pixels are only allocated once
+	size_t totalSize = image.levels[0].size;
+	int width = image.levels[0].width;
+	int height = image.levels[0].height;
+	while ((width > 1) || (height > 1))
+	{
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+
+		TEXTURE_IMAGE::MIP_LEVEL level;
+		level.width = width;
+		level.height = height;
+		level.offset = totalSize;
+		level.size = (size_t)width * height * channels;
+		image.levels.push_back(level);
+		totalSize += level.size;
+	}
+	image.decodedPixels.resize(totalSize);
+
+	for (size_t i = 1; i < image.levels.size(); i++)
+	{
+		const TEXTURE_IMAGE::MIP_LEVEL& source = image.levels[i - 1];
+		const TEXTURE_IMAGE::MIP_LEVEL& target = image.levels[i];
+		const unsigned char* pSource = image.decodedPixels.data() + source.offset;
+		unsigned char* pTarget = image.decodedPixels.data() + target.offset;
+
+		for (int y = 0; y < target.height; y++)
+		{
+			// odd sizes repeat the last row or column
+			int y0 = (y * 2 < source.height) ? y * 2 : source.height - 1;
+			int y1 = (y * 2 + 1 < source.height) ? y * 2 + 1 : y0;
+			for (int x = 0; x < target.width; x++)
+			{
+				int x0 = (x * 2 < source.width) ? x * 2 : source.width - 1;
+				int x1 = (x * 2 + 1 < source.width) ? x * 2 + 1 : x0;
+				for (int c = 0; c < channels; c++)
+				{
+					int sum = pSource[(y0 * source.width + x0) * channels + c] +
+						pSource[(y0 * source.width + x1) * channels + c] +
+						pSource[(y1 * source.width + x0) * channels + c] +
+						pSource[(y1 * source.width + x1) * channels + c];
+					pTarget[(y * target.width + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  FreeImage()
+ *
+ *  This method is used to free the pixels of an image, and
+ *  unmap its cache entry when it was read from the cache.
+ ***********************************************************/
+void TextureCache::FreeImage(TEXTURE_IMAGE& image)
+{
+	MappedFile::Unmap(image.mappedEntry);
+	image.pMappedPixels = NULL;
+
+	std::vector<unsigned char>().swap(image.decodedPixels);
+	image.levels.clear();
+}
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.h
+// ============
+// on-disk cache of decoded and mipmapped texture images
+//
+// Each entry is a KTX2 file holding every mip level of one image, ready to
+// be passed to glTexImage2D or glCompressedTexImage2D.  Entries are named
+// by a hash of the source image file and the compression they were made
+// with, so an edited image gets a new entry, and they are memory mapped
+// when read so a warm start needs no image decoding, no mipmap generation
+// and no block compression.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// the layout of the pixels of a texture image
+enum TEXTURE_FORMAT
+{
+	TEXTURE_FORMAT_UNKNOWN,
+	TEXTURE_FORMAT_RGB8,        // 3 bytes per texel
+	TEXTURE_FORMAT_RGBA8,       // 4 bytes per texel
+	TEXTURE_FORMAT_BC1,         // 8 bytes per 4x4 block, opaque RGB
+	TEXTURE_FORMAT_BC3,         // 16 bytes per 4x4 block, RGB and alpha
+	TEXTURE_FORMAT_BC7          // 16 bytes per 4x4 block, RGB or RGBA
+};
+
+// the block compression formats a texture may be converted to
+enum TEXTURE_COMPRESSION
+{
+	TEXTURE_COMPRESSION_NONE,   // keep RGB8 and RGBA8
+	TEXTURE_COMPRESSION_S3TC,   // BC1 for RGB, BC3 for RGBA
+	TEXTURE_COMPRESSION_BPTC    // BC7 for both
+};
+
+/***********************************************************
+ *  TEXTURE_IMAGE
+ *
+ *  A texture image with all of its mip levels.  The pixels
+ *  are either decoded into memory or mapped from a cache
+ *  entry, and are released with TextureCache::FreeImage().
+ ***********************************************************/
+struct TEXTURE_IMAGE
+{
+	// one mip level, the offset is from GetPixels()
+	struct MIP_LEVEL
+	{
+		int width;
+		int height;
+		size_t offset;
+		size_t size;
+	};
+
+	int width = 0;
+	int height = 0;
+	// channels of the source image, 3 or 4
+	int colorChannels = 0;
+	TEXTURE_FORMAT format = TEXTURE_FORMAT_UNKNOWN;
+	// every mip level, largest first - empty when there is no image
+	std::vector<MIP_LEVEL> levels;
+
+	// pixels of the levels when the image was decoded
+	std::vector<unsigned char> decodedPixels;
+	// mapped cache entry when the image was read from the cache
+	const unsigned char* pMappedPixels = NULL;
+	MappedFile::VIEW mappedEntry;
+
+	// pixels of all the levels, which may be stored in any order
+	const unsigned char* GetPixels() const
+	{
+		return((NULL != pMappedPixels) ? pMappedPixels : decodedPixels.data());
+	}
+	// size of the pixels up to the end of the last stored level
+	size_t GetPixelsSize() const
+	{
+		size_t size = 0;
+		for (size_t i = 0; i < levels.size(); i++)
+		{
+			if (levels[i].offset + levels[i].size > size)
+			{
+				size = levels[i].offset + levels[i].size;
+			}
+		}
+		return(size);
+	}
+
+	// size of one mip level in a format, block compressed
+	// levels are padded to whole 4x4 blocks
+	static size_t GetLevelSize(TEXTURE_FORMAT format, int width, int height)
+	{
+		size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+		switch (format)
+		{
+		case TEXTURE_FORMAT_RGB8:
+			return((size_t)width * height * 3);
+		case TEXTURE_FORMAT_RGBA8:
+			return((size_t)width * height * 4);
+		case TEXTURE_FORMAT_BC1:
+			return(blocks * 8);
+		case TEXTURE_FORMAT_BC3:
+		case TEXTURE_FORMAT_BC7:
+			return(blocks * 16);
+		default:
+			return(0);
+		}
+	}
+};
+
+class TextureCache
+{
+public:
+	// constructor
+	TextureCache();
+
+	// set the directory the entries are kept in, which is created
+	// when it does not exist - an empty directory turns the cache off
+	void SetDirectory(const std::string& directory);
+	bool IsEnabled() const { return(m_directory.empty() == false); }
+
+	// hash the contents of a source image file
+	static uint64_t HashBytes(const unsigned char* data, size_t size);
+
+	// map the entry for a source file hash, false when there is none
+	bool Load(uint64_t sourceHash, size_t sourceSize, TEXTURE_COMPRESSION compression, TEXTURE_IMAGE& image) const;
+	// write the entry for a source file hash
+	bool Store(uint64_t sourceHash, size_t sourceSize, TEXTURE_COMPRESSION compression, const TEXTURE_IMAGE& image);
+
+	// fill the smaller mip levels of an image from its first level
+	static void BuildMipLevels(TEXTURE_IMAGE& image);
+
+	// free the pixels of an image, unmapping a cache entry
+	static void FreeImage(TEXTURE_IMAGE& image);
+
+private:
+	// directory the entries are kept in, ending with a separator
+	std::string m_directory;
+	// makes the temporary file names of concurrent stores unique
+	std::atomic<unsigned int> m_storeCount;
+
+	// get the file name of the entry for a source file hash
+	std::string GetEntryPath(uint64_t sourceHash, TEXTURE_COMPRESSION compression) const;
+	// get the value that ties an entry to its source file
+	static std::string GetSourceValue(uint64_t sourceHash, size_t sourceSize);
+};
@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.cpp
+// ============
+// decode texture image files on worker threads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureLoader.h"
+#include "BlockCompressor.h"
+#include "Ktx2File.h"
+
+#include "stb_image.h"
+
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace
+{
+	// the scene only has a handful of textures, so a few
+	// workers are enough to decode them all at once
+	const unsigned int g_MaxWorkers = 4;
+}
+
+/***********************************************************
+ *  TextureLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureLoader::TextureLoader()
+{
+	m_pending = 0;
+	m_bStopping = false;
+	m_compression = TEXTURE_COMPRESSION_NONE;
+}
+
+/***********************************************************
+ *  ~TextureLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_requestReady.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+
+	// free any images that were decoded but never collected
+	while (m_decoded.empty() == false)
+	{
+		FreeImage(m_decoded.front());
+		m_decoded.pop_front();
+	}
+}
+
+/***********************************************************
+ *  SetCacheDirectory()
+ *
+ *  This method is used to keep the decoded images in the
+ *  passed in directory, so they are not decoded again on
+ *  the next run.  An empty directory turns the cache off.
+ ***********************************************************/
+void TextureLoader::SetCacheDirectory(const std::string& directory)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// the workers read the cache without locking
+	if (m_workers.empty())
+	{
+		m_cache.SetDirectory(directory);
+	}
+}
+
+/***********************************************************
+ *  SetCompression()
+ *
+ *  This method is used to block compress the decoded images
+ *  to one of the formats the GPU can sample, so that they
+ *  take less video memory and bandwidth.
+ ***********************************************************/
+void TextureLoader::SetCompression(TEXTURE_COMPRESSION compression)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// the workers read the compression without locking
+	if (m_workers.empty())
+	{
+		m_compression = compression;
+	}
+}
+
+/***********************************************************
+ *  QueueImage()
+ *
+ *  This method is used to queue an image file for decoding.
+ *  The slot is returned with the decoded image, so that
+ *  the caller knows which texture it belongs to.
+ ***********************************************************/
+void TextureLoader::QueueImage(const char* filename, int slot)
+{
+	DECODED_IMAGE request;
+	request.slot = slot;
+	request.filename = filename;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_workers.empty())
+		{
+			StartWorkers();
+		}
+		m_requests.push_back(std::move(request));
+		m_pending++;
+	}
+	m_requestReady.notify_one();
+}
+
+/***********************************************************
+ *  PopDecodedImage()
+ *
+ *  This method is used to get the next decoded image
+ *  without waiting.  False is returned when no image has
+ *  finished decoding.
+ ***********************************************************/
+bool TextureLoader::PopDecodedImage(DECODED_IMAGE& image)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_decoded.empty())
+	{
+		return(false);
+	}
+
+	image = std::move(m_decoded.front());
+	m_decoded.pop_front();
+	m_pending--;
+
+	return(true);
+}
+
+/***********************************************************
+ *  WaitDecodedImage()
+ *
+ *  This method is used to get the next decoded image,
+ *  waiting for one to finish decoding.  False is returned
+ *  when there are no more queued images.
+ ***********************************************************/
+bool TextureLoader::WaitDecodedImage(DECODED_IMAGE& image)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_imageReady.wait(lock, [this]() { return((m_decoded.empty() == false) || (m_pending == 0)); });
+	if (m_decoded.empty())
+	{
+		return(false);
+	}
+
+	image = std::move(m_decoded.front());
+	m_decoded.pop_front();
+	m_pending--;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FreeImage()
+ *
+ *  This method is used to free the pixels of a decoded
+ *  image once they have been uploaded.
+ ***********************************************************/
+void TextureLoader::FreeImage(DECODED_IMAGE& image)
+{
+	TextureCache::FreeImage(image.image);
+}
+
+/***********************************************************
+ *  GetPendingCount()
+ *
+ *  This method is used to get the number of queued images
+ *  that have not been collected yet.
+ ***********************************************************/
+int TextureLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return(m_pending);
+}
+
+/***********************************************************
+ *  StartWorkers()
+ *
+ *  This method is used to start the worker threads.  One
+ *  core is left for the OpenGL thread.
+ ***********************************************************/
+void TextureLoader::StartWorkers()
+{
+	unsigned int workerCount = std::thread::hardware_concurrency();
+
+	if (workerCount > 1)
+	{
+		workerCount--;
+	}
+	if (workerCount > g_MaxWorkers)
+	{
+		workerCount = g_MaxWorkers;
+	}
+	if (workerCount < 1)
+	{
+		workerCount = 1;
+	}
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&TextureLoader::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is run by each worker thread, decoding the
+ *  queued image files until the loader is destroyed.
+ ***********************************************************/
+void TextureLoader::WorkerLoop()
+{
+	// the flip setting is per thread, so the workers never
+	// race with stbi_set_flip_vertically_on_load() callers
+	stbi_set_flip_vertically_on_load_thread(true);
+
+	while (true)
+	{
+		DECODED_IMAGE image;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_requestReady.wait(lock, [this]() { return(m_bStopping || (m_requests.empty() == false)); });
+			if (m_bStopping)
+			{
+				return;
+			}
+			image = std::move(m_requests.front());
+			m_requests.pop_front();
+		}
+
+		// decode without holding the lock, so that the
+		// workers run in parallel
+		DecodeImage(image);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_decoded.push_back(std::move(image));
+		}
+		m_imageReady.notify_all();
+	}
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  This method is used to get the mip levels of a queued
+ *  image file.  The file is hashed to find its entry in
+ *  the texture cache, and when there is none the file is
+ *  decoded, its mip levels are built and compressed, and
+ *  the result is stored in the cache for the next run.
+ ***********************************************************/
+void TextureLoader::DecodeImage(DECODED_IMAGE& image)
+{
+	std::ifstream file(image.filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return;
+	}
+	std::vector<unsigned char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	// KTX2 files already have their mip levels in the format
+	// they are uploaded in
+	if (Ktx2File::IsKtx2(contents.data(), contents.size()))
+	{
+		size_t pixelsStart = 0;
+		if (Ktx2File::Read(contents.data(), contents.size(), image.image, pixelsStart) == true)
+		{
+			contents.erase(contents.begin(), contents.begin() + pixelsStart);
+			image.image.decodedPixels.swap(contents);
+		}
+		return;
+	}
+
+	uint64_t sourceHash = 0;
+	if (m_cache.IsEnabled())
+	{
+		sourceHash = TextureCache::HashBytes(contents.data(), contents.size());
+		if (m_cache.Load(sourceHash, contents.size(), m_compression, image.image) == true)
+		{
+			image.bFromCache = true;
+			return;
+		}
+	}
+
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+	unsigned char* pixels = stbi_load_from_memory(
+		contents.data(),
+		(int)contents.size(),
+		&width,
+		&height,
+		&colorChannels,
+		0);
+	if (NULL == pixels)
+	{
+		return;
+	}
+
+	TEXTURE_IMAGE::MIP_LEVEL level;
+	level.width = width;
+	level.height = height;
+	level.offset = 0;
+	level.size = (size_t)width * height * colorChannels;
+
+	image.image.width = width;
+	image.image.height = height;
+	image.image.colorChannels = colorChannels;
+	if (colorChannels == 3)
+	{
+		image.image.format = TEXTURE_FORMAT_RGB8;
+	}
+	else if (colorChannels == 4)
+	{
+		image.image.format = TEXTURE_FORMAT_RGBA8;
+	}
+	image.image.levels.push_back(level);
+	image.image.decodedPixels.assign(pixels, pixels + level.size);
+	stbi_image_free(pixels);
+
+	TextureCache::BuildMipLevels(image.image);
+	// the mip levels are filtered before compressing, so the
+	// small levels do not average the compression errors
+	BlockCompressor::CompressImage(image.image, m_compression);
+
+	if (m_cache.IsEnabled())
+	{
+		m_cache.Store(sourceHash, contents.size(), m_compression, image.image);
+	}
+}
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.h
+// ============
+// decode texture image files on worker threads
+//
+// Image files are queued from the OpenGL thread, decoded in parallel by a
+// small pool of worker threads, and the decoded pixels are collected again
+// on the OpenGL thread for uploading.  The workers have no OpenGL context,
+// so nothing they run may make OpenGL calls.
+//
+// With a cache directory set, the workers read the mip levels of images
+// that were decoded before from the texture cache, and add the images
+// they have to decode to it.  With a compression set, the decoded images
+// are block compressed before they are cached.  KTX2 files are read as
+// they are, since they are compressed offline by the TextureCompressor.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureCache.h"
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class TextureLoader
+{
+public:
+	// constructor
+	TextureLoader();
+	// destructor - waits for the worker threads to finish
+	~TextureLoader();
+
+	// an image file decoded by one of the worker threads
+	struct DECODED_IMAGE
+	{
+		// the value passed in when the image was queued
+		int slot = -1;
+		std::string filename;
+		// the image with all of its mip levels, which has no levels
+		// when the file could not be read - must be released with
+		// FreeImage()
+		TEXTURE_IMAGE image;
+		// set when the image was read from the texture cache
+		bool bFromCache = false;
+	};
+
+	// keep decoded images in the passed in directory - must be set
+	// before the first image is queued
+	void SetCacheDirectory(const std::string& directory);
+
+	// block compress decoded images for the GPU - must be set before
+	// the first image is queued
+	void SetCompression(TEXTURE_COMPRESSION compression);
+
+	// queue an image file to be decoded, flipped vertically for OpenGL
+	void QueueImage(const char* filename, int slot);
+
+	// get the next decoded image, false when none is ready
+	bool PopDecodedImage(DECODED_IMAGE& image);
+
+	// wait until an image is decoded, false when nothing is left to decode
+	bool WaitDecodedImage(DECODED_IMAGE& image);
+
+	// free the pixels of a decoded image
+	static void FreeImage(DECODED_IMAGE& image);
+
+	// number of queued images that have not been popped yet
+	int GetPendingCount();
+
+private:
+	// image files waiting to be decoded
+	std::deque<DECODED_IMAGE> m_requests;
+	// decoded images waiting for the OpenGL thread
+	std::deque<DECODED_IMAGE> m_decoded;
+	// queued images that have not been popped yet
+	int m_pending;
+	// decoded images kept between runs
+	TextureCache m_cache;
+	// the block compression of decoded images
+	TEXTURE_COMPRESSION m_compression;
+	// set when the worker threads must exit
+	bool m_bStopping;
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	// signalled when a request is queued or the loader is stopping
+	std::condition_variable m_requestReady;
+	// signalled when an image has been decoded
+	std::condition_variable m_imageReady;
+
+	// start the worker threads when the first image is queued
+	void StartWorkers();
+	// decode the queued image files until the loader is stopping
+	void WorkerLoop();
+	// read an image from the cache, or decode it and add it to the cache
+	void DecodeImage(DECODED_IMAGE& image);
+};
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// transform.cpp
+// ============
+// scale, rotation and translation of an object relative to its parent
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Transform.h"
+#include "TransformBatch.h"
+
+/***********************************************************
+ *  Transform()
+ *
+ *  The constructors for the class, which build the matrix
+ *  of the transform the same way as the matrices of a
+ *  TransformBatch.
+ ***********************************************************/
+Transform::Transform()
+{
+	m_scale = glm::vec3(1.0f);
+	m_rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	m_position = glm::vec3(0.0f);
+	m_matrix = glm::mat4(1.0f);
+}
+
+Transform::Transform(
+	const glm::vec3& scale,
+	const glm::quat& rotation,
+	const glm::vec3& position)
+{
+	m_scale = scale;
+	m_rotation = rotation;
+	m_position = position;
+	m_matrix = TransformBatch::ComposeLocalMatrix(m_scale, m_rotation, m_position);
+}
+
+Transform::Transform(
+	const glm::vec3& scale,
+	const glm::vec3& position)
+{
+	m_scale = scale;
+	m_rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	m_position = position;
+	m_matrix = TransformBatch::ComposeLocalMatrix(m_scale, m_rotation, m_position);
+}
+
+/***********************************************************
+ *  FromEulerDegrees()
+ *
+ *  This method is used for building a transform from the
+ *  Euler degree triplets the scene is authored with.  The
+ *  sines and cosines are only taken here.
+ ***********************************************************/
+Transform Transform::FromEulerDegrees(
+	const glm::vec3& scaleXYZ,
+	const glm::vec3& rotationDegrees,
+	const glm::vec3& positionXYZ)
+{
+	return(Transform(scaleXYZ, RotationFromEulerDegrees(rotationDegrees), positionXYZ));
+}
+
+/***********************************************************
+ *  RotationFromEulerDegrees()
+ *
+ *  This method is used for getting the quaternion that
+ *  rotates about the X axis, then the Y axis, then the Z
+ *  axis, matching the X * Y * Z order of the rotation
+ *  matrices the scene used to be built with.
+ ***********************************************************/
+glm::quat Transform::RotationFromEulerDegrees(const glm::vec3& rotationDegrees)
+{
+	return(
+		glm::angleAxis(glm::radians(rotationDegrees.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+		glm::angleAxis(glm::radians(rotationDegrees.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+		glm::angleAxis(glm::radians(rotationDegrees.z), glm::vec3(0.0f, 0.0f, 1.0f)));
+}
@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// transform.h
+// ============
+// scale, rotation and translation of an object relative to its parent
+//
+// The rotation is kept as a unit quaternion, so Euler angles are only
+// turned into a rotation once, when the scene is authored, and drawing
+// needs no sine or cosine.  A transform cannot be changed once it is made,
+// so its matrix is built straight from the quaternion once, in the
+// constructor, and never again.  The scene graph composes the matrices with
+// their parents in a TransformBatch.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+class Transform
+{
+public:
+	// constructor - the identity transform
+	Transform();
+	Transform(
+		const glm::vec3& scale,
+		const glm::quat& rotation,
+		const glm::vec3& position);
+	// a transform without a rotation
+	Transform(
+		const glm::vec3& scale,
+		const glm::vec3& position);
+
+	// build a transform that rotates about the X axis, then the Y
+	// axis, then the Z axis by the passed in degrees - for authoring
+	static Transform FromEulerDegrees(
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegrees,
+		const glm::vec3& positionXYZ);
+	// get the rotation of the passed in Euler degrees, in the same
+	// order as FromEulerDegrees()
+	static glm::quat RotationFromEulerDegrees(const glm::vec3& rotationDegrees);
+
+	const glm::vec3& GetScale() const { return(m_scale); }
+	const glm::quat& GetRotation() const { return(m_rotation); }
+	const glm::vec3& GetPosition() const { return(m_position); }
+	// get the matrix that scales, then rotates, then translates
+	const glm::mat4& GetMatrix() const { return(m_matrix); }
+
+private:
+	glm::vec3 m_scale;
+	glm::quat m_rotation;
+	glm::vec3 m_position;
+	// the matrix of the values above, built by the constructor
+	glm::mat4 m_matrix;
+};
@@ -0,0 +1,332 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.cpp
+// ============
+// compose the world matrices of many objects in one pass from their scale,
+// rotation and translation
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformBatch.h"
+
+// only declared when the project is built with GLM_FORCE_INTRINSICS
+#include <glm/simd/matrix.h>
+#include <glm/gtc/type_ptr.hpp>
+
+/***********************************************************
+ *  TransformBatch()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformBatch::TransformBatch()
+{
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding an object to the batch.
+ *  A parent that is not in the batch yet is ignored, which
+ *  keeps every parent stored before its children.  The
+ *  index of the new object is returned.
+ ***********************************************************/
+int TransformBatch::Add(
+	int parent,
+	const glm::vec3& scale,
+	const glm::quat& rotation,
+	const glm::vec3& position)
+{
+	if (parent >= (int)m_parents.size())
+	{
+		parent = -1;
+	}
+
+	m_parents.push_back(parent);
+	m_scaleX.push_back(0.0f);
+	m_scaleY.push_back(0.0f);
+	m_scaleZ.push_back(0.0f);
+	m_rotationX.push_back(0.0f);
+	m_rotationY.push_back(0.0f);
+	m_rotationZ.push_back(0.0f);
+	m_rotationW.push_back(1.0f);
+	m_positionX.push_back(0.0f);
+	m_positionY.push_back(0.0f);
+	m_positionZ.push_back(0.0f);
+	m_worldMatrices.push_back(glm::mat4(1.0f));
+
+	int index = (int)m_parents.size() - 1;
+	Set(index, scale, rotation, position);
+
+	return(index);
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for making room for the passed in
+ *  number of objects, so adding them does not grow the
+ *  arrays over and over.
+ ***********************************************************/
+void TransformBatch::Reserve(int count)
+{
+	m_parents.reserve(count);
+	m_scaleX.reserve(count);
+	m_scaleY.reserve(count);
+	m_scaleZ.reserve(count);
+	m_rotationX.reserve(count);
+	m_rotationY.reserve(count);
+	m_rotationZ.reserve(count);
+	m_rotationW.reserve(count);
+	m_positionX.reserve(count);
+	m_positionY.reserve(count);
+	m_positionZ.reserve(count);
+	m_worldMatrices.reserve(count);
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  This method is used for changing the transformation of
+ *  an object relative to its parent.  The world matrix is
+ *  composed again by the next ComposeWorldMatrices().
+ ***********************************************************/
+void TransformBatch::Set(
+	int index,
+	const glm::vec3& scale,
+	const glm::quat& rotation,
+	const glm::vec3& position)
+{
+	if ((index < 0) || (index >= (int)m_parents.size()))
+	{
+		return;
+	}
+
+	m_scaleX[index] = scale.x;
+	m_scaleY[index] = scale.y;
+	m_scaleZ[index] = scale.z;
+	m_rotationX[index] = rotation.x;
+	m_rotationY[index] = rotation.y;
+	m_rotationZ[index] = rotation.z;
+	m_rotationW[index] = rotation.w;
+	m_positionX[index] = position.x;
+	m_positionY[index] = position.y;
+	m_positionZ[index] = position.z;
+}
+
+/***********************************************************
+ *  ComposeWorldMatrices()
+ *
+ *  This method is used for composing the world matrices of
+ *  the flagged objects.  The local matrices of four objects
+ *  are built at once, with the rotation matrix of each lane
+ *  taken from its quaternion and its columns scaled, then
+ *  the columns are moved into one matrix per object by a
+ *  transpose.  Each local matrix is multiplied by the world
+ *  matrix of its parent, in order, so a parent in the same
+ *  four objects is already composed.  The objects left over
+ *  at the end of the arrays, or every object without SSE,
+ *  are composed one at a time.
+ ***********************************************************/
+void TransformBatch::ComposeWorldMatrices(const unsigned char* dirty)
+{
+	int count = (int)m_parents.size();
+	int i = 0;
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+	const glm_vec4 one = _mm_set1_ps(1.0f);
+	const glm_vec4 zero = _mm_setzero_ps();
+
+	for (; i + 4 <= count; i += 4)
+	{
+		if ((NULL != dirty) && ((dirty[i] | dirty[i + 1] | dirty[i + 2] | dirty[i + 3]) == 0))
+		{
+			continue;
+		}
+
+		glm_vec4 x = _mm_loadu_ps(&m_rotationX[i]);
+		glm_vec4 y = _mm_loadu_ps(&m_rotationY[i]);
+		glm_vec4 z = _mm_loadu_ps(&m_rotationZ[i]);
+		glm_vec4 w = _mm_loadu_ps(&m_rotationW[i]);
+		glm_vec4 scaleX = _mm_loadu_ps(&m_scaleX[i]);
+		glm_vec4 scaleY = _mm_loadu_ps(&m_scaleY[i]);
+		glm_vec4 scaleZ = _mm_loadu_ps(&m_scaleZ[i]);
+
+		// twice the products of the quaternion values
+		glm_vec4 x2 = _mm_add_ps(x, x);
+		glm_vec4 y2 = _mm_add_ps(y, y);
+		glm_vec4 z2 = _mm_add_ps(z, z);
+		glm_vec4 xx = _mm_mul_ps(x, x2);
+		glm_vec4 yy = _mm_mul_ps(y, y2);
+		glm_vec4 zz = _mm_mul_ps(z, z2);
+		glm_vec4 xy = _mm_mul_ps(x, y2);
+		glm_vec4 xz = _mm_mul_ps(x, z2);
+		glm_vec4 yz = _mm_mul_ps(y, z2);
+		glm_vec4 wx = _mm_mul_ps(w, x2);
+		glm_vec4 wy = _mm_mul_ps(w, y2);
+		glm_vec4 wz = _mm_mul_ps(w, z2);
+
+		// columns[c][r] holds row r of column c for the four objects
+		glm_vec4 columns[4][4];
+		columns[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scaleX);
+		columns[0][1] = _mm_mul_ps(_mm_add_ps(xy, wz), scaleX);
+		columns[0][2] = _mm_mul_ps(_mm_sub_ps(xz, wy), scaleX);
+		columns[0][3] = zero;
+		columns[1][0] = _mm_mul_ps(_mm_sub_ps(xy, wz), scaleY);
+		columns[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scaleY);
+		columns[1][2] = _mm_mul_ps(_mm_add_ps(yz, wx), scaleY);
+		columns[1][3] = zero;
+		columns[2][0] = _mm_mul_ps(_mm_add_ps(xz, wy), scaleZ);
+		columns[2][1] = _mm_mul_ps(_mm_sub_ps(yz, wx), scaleZ);
+		columns[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scaleZ);
+		columns[2][3] = zero;
+		columns[3][0] = _mm_loadu_ps(&m_positionX[i]);
+		columns[3][1] = _mm_loadu_ps(&m_positionY[i]);
+		columns[3][2] = _mm_loadu_ps(&m_positionZ[i]);
+		columns[3][3] = one;
+
+		// after the transpose columns[c][lane] is column c of one object
+		for (int c = 0; c < 4; c++)
+		{
+			_MM_TRANSPOSE4_PS(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+		}
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			int index = i + lane;
+			if ((NULL != dirty) && (dirty[index] == 0))
+			{
+				continue;
+			}
+
+			glm_vec4 local[4] = { columns[0][lane], columns[1][lane], columns[2][lane], columns[3][lane] };
+			float* world = glm::value_ptr(m_worldMatrices[index]);
+			int parent = m_parents[index];
+
+			if (parent >= 0)
+			{
+				const float* parentWorld = glm::value_ptr(m_worldMatrices[parent]);
+				glm_vec4 parentColumns[4];
+				glm_vec4 product[4];
+				for (int c = 0; c < 4; c++)
+				{
+					parentColumns[c] = _mm_loadu_ps(parentWorld + c * 4);
+				}
+				glm_mat4_mul(parentColumns, local, product);
+				for (int c = 0; c < 4; c++)
+				{
+					_mm_storeu_ps(world + c * 4, product[c]);
+				}
+			}
+			else
+			{
+				for (int c = 0; c < 4; c++)
+				{
+					_mm_storeu_ps(world + c * 4, local[c]);
+				}
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		if ((NULL == dirty) || (dirty[i] != 0))
+		{
+			ComposeWorldMatrix(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  ComposeWorldMatricesScalar()
+ *
+ *  This method is used for composing the world matrices of
+ *  the flagged objects one at a time, for comparing with
+ *  the batch.
+ ***********************************************************/
+void TransformBatch::ComposeWorldMatricesScalar(const unsigned char* dirty)
+{
+	int count = (int)m_parents.size();
+
+	for (int i = 0; i < count; i++)
+	{
+		if ((NULL == dirty) || (dirty[i] != 0))
+		{
+			ComposeWorldMatrix(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  ComposeWorldMatrix()
+ *
+ *  This method is used for composing the world matrix of
+ *  one object from its local matrix and the world matrix
+ *  of its parent.
+ ***********************************************************/
+void TransformBatch::ComposeWorldMatrix(int index)
+{
+	glm::mat4 local = ComposeLocalMatrix(
+		glm::vec3(m_scaleX[index], m_scaleY[index], m_scaleZ[index]),
+		glm::quat(m_rotationW[index], m_rotationX[index], m_rotationY[index], m_rotationZ[index]),
+		glm::vec3(m_positionX[index], m_positionY[index], m_positionZ[index]));
+
+	if (m_parents[index] >= 0)
+	{
+		m_worldMatrices[index] = m_worldMatrices[m_parents[index]] * local;
+	}
+	else
+	{
+		m_worldMatrices[index] = local;
+	}
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all of the objects.
+ ***********************************************************/
+void TransformBatch::Clear()
+{
+	m_parents.clear();
+	m_scaleX.clear();
+	m_scaleY.clear();
+	m_scaleZ.clear();
+	m_rotationX.clear();
+	m_rotationY.clear();
+	m_rotationZ.clear();
+	m_rotationW.clear();
+	m_positionX.clear();
+	m_positionY.clear();
+	m_positionZ.clear();
+	m_worldMatrices.clear();
+}
+
+/***********************************************************
+ *  ComposeLocalMatrix()
+ *
+ *  This method is used for building the matrix that scales,
+ *  then rotates, then translates, with the rotation matrix
+ *  taken straight from the unit quaternion.
+ ***********************************************************/
+glm::mat4 TransformBatch::ComposeLocalMatrix(
+	const glm::vec3& scale,
+	const glm::quat& rotation,
+	const glm::vec3& position)
+{
+	float xx = rotation.x * rotation.x * 2.0f;
+	float yy = rotation.y * rotation.y * 2.0f;
+	float zz = rotation.z * rotation.z * 2.0f;
+	float xy = rotation.x * rotation.y * 2.0f;
+	float xz = rotation.x * rotation.z * 2.0f;
+	float yz = rotation.y * rotation.z * 2.0f;
+	float wx = rotation.w * rotation.x * 2.0f;
+	float wy = rotation.w * rotation.y * 2.0f;
+	float wz = rotation.w * rotation.z * 2.0f;
+
+	glm::mat4 matrix;
+	matrix[0] = glm::vec4(1.0f - (yy + zz), xy + wz, xz - wy, 0.0f) * scale.x;
+	matrix[1] = glm::vec4(xy - wz, 1.0f - (xx + zz), yz + wx, 0.0f) * scale.y;
+	matrix[2] = glm::vec4(xz + wy, yz - wx, 1.0f - (xx + yy), 0.0f) * scale.z;
+	matrix[3] = glm::vec4(position, 1.0f);
+
+	return(matrix);
+}
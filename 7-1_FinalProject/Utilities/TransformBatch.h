@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.h
+// ============
+// compose the world matrices of many objects in one pass from their scale,
+// rotation and translation
+//
+// The transformation of every object relative to its parent is stored as
+// separate arrays of scale, quaternion rotation and translation values,
+// so the local matrices of four objects are built at once with SSE, with
+// one lane per object.  Each local matrix is then multiplied by the world
+// matrix of its parent with the matrix kernel of glm.  A parent is always
+// stored before its children, so one pass in order composes every world
+// matrix.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+class TransformBatch
+{
+public:
+	// constructor
+	TransformBatch();
+
+	// add an object, returning its index - the parent must already
+	// be in the batch, or -1 for an object placed in world space
+	int Add(
+		int parent,
+		const glm::vec3& scale,
+		const glm::quat& rotation,
+		const glm::vec3& position);
+
+	// make room for the passed in number of objects
+	void Reserve(int count);
+
+	// change the transformation of an object relative to its parent
+	void Set(
+		int index,
+		const glm::vec3& scale,
+		const glm::quat& rotation,
+		const glm::vec3& position);
+
+	// compose the world matrices of the objects with a nonzero
+	// flag, or of every object when the flags are NULL - the
+	// parents of a flagged object must already be up to date
+	void ComposeWorldMatrices(const unsigned char* dirty = NULL);
+	// compose the same world matrices one object at a time,
+	// without SSE
+	void ComposeWorldMatricesScalar(const unsigned char* dirty = NULL);
+
+	// remove all of the objects
+	void Clear();
+
+	int GetCount() const { return((int)m_parents.size()); }
+	const glm::mat4& GetWorldMatrix(int index) const { return(m_worldMatrices[index]); }
+	const glm::mat4* GetWorldMatrices() const { return(m_worldMatrices.data()); }
+
+	// build the local matrix of one object, the same way the
+	// batch does - the rotation must be a unit quaternion
+	static glm::mat4 ComposeLocalMatrix(
+		const glm::vec3& scale,
+		const glm::quat& rotation,
+		const glm::vec3& position);
+
+private:
+	// the parent of every object, -1 for none
+	std::vector<int> m_parents;
+	// the transformations relative to the parents, one array for
+	// each value so four objects are loaded at once
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_scaleZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_rotationW;
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	// the composed world matrices
+	std::vector<glm::mat4> m_worldMatrices;
+
+	// compose the world matrix of one object
+	void ComposeWorldMatrix(int index);
+};
@@ -0,0 +1,411 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexcacheoptimizer.cpp
+// ============
+// reorder indexed triangle lists so that the GPU transforms fewer vertices
+// and shades fewer hidden pixels
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VertexCacheOptimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	/***********************************************************
+	 *  HashVertex()
+	 *
+	 *  Get the FNV-1a hash of the bytes of a vertex, so that
+	 *  identical vertices can be found without comparing each
+	 *  pair.
+	 ***********************************************************/
+	unsigned long long HashVertex(const float* vertex, size_t floatsPerVertex)
+	{
+		const unsigned char* bytes = (const unsigned char*)vertex;
+		unsigned long long hash = 14695981039346656037ULL;
+
+		for (size_t i = 0; i < floatsPerVertex * sizeof(float); i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  GetPosition()
+	 *
+	 *  Get the position of a vertex, from its first three
+	 *  floats.
+	 ***********************************************************/
+	glm::vec3 GetPosition(const float* vertices, size_t floatsPerVertex, unsigned int vertex)
+	{
+		const float* position = vertices + (size_t)vertex * floatsPerVertex;
+		return(glm::vec3(position[0], position[1], position[2]));
+	}
+}
+
+/***********************************************************
+ *  OptimizeTriangleOrder()
+ *
+ *  This method is used for reordering the triangles with the
+ *  Tipsify algorithm.  Every triangle around the fanning
+ *  vertex is drawn, then the next fanning vertex is the one
+ *  of those just drawn that has been in the cache longest
+ *  and will not be pushed out by its own triangles.  When
+ *  none is left the most recent vertex with triangles left
+ *  is used, or failing that the next vertex in order, which
+ *  usually starts over with a cold cache.
+ ***********************************************************/
+void VertexCacheOptimizer::OptimizeTriangleOrder(
+	unsigned int* indices,
+	size_t indexCount,
+	size_t vertexCount,
+	int cacheSize,
+	std::vector<size_t>& clusterStarts)
+{
+	size_t triangleCount = indexCount / 3;
+
+	clusterStarts.clear();
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	// the triangles left to draw around each vertex, and the
+	// triangles of every vertex stored vertex by vertex
+	std::vector<unsigned int> liveCounts(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		liveCounts[indices[i]]++;
+	}
+
+	std::vector<size_t> firstTriangles(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		firstTriangles[v + 1] = firstTriangles[v] + liveCounts[v];
+	}
+
+	std::vector<unsigned int> vertexTriangles(triangleCount * 3);
+	std::vector<size_t> fillPositions(firstTriangles.begin(), firstTriangles.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		vertexTriangles[fillPositions[indices[i]]++] = (unsigned int)(i / 3);
+	}
+
+	// a vertex is in the cache while fewer than the cache size
+	// vertices have been added since it was
+	std::vector<unsigned int> cacheTimes(vertexCount, 0);
+	std::vector<unsigned char> drawn(triangleCount, 0);
+	std::vector<unsigned int> deadEnds;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> ordered;
+	unsigned int timestamp = (unsigned int)cacheSize + 1;
+	size_t cursor = 0;
+	bool bColdCache = true;
+	long long fanning = indices[0];
+
+	ordered.reserve(triangleCount * 3);
+	while (fanning >= 0)
+	{
+		if (bColdCache == true)
+		{
+			clusterStarts.push_back(ordered.size());
+		}
+
+		candidates.clear();
+		for (size_t k = firstTriangles[fanning]; k < firstTriangles[fanning + 1]; k++)
+		{
+			unsigned int triangle = vertexTriangles[k];
+			if (drawn[triangle] != 0)
+			{
+				continue;
+			}
+			drawn[triangle] = 1;
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				unsigned int vertex = indices[triangle * 3 + corner];
+
+				ordered.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveCounts[vertex]--;
+				if (timestamp - cacheTimes[vertex] > (unsigned int)cacheSize)
+				{
+					cacheTimes[vertex] = timestamp++;
+				}
+			}
+		}
+
+		// the oldest vertex that stays in the cache through its fan
+		long long next = -1;
+		int bestPriority = -1;
+		for (size_t i = 0; i < candidates.size(); i++)
+		{
+			unsigned int vertex = candidates[i];
+			if (liveCounts[vertex] == 0)
+			{
+				continue;
+			}
+
+			int priority = 0;
+			unsigned int age = timestamp - cacheTimes[vertex];
+			if (age + 2 * liveCounts[vertex] <= (unsigned int)cacheSize)
+			{
+				priority = (int)age;
+			}
+			if (priority > bestPriority)
+			{
+				next = vertex;
+				bestPriority = priority;
+			}
+		}
+
+		bColdCache = false;
+		if (next < 0)
+		{
+			while ((deadEnds.empty() == false) && (next < 0))
+			{
+				unsigned int vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveCounts[vertex] > 0)
+				{
+					next = vertex;
+				}
+			}
+			while ((cursor < vertexCount) && (next < 0))
+			{
+				if (liveCounts[cursor] > 0)
+				{
+					next = (long long)cursor;
+				}
+				cursor++;
+			}
+			if (next >= 0)
+			{
+				bColdCache = (timestamp - cacheTimes[next] > (unsigned int)cacheSize);
+			}
+		}
+		fanning = next;
+	}
+
+	std::copy(ordered.begin(), ordered.end(), indices);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This method is used for sorting the runs of triangles
+ *  found by OptimizeTriangleOrder(), which each start with
+ *  a cold cache so sorting them costs little cache reuse.
+ *  A run facing out from the center of the mesh is likely
+ *  to cover the others from any view, so the runs are drawn
+ *  by how far their centers lie along their normals from
+ *  the center of the mesh, farthest first.
+ ***********************************************************/
+void VertexCacheOptimizer::OptimizeOverdraw(
+	unsigned int* indices,
+	size_t indexCount,
+	const float* vertices,
+	size_t vertexCount,
+	size_t floatsPerVertex,
+	const std::vector<size_t>& clusterStarts)
+{
+	size_t triangleIndexCount = (indexCount / 3) * 3;
+
+	if ((clusterStarts.size() < 2) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	// the center of the mesh, weighted by the triangle areas
+	std::vector<glm::vec3> clusterCenters(clusterStarts.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterStarts.size(), glm::vec3(0.0f));
+	std::vector<float> clusterAreas(clusterStarts.size(), 0.0f);
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+
+	for (size_t cluster = 0; cluster < clusterStarts.size(); cluster++)
+	{
+		size_t end = (cluster + 1 < clusterStarts.size()) ? clusterStarts[cluster + 1] : triangleIndexCount;
+		for (size_t i = clusterStarts[cluster]; i < end; i += 3)
+		{
+			glm::vec3 p0 = GetPosition(vertices, floatsPerVertex, indices[i]);
+			glm::vec3 p1 = GetPosition(vertices, floatsPerVertex, indices[i + 1]);
+			glm::vec3 p2 = GetPosition(vertices, floatsPerVertex, indices[i + 2]);
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+
+			clusterCenters[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+			clusterNormals[cluster] += normal;
+			clusterAreas[cluster] += area;
+		}
+		meshCenter += clusterCenters[cluster];
+		meshArea += clusterAreas[cluster];
+	}
+	if (meshArea <= 0.0f)
+	{
+		return;
+	}
+	meshCenter /= meshArea;
+
+	std::vector<float> potentials(clusterStarts.size(), 0.0f);
+	std::vector<size_t> clusterOrder(clusterStarts.size());
+	for (size_t cluster = 0; cluster < clusterStarts.size(); cluster++)
+	{
+		if ((clusterAreas[cluster] > 0.0f) && (glm::length(clusterNormals[cluster]) > 0.0f))
+		{
+			glm::vec3 center = clusterCenters[cluster] / clusterAreas[cluster];
+			potentials[cluster] = glm::dot(center - meshCenter, glm::normalize(clusterNormals[cluster]));
+		}
+		clusterOrder[cluster] = cluster;
+	}
+
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+		[&potentials](size_t a, size_t b) { return(potentials[a] > potentials[b]); });
+
+	std::vector<unsigned int> ordered;
+	ordered.reserve(triangleIndexCount);
+	for (size_t i = 0; i < clusterOrder.size(); i++)
+	{
+		size_t cluster = clusterOrder[i];
+		size_t end = (cluster + 1 < clusterStarts.size()) ? clusterStarts[cluster + 1] : triangleIndexCount;
+		ordered.insert(ordered.end(), indices + clusterStarts[cluster], indices + end);
+	}
+
+	std::copy(ordered.begin(), ordered.end(), indices);
+}
+
+/***********************************************************
+ *  OptimizeVertexOrder()
+ *
+ *  This method is used for merging the vertices that have
+ *  identical values, and numbering the vertices in the order
+ *  the triangles first use them, so that the vertex fetches
+ *  walk forward through memory.  The vertices no triangle
+ *  uses yet are kept, after the used ones, since more
+ *  triangles may still be added for them.
+ ***********************************************************/
+size_t VertexCacheOptimizer::OptimizeVertexOrder(
+	unsigned int* indices,
+	size_t indexCount,
+	float* vertices,
+	size_t vertexCount,
+	size_t floatsPerVertex,
+	std::vector<unsigned int>& remap)
+{
+	size_t vertexBytes = floatsPerVertex * sizeof(float);
+	std::vector<unsigned int> firstCopies(vertexCount);
+	std::unordered_multimap<unsigned long long, unsigned int> hashedVertices;
+
+	// find the first vertex with the values of each vertex
+	hashedVertices.reserve(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		const float* vertex = vertices + v * floatsPerVertex;
+		unsigned long long hash = HashVertex(vertex, floatsPerVertex);
+
+		firstCopies[v] = (unsigned int)v;
+		auto range = hashedVertices.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (memcmp(vertices + (size_t)it->second * floatsPerVertex, vertex, vertexBytes) == 0)
+			{
+				firstCopies[v] = it->second;
+				break;
+			}
+		}
+		if (firstCopies[v] == v)
+		{
+			hashedVertices.insert(std::make_pair(hash, (unsigned int)v));
+		}
+	}
+
+	remap.assign(vertexCount, UINT_MAX);
+	unsigned int nextVertex = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		unsigned int vertex = firstCopies[indices[i]];
+		if (remap[vertex] == UINT_MAX)
+		{
+			remap[vertex] = nextVertex++;
+		}
+		indices[i] = remap[vertex];
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		if ((firstCopies[v] == v) && (remap[v] == UINT_MAX))
+		{
+			remap[v] = nextVertex++;
+		}
+	}
+
+	std::vector<float> ordered((size_t)nextVertex * floatsPerVertex);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		if (firstCopies[v] == v)
+		{
+			memcpy(&ordered[(size_t)remap[v] * floatsPerVertex], vertices + v * floatsPerVertex, vertexBytes);
+		}
+	}
+	std::copy(ordered.begin(), ordered.end(), vertices);
+
+	// the merged vertices take the number of their first copy
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		remap[v] = remap[firstCopies[v]];
+	}
+
+	return(nextVertex);
+}
+
+/***********************************************************
+ *  MeasureCache()
+ *
+ *  This method is used for simulating a FIFO post-transform
+ *  cache of the passed in size over the triangles, and
+ *  counting the vertices that miss the cache.  The average
+ *  cache miss ratio (ACMR) is the count per triangle, and
+ *  the average transform to vertex ratio (ATVR) is the count
+ *  per vertex used, which does not depend on the mesh shape.
+ ***********************************************************/
+VertexCacheOptimizer::CACHE_STATS VertexCacheOptimizer::MeasureCache(
+	const unsigned int* indices,
+	size_t indexCount,
+	size_t vertexCount,
+	int cacheSize)
+{
+	CACHE_STATS stats = { 0.0, 0.0 };
+	size_t triangleCount = indexCount / 3;
+	std::vector<unsigned int> cacheTimes(vertexCount, 0);
+	std::vector<unsigned char> used(vertexCount, 0);
+	unsigned int timestamp = (unsigned int)cacheSize + 1;
+	size_t transformed = 0;
+	size_t usedCount = 0;
+
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		unsigned int vertex = indices[i];
+		if (timestamp - cacheTimes[vertex] > (unsigned int)cacheSize)
+		{
+			cacheTimes[vertex] = timestamp++;
+			transformed++;
+		}
+		if (used[vertex] == 0)
+		{
+			used[vertex] = 1;
+			usedCount++;
+		}
+	}
+
+	if (triangleCount > 0)
+	{
+		stats.acmr = (double)transformed / triangleCount;
+		stats.atvr = (double)transformed / usedCount;
+	}
+	return(stats);
+}
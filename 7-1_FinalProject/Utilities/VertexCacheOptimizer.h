@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexcacheoptimizer.h
+// ============
+// reorder indexed triangle lists so that the GPU transforms fewer vertices
+// and shades fewer hidden pixels
+//
+// The triangles are ordered with the Tipsify algorithm, which fans out
+// around one vertex at a time and picks the next vertex from those still
+// in a simulated post-transform cache.  The runs of triangles that start
+// with a cold cache are then sorted so the ones facing out from the mesh
+// are drawn first and hide the rest.  Finally the vertices are merged
+// when their values are identical, and numbered in the order that the
+// triangles first use them, so that they are fetched in memory order.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+class VertexCacheOptimizer
+{
+public:
+	// vertices kept by the simulated post-transform cache, a little
+	// under the caches of current GPUs so the order suits them all
+	static const int DEFAULT_CACHE_SIZE = 16;
+
+	// how well a triangle list reuses the vertices in a cache
+	struct CACHE_STATS
+	{
+		double acmr;        // vertices transformed per triangle, 3 at worst
+		double atvr;        // vertices transformed per vertex used, 1 at best
+	};
+
+	// reorder the triangles for the cache, passing back the
+	// first index of every run that starts with a cold cache
+	static void OptimizeTriangleOrder(
+		unsigned int* indices,
+		size_t indexCount,
+		size_t vertexCount,
+		int cacheSize,
+		std::vector<size_t>& clusterStarts);
+
+	// reorder the runs of triangles so the ones facing out from
+	// the center of the mesh are drawn first - the positions are
+	// the first three floats of every vertex
+	static void OptimizeOverdraw(
+		unsigned int* indices,
+		size_t indexCount,
+		const float* vertices,
+		size_t vertexCount,
+		size_t floatsPerVertex,
+		const std::vector<size_t>& clusterStarts);
+
+	// merge the identical vertices, and number the vertices in the
+	// order they are first used, passing back the new number of
+	// every vertex and returning the new vertex count - the unused
+	// vertices are kept after the used ones
+	static size_t OptimizeVertexOrder(
+		unsigned int* indices,
+		size_t indexCount,
+		float* vertices,
+		size_t vertexCount,
+		size_t floatsPerVertex,
+		std::vector<unsigned int>& remap);
+
+	// count the vertices a FIFO cache of the passed in size
+	// transforms to draw the triangles
+	static CACHE_STATS MeasureCache(
+		const unsigned int* indices,
+		size_t indexCount,
+		size_t vertexCount,
+		int cacheSize);
+};
@@ -1,5 +1,13 @@
 #version 440 core
 
+// the texture arrays are sampled through bindless handles when
+// the driver has them, which SceneManager checks for as well
+#ifdef GL_ARB_bindless_texture
+#extension GL_ARB_bindless_texture : require
+#endif
+
+// the member order of these structs is packed for the std140
+// layout and must match the structs uploaded by SceneManager
 struct Material 
 {
     vec3 ambientColor;
@@ -12,32 +20,62 @@ struct Material
 struct LightSource 
 {
     vec3 position;	
+    float focalStrength;
     vec3 ambientColor;
+    float specularIntensity;
     vec3 diffuseColor;
     vec3 specularColor;
-    float focalStrength;
-    float specularIntensity;
 };
 
 #define TOTAL_LIGHTS 1
+#define MAX_MATERIALS 32
+#define MAX_TEXTURE_ARRAYS 16
 
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
+// object values, from the uniforms or from the instance attributes
+flat in vec4 fragmentObjectColor;
+flat in vec2 fragmentUVScale;
+flat in int fragmentMaterialIndex;
+// texture array layer times MAX_TEXTURE_ARRAYS plus the texture
+// array, -1 when the object is not textured, or -2 while the
+// image of the texture is still being decoded
+flat in int fragmentTexture;
 
 out vec4 outFragmentColor;
 
-uniform bool bUseTexture=false;
 uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
-uniform sampler2D objectTexture;
 uniform vec3 viewPosition;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
-uniform LightSource lightSources[TOTAL_LIGHTS];
-uniform Material material;
+// number of texture arrays holding decoded images
+uniform int textureArrayCount = 0;
+
+// material table, written once when the materials are defined
+layout(std140) uniform MaterialBlock
+{
+    Material materials[MAX_MATERIALS];
+};
+
+// light sources, written once when the lights are set up
+layout(std140) uniform LightBlock
+{
+    LightSource lightSources[TOTAL_LIGHTS];
+};
+
+#ifdef GL_ARB_bindless_texture
+// bindless handles of the texture arrays, in the xy components
+layout(std140) uniform TextureBlock
+{
+    uvec4 textureHandles[MAX_TEXTURE_ARRAYS];
+};
+#else
+// texture arrays, each bound to the texture unit of its index
+uniform sampler2DArray textureArrays[MAX_TEXTURE_ARRAYS];
+#endif
 
 // function prototypes
-vec3 CalcLightSource(LightSource light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcLightSource(LightSource light, Material material, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec4 SampleObjectTexture(int objectTexture, vec2 textureCoordinate);
 
 void main()
 {
@@ -47,37 +85,74 @@ void main()
       vec3 lightNormal = normalize(fragmentVertexNormal);
       vec3 viewDirection = normalize(viewPosition - fragmentPosition);
       vec3 phongResult = vec3(0.0f);
+      Material material = materials[fragmentMaterialIndex];
 
       for(int i = 0; i < TOTAL_LIGHTS; i++)
       {
-         phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection);
+         phongResult += CalcLightSource(lightSources[i], material, lightNormal, fragmentPosition, viewDirection);
       }
       
-      if(bUseTexture == true)
+      if(fragmentTexture != -1)
       {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         vec4 textureColor = SampleObjectTexture(fragmentTexture, fragmentTextureCoordinate * fragmentUVScale);
          outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
       }
       else
       {
-         outFragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
+         outFragmentColor = vec4(phongResult * fragmentObjectColor.xyz, fragmentObjectColor.w);
       }
    }
    else 
    {
-      if(bUseTexture == true)
+      if(fragmentTexture != -1)
       {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         outFragmentColor = SampleObjectTexture(fragmentTexture, fragmentTextureCoordinate * fragmentUVScale);
       }
       else
       {
-         outFragmentColor = objectColor;
+         outFragmentColor = fragmentObjectColor;
       }
    }
 }
 
+// the textures of the instances of one draw can be in different
+// texture arrays, so the arrays are only indexed with the loop
+// counter, which is the same for every fragment - the derivatives
+// are taken outside the loop for the same reason, and the loop
+// stops at the arrays in use, since each one costs a sample on
+// drivers that run both sides of a branch
+vec4 SampleObjectTexture(int objectTexture, vec2 textureCoordinate)
+{
+    vec2 dx = dFdx(textureCoordinate);
+    vec2 dy = dFdy(textureCoordinate);
+
+    // grey placeholder until the image is decoded
+    if(objectTexture < -1)
+    {
+        return vec4(vec3(128.0f / 255.0f), 1.0f);
+    }
+
+    int textureArray = objectTexture % MAX_TEXTURE_ARRAYS;
+    vec3 layerCoordinate = vec3(textureCoordinate, float(objectTexture / MAX_TEXTURE_ARRAYS));
+    vec4 textureColor = vec4(0.0f);
+
+    for(int i = 0; i < textureArrayCount; i++)
+    {
+        if(i == textureArray)
+        {
+#ifdef GL_ARB_bindless_texture
+            textureColor = textureGrad(sampler2DArray(textureHandles[i].xy), layerCoordinate, dx, dy);
+#else
+            textureColor = textureGrad(textureArrays[i], layerCoordinate, dx, dy);
+#endif
+        }
+    }
+
+    return textureColor;
+}
+
 // taken and modified from https://opentk.net/learn/chapter2/6-multiple-lights.html
-vec3 CalcLightSource(LightSource light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcLightSource(LightSource light, Material material, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
     // values for attenuation
     //#define light_constant 0.02
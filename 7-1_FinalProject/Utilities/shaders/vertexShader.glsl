@@ -3,18 +3,87 @@ layout (location = 0) in vec3 inVertexPosition;
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
 
+// per-instance values, only read when drawing instanced
+// - the model matrix takes locations 3 to 6
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceColor;
+// xy is the UV scale, z is the material index, w is the texture
+layout (location = 8) in vec4 inInstanceParams;
+// scale and offset moving packed positions into object space
+layout (location = 9) in vec3 inInstanceDecodeScale;
+layout (location = 10) in vec3 inInstanceDecodeOffset;
+
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec2 fragmentTextureCoordinate;
+flat out vec4 fragmentObjectColor;
+flat out vec2 fragmentUVScale;
+flat out int fragmentMaterialIndex;
+flat out int fragmentTexture;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform bool bUseInstancing = false;
+// set when the vertices are packed - the positions are then steps
+// across the bounding box given by the decode scale and offset,
+// and the xy of the normal is a point on the unfolded octahedron
+uniform bool bPackedVertices = false;
+uniform vec3 positionDecodeScale = vec3(1.0f);
+uniform vec3 positionDecodeOffset = vec3(0.0f);
+uniform vec4 objectColor = vec4(1.0f);
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+uniform int materialIndex = 0;
+// texture array layer times MAX_TEXTURE_ARRAYS plus the texture
+// array, -1 when the object is not textured, or -2 while the
+// image of the texture is still being decoded
+uniform int objectTexture = -1;
+
+// unit normal of a point on the octahedron |x| + |y| + |z| = 1
+// unfolded into the -1 to 1 square
+vec3 DecodeOctahedral(vec2 encoded)
+{
+   vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   if(normal.z < 0.0)
+   {
+      normal.xy = (1.0 - abs(encoded.yx)) * vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+   }
+   return normalize(normal);
+}
 
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
+   mat4 objectModel = model;
+   vec3 decodeScale = positionDecodeScale;
+   vec3 decodeOffset = positionDecodeOffset;
+
+   if(bUseInstancing == true)
+   {
+      objectModel = inInstanceModel;
+      decodeScale = inInstanceDecodeScale;
+      decodeOffset = inInstanceDecodeOffset;
+      fragmentObjectColor = inInstanceColor;
+      fragmentUVScale = inInstanceParams.xy;
+      fragmentMaterialIndex = int(inInstanceParams.z + 0.5);
+      fragmentTexture = int(floor(inInstanceParams.w + 0.5));
+   }
+   else
+   {
+      fragmentObjectColor = objectColor;
+      fragmentUVScale = UVscale;
+      fragmentMaterialIndex = materialIndex;
+      fragmentTexture = objectTexture;
+   }
+
+   vec3 position = inVertexPosition;
    fragmentVertexNormal = inVertexNormal;
+   if(bPackedVertices == true)
+   {
+      position = inVertexPosition * decodeScale + decodeOffset;
+      fragmentVertexNormal = DecodeOctahedral(inVertexNormal.xy);
+   }
+
+   fragmentPosition = vec3(objectModel * vec4(position, 1.0));
+   gl_Position = projection * view * objectModel * vec4(position, 1.0f);
    fragmentTextureCoordinate = inTextureCoordinate;
-}
\ No newline at end of file
+}